@@ -0,0 +1,151 @@
+// hostArduino.cpp - Arduino core stand-in (native build)
+// This module implements Serial, Print, the time functions and GPIO stubs declared in
+// host/include/Arduino.h.
+//
+// Key features:
+// - Serial output goes to stdout, line-buffered, safe to use from several tasks
+// - Serial input reads stdin without blocking (the console works when input is piped)
+// - GPIO writes are logged with HOST_LOG_GPIO
+
+#include <Arduino.h> // Include header for this module
+#include <stdarg.h> // va_list
+#include <fcntl.h> // Non-blocking stdin
+#include <unistd.h> // read
+#include <chrono> // Monotonic clock
+
+HardwareSerial Serial;
+
+// Program start (time zero of millis/micros/esp_timer)
+static const std::chrono::steady_clock::time_point hostStart = std::chrono::steady_clock::now();
+// One byte read ahead from stdin by available() (-1 = none)
+static int serialPeek = -1;
+
+int64_t esp_timer_get_time() {
+    auto elapsed = std::chrono::steady_clock::now() - hostStart;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+unsigned long millis() {
+    return esp_timer_get_time() / 1000;
+}
+
+unsigned long micros() {
+    return esp_timer_get_time();
+}
+
+void delay(uint32_t ms) {
+    vTaskDelay(ms / portTICK_PERIOD_MS);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+#if defined(HOST_LOG_GPIO)
+    printf("[Host] pinMode(%u, %u)\n", pin, mode);
+#endif
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+#if defined(HOST_LOG_GPIO)
+    printf("[Host] digitalWrite(%u, %u)\n", pin, value);
+#endif
+}
+
+int digitalRead(uint8_t pin) {
+    return HIGH; // Keys are active low: released
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+}
+
+size_t Print::write(const char *str) {
+    return str ? write((const uint8_t *)str, strlen(str)) : 0;
+}
+
+size_t Print::print(const char *str) { return write(str); }
+size_t Print::print(const String &str) { return write(str.c_str()); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(int value) { return printf("%d", value); }
+size_t Print::print(unsigned int value) { return printf("%u", value); }
+size_t Print::print(long value) { return printf("%ld", value); }
+size_t Print::print(unsigned long value) { return printf("%lu", value); }
+size_t Print::print(double value, int digits) { return printf("%.*f", digits, value); }
+size_t Print::println() { return write("\r\n"); }
+size_t Print::println(const char *str) { return print(str) + println(); }
+size_t Print::println(const String &str) { return print(str) + println(); }
+size_t Print::println(int value) { return print(value) + println(); }
+size_t Print::println(unsigned int value) { return print(value) + println(); }
+size_t Print::println(long value) { return print(value) + println(); }
+size_t Print::println(unsigned long value) { return print(value) + println(); }
+size_t Print::println(double value, int digits) { return print(value, digits) + println(); }
+
+size_t Print::printf(const char *format, ...) {
+    char small[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    if ((size_t)len < sizeof(small)) return write((const uint8_t *)small, len);
+    char *big = (char *)malloc(len + 1); // Long output (e.g. trace JSON lines)
+    if (!big) return 0;
+    va_start(args, format);
+    vsnprintf(big, len + 1, format, args);
+    va_end(args);
+    size_t n = write((const uint8_t *)big, len);
+    free(big);
+    return n;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (c == '\r') return 1; // Print::println sends CRLF; keep host logs LF only
+    return fputc(c, stdout) == EOF ? 0 : 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+    flockfile(stdout); // Keep one call's output together across tasks
+    size_t n = 0;
+    for (size_t i = 0; i < size; i++) {
+        if (buffer[i] != '\r' && putc_unlocked(buffer[i], stdout) == EOF) break;
+        n++;
+    }
+    funlockfile(stdout);
+    return n;
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+int HardwareSerial::available() {
+    if (serialPeek >= 0) return 1;
+    int flags = fcntl(STDIN_FILENO, F_GETFL);
+    fcntl(STDIN_FILENO, F_SETFL, flags | O_NONBLOCK);
+    unsigned char c;
+    if (::read(STDIN_FILENO, &c, 1) == 1) serialPeek = c;
+    fcntl(STDIN_FILENO, F_SETFL, flags);
+    return serialPeek >= 0 ? 1 : 0;
+}
+
+int HardwareSerial::read() {
+    if (!available()) return -1;
+    int c = serialPeek;
+    serialPeek = -1;
+    return c;
+}
+
+String HardwareSerial::readStringUntil(char terminator) {
+    String line;
+    unsigned long start = millis();
+    while (millis() - start < 1000) { // Arduino Stream default timeout
+        int c = read();
+        if (c < 0) {
+            delay(1);
+            continue;
+        }
+        if (c == terminator) break;
+        line += (char)c;
+    }
+    return line;
+}
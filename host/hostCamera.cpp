@@ -0,0 +1,392 @@
+// hostCamera.cpp - Camera driver stand-in (native build)
+// This module implements esp_camera.h on the host: recorded JPEG frames (or a test pattern)
+// are served through a small pool of frame buffers at a fixed frame rate.
+//
+// Key features:
+// - Preview frames are decoded once per recording frame and cached at the requested size
+// - fb_count buffers; esp_camera_fb_get() waits for a free one (4 s timeout like the driver)
+// - Waits use vTaskDelay, so a camera task deleted while waiting exits cleanly
+// - Register map seeded per mode (timing and converged exposure registers)
+
+#include <esp_camera.h> // Include header for this module
+#include <Arduino.h> // Serial, vTaskDelay
+#include <dirent.h> // Recording directory listing
+#include <algorithm> // sort
+#include <map> // Decoded frame cache
+#include <mutex> // Driver state lock
+#include <string> // File names
+#include <vector> // Buffers
+#include "hostJpeg.h" // JPEG decode/encode
+
+// Frame buffer of the pool
+struct HostFrame {
+    camera_fb_t fb;             // Handed to the firmware
+    std::vector<uint8_t> data;  // Pixel or JPEG storage
+    bool inUse;                 // Owned by the firmware
+};
+
+// Width and height of each framesize_t
+static const uint16_t frameSizes[FRAMESIZE_INVALID][2] = {
+    {96, 96}, {160, 120}, {176, 144}, {240, 176}, {240, 240}, {320, 240}, {400, 296}, {480, 320},
+    {640, 480}, {800, 600}, {1024, 768}, {1280, 720}, {1280, 1024}, {1600, 1200}, {1920, 1080},
+    {720, 1280}, {864, 1536}, {2048, 1536}, {2560, 1440}, {2560, 1600}, {1080, 1920}, {2560, 1920},
+};
+
+// Frame source
+static std::string sourceDir;
+static std::vector<std::string> sourceFiles;
+static int sourceFps = 25;
+// Driver state
+static std::mutex cameraLock;
+static bool cameraReady = false;
+static camera_config_t activeConfig;
+static std::vector<HostFrame> framePool;
+static int64_t nextFrameUs = 0;
+static uint32_t frameCounter = 0;
+// Preview frames decoded from the recording, keyed by file index (for the current size)
+static std::map<size_t, std::vector<uint16_t>> decodedCache;
+static int cacheWidth = 0, cacheHeight = 0;
+// Sensor and its register map
+static sensor_t hostSensor;
+static std::map<int, int> sensorRegisters;
+
+#define HOST_CAMERA_FB_TIMEOUT_MS 4000 // Same as the driver's FB_GET_TIMEOUT
+
+/**
+ * @brief Read a whole host file.
+ */
+static bool HostCamera_ReadFile(const std::string &path, std::vector<uint8_t> &data) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    data.resize(size > 0 ? size : 0);
+    bool ok = size > 0 && fread(data.data(), 1, size, file) == (size_t)size;
+    fclose(file);
+    return ok;
+}
+
+/**
+ * @brief Nearest-neighbor resize of native RGB565 pixels.
+ */
+static void HostCamera_Resize(const std::vector<uint16_t> &src, int srcW, int srcH, std::vector<uint16_t> &dst, int w, int h) {
+    dst.resize((size_t)w * h);
+    for (int y = 0; y < h; y++) {
+        const uint16_t *row = &src[(size_t)(y * srcH / h) * srcW];
+        for (int x = 0; x < w; x++) dst[(size_t)y * w + x] = row[x * srcW / w];
+    }
+}
+
+/**
+ * @brief Render the moving color bar test pattern (native RGB565).
+ */
+static void HostCamera_Pattern(std::vector<uint16_t> &pixels, int w, int h, uint32_t frame) {
+    static const uint16_t bars[8] = {0xFFFF, 0xFFE0, 0x07FF, 0x07E0, 0xF81F, 0xF800, 0x001F, 0x0000};
+    pixels.resize((size_t)w * h);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int bar = ((x + frame * 4) % w) * 8 / w;
+            pixels[(size_t)y * w + x] = bars[bar];
+        }
+    }
+}
+
+/**
+ * @brief Get the native RGB565 image of the next source frame at the configured size.
+ */
+static bool HostCamera_SourceImage(uint32_t frame, int w, int h, std::vector<uint16_t> &pixels) {
+    if (sourceFiles.empty()) {
+        HostCamera_Pattern(pixels, w, h, frame);
+        return true;
+    }
+    size_t index = frame % sourceFiles.size();
+    if (cacheWidth != w || cacheHeight != h) {
+        decodedCache.clear();
+        cacheWidth = w;
+        cacheHeight = h;
+    }
+    auto cached = decodedCache.find(index);
+    if (cached != decodedCache.end()) {
+        pixels = cached->second;
+        return true;
+    }
+    std::vector<uint8_t> jpeg;
+    std::vector<uint16_t> decoded;
+    int srcW, srcH, scale = 1;
+    if (!HostCamera_ReadFile(sourceFiles[index], jpeg) || !HostJpeg_GetSize(jpeg.data(), jpeg.size(), srcW, srcH)) return false;
+    while (scale < 8 && srcW / (scale * 2) >= w && srcH / (scale * 2) >= h) scale *= 2; // Cheapest DCT scale still large enough
+    if (!HostJpeg_Decode(jpeg.data(), jpeg.size(), scale, decoded, srcW, srcH)) return false;
+    HostCamera_Resize(decoded, srcW, srcH, pixels, w, h);
+    decodedCache[index] = pixels;
+    return true;
+}
+
+/**
+ * @brief Fill a pool frame with the next image in the configured format.
+ */
+static bool HostCamera_Fill(HostFrame &frame, uint32_t number) {
+    int w = frameSizes[activeConfig.frame_size][0];
+    int h = frameSizes[activeConfig.frame_size][1];
+    if (activeConfig.pixel_format == PIXFORMAT_JPEG && !sourceFiles.empty()) {
+        int srcW, srcH;
+        std::vector<uint8_t> jpeg;
+        if (!HostCamera_ReadFile(sourceFiles[number % sourceFiles.size()], jpeg)) return false;
+        if (HostJpeg_GetSize(jpeg.data(), jpeg.size(), srcW, srcH) && srcW == w && srcH == h) {
+            frame.data.swap(jpeg); // Recording already has the requested size
+        } else {
+            std::vector<uint16_t> pixels;
+            if (!HostCamera_SourceImage(number, w, h, pixels)) return false;
+            if (!HostJpeg_Encode(pixels.data(), w, h, activeConfig.jpeg_quality, frame.data)) return false;
+        }
+    } else {
+        std::vector<uint16_t> pixels;
+        if (!HostCamera_SourceImage(number, w, h, pixels)) return false;
+        if (activeConfig.pixel_format == PIXFORMAT_JPEG) {
+            if (!HostJpeg_Encode(pixels.data(), w, h, activeConfig.jpeg_quality, frame.data)) return false;
+        } else {
+            frame.data.resize((size_t)w * h * 2);
+            for (size_t i = 0; i < pixels.size(); i++) { // Sensor byte order (big-endian)
+                frame.data[i * 2] = pixels[i] >> 8;
+                frame.data[i * 2 + 1] = pixels[i] & 0xFF;
+            }
+        }
+    }
+    int64_t now = esp_timer_get_time();
+    frame.fb.buf = frame.data.data();
+    frame.fb.len = frame.data.size();
+    frame.fb.width = w;
+    frame.fb.height = h;
+    frame.fb.format = activeConfig.pixel_format;
+    frame.fb.timestamp.tv_sec = now / 1000000;
+    frame.fb.timestamp.tv_usec = now % 1000000;
+    return true;
+}
+
+// Sensor setters: record the value in status
+#define HOST_SENSOR_SETTER(name, field) \
+    static int HostSensor_##name(sensor_t *sensor, int value) { sensor->status.field = value; return 0; }
+HOST_SENSOR_SETTER(SetContrast, contrast)
+HOST_SENSOR_SETTER(SetBrightness, brightness)
+HOST_SENSOR_SETTER(SetSaturation, saturation)
+HOST_SENSOR_SETTER(SetSharpness, sharpness)
+HOST_SENSOR_SETTER(SetDenoise, denoise)
+HOST_SENSOR_SETTER(SetQuality, quality)
+HOST_SENSOR_SETTER(SetColorbar, colorbar)
+HOST_SENSOR_SETTER(SetWhitebal, awb)
+HOST_SENSOR_SETTER(SetGainCtrl, agc)
+HOST_SENSOR_SETTER(SetExposureCtrl, aec)
+HOST_SENSOR_SETTER(SetHmirror, hmirror)
+HOST_SENSOR_SETTER(SetVflip, vflip)
+HOST_SENSOR_SETTER(SetAec2, aec2)
+HOST_SENSOR_SETTER(SetAwbGain, awb_gain)
+HOST_SENSOR_SETTER(SetAgcGain, agc_gain)
+HOST_SENSOR_SETTER(SetAecValue, aec_value)
+HOST_SENSOR_SETTER(SetSpecialEffect, special_effect)
+HOST_SENSOR_SETTER(SetWbMode, wb_mode)
+HOST_SENSOR_SETTER(SetAeLevel, ae_level)
+HOST_SENSOR_SETTER(SetDcw, dcw)
+HOST_SENSOR_SETTER(SetBpc, bpc)
+HOST_SENSOR_SETTER(SetWpc, wpc)
+HOST_SENSOR_SETTER(SetRawGma, raw_gma)
+HOST_SENSOR_SETTER(SetLenc, lenc)
+
+static int HostSensor_SetGainceiling(sensor_t *sensor, int value) { sensor->status.gainceiling = value; return 0; }
+static int HostSensor_SetFramesize(sensor_t *sensor, framesize_t size) { sensor->status.framesize = size; return 0; }
+static int HostSensor_SetPixformat(sensor_t *sensor, pixformat_t format) { sensor->pixformat = format; return 0; }
+static int HostSensor_InitStatus(sensor_t *sensor) { return 0; }
+static int HostSensor_Reset(sensor_t *sensor) { sensorRegisters.clear(); return 0; }
+
+static int HostSensor_GetReg(sensor_t *sensor, int reg, int mask) {
+    std::lock_guard<std::mutex> lock(cameraLock);
+    auto it = sensorRegisters.find(reg);
+    return (it == sensorRegisters.end() ? 0 : it->second) & mask;
+}
+
+static int HostSensor_SetReg(sensor_t *sensor, int reg, int mask, int value) {
+    std::lock_guard<std::mutex> lock(cameraLock);
+    int &stored = sensorRegisters[reg];
+    stored = (stored & ~mask) | (value & mask);
+    return 0;
+}
+
+/**
+ * @brief Seed the register map with what a running sensor reports in this mode: the timing
+ * registers sensorExposure.cpp reads, and a converged auto exposure (halved line time in
+ * the subsampled modes, so the hand-over has something to scale).
+ */
+static void HostCamera_SeedRegisters(const camera_config_t &config) {
+    sensorRegisters.clear();
+#if defined(OV5640)
+    bool full = config.frame_size > FRAMESIZE_SVGA; // Full-resolution timing instead of subsampled
+    sensorRegisters[0x3034] = 0x18; // 8-bit mode
+    sensorRegisters[0x3035] = 0x11; // System clock divider 1
+    sensorRegisters[0x3036] = 0x54; // PLL multiplier
+    sensorRegisters[0x3037] = 0x13; // Pre-divider 3, root divider 2
+    sensorRegisters[0x3108] = 0x01; // SCLK / 2
+    sensorRegisters[0x380C] = full ? 2844 : 1896; // HTS
+    sensorRegisters[0x380E] = full ? 1968 : 984;  // VTS
+    sensorRegisters[0x3500] = (full ? 400 : 600) << 4; // Exposure (1/16 lines)
+    sensorRegisters[0x350A] = 0x40; // Gain x4
+    sensorRegisters[0x3400] = 0x5A0; // AWB R, G, B gains
+    sensorRegisters[0x3402] = 0x400;
+    sensorRegisters[0x3404] = 0x6C0;
+#else
+    sensorRegisters[0x112] = config.frame_size > FRAMESIZE_SVGA ? 0x00 : config.frame_size > FRAMESIZE_CIF ? 0x40 : 0x20; // COM7
+    sensorRegisters[0x111] = 0x80; // CLKRC: doubler on, divider 1
+    sensorRegisters[0x113] = 0xE5; // COM8: AEC/AGC on
+    sensorRegisters[0x110] = 300 >> 2; // AEC: 300 lines
+    sensorRegisters[0x100] = 0x10; // GAIN x2
+#endif
+}
+
+/**
+ * @brief Reset the sensor stand-in to its power-on state.
+ */
+static void HostCamera_InitSensor(const camera_config_t &config) {
+    HostCamera_SeedRegisters(config);
+    hostSensor = sensor_t();
+#if defined(OV5640)
+    hostSensor.id.PID = OV5640_PID;
+    hostSensor.slv_addr = 0x3C;
+#else
+    hostSensor.id.PID = OV2640_PID;
+    hostSensor.slv_addr = 0x30;
+#endif
+    hostSensor.pixformat = config.pixel_format;
+    hostSensor.xclk_freq_hz = config.xclk_freq_hz;
+    hostSensor.status.framesize = config.frame_size;
+    hostSensor.status.quality = config.jpeg_quality;
+    hostSensor.status.awb = hostSensor.status.awb_gain = hostSensor.status.aec = hostSensor.status.agc = 1;
+    hostSensor.init_status = HostSensor_InitStatus;
+    hostSensor.reset = HostSensor_Reset;
+    hostSensor.set_pixformat = HostSensor_SetPixformat;
+    hostSensor.set_framesize = HostSensor_SetFramesize;
+    hostSensor.set_contrast = HostSensor_SetContrast;
+    hostSensor.set_brightness = HostSensor_SetBrightness;
+    hostSensor.set_saturation = HostSensor_SetSaturation;
+    hostSensor.set_sharpness = HostSensor_SetSharpness;
+    hostSensor.set_denoise = HostSensor_SetDenoise;
+    hostSensor.set_gainceiling = HostSensor_SetGainceiling;
+    hostSensor.set_quality = HostSensor_SetQuality;
+    hostSensor.set_colorbar = HostSensor_SetColorbar;
+    hostSensor.set_whitebal = HostSensor_SetWhitebal;
+    hostSensor.set_gain_ctrl = HostSensor_SetGainCtrl;
+    hostSensor.set_exposure_ctrl = HostSensor_SetExposureCtrl;
+    hostSensor.set_hmirror = HostSensor_SetHmirror;
+    hostSensor.set_vflip = HostSensor_SetVflip;
+    hostSensor.set_aec2 = HostSensor_SetAec2;
+    hostSensor.set_awb_gain = HostSensor_SetAwbGain;
+    hostSensor.set_agc_gain = HostSensor_SetAgcGain;
+    hostSensor.set_aec_value = HostSensor_SetAecValue;
+    hostSensor.set_special_effect = HostSensor_SetSpecialEffect;
+    hostSensor.set_wb_mode = HostSensor_SetWbMode;
+    hostSensor.set_ae_level = HostSensor_SetAeLevel;
+    hostSensor.set_dcw = HostSensor_SetDcw;
+    hostSensor.set_bpc = HostSensor_SetBpc;
+    hostSensor.set_wpc = HostSensor_SetWpc;
+    hostSensor.set_raw_gma = HostSensor_SetRawGma;
+    hostSensor.set_lenc = HostSensor_SetLenc;
+    hostSensor.get_reg = HostSensor_GetReg;
+    hostSensor.set_reg = HostSensor_SetReg;
+}
+
+void HostCamera_SetSource(const char *directory, int fps) {
+    sourceDir = directory ? directory : "";
+    sourceFps = fps > 0 ? fps : 25;
+    sourceFiles.clear();
+    decodedCache.clear();
+    if (sourceDir.empty()) return;
+    DIR *dir = opendir(sourceDir.c_str());
+    if (!dir) {
+        Serial.printf("[HostCamera] Cannot open %s, using the test pattern.\n", sourceDir.c_str());
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        std::string name = entry->d_name;
+        size_t dot = name.rfind('.');
+        std::string ext = dot == std::string::npos ? "" : name.substr(dot);
+        if (ext == ".jpg" || ext == ".jpeg" || ext == ".JPG") sourceFiles.push_back(sourceDir + "/" + name);
+    }
+    closedir(dir);
+    std::sort(sourceFiles.begin(), sourceFiles.end());
+    Serial.printf("[HostCamera] %u recorded frames from %s at %d fps.\n", (unsigned)sourceFiles.size(), sourceDir.c_str(), sourceFps);
+}
+
+uint32_t HostCamera_GetFrameCount() {
+    std::lock_guard<std::mutex> lock(cameraLock);
+    return frameCounter;
+}
+
+esp_err_t esp_camera_init(const camera_config_t *config) {
+    std::lock_guard<std::mutex> lock(cameraLock);
+    if (cameraReady) return ESP_ERR_INVALID_STATE;
+    if (config->frame_size >= FRAMESIZE_INVALID || config->fb_count < 1) return ESP_ERR_INVALID_ARG;
+    activeConfig = *config;
+    framePool.clear();
+    framePool.resize(config->fb_count);
+    for (HostFrame &frame : framePool) frame.inUse = false;
+    HostCamera_InitSensor(*config);
+    nextFrameUs = esp_timer_get_time();
+    cameraReady = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_camera_deinit() {
+    std::lock_guard<std::mutex> lock(cameraLock);
+    if (!cameraReady) return ESP_ERR_INVALID_STATE;
+    for (HostFrame &frame : framePool) {
+        if (frame.inUse) Serial.println("[HostCamera] Deinit with a frame buffer still in use!");
+    }
+    framePool.clear();
+    cameraReady = false;
+    return ESP_OK;
+}
+
+camera_fb_t *esp_camera_fb_get() {
+    int64_t start = esp_timer_get_time();
+    while (true) {
+        int64_t now = esp_timer_get_time();
+        HostFrame *free = NULL;
+        uint32_t number = 0;
+        {
+            std::lock_guard<std::mutex> lock(cameraLock);
+            if (!cameraReady) return NULL;
+            for (HostFrame &frame : framePool) {
+                if (!frame.inUse) {
+                    free = &frame;
+                    break;
+                }
+            }
+            if (free && now >= nextFrameUs) {
+                free->inUse = true;
+                number = frameCounter++;
+                nextFrameUs = (now - nextFrameUs > 1000000 / sourceFps ? now : nextFrameUs) + 1000000 / sourceFps;
+            } else {
+                free = NULL;
+            }
+        }
+        if (free) {
+            if (HostCamera_Fill(*free, number)) return &free->fb;
+            std::lock_guard<std::mutex> lock(cameraLock);
+            free->inUse = false;
+            return NULL;
+        }
+        if (now - start > HOST_CAMERA_FB_TIMEOUT_MS * 1000LL) return NULL;
+        int64_t wait = nextFrameUs - now;
+        vTaskDelay(wait > 1000 ? wait / 1000 / portTICK_PERIOD_MS : 1); // Sensor timing or buffer release
+    }
+}
+
+void esp_camera_fb_return(camera_fb_t *fb) {
+    std::lock_guard<std::mutex> lock(cameraLock);
+    for (HostFrame &frame : framePool) {
+        if (&frame.fb == fb) frame.inUse = false;
+    }
+}
+
+sensor_t *esp_camera_sensor_get() {
+    std::lock_guard<std::mutex> lock(cameraLock);
+    return cameraReady ? &hostSensor : NULL;
+}
@@ -0,0 +1,169 @@
+// hostGolden.cpp - Golden image checks of the rendered screens (native build)
+// This module drives the real display code with fixed inputs and compares the framebuffer
+// with the golden PNGs in host/golden.
+//
+// Key features:
+// - Inputs come from Bench_FillScene(), so they are identical on every run
+// - Tolerance per channel and per screen (see hostGolden.h)
+// - --golden-update rewrites the golden images after an intended rendering change
+
+#include "hostGolden.h" // Include header for this module
+#include <Arduino.h> // Serial
+#include <SD.h> // Card stand-in
+#include <img_converters.h> // fmt2jpg
+#include <unistd.h> // rmdir
+#include <vector> // Pixel buffers
+#include "displayTask.h" // Screens under test
+#include "bench.h" // Bench_FillScene
+
+// Photo shown by the gallery check (1/4 scale decode fills the 320x240 screen)
+#define GOLDEN_PHOTO_WIDTH 1280
+#define GOLDEN_PHOTO_HEIGHT 960
+
+// One checked screen
+struct GoldenScreen {
+    const char *name;  // Golden file name without extension
+    void (*render)();  // Draws the screen on tftDisplay
+};
+
+/**
+ * @brief Preview: one QVGA test frame through DisplayTask_ShowCamera.
+ * Rendered more than a second after DisplayTask_Init(), the first frame always shows "FPS: 0".
+ */
+static void HostGolden_RenderPreview() {
+    static std::vector<uint16_t> pixels(320 * 240);
+    Bench_FillScene(pixels.data(), 320, 240);
+    camera_fb_t frame = {};
+    frame.buf = (uint8_t *)pixels.data();
+    frame.len = pixels.size() * sizeof(uint16_t);
+    frame.width = 320;
+    frame.height = 240;
+    frame.format = PIXFORMAT_RGB565;
+    int64_t now = esp_timer_get_time();
+    frame.timestamp.tv_sec = now / 1000000;
+    frame.timestamp.tv_usec = now % 1000000;
+    DisplayTask_ShowCamera(&frame); // Returning a frame the driver does not own is a no-op on the host
+}
+
+/**
+ * @brief Gallery: the generated photo written as /photo_1.jpg.
+ */
+static void HostGolden_RenderGallery() {
+    DisplayTask_ShowGallery(1);
+}
+
+/**
+ * @brief Error screen with the SD card message.
+ */
+static void HostGolden_RenderError() {
+    DisplayTask_DrawError("TFCard not found!\n\nPlease check the connection and retry.");
+}
+
+static const GoldenScreen goldenScreens[] = {
+    {"preview", HostGolden_RenderPreview},
+    {"gallery", HostGolden_RenderGallery},
+    {"error", HostGolden_RenderError},
+};
+
+/**
+ * @brief Write the gallery photo (test scene encoded as JPEG) to the card.
+ * @return true on success
+ */
+static bool HostGolden_WritePhoto() {
+    std::vector<uint16_t> pixels((size_t)GOLDEN_PHOTO_WIDTH * GOLDEN_PHOTO_HEIGHT);
+    Bench_FillScene(pixels.data(), GOLDEN_PHOTO_WIDTH, GOLDEN_PHOTO_HEIGHT);
+    uint8_t *jpeg = NULL;
+    size_t jpegLen = 0;
+    if (!fmt2jpg((uint8_t *)pixels.data(), pixels.size() * 2, GOLDEN_PHOTO_WIDTH, GOLDEN_PHOTO_HEIGHT,
+                 PIXFORMAT_RGB565, 90, &jpeg, &jpegLen)) {
+        return false;
+    }
+    File file = SD.open("/photo_1.jpg", FILE_WRITE);
+    bool ok = file && file.write(jpeg, jpegLen) == jpegLen;
+    file.close();
+    free(jpeg);
+    return ok;
+}
+
+/**
+ * @brief Expand one RGB565 channel to 8 bits like HostTft_SavePng.
+ */
+static inline int HostGolden_Channel(uint16_t color, int shift, int bits) {
+    int max = (1 << bits) - 1;
+    return ((color >> shift) & max) * 255 / max;
+}
+
+/**
+ * @brief Count the pixels that differ by more than GOLDEN_CHANNEL_TOLERANCE in any channel.
+ * @param worst Receives the largest channel difference
+ */
+static int HostGolden_CountDiffs(const uint16_t *actual, const uint16_t *expected, size_t count, int &worst) {
+    int diffs = 0;
+    worst = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (actual[i] == expected[i]) continue;
+        int d = max(abs(HostGolden_Channel(actual[i], 11, 5) - HostGolden_Channel(expected[i], 11, 5)),
+                    max(abs(HostGolden_Channel(actual[i], 5, 6) - HostGolden_Channel(expected[i], 5, 6)),
+                        abs(HostGolden_Channel(actual[i], 0, 5) - HostGolden_Channel(expected[i], 0, 5))));
+        worst = max(worst, d);
+        if (d > GOLDEN_CHANNEL_TOLERANCE) diffs++;
+    }
+    return diffs;
+}
+
+/**
+ * @brief Render the screens and compare them with <dir>/<screen>.png.
+ * A failing screen is saved as <dir>/<screen>.actual.png for inspection.
+ * Initializes the display (DisplayTask_Init) and maps the SD card to a temporary directory.
+ * @param dir Golden image directory
+ * @param update true to (re)write the golden images instead of comparing
+ * @return Number of screens that failed
+ */
+int HostGolden_Run(const char *dir, bool update) {
+    char cardDir[] = "/tmp/golden-sd-XXXXXX";
+    if (!mkdtemp(cardDir)) {
+        Serial.println("[Golden] Cannot create the card directory.");
+        return 1;
+    }
+    HostSd_SetRoot(cardDir);
+    DisplayTask_Init();
+    if (!SD.begin() || !HostGolden_WritePhoto()) {
+        Serial.println("[Golden] Cannot write the gallery photo.");
+        return 1;
+    }
+    int failures = 0;
+    for (const GoldenScreen &screen : goldenScreens) {
+        screen.render();
+        String path = String(dir) + "/" + screen.name + ".png";
+        if (update) {
+            bool saved = HostTft_SavePng(path.c_str(), tftDisplay);
+            Serial.printf("[Golden] %s: %s %s.\n", screen.name, saved ? "written to" : "could not be written to", path.c_str());
+            if (!saved) failures++;
+            continue;
+        }
+        std::vector<uint16_t> expected;
+        int width = 0, height = 0, worst = 0, diffs = -1;
+        if (!HostTft_LoadPng(path.c_str(), expected, width, height)) {
+            Serial.printf("[Golden] %s: cannot read %s.\n", screen.name, path.c_str());
+        } else if (width != tftDisplay.width() || height != tftDisplay.height()) {
+            Serial.printf("[Golden] %s: size %dx%d, expected %dx%d.\n", screen.name, tftDisplay.width(),
+                          tftDisplay.height(), width, height);
+        } else {
+            diffs = HostGolden_CountDiffs(tftDisplay.frameBuffer(), expected.data(), expected.size(), worst);
+        }
+        bool ok = diffs >= 0 && diffs <= GOLDEN_MAX_DIFF_PIXELS;
+        if (diffs >= 0) {
+            Serial.printf("[Golden] %s: %s (%d pixels differ, worst channel difference %d).\n", screen.name,
+                          ok ? "ok" : "FAILED", diffs, worst);
+        }
+        if (!ok) {
+            String actualPath = String(dir) + "/" + screen.name + ".actual.png";
+            HostTft_SavePng(actualPath.c_str(), tftDisplay);
+            Serial.printf("[Golden] %s: actual screen saved to %s.\n", screen.name, actualPath.c_str());
+            failures++;
+        }
+    }
+    SD.remove("/photo_1.jpg");
+    rmdir(cardDir);
+    return failures;
+}
@@ -0,0 +1,22 @@
+// hostGolden.h - Golden image checks of the rendered screens (native build)
+// Renders the preview (DisplayTask_ShowCamera with the fixed test scene), the gallery
+// (DisplayTask_ShowGallery with a generated photo) and the error screen into the host framebuffer
+// and compares each with a golden PNG. Rendering optimizations must keep these passing.
+
+#pragma once // Prevent multiple inclusion of this header
+
+// Largest per-channel difference (8-bit units) for two pixels to count as equal
+// (absorbs JPEG decoder rounding differences between libjpeg versions)
+#define GOLDEN_CHANNEL_TOLERANCE 8
+// Number of pixels per screen allowed to differ by more than the channel tolerance
+#define GOLDEN_MAX_DIFF_PIXELS 16
+
+/**
+ * @brief Render the screens and compare them with <dir>/<screen>.png.
+ * A failing screen is saved as <dir>/<screen>.actual.png for inspection.
+ * Initializes the display (DisplayTask_Init) and maps the SD card to a temporary directory.
+ * @param dir Golden image directory
+ * @param update true to (re)write the golden images instead of comparing
+ * @return Number of screens that failed
+ */
+int HostGolden_Run(const char *dir, bool update);
@@ -0,0 +1,230 @@
+// hostJpeg.cpp - JPEG decode/encode for the host stand-ins (native build)
+// This module wraps libjpeg for the TJpg_Decoder and esp_camera stand-ins and implements TJpgDec.
+//
+// Key features:
+// - Errors are reported through a longjmp error manager instead of exiting the process
+// - RGB565 conversion with the same bit truncation as TJpgDec
+// - TJpgDec output in 16x16 blocks; a callback returning false stops the decode
+
+#include "hostJpeg.h" // Include header for this module
+#include <TJpg_Decoder.h> // Decoder stand-in
+#include <img_converters.h> // fmt2jpg stand-in
+#include <SD.h> // Card files
+#include <setjmp.h> // libjpeg error recovery
+#include <stdio.h> // FILE (required by jpeglib.h)
+#include <jpeglib.h> // libjpeg
+
+TJpg_Decoder TJpgDec;
+
+// libjpeg error manager that jumps back instead of calling exit()
+struct HostJpegError {
+    jpeg_error_mgr base;
+    jmp_buf jump;
+};
+
+static void HostJpeg_ErrorExit(j_common_ptr cinfo) {
+    longjmp(((HostJpegError *)cinfo->err)->jump, 1);
+}
+
+static void HostJpeg_Silent(j_common_ptr cinfo, int level) {}
+
+/**
+ * @brief Convert 8-bit RGB to native RGB565.
+ */
+static inline uint16_t HostJpeg_Rgb565(const uint8_t *rgb) {
+    return ((rgb[0] & 0xF8) << 8) | ((rgb[1] & 0xFC) << 3) | (rgb[2] >> 3);
+}
+
+/**
+ * @brief Decode a JPEG and hand out groups of up to 16 rows.
+ * @param rows Called with (y, rowCount, width, native pixels); return false to stop
+ * @return JDR_OK, JDR_INTR if stopped, or JDR_FMT1 on a decode error
+ */
+template <typename RowsFn>
+static JRESULT HostJpeg_DecodeRows(const uint8_t *data, size_t size, int scale, int &width, int &height, RowsFn rows) {
+    jpeg_decompress_struct cinfo;
+    HostJpegError err;
+    cinfo.err = jpeg_std_error(&err.base);
+    err.base.error_exit = HostJpeg_ErrorExit;
+    err.base.emit_message = HostJpeg_Silent;
+    std::vector<uint8_t> rgb;
+    std::vector<uint16_t> band;
+    if (setjmp(err.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        return JDR_FMT1;
+    }
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, data, size);
+    jpeg_read_header(&cinfo, TRUE);
+    cinfo.out_color_space = JCS_RGB;
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = scale == 2 || scale == 4 || scale == 8 ? scale : 1;
+    jpeg_start_decompress(&cinfo);
+    width = cinfo.output_width;
+    height = cinfo.output_height;
+    rgb.resize((size_t)width * 3);
+    band.resize((size_t)width * 16);
+    JRESULT result = JDR_OK;
+    while (cinfo.output_scanline < cinfo.output_height) {
+        int y = cinfo.output_scanline;
+        int count = 0;
+        while (count < 16 && cinfo.output_scanline < cinfo.output_height) {
+            JSAMPROW row = rgb.data();
+            jpeg_read_scanlines(&cinfo, &row, 1);
+            for (int x = 0; x < width; x++) band[(size_t)count * width + x] = HostJpeg_Rgb565(&rgb[x * 3]);
+            count++;
+        }
+        if (!rows(y, count, width, band.data())) {
+            result = JDR_INTR;
+            break;
+        }
+    }
+    if (result == JDR_OK) jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    return result;
+}
+
+bool HostJpeg_GetSize(const uint8_t *data, size_t size, int &width, int &height) {
+    jpeg_decompress_struct cinfo;
+    HostJpegError err;
+    cinfo.err = jpeg_std_error(&err.base);
+    err.base.error_exit = HostJpeg_ErrorExit;
+    err.base.emit_message = HostJpeg_Silent;
+    if (setjmp(err.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, data, size);
+    jpeg_read_header(&cinfo, TRUE);
+    width = cinfo.image_width;
+    height = cinfo.image_height;
+    jpeg_destroy_decompress(&cinfo);
+    return true;
+}
+
+bool HostJpeg_Decode(const uint8_t *data, size_t size, int scale, std::vector<uint16_t> &pixels, int &width, int &height) {
+    JRESULT result = HostJpeg_DecodeRows(data, size, scale, width, height,
+        [&](int y, int count, int w, const uint16_t *band) {
+            if (pixels.size() != (size_t)width * height) pixels.resize((size_t)width * height);
+            memcpy(&pixels[(size_t)y * w], band, (size_t)count * w * sizeof(uint16_t));
+            return true;
+        });
+    return result == JDR_OK;
+}
+
+bool HostJpeg_Encode(const uint16_t *pixels, int width, int height, int quality, std::vector<uint8_t> &jpeg) {
+    jpeg_compress_struct cinfo;
+    HostJpegError err;
+    cinfo.err = jpeg_std_error(&err.base);
+    err.base.error_exit = HostJpeg_ErrorExit;
+    err.base.emit_message = HostJpeg_Silent;
+    unsigned char *out = NULL;
+    unsigned long outSize = 0;
+    std::vector<uint8_t> rgb((size_t)width * 3);
+    if (setjmp(err.jump)) {
+        jpeg_destroy_compress(&cinfo);
+        free(out);
+        return false;
+    }
+    jpeg_create_compress(&cinfo);
+    jpeg_mem_dest(&cinfo, &out, &outSize);
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    int q = 100 - (quality < 0 ? 0 : quality > 63 ? 63 : quality) * 90 / 63; // 0..63 (lower is better) to 100..10
+    jpeg_set_quality(&cinfo, q, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+    while (cinfo.next_scanline < cinfo.image_height) {
+        const uint16_t *src = &pixels[(size_t)cinfo.next_scanline * width];
+        for (int x = 0; x < width; x++) {
+            rgb[x * 3 + 0] = ((src[x] >> 11) & 0x1F) << 3;
+            rgb[x * 3 + 1] = ((src[x] >> 5) & 0x3F) << 2;
+            rgb[x * 3 + 2] = (src[x] & 0x1F) << 3;
+        }
+        JSAMPROW row = rgb.data();
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    jpeg.assign(out, out + outSize);
+    free(out);
+    return true;
+}
+
+bool fmt2jpg(uint8_t *src, size_t src_len, uint16_t width, uint16_t height, pixformat_t format, uint8_t quality,
+             uint8_t **out, size_t *out_len) {
+    if (format != PIXFORMAT_RGB565 || src_len < (size_t)width * height * 2) return false;
+    std::vector<uint16_t> pixels((size_t)width * height);
+    const uint16_t *in = (const uint16_t *)src;
+    for (size_t i = 0; i < pixels.size(); i++) pixels[i] = (in[i] >> 8) | (in[i] << 8); // Sensor order to native
+    std::vector<uint8_t> jpeg;
+    int cameraQuality = (100 - (quality > 100 ? 100 : quality)) * 63 / 90; // 0-100 to the driver's 0..63 scale
+    if (!HostJpeg_Encode(pixels.data(), width, height, cameraQuality, jpeg)) return false;
+    *out = (uint8_t *)malloc(jpeg.size());
+    if (!*out) return false;
+    memcpy(*out, jpeg.data(), jpeg.size());
+    *out_len = jpeg.size();
+    return true;
+}
+
+/**
+ * @brief Read a whole card file.
+ */
+static bool HostJpeg_ReadFile(File file, std::vector<uint8_t> &data) {
+    if (!file) return false;
+    data.resize(file.size());
+    file.seek(0);
+    bool ok = file.read(data.data(), data.size()) == data.size();
+    return ok;
+}
+
+JRESULT TJpg_Decoder::drawJpg(int32_t x, int32_t y, const uint8_t *data, uint32_t size) {
+    if (!tft_output) return JDR_PAR;
+    int width, height;
+    std::vector<uint16_t> block(16 * 16);
+    return HostJpeg_DecodeRows(data, size, jpgScale, width, height,
+        [&](int row, int count, int w, const uint16_t *band) {
+            for (int bx = 0; bx < w; bx += 16) { // Split the band into 16x16 blocks
+                int bw = w - bx < 16 ? w - bx : 16;
+                for (int r = 0; r < count; r++) {
+                    for (int c = 0; c < bw; c++) {
+                        uint16_t value = band[(size_t)r * w + bx + c];
+                        block[r * bw + c] = swap ? (uint16_t)((value >> 8) | (value << 8)) : value;
+                    }
+                }
+                if (!tft_output(x + bx, y + row, bw, count, block.data())) return false;
+            }
+            return true;
+        });
+}
+
+JRESULT TJpg_Decoder::getJpgSize(uint16_t *w, uint16_t *h, const uint8_t *data, uint32_t size) {
+    int width, height;
+    if (!HostJpeg_GetSize(data, size, width, height)) return JDR_FMT1;
+    *w = width;
+    *h = height;
+    return JDR_OK;
+}
+
+JRESULT TJpg_Decoder::drawSdJpg(int32_t x, int32_t y, const char *path) {
+    return drawSdJpg(x, y, SD.open(path, FILE_READ));
+}
+
+JRESULT TJpg_Decoder::drawSdJpg(int32_t x, int32_t y, File file) {
+    std::vector<uint8_t> data;
+    if (!HostJpeg_ReadFile(file, data)) return JDR_INP;
+    return drawJpg(x, y, data.data(), data.size());
+}
+
+JRESULT TJpg_Decoder::getSdJpgSize(uint16_t *w, uint16_t *h, const char *path) {
+    return getSdJpgSize(w, h, SD.open(path, FILE_READ));
+}
+
+JRESULT TJpg_Decoder::getSdJpgSize(uint16_t *w, uint16_t *h, File file) {
+    std::vector<uint8_t> data;
+    if (!HostJpeg_ReadFile(file, data)) return JDR_INP;
+    return getJpgSize(w, h, data.data(), data.size());
+}
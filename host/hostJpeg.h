@@ -0,0 +1,29 @@
+// hostJpeg.h - libjpeg helpers shared by the host stand-ins (native build)
+// Used by the TJpg_Decoder and esp_camera stand-ins.
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stdint.h> // Fixed-width integer types
+#include <stddef.h> // size_t
+#include <vector> // Output buffers
+
+/**
+ * @brief Read the size of a JPEG image.
+ * @return true if the header is valid
+ */
+bool HostJpeg_GetSize(const uint8_t *data, size_t size, int &width, int &height);
+
+/**
+ * @brief Decode a JPEG to native RGB565 with libjpeg DCT scaling.
+ * @param scale 1, 2, 4 or 8
+ * @param pixels Receives width * height native colors
+ * @return true on success
+ */
+bool HostJpeg_Decode(const uint8_t *data, size_t size, int scale, std::vector<uint16_t> &pixels, int &width, int &height);
+
+/**
+ * @brief Encode native RGB565 pixels as a baseline JPEG.
+ * @param quality esp32-camera style quality (0 best .. 63 worst)
+ * @param jpeg Receives the JPEG bytes
+ * @return true on success
+ */
+bool HostJpeg_Encode(const uint16_t *pixels, int width, int height, int quality, std::vector<uint8_t> &jpeg);
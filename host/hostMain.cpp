@@ -0,0 +1,258 @@
+// hostMain.cpp - Native build entry point
+// This is the Linux entry point of the native environment. It brings up the same modules as
+// main.cpp's setup() (display, SD card, camera, display event loop, camera/display tasks,
+// profiler) on the host stand-ins, optionally replays a key timeline, runs for a fixed time,
+// and reports what happened.
+//
+// Key features:
+// - --frames DIR plays recorded JPEG frames as the camera (test pattern otherwise)
+// - --sd DIR backs the SD card, --png FILE saves the final screen, --metrics prints /metrics
+// - --keys FILE replays a key timeline (inputReplay.h format) against the real DisplayTask
+// - --bench [FILTER] runs the pixel kernel benchmarks (bench.h) instead of the system
+// - --golden DIR checks the rendered screens against golden PNGs (hostGolden.h), --golden-update DIR rewrites them
+// - --motion DIR runs a recorded sequence through the motion detector against its expected events (hostMotion.h)
+// - The web server and key ISRs are not part of the native build
+// - Left out of unit test builds (PIO_UNIT_TESTING), where each test suite brings its own main()
+
+#include <Arduino.h> // Arduino core stand-in
+#include <SD.h> // HostSd_SetRoot
+#include <unistd.h> // _exit
+#include "cameraTask.h" // Camera task module
+#include "displayTask.h" // Display task module
+#include "tfCard.h" // SD card module
+#include "keyTask.h" // KeyTask_SetLED
+#include "webTask.h" // WebTask_StopWifi, WebTask_StartWifi
+#include "taskConfig.h" // Task placement table
+#include "profiler.h" // Per-task CPU profiling
+#include "metrics.h" // Pipeline counters
+#include "trace.h" // Event tracing
+#include "inputReplay.h" // Key timeline replay
+#include "bench.h" // Pixel kernel benchmarks
+#include "hostGolden.h" // Golden image checks
+#include "hostMotion.h" // Recorded motion sequences
+#include "motionTask.h" // Motion detection
+#include "videoTask.h" // Video recording
+#include "timelapseTask.h" // Timelapse mode
+
+// Mutex for camera access (defined in main.cpp on the device)
+SemaphoreHandle_t cameraMutex;
+// Task handle for camera task (defined in main.cpp on the device)
+TaskHandle_t cameraTaskHandle = NULL;
+
+// Command line options
+struct HostOptions {
+    const char *framesDir = NULL; // Recorded frames (NULL = test pattern)
+    int fps = 25;                 // Camera frame rate
+    const char *sdDir = "sdcard"; // SD card directory
+    const char *pngPath = NULL;   // Final screenshot
+    const char *keysPath = NULL;  // Key timeline
+    const char *tracePath = NULL; // Chrome trace output
+    int seconds = 5;              // Run time after the key timeline
+    bool metrics = false;         // Print the /metrics text at the end
+    bool bench = false;           // Run the benchmarks and exit
+    const char *benchFilter = ""; // Benchmark case filter
+    const char *goldenDir = NULL; // Golden image directory (check or update, then exit)
+    bool goldenUpdate = false;    // Rewrite the golden images
+    const char *motionDir = NULL; // Recorded sequence to check (then exit)
+};
+
+/**
+ * @brief Flash LED stand-in (keyTask.cpp drives a GPIO on the device).
+ * @param on true to turn the LED on
+ */
+void KeyTask_SetLED(bool on) {
+    Serial.printf("[Host] Flash LED %s.\n", on ? "on" : "off");
+}
+
+/**
+ * @brief Key wake-up stand-in (no keys on the host: light sleep always ends on the timer).
+ */
+void KeyTask_EnableSleepWakeup() {}
+
+/**
+ * @brief Key wake-up stand-in (nothing to restore on the host).
+ */
+void KeyTask_DisableSleepWakeup() {}
+
+/**
+ * @brief Wi-Fi stand-in (no web server on the host).
+ */
+void WebTask_StopWifi() {}
+
+/**
+ * @brief Wi-Fi stand-in (no web server on the host).
+ */
+void WebTask_StartWifi() {}
+
+#ifndef PIO_UNIT_TESTING // The command line only exists in the program
+/**
+ * @brief Print the command line help.
+ */
+static void Host_Usage(const char *program) {
+    printf("Usage: %s [--frames DIR] [--fps N] [--sd DIR] [--keys FILE] [--seconds N] [--png FILE]\n"
+           "          [--metrics] [--trace FILE]\n"
+           "       %s --bench [FILTER]\n"
+           "       %s --golden DIR | --golden-update DIR\n"
+           "       %s --motion DIR [--fps N]\n", program, program, program, program);
+}
+
+/**
+ * @brief Parse the command line.
+ * @return false on an unknown option or a missing value
+ */
+static bool Host_ParseOptions(int argc, char **argv, HostOptions &options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool takesValue = true;
+        if (strcmp(arg, "--frames") == 0 && value) options.framesDir = value;
+        else if (strcmp(arg, "--fps") == 0 && value) options.fps = atoi(value);
+        else if (strcmp(arg, "--sd") == 0 && value) options.sdDir = value;
+        else if (strcmp(arg, "--png") == 0 && value) options.pngPath = value;
+        else if (strcmp(arg, "--keys") == 0 && value) options.keysPath = value;
+        else if (strcmp(arg, "--trace") == 0 && value) options.tracePath = value;
+        else if (strcmp(arg, "--seconds") == 0 && value) options.seconds = atoi(value);
+        else if (strcmp(arg, "--golden") == 0 && value) options.goldenDir = value;
+        else if (strcmp(arg, "--golden-update") == 0 && value) options.goldenDir = value, options.goldenUpdate = true;
+        else if (strcmp(arg, "--metrics") == 0) options.metrics = true, takesValue = false;
+        else if (strcmp(arg, "--bench") == 0) {
+            options.bench = true;
+            takesValue = value && value[0] != '-'; // Optional filter
+            if (takesValue) options.benchFilter = value;
+        }
+        else if (strcmp(arg, "--motion") == 0 && value) options.motionDir = value;
+        else return false;
+        if (takesValue) i++;
+    }
+    return true;
+}
+
+/**
+ * @brief Replay a key timeline file in real time: gestures are recognized with the same
+ * KeyGesture rules as KeyTask and dispatched like KeyTask_DefaultHandler.
+ */
+static void Host_ReplayKeys(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        Serial.printf("[Host] Cannot open key timeline %s.\n", path);
+        return;
+    }
+    static char text[16384];
+    size_t length = fread(text, 1, sizeof(text) - 1, file);
+    fclose(file);
+    text[length] = '\0';
+    static ReplayEdge edges[256];
+    static ReplayResult result;
+    int edgeCount = InputReplay_Parse(text, edges, 256);
+    if (edgeCount < 0) {
+        Serial.printf("[Host] Malformed key timeline %s.\n", path);
+        return;
+    }
+    InputReplay_Run(edges, edgeCount, 0, result);
+    unsigned long start = millis();
+    for (int i = 0; i < result.eventCount; i++) {
+        const ReplayEvent &event = result.events[i];
+        long wait = (long)event.timeMs - (long)(millis() - start);
+        if (wait > 0) delay(wait);
+        Serial.printf("[Host] %u ms: %s %s.\n", (unsigned)event.timeMs, InputReplay_KeyName(event.key),
+                      InputReplay_GestureName(event.gesture));
+        if (event.key == KEY_ID_CAM) {
+            DisplayTask_SavePhoto(event.gesture != KEY_GESTURE_SINGLE);
+            continue;
+        }
+        DisplayEvent displayEvent;
+        if (UiState_MapGesture(event.key, event.gesture, displayEvent)) DisplayTask_PostEvent(displayEvent);
+    }
+}
+
+#if defined(ENABLE_TRACE)
+// Print target writing to a host file (for Trace_Dump)
+class HostFilePrint : public Print {
+public:
+    explicit HostFilePrint(FILE *file) : file(file) {}
+    size_t write(uint8_t c) override { return fputc(c, file) == EOF ? 0 : 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { return fwrite(buffer, 1, size, file); }
+
+private:
+    FILE *file;
+};
+#endif
+
+int main(int argc, char **argv) {
+    HostOptions options;
+    if (!Host_ParseOptions(argc, argv, options)) {
+        Host_Usage(argv[0]);
+        return 2;
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    HostCamera_SetSource(options.framesDir, options.fps);
+    HostSd_SetRoot(options.sdDir);
+    if (options.bench) { // Benchmarks run alone: no tasks competing for the CPU
+        jpegDecoderMutex = xSemaphoreCreateMutex(); // Only part of DisplayTask_Init() the suite needs
+        int count = Bench_Run(Serial, options.benchFilter);
+        fflush(stdout);
+        return count > 0 ? 0 : 1;
+    }
+    if (options.goldenDir) { // Rendering checks run alone as well
+        int failures = HostGolden_Run(options.goldenDir, options.goldenUpdate);
+        Serial.printf("[Host] Golden images: %d screen(s) failed.\n", failures);
+        fflush(stdout);
+        _exit(failures ? 1 : 0);
+    }
+
+    if (options.motionDir) { // Detector checks need no tasks either
+        int failures = HostMotion_RunSequence(options.motionDir, options.fps);
+        Serial.printf("[Host] Motion detector: %s.\n", failures == 0 ? "passed" : "failed");
+        fflush(stdout);
+        return failures == 0 ? 0 : 1;
+    }
+
+    // Same order as setup() in main.cpp, minus the web server and key input
+    Serial.println("[Main] System setup started.");
+    cameraMutex = xSemaphoreCreateMutex();
+#if defined(ENABLE_TRACE)
+    Trace_Init();
+#endif
+    DisplayTask_Init();
+    TfCard_Init();
+    CameraTask_InitPreviewConfig();
+    CameraTask_Init();
+    DisplayTask_InitEvents();
+    VideoTask_Init();
+    TimelapseTask_Init();
+#if defined(ENABLE_MOTION)
+    MotionTask_Init();
+#endif
+    TaskConfig_Start(TASK_CAMERA, CameraTask, NULL, &cameraTaskHandle);
+    TaskConfig_Start(TASK_DISPLAY, DisplayTask, NULL, NULL);
+#if defined(ENABLE_MOTION)
+    TaskConfig_Start(TASK_MOTION, MotionTask, NULL, NULL);
+#endif
+    Profiler_Init();
+    Serial.println("[Main] System setup completed.");
+
+    if (options.keysPath) Host_ReplayKeys(options.keysPath);
+    delay(options.seconds * 1000);
+
+    Serial.printf("[Host] Camera frames %u, displayed %u, dropped %u.\n", (unsigned)HostCamera_GetFrameCount(),
+                  (unsigned)Metrics_Get(METRIC_DISPLAY_FRAMES), (unsigned)Metrics_Get(METRIC_CAMERA_FRAMES_DROPPED));
+    Profiler_PrintSerial();
+    if (options.metrics) Serial.print(Metrics_Render());
+    if (options.pngPath) {
+        bool saved = HostTft_SavePng(options.pngPath, tftDisplay);
+        Serial.printf("[Host] Screen %s %s.\n", saved ? "saved to" : "could not be saved to", options.pngPath);
+    }
+#if defined(ENABLE_TRACE)
+    if (options.tracePath) {
+        FILE *file = fopen(options.tracePath, "wb");
+        if (file) {
+            HostFilePrint out(file);
+            Serial.printf("[Host] %u trace events written to %s.\n", (unsigned)Trace_Dump(out), options.tracePath);
+            fclose(file);
+        }
+    }
+#endif
+    fflush(stdout);
+    _exit(0); // Tasks never return; leave without running static destructors under them
+}
+#endif // PIO_UNIT_TESTING
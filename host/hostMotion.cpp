@@ -0,0 +1,121 @@
+// hostMotion.cpp - Motion detector checks on recorded frame sequences (native build)
+// This module decodes recorded JPEG frames the way the camera stand-in does, feeds them to the
+// motion detector with virtual timestamps and checks the events against expected.txt.
+//
+// Key features:
+// - No sleeping: a 200-frame sequence replays in well under a second
+// - Frames converted to QVGA RGB565 in panel byte order, as the preview delivers them
+// - Events printed in the expected.txt format, so new recordings are easy to bless
+
+#include "hostMotion.h" // Include header for this module
+#include <Arduino.h> // Serial
+#include <dirent.h> // opendir, readdir
+#include <algorithm> // std::sort
+#include <string> // File names
+#include <vector> // Pixel buffers
+#include "hostJpeg.h" // HostJpeg_Decode
+#include "motionReplay.h" // Detector, event format and comparison
+#include "pixelKernels.h" // PixelKernels_SwapBytes
+
+// Frame size delivered to the detector (preview resolution)
+#define HOST_MOTION_WIDTH 320
+#define HOST_MOTION_HEIGHT 240
+
+/**
+ * @brief Read a whole host file.
+ */
+static bool HostMotion_ReadFile(const std::string &path, std::vector<uint8_t> &data) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    data.resize(size > 0 ? size : 0);
+    bool ok = size > 0 && fread(data.data(), 1, size, file) == (size_t)size;
+    fclose(file);
+    return ok;
+}
+
+/**
+ * @brief Decode a JPEG frame to QVGA RGB565 in panel byte order (nearest-neighbor scaling).
+ */
+static bool HostMotion_LoadFrame(const std::string &path, std::vector<uint16_t> &frame) {
+    std::vector<uint8_t> jpeg;
+    std::vector<uint16_t> decoded;
+    int width, height, scale = 1;
+    if (!HostMotion_ReadFile(path, jpeg) || !HostJpeg_GetSize(jpeg.data(), jpeg.size(), width, height)) return false;
+    while (scale < 8 && width / (scale * 2) >= HOST_MOTION_WIDTH && height / (scale * 2) >= HOST_MOTION_HEIGHT) scale *= 2;
+    if (!HostJpeg_Decode(jpeg.data(), jpeg.size(), scale, decoded, width, height)) return false;
+    frame.resize(HOST_MOTION_WIDTH * HOST_MOTION_HEIGHT);
+    for (int y = 0; y < HOST_MOTION_HEIGHT; y++) {
+        const uint16_t *row = &decoded[(size_t)(y * height / HOST_MOTION_HEIGHT) * width];
+        for (int x = 0; x < HOST_MOTION_WIDTH; x++) frame[y * HOST_MOTION_WIDTH + x] = row[x * width / HOST_MOTION_WIDTH];
+    }
+    PixelKernels_SwapBytes(frame.data(), frame.data(), frame.size()); // Native -> panel byte order
+    return true;
+}
+
+/**
+ * @brief Replay a recorded frame sequence through the motion detector.
+ * @param dir Sequence directory
+ * @param fps Recording frame rate
+ * @return Number of mismatches with expected.txt (0 = match), or -1 if the sequence could not be read
+ */
+int HostMotion_RunSequence(const char *dir, int fps) {
+    std::vector<std::string> files;
+    DIR *handle = opendir(dir);
+    if (!handle) {
+        Serial.printf("[HostMotion] Cannot open %s.\n", dir);
+        return -1;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(handle)) != NULL) {
+        std::string name = entry->d_name;
+        size_t dot = name.rfind('.');
+        std::string ext = dot == std::string::npos ? "" : name.substr(dot);
+        if (ext == ".jpg" || ext == ".jpeg" || ext == ".JPG") files.push_back(std::string(dir) + "/" + name);
+    }
+    closedir(handle);
+    std::sort(files.begin(), files.end());
+    if (files.empty()) {
+        Serial.printf("[HostMotion] No .jpg frames in %s.\n", dir);
+        return -1;
+    }
+
+    static MotionDetector detector; // About 29 KB, kept off the stack
+    static MotionEvent actual[MOTION_REPLAY_MAX_EVENTS];
+    MotionDetector_Init(detector);
+    int actualCount = 0;
+    std::vector<uint16_t> frame;
+    char line[64];
+    for (size_t i = 0; i < files.size(); i++) {
+        if (!HostMotion_LoadFrame(files[i], frame)) {
+            Serial.printf("[HostMotion] Cannot decode %s.\n", files[i].c_str());
+            return -1;
+        }
+        MotionEvent event;
+        if (!MotionDetector_Process(detector, frame.data(), HOST_MOTION_WIDTH, HOST_MOTION_HEIGHT,
+                                    (uint32_t)(i * 1000 / fps), event)) {
+            continue;
+        }
+        MotionReplay_Format(event, line, sizeof(line));
+        Serial.printf("[Motion] %s\n", line);
+        if (actualCount < MOTION_REPLAY_MAX_EVENTS) actual[actualCount++] = event;
+    }
+    Serial.printf("[HostMotion] %u frames from %s, %d events.\n", (unsigned)files.size(), dir, actualCount);
+
+    std::vector<uint8_t> text;
+    if (!HostMotion_ReadFile(std::string(dir) + "/expected.txt", text)) {
+        Serial.println("[HostMotion] No expected.txt, events not checked.");
+        return 0;
+    }
+    text.push_back('\0');
+    MotionEvent expected[MOTION_REPLAY_MAX_EVENTS];
+    int expectedCount = MotionReplay_Parse((const char *)text.data(), expected, MOTION_REPLAY_MAX_EVENTS);
+    if (expectedCount < 0) {
+        Serial.printf("[HostMotion] Malformed %s/expected.txt.\n", dir);
+        return -1;
+    }
+    return MotionReplay_Compare(expected, expectedCount, actual, actualCount,
+                                [](const char *mismatch) { Serial.printf("[HostMotion] %s\n", mismatch); });
+}
@@ -0,0 +1,17 @@
+// hostMotion.h - Motion detector checks on recorded frame sequences (native build)
+// Runs a directory of JPEG frames through a fresh MotionDetector on a virtual clock, prints the
+// events in the replay text format (motionReplay.h) and compares them with <dir>/expected.txt.
+// Detector changes must keep the recorded sequences in host/motion passing.
+
+#pragma once // Prevent multiple inclusion of this header
+
+/**
+ * @brief Replay a recorded frame sequence through the motion detector.
+ * Frames are the .jpg files of the directory in name order, scaled to QVGA like the camera
+ * stand-in, one every 1000 / fps ms. Without <dir>/expected.txt the events are only printed,
+ * which is how a new recording gets its expected events.
+ * @param dir Sequence directory
+ * @param fps Recording frame rate
+ * @return Number of mismatches with expected.txt (0 = match), or -1 if the sequence could not be read
+ */
+int HostMotion_RunSequence(const char *dir, int fps);
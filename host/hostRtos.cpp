@@ -0,0 +1,355 @@
+// hostRtos.cpp - FreeRTOS API on POSIX threads (native build)
+// This module implements the kernel subset declared in host/include/freertos on top of pthreads.
+// All kernel objects share one lock and one condition variable, which keeps the semantics simple
+// (every state change wakes every waiter) at a cost that does not matter on a PC.
+//
+// Key features:
+// - Tasks are detached pthreads; deletion is deferred to the victim's next kernel call
+// - Queues, counting semaphores, mutexes and queue sets with tick timeouts
+// - uxTaskGetSystemState reports real per-thread CPU time for the profiler
+
+#include "freertos/FreeRTOS.h" // Include headers for this module
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <pthread.h> // Threads and per-thread CPU clocks
+#include <time.h> // clock_gettime
+#include <string.h> // memcpy, strncpy
+#include <stdio.h> // fprintf
+#include <chrono> // Wait deadlines
+#include <condition_variable> // Kernel wake-ups
+#include <deque> // Queue storage
+#include <mutex> // Kernel lock
+#include <vector> // Task list and item storage
+
+// One task (pthread)
+struct HostTask {
+    pthread_t thread;           // Underlying thread
+    TaskFunction_t function;    // Task function
+    void *param;                // Task parameter
+    char name[configMAX_TASK_NAME_LEN]; // Task name
+    UBaseType_t priority;       // Recorded priority
+    BaseType_t core;            // Recorded core
+    uint32_t stackDepth;        // Configured stack depth (bytes)
+    UBaseType_t number;         // Creation number
+    clockid_t cpuClock;         // Thread CPU clock
+    bool deleteRequested;       // Set by vTaskDelete from another task
+};
+
+// One queue, semaphore or queue set
+struct QueueDefinition {
+    UBaseType_t length;                    // Maximum number of items
+    UBaseType_t itemSize;                  // Item size (0 for semaphores)
+    std::deque<std::vector<uint8_t>> items; // Stored items
+    QueueDefinition *set;                  // Set this queue belongs to (NULL if none)
+};
+
+// Thrown inside a task that was deleted by another task; caught by the task trampoline
+struct HostTaskDeleted {};
+
+// Kernel lock and wake-up condition shared by every object
+static std::recursive_mutex kernelMutex;
+static std::condition_variable_any kernelCond;
+// Live tasks
+static std::vector<HostTask *> taskList;
+static UBaseType_t taskCounter = 0;
+// Task record of the calling thread (NULL for the main thread until first use)
+static thread_local HostTask *currentTask = NULL;
+// Kernel start time
+static const std::chrono::steady_clock::time_point kernelStart = std::chrono::steady_clock::now();
+
+/**
+ * @brief Get the record of the calling thread, creating one for threads not started by the kernel.
+ */
+static HostTask *HostRtos_Current() {
+    if (!currentTask) {
+        HostTask *task = new HostTask();
+        task->thread = pthread_self();
+        task->function = NULL;
+        task->param = NULL;
+        strncpy(task->name, "loopTask", sizeof(task->name) - 1); // Arduino's name for setup()/loop()
+        task->priority = 1;
+        task->core = 1;
+        task->stackDepth = 8192;
+        pthread_getcpuclockid(task->thread, &task->cpuClock);
+        task->deleteRequested = false;
+        std::lock_guard<std::recursive_mutex> lock(kernelMutex);
+        task->number = ++taskCounter;
+        taskList.push_back(task);
+        currentTask = task;
+    }
+    return currentTask;
+}
+
+/**
+ * @brief Wait on the kernel condition until pred() holds or the timeout expires.
+ * Throws HostTaskDeleted if the calling task is deleted while waiting.
+ * @param lock Held kernel lock
+ * @param ticks Timeout in ticks (portMAX_DELAY = forever)
+ * @param pred Condition to wait for
+ * @return true if pred() holds
+ */
+template <typename Pred>
+static bool HostRtos_Wait(std::unique_lock<std::recursive_mutex> &lock, TickType_t ticks, Pred pred) {
+    HostTask *self = HostRtos_Current();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ticks * portTICK_PERIOD_MS);
+    while (true) {
+        if (self->deleteRequested) throw HostTaskDeleted();
+        if (pred()) return true;
+        if (ticks == portMAX_DELAY) {
+            kernelCond.wait(lock);
+        } else if (kernelCond.wait_until(lock, deadline) == std::cv_status::timeout) {
+            if (self->deleteRequested) throw HostTaskDeleted();
+            return pred();
+        }
+    }
+}
+
+/**
+ * @brief Thread entry: run the task function and unregister the task when it returns or is deleted.
+ */
+static void *HostRtos_TaskEntry(void *arg) {
+    HostTask *task = (HostTask *)arg;
+    currentTask = task;
+    pthread_getcpuclockid(pthread_self(), &task->cpuClock);
+    try {
+        task->function(task->param);
+        fprintf(stderr, "[HostRtos] Task %s returned (not allowed in FreeRTOS).\n", task->name);
+    } catch (const HostTaskDeleted &) {
+    }
+    {
+        std::lock_guard<std::recursive_mutex> lock(kernelMutex);
+        for (size_t i = 0; i < taskList.size(); i++) {
+            if (taskList[i] == task) taskList.erase(taskList.begin() + i);
+        }
+        kernelCond.notify_all(); // Wake a deleter waiting for us
+    }
+    delete task;
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackDepth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+    HostTask *task = new HostTask();
+    task->function = function;
+    task->param = param;
+    strncpy(task->name, name ? name : "", sizeof(task->name) - 1);
+    task->name[sizeof(task->name) - 1] = '\0';
+    task->priority = priority;
+    task->core = core;
+    task->stackDepth = stackDepth;
+    task->deleteRequested = false;
+    std::lock_guard<std::recursive_mutex> lock(kernelMutex); // Registered before the thread can run
+    task->number = ++taskCounter;
+    taskList.push_back(task);
+    if (pthread_create(&task->thread, NULL, HostRtos_TaskEntry, task) != 0) {
+        taskList.pop_back();
+        delete task;
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    if (handle) *handle = task;
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stackDepth, void *param,
+                       UBaseType_t priority, TaskHandle_t *handle) {
+    return xTaskCreatePinnedToCore(function, name, stackDepth, param, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    HostTask *self = HostRtos_Current();
+    if (!task || task == self) throw HostTaskDeleted(); // Unwinds to the trampoline
+    std::unique_lock<std::recursive_mutex> lock(kernelMutex);
+    task->deleteRequested = true;
+    kernelCond.notify_all();
+    while (true) { // The victim leaves at its next kernel call
+        bool alive = false;
+        for (HostTask *t : taskList) alive |= t == task;
+        if (!alive) break;
+        kernelCond.wait(lock);
+    }
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::unique_lock<std::recursive_mutex> lock(kernelMutex);
+    HostRtos_Wait(lock, ticks, [] { return false; });
+}
+
+TickType_t xTaskGetTickCount() {
+    auto elapsed = std::chrono::steady_clock::now() - kernelStart;
+    return (TickType_t)(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return HostRtos_Current();
+}
+
+char *pcTaskGetName(TaskHandle_t task) {
+    return (task ? task : HostRtos_Current())->name;
+}
+
+BaseType_t xPortGetCoreID() {
+    BaseType_t core = HostRtos_Current()->core;
+    return core == tskNO_AFFINITY ? 0 : core;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks() {
+    std::lock_guard<std::recursive_mutex> lock(kernelMutex);
+    return taskList.size();
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *status, UBaseType_t maxCount, uint32_t *totalRunTime) {
+    std::lock_guard<std::recursive_mutex> lock(kernelMutex);
+    UBaseType_t count = 0;
+    for (HostTask *task : taskList) {
+        if (count >= maxCount) break;
+        struct timespec ts = {0, 0};
+        clock_gettime(task->cpuClock, &ts);
+        TaskStatus_t &s = status[count++];
+        s.xHandle = task;
+        s.pcTaskName = task->name;
+        s.xTaskNumber = task->number;
+        s.eCurrentState = task == currentTask ? eRunning : eBlocked;
+        s.uxCurrentPriority = s.uxBasePriority = task->priority;
+        s.ulRunTimeCounter = (uint32_t)((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+        s.usStackHighWaterMark = task->stackDepth;
+        s.xCoreID = task->core;
+    }
+    if (totalRunTime) {
+        auto elapsed = std::chrono::steady_clock::now() - kernelStart;
+        *totalRunTime = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    }
+    return count;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    return (task ? task : HostRtos_Current())->stackDepth;
+}
+
+TaskHandle_t xTaskGetIdleTaskHandleForCPU(UBaseType_t cpu) {
+    return NULL; // No idle tasks on the host: per-core load stays unavailable
+}
+
+void HostRtos_EnterCritical() {
+    kernelMutex.lock();
+}
+
+void HostRtos_ExitCritical() {
+    kernelMutex.unlock();
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    if (length == 0) return NULL;
+    QueueDefinition *queue = new QueueDefinition();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    queue->set = NULL;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+/**
+ * @brief Store an item (front or back) and notify the owning set. Kernel lock must be held.
+ */
+static void HostRtos_Store(QueueHandle_t queue, const void *item, bool front) {
+    std::vector<uint8_t> data(queue->itemSize);
+    if (queue->itemSize) memcpy(data.data(), item, queue->itemSize);
+    if (front) queue->items.push_front(data);
+    else queue->items.push_back(data);
+    if (queue->set) HostRtos_Store(queue->set, &queue, false); // Tell the set which member has data
+    kernelCond.notify_all();
+}
+
+/**
+ * @brief Send an item, waiting for space.
+ */
+static BaseType_t HostRtos_Send(QueueHandle_t queue, const void *item, TickType_t ticks, bool front) {
+    std::unique_lock<std::recursive_mutex> lock(kernelMutex);
+    if (!HostRtos_Wait(lock, ticks, [queue] { return queue->items.size() < queue->length; })) return errQUEUE_FULL;
+    HostRtos_Store(queue, item, front);
+    return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    return HostRtos_Send(queue, item, ticks, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    return HostRtos_Send(queue, item, ticks, true);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item) {
+    std::lock_guard<std::recursive_mutex> lock(kernelMutex);
+    if (!queue->items.empty()) { // Length 1 queue: replace the pending item
+        if (queue->itemSize) memcpy(queue->items.front().data(), item, queue->itemSize);
+        kernelCond.notify_all();
+        return pdPASS;
+    }
+    HostRtos_Store(queue, item, false);
+    return pdPASS;
+}
+
+/**
+ * @brief Receive or peek an item, waiting for data.
+ */
+static BaseType_t HostRtos_Receive(QueueHandle_t queue, void *item, TickType_t ticks, bool remove) {
+    std::unique_lock<std::recursive_mutex> lock(kernelMutex);
+    if (!HostRtos_Wait(lock, ticks, [queue] { return !queue->items.empty(); })) return errQUEUE_EMPTY;
+    if (item && queue->itemSize) memcpy(item, queue->items.front().data(), queue->itemSize);
+    if (remove) {
+        queue->items.pop_front();
+        kernelCond.notify_all(); // Wake senders waiting for space
+    }
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks) {
+    return HostRtos_Receive(queue, item, ticks, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t ticks) {
+    return HostRtos_Receive(queue, item, ticks, false);
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    std::lock_guard<std::recursive_mutex> lock(kernelMutex);
+    queue->items.clear();
+    kernelCond.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::recursive_mutex> lock(kernelMutex);
+    return queue->items.size();
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    std::lock_guard<std::recursive_mutex> lock(kernelMutex);
+    return queue->length - queue->items.size();
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+    QueueDefinition *sem = xQueueCreate(maxCount, 0);
+    for (UBaseType_t i = 0; sem && i < initialCount; i++) sem->items.push_back(std::vector<uint8_t>());
+    return sem;
+}
+
+QueueSetHandle_t xQueueCreateSet(UBaseType_t length) {
+    return xQueueCreate(length, sizeof(QueueSetMemberHandle_t));
+}
+
+BaseType_t xQueueAddToSet(QueueSetMemberHandle_t member, QueueSetHandle_t set) {
+    std::lock_guard<std::recursive_mutex> lock(kernelMutex);
+    if (member->set || !member->items.empty()) return pdFAIL; // Same rule as the kernel
+    member->set = set;
+    return pdPASS;
+}
+
+QueueSetMemberHandle_t xQueueSelectFromSet(QueueSetHandle_t set, TickType_t ticks) {
+    QueueSetMemberHandle_t member = NULL;
+    return xQueueReceive(set, &member, ticks) == pdPASS ? member : NULL;
+}
@@ -0,0 +1,215 @@
+// hostSd.cpp - SD card stand-in backed by a host directory (native build)
+// This module implements fs::File, fs::FS and SD from host/include on stdio and dirent.
+// Paths are the card paths used by the firmware ("/photo_1.jpg"), resolved under the root.
+//
+// Key features:
+// - Read, write and append files; list directories with openNextFile()
+// - The same open modes as the ESP32 core ("r", "w", "a")
+// - Card size reports the host file system's size
+
+#include <SD.h> // Include header for this module
+#include <dirent.h> // Directory listing
+#include <sys/stat.h> // stat, mkdir
+#include <sys/statvfs.h> // File system size
+#include <unistd.h> // rmdir
+#include <errno.h> // errno
+
+fs::SDFS SD;
+SPIClass SPI;
+// Host directory backing the card
+static String sdRoot = "sdcard";
+
+namespace fs {
+
+// Open file or directory
+struct HostFileImpl {
+    FILE *file = NULL;   // Open regular file
+    DIR *dir = NULL;     // Open directory
+    String path;         // Card path ("/dir/name")
+    String hostPath;     // Host path
+    String baseName;     // Last path component
+    ~HostFileImpl() {
+        if (file) fclose(file);
+        if (dir) closedir(dir);
+    }
+};
+
+/**
+ * @brief Open a card path for the given host path.
+ */
+static std::shared_ptr<HostFileImpl> HostSd_Open(const String &path, const String &hostPath, const char *mode) {
+    struct stat st;
+    auto impl = std::make_shared<HostFileImpl>();
+    impl->path = path;
+    impl->hostPath = hostPath;
+    int slash = -1;
+    for (int i = 0; i < (int)path.length(); i++) {
+        if (path[i] == '/') slash = i;
+    }
+    impl->baseName = path.substring(slash + 1);
+    if (stat(hostPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        impl->dir = opendir(hostPath.c_str());
+        return impl->dir ? impl : NULL;
+    }
+    const char *stdioMode = strcmp(mode, FILE_WRITE) == 0 ? "w+b" : strcmp(mode, FILE_APPEND) == 0 ? "a+b" : "rb";
+    impl->file = fopen(hostPath.c_str(), stdioMode);
+    return impl->file ? impl : NULL;
+}
+
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t *buffer, size_t size) {
+    if (!impl || !impl->file) return 0;
+    return fwrite(buffer, 1, size, impl->file);
+}
+
+int File::available() {
+    if (!impl || !impl->file) return 0;
+    return (int)(size() - position());
+}
+
+int File::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::read(uint8_t *buffer, size_t size) {
+    if (!impl || !impl->file) return 0;
+    return fread(buffer, 1, size, impl->file);
+}
+
+int File::peek() {
+    if (!impl || !impl->file) return -1;
+    int c = fgetc(impl->file);
+    if (c != EOF) ungetc(c, impl->file);
+    return c == EOF ? -1 : c;
+}
+
+void File::flush() {
+    if (impl && impl->file) fflush(impl->file);
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    if (!impl || !impl->file) return false;
+    return fseek(impl->file, pos, mode == SeekSet ? SEEK_SET : mode == SeekCur ? SEEK_CUR : SEEK_END) == 0;
+}
+
+size_t File::position() const {
+    if (!impl || !impl->file) return 0;
+    long pos = ftell(impl->file);
+    return pos < 0 ? 0 : pos;
+}
+
+size_t File::size() const {
+    if (!impl || !impl->file) return 0;
+    fflush(impl->file);
+    struct stat st;
+    return fstat(fileno(impl->file), &st) == 0 ? st.st_size : 0;
+}
+
+void File::close() {
+    impl.reset();
+}
+
+File::operator bool() const {
+    return impl != NULL;
+}
+
+const char *File::name() const {
+    return impl ? impl->baseName.c_str() : "";
+}
+
+const char *File::path() const {
+    return impl ? impl->path.c_str() : "";
+}
+
+bool File::isDirectory() const {
+    return impl && impl->dir;
+}
+
+File File::openNextFile(const char *mode) {
+    if (!impl || !impl->dir) return File();
+    struct dirent *entry;
+    while ((entry = readdir(impl->dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        String separator = impl->path.endsWith("/") ? "" : "/";
+        String path = impl->path + separator + entry->d_name;
+        String hostPath = impl->hostPath + "/" + entry->d_name;
+        return File(HostSd_Open(path, hostPath, mode));
+    }
+    return File();
+}
+
+void File::rewindDirectory() {
+    if (impl && impl->dir) rewinddir(impl->dir);
+}
+
+time_t File::getLastWrite() {
+    struct stat st;
+    return impl && stat(impl->hostPath.c_str(), &st) == 0 ? st.st_mtime : 0;
+}
+
+String FS::hostPath(const char *path) const {
+    String p = root;
+    if (path[0] != '/') p += "/";
+    p += path;
+    return p;
+}
+
+File FS::open(const char *path, const char *mode, bool create) {
+    return File(HostSd_Open(path, hostPath(path), mode));
+}
+
+bool FS::exists(const char *path) {
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char *path) {
+    return ::remove(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char *from, const char *to) {
+    return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char *path) {
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool FS::rmdir(const char *path) {
+    return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+bool SDFS::begin(uint8_t ssPin, SPIClass &spi, uint32_t frequency, const char *mountpoint, uint8_t maxFiles,
+                 bool formatIfEmpty) {
+    root = sdRoot;
+    if (::mkdir(root.c_str(), 0755) != 0 && errno != EEXIST) {
+        Serial.printf("[HostSd] Cannot create card directory %s.\n", root.c_str());
+        return false;
+    }
+    Serial.printf("[HostSd] Card mapped to %s.\n", root.c_str());
+    return true;
+}
+
+uint64_t SDFS::cardSize() {
+    return totalBytes();
+}
+
+uint64_t SDFS::totalBytes() {
+    struct statvfs vfs;
+    return statvfs(root.c_str(), &vfs) == 0 ? (uint64_t)vfs.f_blocks * vfs.f_frsize : 0;
+}
+
+uint64_t SDFS::usedBytes() {
+    struct statvfs vfs;
+    return statvfs(root.c_str(), &vfs) == 0 ? (uint64_t)(vfs.f_blocks - vfs.f_bfree) * vfs.f_frsize : 0;
+}
+
+} // namespace fs
+
+void HostSd_SetRoot(const char *path) {
+    sdRoot = path;
+}
@@ -0,0 +1,221 @@
+// hostTft.cpp - TFT display stand-in (native build)
+// This module implements the framebuffer TFT_eSPI/TFT_eSprite declared in host/include/TFT_eSPI.h
+// and the PNG writer used to inspect it.
+//
+// Key features:
+// - Rotation swaps width and height like the panel driver
+// - Sprites push into their parent with panel byte order conversion
+// - PNG output and input through libpng (RGB888)
+
+#include <TFT_eSPI.h> // Include header for this module
+#include <png.h> // PNG encoder
+
+/**
+ * @brief Swap the bytes of an RGB565 value (panel byte order <-> native).
+ */
+static inline uint16_t HostTft_Swap(uint16_t value) {
+    return (value >> 8) | (value << 8);
+}
+
+TFT_eSPI::TFT_eSPI(int16_t width, int16_t height)
+    : rotatedWidth(width), rotatedHeight(height), panelWidth(width), panelHeight(height),
+      pixels((size_t)width * height, TFT_BLACK) {}
+
+void TFT_eSPI::init() {
+    std::fill(pixels.begin(), pixels.end(), TFT_BLACK);
+}
+
+void TFT_eSPI::setRotation(uint8_t rotation) {
+    bool landscape = rotation & 1;
+    rotatedWidth = landscape ? panelHeight : panelWidth;
+    rotatedHeight = landscape ? panelWidth : panelHeight;
+}
+
+void TFT_eSPI::writePixel(int32_t x, int32_t y, uint16_t color) {
+    pixels[(size_t)y * rotatedWidth + x] = color;
+}
+
+uint16_t TFT_eSPI::getPixel(int32_t x, int32_t y) const {
+    return pixels[(size_t)y * rotatedWidth + x];
+}
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color) {
+    if (x < 0 || y < 0 || x >= rotatedWidth || y >= rotatedHeight) return;
+    writePixel(x, y, color);
+    pixelsWritten++;
+}
+
+uint16_t TFT_eSPI::readPixel(int32_t x, int32_t y) {
+    if (x < 0 || y < 0 || x >= rotatedWidth || y >= rotatedHeight) return 0;
+    return getPixel(x, y);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    int32_t x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+    int32_t x1 = x + w > rotatedWidth ? rotatedWidth : x + w;
+    int32_t y1 = y + h > rotatedHeight ? rotatedHeight : y + h;
+    for (int32_t yy = y0; yy < y1; yy++) {
+        for (int32_t xx = x0; xx < x1; xx++) writePixel(xx, yy, color);
+    }
+    pushCalls++;
+    if (x1 > x0 && y1 > y0) pixelsWritten += (uint64_t)(x1 - x0) * (y1 - y0);
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+}
+
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) {
+    int32_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int32_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int32_t err = dx + dy;
+    while (true) { // Bresenham
+        drawPixel(x0, y0, color);
+        if (x0 == x1 && y0 == y1) break;
+        int32_t e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) {
+    for (int32_t row = 0; row < h; row++) {
+        int32_t yy = y + row;
+        if (yy < 0 || yy >= rotatedHeight) continue;
+        for (int32_t col = 0; col < w; col++) {
+            int32_t xx = x + col;
+            if (xx < 0 || xx >= rotatedWidth) continue;
+            uint16_t value = data[(size_t)row * w + col];
+            writePixel(xx, yy, swapBytes ? value : HostTft_Swap(value));
+        }
+    }
+    pushCalls++;
+    pixelsWritten += (uint64_t)w * h;
+}
+
+void TFT_eSPI::drawChar(int32_t x, int32_t y, char c) {
+    int32_t cell = 6 * textSize, rows = 8 * textSize;
+    if (textBgColor != textColor) fillRect(x, y, cell, rows, textBgColor); // Opaque background
+    if (c != ' ') fillRect(x, y, 5 * textSize, 7 * textSize, textColor); // Glyph cell
+}
+
+int16_t TFT_eSPI::drawString(const char *text, int32_t x, int32_t y) {
+    int32_t start = x;
+    for (const char *p = text; *p; p++) {
+        drawChar(x, y, *p);
+        x += 6 * textSize;
+    }
+    return x - start;
+}
+
+size_t TFT_eSPI::write(uint8_t c) {
+    if (c == '\n') {
+        cursorX = 0;
+        cursorY += 8 * textSize;
+        return 1;
+    }
+    if (c == '\r') return 1;
+    if (cursorX + 6 * textSize > rotatedWidth) { // Wrap like TFT_eSPI's default textwrapX
+        cursorX = 0;
+        cursorY += 8 * textSize;
+    }
+    drawChar(cursorX, cursorY, c);
+    cursorX += 6 * textSize;
+    return 1;
+}
+
+void *TFT_eSprite::createSprite(int16_t w, int16_t h, uint8_t frames) {
+    buffer.assign((size_t)w * h, 0);
+    rotatedWidth = panelWidth = w;
+    rotatedHeight = panelHeight = h;
+    return buffer.data();
+}
+
+void TFT_eSprite::deleteSprite() {
+    buffer.clear();
+    buffer.shrink_to_fit();
+    rotatedWidth = rotatedHeight = panelWidth = panelHeight = 0;
+}
+
+void TFT_eSprite::writePixel(int32_t x, int32_t y, uint16_t color) {
+    buffer[(size_t)y * rotatedWidth + x] = HostTft_Swap(color);
+}
+
+uint16_t TFT_eSprite::getPixel(int32_t x, int32_t y) const {
+    return HostTft_Swap(buffer[(size_t)y * rotatedWidth + x]);
+}
+
+void TFT_eSprite::pushSprite(int32_t x, int32_t y) {
+    if (buffer.empty()) return;
+    bool swap = parent->getSwapBytes();
+    parent->setSwapBytes(false); // Sprite data is in panel byte order
+    parent->pushImage(x, y, rotatedWidth, rotatedHeight, buffer.data());
+    parent->setSwapBytes(swap);
+}
+
+bool HostTft_SavePng(const char *path, const uint16_t *pixels, int width, int height) {
+    FILE *file = fopen(path, "wb");
+    if (!file) return false;
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info = png ? png_create_info_struct(png) : NULL;
+    if (!info || setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, &info);
+        fclose(file);
+        return false;
+    }
+    png_init_io(png, file);
+    png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
+                 PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png, info);
+    std::vector<uint8_t> row(width * 3);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint16_t c = pixels[(size_t)y * width + x];
+            row[x * 3 + 0] = ((c >> 11) & 0x1F) * 255 / 31;
+            row[x * 3 + 1] = ((c >> 5) & 0x3F) * 255 / 63;
+            row[x * 3 + 2] = (c & 0x1F) * 255 / 31;
+        }
+        png_write_row(png, row.data());
+    }
+    png_write_end(png, NULL);
+    png_destroy_write_struct(&png, &info);
+    fclose(file);
+    return true;
+}
+
+bool HostTft_LoadPng(const char *path, std::vector<uint16_t> &pixels, int &width, int &height) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return false;
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info = png ? png_create_info_struct(png) : NULL;
+    if (!info || setjmp(png_jmpbuf(png))) {
+        png_destroy_read_struct(&png, &info, NULL);
+        fclose(file);
+        return false;
+    }
+    png_init_io(png, file);
+    png_read_info(png, info);
+    png_set_strip_16(png); // Normalize to 8-bit RGB
+    png_set_strip_alpha(png);
+    png_set_palette_to_rgb(png);
+    png_set_gray_to_rgb(png);
+    png_read_update_info(png, info);
+    width = png_get_image_width(png, info);
+    height = png_get_image_height(png, info);
+    pixels.resize((size_t)width * height);
+    std::vector<uint8_t> row(png_get_rowbytes(png, info));
+    for (int y = 0; y < height; y++) {
+        png_read_row(png, row.data(), NULL);
+        for (int x = 0; x < width; x++) {
+            const uint8_t *rgb = &row[x * 3];
+            uint16_t r = (rgb[0] * 31 + 127) / 255, g = (rgb[1] * 63 + 127) / 255, b = (rgb[2] * 31 + 127) / 255;
+            pixels[(size_t)y * width + x] = (r << 11) | (g << 5) | b; // Exact inverse of HostTft_SavePng
+        }
+    }
+    png_destroy_read_struct(&png, &info, NULL);
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,65 @@
+// Arduino.h - Host stand-in for the Arduino-ESP32 core (native build)
+// This header pulls in the same implicit dependencies as the ESP32 core's Arduino.h
+// (FreeRTOS, esp_timer, heap caps, libc), so firmware sources compile unchanged on Linux.
+//
+// Key features:
+// - Serial prints to stdout; Serial.available()/read come from stdin when it is not a terminal
+// - millis()/micros()/delay() on the host monotonic clock (delay() is a FreeRTOS delay)
+// - GPIO calls are accepted and logged only when HOST_LOG_GPIO is defined
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stdint.h> // Fixed-width integer types
+#include <stdio.h> // printf family
+#include <stdlib.h> // malloc, free
+#include <string.h> // memcpy, strcmp
+#include <math.h> // Math helpers
+#include <ctype.h> // Character classes
+#include <algorithm> // std::min/std::max (the core exports them as min/max)
+#include "freertos/FreeRTOS.h" // FreeRTOS kernel stand-in
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h" // Microsecond clock
+#include "esp_heap_caps.h" // Capability-based heap
+#include "WString.h" // String
+#include "Print.h" // Print
+
+#define PROGMEM
+#define IRAM_ATTR
+#define ARDUINO_ISR_ATTR
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+static inline void *ps_malloc(size_t size) { return malloc(size); }
+
+// Serial port: stdout for output, stdin (non-blocking) for the console
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud) {}
+    int available();
+    int read();
+    String readStringUntil(char terminator);
+    using Print::write;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    void flush();
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,71 @@
+// FS.h - Host stand-in for the Arduino-ESP32 file system API (native build)
+// Files and directories map to a host directory (see SD.h). File objects share their
+// handle between copies, like the ESP32 core's File.
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h> // Print, String
+#include <memory> // Shared file handle
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct HostFileImpl; // Open file or directory (hostSd.cpp)
+
+class File : public Print {
+public:
+    File() {}
+    explicit File(std::shared_ptr<HostFileImpl> impl) : impl(impl) {}
+    using Print::write;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    int available();
+    int read();
+    size_t read(uint8_t *buffer, size_t size);
+    int peek();
+    void flush();
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void close();
+    operator bool() const;
+    const char *name() const;
+    const char *path() const;
+    bool isDirectory() const;
+    File openNextFile(const char *mode = FILE_READ);
+    void rewindDirectory();
+    time_t getLastWrite();
+
+private:
+    std::shared_ptr<HostFileImpl> impl;
+};
+
+class FS {
+public:
+    File open(const char *path, const char *mode = FILE_READ, bool create = false);
+    File open(const String &path, const char *mode = FILE_READ, bool create = false) { return open(path.c_str(), mode, create); }
+    bool exists(const char *path);
+    bool exists(const String &path) { return exists(path.c_str()); }
+    bool remove(const char *path);
+    bool remove(const String &path) { return remove(path.c_str()); }
+    bool rename(const char *from, const char *to);
+    bool mkdir(const char *path);
+    bool rmdir(const char *path);
+
+protected:
+    String root; // Host directory backing "/"
+    String hostPath(const char *path) const;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
@@ -0,0 +1,31 @@
+// Print.h - Host stand-in for the Arduino Print class (native build)
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stddef.h> // size_t
+#include <stdint.h> // Fixed-width integer types
+#include "WString.h" // String
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *str);
+    size_t print(const char *str);
+    size_t print(const String &str);
+    size_t print(char c);
+    size_t print(int value);
+    size_t print(unsigned int value);
+    size_t print(long value);
+    size_t print(unsigned long value);
+    size_t print(double value, int digits = 2);
+    size_t println();
+    size_t println(const char *str);
+    size_t println(const String &str);
+    size_t println(int value);
+    size_t println(unsigned int value);
+    size_t println(long value);
+    size_t println(unsigned long value);
+    size_t println(double value, int digits = 2);
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
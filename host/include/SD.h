@@ -0,0 +1,31 @@
+// SD.h - Host stand-in for the Arduino-ESP32 SD library (native build)
+// The card is a host directory, "./sdcard" unless HostSd_SetRoot() is called before SD.begin().
+
+#pragma once // Prevent multiple inclusion of this header
+#include "FS.h" // File system API
+#include "SPI.h" // SPIClass
+
+enum sdcard_type_t { CARD_NONE, CARD_MMC, CARD_SD, CARD_SDHC, CARD_UNKNOWN };
+
+namespace fs {
+
+class SDFS : public FS {
+public:
+    bool begin(uint8_t ssPin = SS, SPIClass &spi = SPI, uint32_t frequency = 4000000, const char *mountpoint = "/sd",
+               uint8_t maxFiles = 5, bool formatIfEmpty = false);
+    void end() {}
+    sdcard_type_t cardType() { return CARD_SDHC; }
+    uint64_t cardSize();
+    uint64_t totalBytes();
+    uint64_t usedBytes();
+};
+
+} // namespace fs
+
+extern fs::SDFS SD;
+
+/**
+ * @brief Select the host directory that backs the SD card (native build only).
+ * @param path Host directory (created by SD.begin() if missing)
+ */
+void HostSd_SetRoot(const char *path);
@@ -0,0 +1,22 @@
+// SPI.h - Host stand-in for the Arduino-ESP32 SPI class (native build)
+// Bus setup is accepted and ignored; the display and card stand-ins do not use a bus.
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stdint.h> // Fixed-width integer types
+
+#define FSPI 0
+#define HSPI 1
+#define VSPI 2
+#define SS 10
+
+class SPIClass {
+public:
+    explicit SPIClass(uint8_t bus = HSPI) : bus(bus) {}
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {}
+    void end() {}
+
+private:
+    uint8_t bus;
+};
+
+extern SPIClass SPI;
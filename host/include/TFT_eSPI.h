@@ -0,0 +1,147 @@
+// TFT_eSPI.h - Host stand-in for the TFT_eSPI display library (native build)
+// The panel is an in-memory RGB565 framebuffer that can be saved as PNG. Byte order follows
+// TFT_eSPI: with setSwapBytes(false) pushImage() data is in panel byte order (as the camera
+// delivers it), with setSwapBytes(true) it is native uint16_t colors (as TJpgDec delivers them).
+// Sprites store pixels in panel byte order, so getPointer() sees the same layout as on the device.
+//
+// Key features:
+// - TFT_eSPI and TFT_eSprite with the drawing calls used by the firmware
+// - Text is drawn as solid 5x7 glyph cells (no font data): positions, sizes and colors match
+// - HostTft_SavePng() dumps the panel for inspection and golden image comparisons
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h> // Print, String
+#include <SPI.h> // SPIClass (pulled in by TFT_eSPI on the device)
+#include <vector> // Pixel storage
+
+#define TFT_WIDTH 240
+#define TFT_HEIGHT 320
+
+#define TFT_BLACK 0x0000
+#define TFT_NAVY 0x000F
+#define TFT_DARKGREEN 0x03E0
+#define TFT_MAROON 0x7800
+#define TFT_PURPLE 0x780F
+#define TFT_OLIVE 0x7BE0
+#define TFT_LIGHTGREY 0xD69A
+#define TFT_DARKGREY 0x7BEF
+#define TFT_BLUE 0x001F
+#define TFT_GREEN 0x07E0
+#define TFT_CYAN 0x07FF
+#define TFT_RED 0xF800
+#define TFT_MAGENTA 0xF81F
+#define TFT_YELLOW 0xFFE0
+#define TFT_WHITE 0xFFFF
+#define TFT_ORANGE 0xFDA0
+
+class TFT_eSPI : public Print {
+public:
+    TFT_eSPI(int16_t width = TFT_WIDTH, int16_t height = TFT_HEIGHT);
+    virtual ~TFT_eSPI() {}
+
+    void begin() { init(); }
+    void init();
+    void setRotation(uint8_t rotation);
+    int16_t width() const { return rotatedWidth; }
+    int16_t height() const { return rotatedHeight; }
+
+    void setSwapBytes(bool swap) { swapBytes = swap; }
+    bool getSwapBytes() const { return swapBytes; }
+    void fillScreen(uint32_t color) { fillRect(0, 0, rotatedWidth, rotatedHeight, color); }
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void drawPixel(int32_t x, int32_t y, uint32_t color);
+    uint16_t readPixel(int32_t x, int32_t y);
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) { fillRect(x, y, w, 1, color); }
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) { fillRect(x, y, 1, h, color); }
+    void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data);
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data) {
+        pushImage(x, y, w, h, (const uint16_t *)data);
+    }
+    uint16_t color565(uint8_t r, uint8_t g, uint8_t b) { return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3); }
+
+    void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+    void setTextSize(uint8_t size) { textSize = size ? size : 1; }
+    void setTextColor(uint16_t color) { textColor = color; textBgColor = color; }
+    void setTextColor(uint16_t fg, uint16_t bg) { textColor = fg; textBgColor = bg; }
+    int16_t drawString(const char *text, int32_t x, int32_t y);
+    int16_t drawString(const String &text, int32_t x, int32_t y) { return drawString(text.c_str(), x, y); }
+    int16_t textWidth(const char *text) { return strlen(text) * 6 * textSize; }
+    int16_t fontHeight() { return 8 * textSize; }
+    using Print::write;
+    size_t write(uint8_t c) override;
+
+    /**
+     * @brief Get the framebuffer (native RGB565 colors, row-major, width() x height()).
+     */
+    const uint16_t *frameBuffer() const { return pixels.data(); }
+
+    /**
+     * @brief Get the number of pushImage/fill calls and pixels written since start (host statistics).
+     */
+    uint32_t pushCount() const { return pushCalls; }
+    uint64_t pixelCount() const { return pixelsWritten; }
+
+protected:
+    // Store one color (native RGB565) at a clipped position
+    virtual void writePixel(int32_t x, int32_t y, uint16_t color);
+    virtual uint16_t getPixel(int32_t x, int32_t y) const;
+    void drawChar(int32_t x, int32_t y, char c);
+
+    int16_t rotatedWidth, rotatedHeight; // Current size
+    int16_t panelWidth, panelHeight;     // Size at rotation 0
+    bool swapBytes = false;
+    int16_t cursorX = 0, cursorY = 0;
+    uint8_t textSize = 1;
+    uint16_t textColor = TFT_WHITE, textBgColor = TFT_WHITE;
+    std::vector<uint16_t> pixels;        // Native colors (panel only)
+    uint32_t pushCalls = 0;
+    uint64_t pixelsWritten = 0;
+};
+
+class TFT_eSprite : public TFT_eSPI {
+public:
+    explicit TFT_eSprite(TFT_eSPI *parent) : TFT_eSPI(0, 0), parent(parent) {}
+    void *createSprite(int16_t w, int16_t h, uint8_t frames = 1);
+    void deleteSprite();
+    bool created() const { return !buffer.empty(); }
+    void *getPointer() { return buffer.empty() ? NULL : buffer.data(); }
+    void pushSprite(int32_t x, int32_t y);
+    void setColorDepth(int8_t depth) {}
+
+protected:
+    void writePixel(int32_t x, int32_t y, uint16_t color) override;
+    uint16_t getPixel(int32_t x, int32_t y) const override;
+
+private:
+    TFT_eSPI *parent;
+    std::vector<uint16_t> buffer; // Panel byte order, like a 16-bit TFT_eSprite
+};
+
+/**
+ * @brief Save an RGB565 image (native colors) as a PNG file (native build only).
+ * @param path Output file
+ * @param pixels Row-major pixels
+ * @param width Image width
+ * @param height Image height
+ * @return true on success
+ */
+bool HostTft_SavePng(const char *path, const uint16_t *pixels, int width, int height);
+
+/**
+ * @brief Load a PNG file written by HostTft_SavePng() back into RGB565 (native build only).
+ * @param path Input file
+ * @param pixels Receives width * height native colors
+ * @param width Receives the image width
+ * @param height Receives the image height
+ * @return true on success
+ */
+bool HostTft_LoadPng(const char *path, std::vector<uint16_t> &pixels, int &width, int &height);
+
+/**
+ * @brief Save the display contents as a PNG file (native build only).
+ */
+static inline bool HostTft_SavePng(const char *path, const TFT_eSPI &tft) {
+    return HostTft_SavePng(path, tft.frameBuffer(), tft.width(), tft.height());
+}
@@ -0,0 +1,34 @@
+// TJpg_Decoder.h - Host stand-in for the TJpg_Decoder library (native build)
+// Decodes with libjpeg and delivers 16x16 RGB565 blocks to the sketch callback, like TJpgDec.
+// Scale 1, 2, 4 and 8 use libjpeg's DCT scaling, matching TJpgDec's output size.
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h> // String
+#include <FS.h> // File system API
+
+enum JRESULT { JDR_OK = 0, JDR_INTR, JDR_INP, JDR_MEM1, JDR_MEM2, JDR_PAR, JDR_FMT1, JDR_FMT2, JDR_FMT3 };
+
+typedef bool (*SketchCallback)(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t *data);
+
+class TJpg_Decoder {
+public:
+    void setJpgScale(uint8_t scale) { jpgScale = scale; }
+    void setCallback(SketchCallback callback) { tft_output = callback; }
+    void setSwapBytes(bool swapBytes) { swap = swapBytes; }
+
+    JRESULT drawJpg(int32_t x, int32_t y, const uint8_t *data, uint32_t size);
+    JRESULT getJpgSize(uint16_t *w, uint16_t *h, const uint8_t *data, uint32_t size);
+    JRESULT drawSdJpg(int32_t x, int32_t y, const char *path);
+    JRESULT drawSdJpg(int32_t x, int32_t y, const String &path) { return drawSdJpg(x, y, path.c_str()); }
+    JRESULT drawSdJpg(int32_t x, int32_t y, File file);
+    JRESULT getSdJpgSize(uint16_t *w, uint16_t *h, const char *path);
+    JRESULT getSdJpgSize(uint16_t *w, uint16_t *h, const String &path) { return getSdJpgSize(w, h, path.c_str()); }
+    JRESULT getSdJpgSize(uint16_t *w, uint16_t *h, File file);
+
+private:
+    uint8_t jpgScale = 1;
+    bool swap = false;
+    SketchCallback tft_output = NULL;
+};
+
+extern TJpg_Decoder TJpgDec;
@@ -0,0 +1,72 @@
+// WString.h - Host stand-in for the Arduino String class (native build)
+// Backed by std::string; only the members used by the firmware are provided.
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stdlib.h> // strtol, strtof
+#include <ctype.h> // tolower
+#include <string> // Storage
+
+class String {
+public:
+    String() {}
+    String(const char *str) : s(str ? str : "") {}
+    String(const std::string &str) : s(str) {}
+    String(char c) : s(1, c) {}
+    explicit String(int value) : s(std::to_string(value)) {}
+    explicit String(unsigned int value) : s(std::to_string(value)) {}
+    explicit String(long value) : s(std::to_string(value)) {}
+    explicit String(unsigned long value) : s(std::to_string(value)) {}
+
+    const char *c_str() const { return s.c_str(); }
+    unsigned int length() const { return s.size(); }
+    bool reserve(unsigned int size) { s.reserve(size); return true; }
+    char operator[](unsigned int index) const { return index < s.size() ? s[index] : 0; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+
+    String &operator+=(const String &other) { s += other.s; return *this; }
+    String &operator+=(const char *str) { s += str ? str : ""; return *this; }
+    String &operator+=(char c) { s += c; return *this; }
+    String &operator+=(int value) { s += std::to_string(value); return *this; }
+    String &operator+=(unsigned int value) { s += std::to_string(value); return *this; }
+    bool concat(const char *str) { *this += str; return true; }
+
+    bool operator==(const String &other) const { return s == other.s; }
+    bool operator==(const char *str) const { return s == (str ? str : ""); }
+    bool operator!=(const String &other) const { return s != other.s; }
+    bool operator!=(const char *str) const { return !(*this == str); }
+    bool equals(const String &other) const { return s == other.s; }
+
+    bool startsWith(const String &prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+    bool endsWith(const String &suffix) const {
+        return s.size() >= suffix.s.size() && s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+    }
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t pos = s.find(c, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    int indexOf(const String &str, unsigned int from = 0) const {
+        size_t pos = s.find(str.s, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    String substring(unsigned int from) const { return from < s.size() ? String(s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        return from < s.size() && to > from ? String(s.substr(from, to - from)) : String();
+    }
+    long toInt() const { return strtol(s.c_str(), NULL, 10); }
+    float toFloat() const { return strtof(s.c_str(), NULL); }
+    void trim() {
+        size_t begin = s.find_first_not_of(" \t\r\n");
+        size_t end = s.find_last_not_of(" \t\r\n");
+        s = begin == std::string::npos ? std::string() : s.substr(begin, end - begin + 1);
+    }
+    void toLowerCase() {
+        for (char &c : s) c = tolower((unsigned char)c);
+    }
+
+private:
+    std::string s;
+};
+
+inline String operator+(const String &a, const String &b) { String r = a; r += b; return r; }
+inline String operator+(const String &a, const char *b) { String r = a; r += b; return r; }
+inline String operator+(const char *a, const String &b) { String r = a; r += b; return r; }
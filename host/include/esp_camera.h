@@ -0,0 +1,136 @@
+// esp_camera.h - Host stand-in for the esp32-camera driver (native build)
+// Frames come from a directory of recorded JPEG frames (played in name order, looping) or,
+// without a directory, from a moving color bar test pattern. RGB565 frames are delivered in the
+// sensor's byte order (big-endian), JPEG frames as files. Frame rate and frame buffer
+// availability are paced like the driver: esp_camera_fb_get() blocks until the next frame
+// is due and a buffer is free.
+//
+// Key features:
+// - Same types and entry points as esp32-camera (config, frame buffers, sensor_t)
+// - sensor_t setters record their values in status; get_reg/set_reg use a register map
+// - HostCamera_SetSource() selects the recording and frame rate before esp_camera_init()
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stdint.h> // Fixed-width integer types
+#include <stddef.h> // size_t
+#include <sys/time.h> // struct timeval
+#include "esp_err.h" // esp_err_t
+
+typedef enum { PIXFORMAT_RGB565, PIXFORMAT_YUV422, PIXFORMAT_YUV420, PIXFORMAT_GRAYSCALE, PIXFORMAT_JPEG,
+               PIXFORMAT_RGB888, PIXFORMAT_RAW, PIXFORMAT_RGB444, PIXFORMAT_RGB555 } pixformat_t;
+
+typedef enum {
+    FRAMESIZE_96X96, FRAMESIZE_QQVGA, FRAMESIZE_QCIF, FRAMESIZE_HQVGA, FRAMESIZE_240X240, FRAMESIZE_QVGA,
+    FRAMESIZE_CIF, FRAMESIZE_HVGA, FRAMESIZE_VGA, FRAMESIZE_SVGA, FRAMESIZE_XGA, FRAMESIZE_HD, FRAMESIZE_SXGA,
+    FRAMESIZE_UXGA, FRAMESIZE_FHD, FRAMESIZE_P_HD, FRAMESIZE_P_3MP, FRAMESIZE_QXGA, FRAMESIZE_QHD,
+    FRAMESIZE_WQXGA, FRAMESIZE_P_FHD, FRAMESIZE_QSXGA, FRAMESIZE_INVALID
+} framesize_t;
+
+typedef enum { CAMERA_FB_IN_PSRAM, CAMERA_FB_IN_DRAM } camera_fb_location_t;
+typedef enum { CAMERA_GRAB_WHEN_EMPTY, CAMERA_GRAB_LATEST } camera_grab_mode_t;
+typedef enum { LEDC_TIMER_0, LEDC_TIMER_1, LEDC_TIMER_2, LEDC_TIMER_3 } ledc_timer_t;
+typedef enum { LEDC_CHANNEL_0, LEDC_CHANNEL_1, LEDC_CHANNEL_2, LEDC_CHANNEL_3 } ledc_channel_t;
+
+typedef struct {
+    int pin_pwdn, pin_reset, pin_xclk;
+    int pin_sccb_sda, pin_sccb_scl;
+    int pin_d7, pin_d6, pin_d5, pin_d4, pin_d3, pin_d2, pin_d1, pin_d0;
+    int pin_vsync, pin_href, pin_pclk;
+    int xclk_freq_hz;
+    ledc_timer_t ledc_timer;
+    ledc_channel_t ledc_channel;
+    pixformat_t pixel_format;
+    framesize_t frame_size;
+    int jpeg_quality;
+    size_t fb_count;
+    camera_fb_location_t fb_location;
+    camera_grab_mode_t grab_mode;
+    int sccb_i2c_port;
+} camera_config_t;
+
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    size_t width;
+    size_t height;
+    pixformat_t format;
+    struct timeval timestamp; // esp_timer time of the capture
+} camera_fb_t;
+
+#define OV2640_PID 0x26
+#define OV5640_PID 0x5640
+
+typedef struct {
+    uint8_t MIDH, MIDL;
+    uint16_t PID;
+    uint8_t VER;
+} sensor_id_t;
+
+typedef struct {
+    framesize_t framesize;
+    bool scale, binning;
+    uint8_t quality;
+    int8_t brightness, contrast, saturation, sharpness;
+    uint8_t denoise, special_effect, wb_mode, awb, awb_gain, aec, aec2;
+    int8_t ae_level;
+    uint16_t aec_value;
+    uint8_t agc, agc_gain, gainceiling, bpc, wpc, raw_gma, lenc, hmirror, vflip, dcw, colorbar;
+} camera_status_t;
+
+typedef struct _sensor sensor_t;
+struct _sensor {
+    sensor_id_t id;
+    uint8_t slv_addr;
+    pixformat_t pixformat;
+    camera_status_t status;
+    int xclk_freq_hz;
+    int (*init_status)(sensor_t *sensor);
+    int (*reset)(sensor_t *sensor);
+    int (*set_pixformat)(sensor_t *sensor, pixformat_t pixformat);
+    int (*set_framesize)(sensor_t *sensor, framesize_t framesize);
+    int (*set_contrast)(sensor_t *sensor, int level);
+    int (*set_brightness)(sensor_t *sensor, int level);
+    int (*set_saturation)(sensor_t *sensor, int level);
+    int (*set_sharpness)(sensor_t *sensor, int level);
+    int (*set_denoise)(sensor_t *sensor, int level);
+    int (*set_gainceiling)(sensor_t *sensor, int gainceiling);
+    int (*set_quality)(sensor_t *sensor, int quality);
+    int (*set_colorbar)(sensor_t *sensor, int enable);
+    int (*set_whitebal)(sensor_t *sensor, int enable);
+    int (*set_gain_ctrl)(sensor_t *sensor, int enable);
+    int (*set_exposure_ctrl)(sensor_t *sensor, int enable);
+    int (*set_hmirror)(sensor_t *sensor, int enable);
+    int (*set_vflip)(sensor_t *sensor, int enable);
+    int (*set_aec2)(sensor_t *sensor, int enable);
+    int (*set_awb_gain)(sensor_t *sensor, int enable);
+    int (*set_agc_gain)(sensor_t *sensor, int gain);
+    int (*set_aec_value)(sensor_t *sensor, int gain);
+    int (*set_special_effect)(sensor_t *sensor, int effect);
+    int (*set_wb_mode)(sensor_t *sensor, int mode);
+    int (*set_ae_level)(sensor_t *sensor, int level);
+    int (*set_dcw)(sensor_t *sensor, int enable);
+    int (*set_bpc)(sensor_t *sensor, int enable);
+    int (*set_wpc)(sensor_t *sensor, int enable);
+    int (*set_raw_gma)(sensor_t *sensor, int enable);
+    int (*set_lenc)(sensor_t *sensor, int enable);
+    int (*get_reg)(sensor_t *sensor, int reg, int mask);
+    int (*set_reg)(sensor_t *sensor, int reg, int mask, int value);
+};
+
+esp_err_t esp_camera_init(const camera_config_t *config);
+esp_err_t esp_camera_deinit();
+camera_fb_t *esp_camera_fb_get();
+void esp_camera_fb_return(camera_fb_t *fb);
+sensor_t *esp_camera_sensor_get();
+
+/**
+ * @brief Select the frame source of the camera stand-in (native build only).
+ * @param directory Directory of recorded JPEG frames (NULL = test pattern)
+ * @param fps Frame rate delivered by esp_camera_fb_get()
+ */
+void HostCamera_SetSource(const char *directory, int fps);
+
+/**
+ * @brief Get the number of frames delivered since start (native build only).
+ */
+uint32_t HostCamera_GetFrameCount();
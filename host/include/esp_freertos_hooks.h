@@ -0,0 +1,13 @@
+// esp_freertos_hooks.h - Host stand-in for the ESP-IDF FreeRTOS hook API (native build)
+// There is no tick interrupt on the host: tick hooks are accepted but never called, so the
+// tick-sampled core load reports unavailable (-1), like the idle run-time one.
+
+#pragma once // Prevent multiple inclusion of this header
+#include "esp_err.h"           // esp_err_t
+#include "freertos/FreeRTOS.h" // UBaseType_t
+
+typedef void (*esp_freertos_tick_cb_t)();
+
+static inline esp_err_t esp_register_freertos_tick_hook_for_cpu(esp_freertos_tick_cb_t callback, UBaseType_t cpu) {
+    return ESP_OK;
+}
@@ -0,0 +1,29 @@
+// esp_heap_caps.h - Host stand-in for the ESP-IDF capability-based heap (native build)
+// Every capability maps to the process heap. Free sizes report the device's nominal
+// internal RAM and PSRAM so the HUD and /metrics show plausible values.
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stddef.h> // size_t
+#include <stdint.h> // Fixed-width integer types
+#include <stdlib.h> // malloc, free
+
+#define MALLOC_CAP_EXEC (1 << 0)
+#define MALLOC_CAP_32BIT (1 << 1)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+// Nominal free sizes reported on the host
+#define HOST_HEAP_INTERNAL_FREE (256 * 1024)
+#define HOST_HEAP_SPIRAM_FREE (8 * 1024 * 1024)
+
+static inline void *heap_caps_malloc(size_t size, uint32_t caps) { return malloc(size); }
+static inline void *heap_caps_calloc(size_t n, size_t size, uint32_t caps) { return calloc(n, size); }
+static inline void *heap_caps_realloc(void *ptr, size_t size, uint32_t caps) { return realloc(ptr, size); }
+static inline void heap_caps_free(void *ptr) { free(ptr); }
+static inline size_t heap_caps_get_free_size(uint32_t caps) {
+    return (caps & MALLOC_CAP_SPIRAM) ? HOST_HEAP_SPIRAM_FREE : HOST_HEAP_INTERNAL_FREE;
+}
+static inline size_t heap_caps_get_largest_free_block(uint32_t caps) { return heap_caps_get_free_size(caps); }
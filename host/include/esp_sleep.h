@@ -0,0 +1,28 @@
+// esp_sleep.h - Host stand-in for the ESP-IDF sleep API (native build)
+// Light sleep blocks the calling thread for the armed timer; the other tasks keep running,
+// so the timelapse schedule and its timing reports work unchanged on the host.
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stdint.h> // Fixed-width integer types
+#include <unistd.h> // usleep
+#include "esp_err.h" // esp_err_t
+
+typedef enum {
+    ESP_SLEEP_WAKEUP_UNDEFINED,
+    ESP_SLEEP_WAKEUP_TIMER,
+    ESP_SLEEP_WAKEUP_GPIO,
+} esp_sleep_wakeup_cause_t;
+
+// Timer armed by esp_sleep_enable_timer_wakeup
+static uint64_t hostSleepTimerUs = 0;
+
+static inline esp_err_t esp_sleep_enable_timer_wakeup(uint64_t us) {
+    hostSleepTimerUs = us;
+    return ESP_OK;
+}
+static inline esp_err_t esp_sleep_enable_gpio_wakeup() { return ESP_OK; }
+static inline esp_err_t esp_light_sleep_start() {
+    usleep(hostSleepTimerUs);
+    return ESP_OK;
+}
+static inline esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() { return ESP_SLEEP_WAKEUP_TIMER; }
@@ -0,0 +1,9 @@
+// esp_timer.h - Host stand-in for the ESP-IDF high resolution timer (native build)
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stdint.h> // Fixed-width integer types
+
+/**
+ * @brief Get the time since program start in microseconds (monotonic).
+ */
+int64_t esp_timer_get_time();
@@ -0,0 +1,58 @@
+// FreeRTOS.h - Host stand-in for the FreeRTOS kernel API (native build)
+// This header declares the subset of the ESP-IDF FreeRTOS API used by the firmware,
+// implemented on POSIX threads in host/hostRtos.cpp.
+//
+// Key features:
+// - 1 ms tick, portMAX_DELAY waits forever
+// - Tasks are pthreads; priorities and cores are recorded but not enforced
+// - Run-time stats come from per-thread CPU clocks (microseconds, like esp_timer on the device)
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stdint.h> // Fixed-width integer types
+#include <stddef.h> // size_t
+
+#define configTICK_RATE_HZ 1000
+#define configUSE_TRACE_FACILITY 1
+#define configGENERATE_RUN_TIME_STATS 1
+#define configMAX_TASK_NAME_LEN 16
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define errQUEUE_FULL pdFALSE
+#define errQUEUE_EMPTY pdFALSE
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+// ISR helpers (there are no interrupts on the host; these behave like task-level calls)
+#define portYIELD_FROM_ISR(...) ((void)0)
+#define portENTER_CRITICAL(mux) HostRtos_EnterCritical()
+#define portEXIT_CRITICAL(mux) HostRtos_ExitCritical()
+#define portENTER_CRITICAL_ISR(mux) HostRtos_EnterCritical()
+#define portEXIT_CRITICAL_ISR(mux) HostRtos_ExitCritical()
+#define portMUX_INITIALIZER_UNLOCKED 0
+typedef int portMUX_TYPE;
+
+/**
+ * @brief Enter the (single, global) host critical section. Nests like a recursive mutex.
+ */
+void HostRtos_EnterCritical();
+
+/**
+ * @brief Leave the host critical section.
+ */
+void HostRtos_ExitCritical();
+
+/**
+ * @brief Get the core the calling task is pinned to (the main thread reports core 1, like loop()).
+ */
+BaseType_t xPortGetCoreID();
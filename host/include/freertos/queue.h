@@ -0,0 +1,29 @@
+// queue.h - Host stand-in for the FreeRTOS queue and queue set API (native build)
+// Queues copy fixed-size items like the kernel does. A queue that belongs to a set posts its
+// handle to the set for every item it receives, so xQueueSelectFromSet() behaves as on the device.
+
+#pragma once // Prevent multiple inclusion of this header
+#include "FreeRTOS.h" // Base types
+
+typedef struct QueueDefinition *QueueHandle_t;
+typedef QueueHandle_t QueueSetHandle_t;
+typedef QueueHandle_t QueueSetMemberHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks);
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void *item, TickType_t ticks);
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t ticks);
+BaseType_t xQueueReset(QueueHandle_t queue);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue);
+
+#define xQueueSendToBack xQueueSend
+#define xQueueSendFromISR(queue, item, woken) xQueueSend((queue), (item), 0)
+#define xQueueReceiveFromISR(queue, item, woken) xQueueReceive((queue), (item), 0)
+
+QueueSetHandle_t xQueueCreateSet(UBaseType_t length);
+BaseType_t xQueueAddToSet(QueueSetMemberHandle_t member, QueueSetHandle_t set);
+QueueSetMemberHandle_t xQueueSelectFromSet(QueueSetHandle_t set, TickType_t ticks);
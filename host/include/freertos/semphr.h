@@ -0,0 +1,17 @@
+// semphr.h - Host stand-in for the FreeRTOS semaphore API (native build)
+// Semaphores are zero-size queues, exactly as in the kernel. Mutexes have no priority inheritance.
+
+#pragma once // Prevent multiple inclusion of this header
+#include "queue.h" // Semaphores are queues
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount);
+
+#define xSemaphoreCreateBinary() xSemaphoreCreateCounting(1, 0)
+#define xSemaphoreCreateMutex() xSemaphoreCreateCounting(1, 1)
+#define xSemaphoreTake(sem, ticks) xQueueReceive((sem), NULL, (ticks))
+#define xSemaphoreGive(sem) xQueueSend((sem), NULL, 0)
+#define xSemaphoreGiveFromISR(sem, woken) xQueueSend((sem), NULL, 0)
+#define uxSemaphoreGetCount(sem) uxQueueMessagesWaiting(sem)
+#define vSemaphoreDelete(sem) vQueueDelete(sem)
@@ -0,0 +1,41 @@
+// task.h - Host stand-in for the FreeRTOS task API (native build)
+// Tasks run as pthreads. vTaskDelete() of another task marks it for deletion and waits until it
+// has left the kernel call it is blocked in (or its next one), so the deleted task never touches
+// resources its deleter frees afterwards.
+
+#pragma once // Prevent multiple inclusion of this header
+#include "FreeRTOS.h" // Base types
+
+typedef struct HostTask *TaskHandle_t;
+
+// Task states reported by uxTaskGetSystemState
+typedef enum { eRunning, eReady, eBlocked, eSuspended, eDeleted, eInvalid } eTaskState;
+
+// Task status record (ESP-IDF layout subset)
+typedef struct {
+    TaskHandle_t xHandle;
+    const char *pcTaskName;
+    UBaseType_t xTaskNumber;
+    eTaskState eCurrentState;
+    UBaseType_t uxCurrentPriority;
+    UBaseType_t uxBasePriority;
+    uint32_t ulRunTimeCounter;    // Thread CPU time (microseconds)
+    uint32_t usStackHighWaterMark; // Not measured on the host: reports the configured depth
+    BaseType_t xCoreID;
+} TaskStatus_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackDepth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stackDepth, void *param,
+                       UBaseType_t priority, TaskHandle_t *handle);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+char *pcTaskGetName(TaskHandle_t task);
+UBaseType_t uxTaskGetNumberOfTasks();
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *status, UBaseType_t maxCount, uint32_t *totalRunTime);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+TaskHandle_t xTaskGetIdleTaskHandleForCPU(UBaseType_t cpu);
+
+#define taskYIELD() vTaskDelay(0)
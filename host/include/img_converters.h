@@ -0,0 +1,23 @@
+// img_converters.h - Host stand-in for the esp32-camera image converters (native build)
+// Only the RGB565 -> JPEG path used by the firmware is provided (libjpeg, see hostJpeg.cpp).
+
+#pragma once // Prevent multiple inclusion of this header
+#include "esp_camera.h" // pixformat_t, camera_fb_t
+
+/**
+ * @brief Encode an image as JPEG.
+ * @param src Pixels (RGB565 in sensor byte order; other formats are rejected)
+ * @param quality JPEG quality (0-100)
+ * @param out Receives a malloc'ed JPEG buffer (release with free())
+ * @param out_len Receives the JPEG size
+ * @return true on success
+ */
+bool fmt2jpg(uint8_t *src, size_t src_len, uint16_t width, uint16_t height, pixformat_t format, uint8_t quality,
+             uint8_t **out, size_t *out_len);
+
+/**
+ * @brief Encode a camera frame buffer as JPEG (see fmt2jpg()).
+ */
+static inline bool frame2jpg(camera_fb_t *fb, uint8_t quality, uint8_t **out, size_t *out_len) {
+    return fmt2jpg(fb->buf, fb->len, fb->width, fb->height, fb->format, quality, out, out_len);
+}
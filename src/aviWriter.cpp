@@ -0,0 +1,266 @@
+// aviWriter.cpp - MJPEG AVI (RIFF) container writer implementation
+// File layout: RIFF 'AVI ' { LIST 'hdrl' { avih, LIST 'strl' { strh, strf } }, JUNK (pads the
+// header to AVI_HEADER_SIZE), LIST 'movi' { '00dc' frame chunks }, idx1, [JUNK tail] }.
+// Everything up to the 'movi' fourcc is written as zeros first and rebuilt on close, when
+// the frame count, sizes and measured frame interval are known.
+//
+// Key features:
+// - Frame chunks (header, JPEG, pad byte) packed into one PSRAM buffer, written in AVI_WRITE_CHUNK blocks
+// - idx1 written straight from PSRAM in one call
+// - The preallocated tail is covered by a JUNK chunk, so no truncation is needed
+
+#include "aviWriter.h" // Include header for this module
+#include <esp_heap_caps.h> // PSRAM allocation
+#include <esp_timer.h> // Microsecond clock
+#include "metrics.h" // Write time histogram
+
+// Little-endian fourcc
+#define AVI_FOURCC(a, b, c, d) ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+// Chunk id of the video frames of stream 0
+#define AVI_CHUNK_VIDEO AVI_FOURCC('0', '0', 'd', 'c')
+// avih flag: the file has an idx1 index
+#define AVIF_HASINDEX 0x10
+// idx1 flag: the chunk is a key frame
+#define AVIIF_KEYFRAME 0x10
+// Header offsets (see the layout above)
+#define AVI_HDRL_SIZE 192      // LIST 'hdrl' payload
+#define AVI_STRL_SIZE 116      // LIST 'strl' payload
+#define AVI_JUNK_OFFSET 212    // JUNK chunk padding the header
+#define AVI_MOVI_OFFSET 500    // LIST 'movi' chunk
+// Bytes of an idx1 entry
+#define AVI_INDEX_ENTRY_SIZE 16
+
+/**
+ * @brief Store a 32-bit little-endian value.
+ * @param out Destination
+ * @param value Value
+ * @return Pointer past the value
+ */
+static uint8_t *AviWriter_Put32(uint8_t *out, uint32_t value) {
+    out[0] = value;
+    out[1] = value >> 8;
+    out[2] = value >> 16;
+    out[3] = value >> 24;
+    return out + 4;
+}
+
+/**
+ * @brief Store a 16-bit little-endian value.
+ * @param out Destination
+ * @param value Value
+ * @return Pointer past the value
+ */
+static uint8_t *AviWriter_Put16(uint8_t *out, uint16_t value) {
+    out[0] = value;
+    out[1] = value >> 8;
+    return out + 2;
+}
+
+/**
+ * @brief Build the AVI_HEADER_SIZE header for the current writer state.
+ * @param writer Writer
+ * @param usPerFrame Frame interval
+ * @param riffSize RIFF chunk payload size (file size - 8)
+ * @param out Destination (AVI_HEADER_SIZE bytes)
+ */
+static void AviWriter_BuildHeader(const AviWriter &writer, uint32_t usPerFrame, uint32_t riffSize, uint8_t *out) {
+    memset(out, 0, AVI_HEADER_SIZE);
+    uint32_t suggested = writer.maxFrameBytes + 8;
+    uint8_t *p = out;
+    p = AviWriter_Put32(p, AVI_FOURCC('R', 'I', 'F', 'F'));
+    p = AviWriter_Put32(p, riffSize);
+    p = AviWriter_Put32(p, AVI_FOURCC('A', 'V', 'I', ' '));
+    p = AviWriter_Put32(p, AVI_FOURCC('L', 'I', 'S', 'T'));
+    p = AviWriter_Put32(p, AVI_HDRL_SIZE);
+    p = AviWriter_Put32(p, AVI_FOURCC('h', 'd', 'r', 'l'));
+    // Main header
+    p = AviWriter_Put32(p, AVI_FOURCC('a', 'v', 'i', 'h'));
+    p = AviWriter_Put32(p, 56);
+    p = AviWriter_Put32(p, usPerFrame);                                                        // dwMicroSecPerFrame
+    p = AviWriter_Put32(p, usPerFrame ? (uint32_t)((uint64_t)suggested * 1000000 / usPerFrame) : 0); // dwMaxBytesPerSec
+    p = AviWriter_Put32(p, 0);                                                                 // dwPaddingGranularity
+    p = AviWriter_Put32(p, AVIF_HASINDEX);                                                     // dwFlags
+    p = AviWriter_Put32(p, writer.frameCount);                                                 // dwTotalFrames
+    p = AviWriter_Put32(p, 0);                                                                 // dwInitialFrames
+    p = AviWriter_Put32(p, 1);                                                                 // dwStreams
+    p = AviWriter_Put32(p, suggested);                                                         // dwSuggestedBufferSize
+    p = AviWriter_Put32(p, writer.width);                                                      // dwWidth
+    p = AviWriter_Put32(p, writer.height);                                                     // dwHeight
+    p += 16;                                                                                   // dwReserved[4]
+    // Stream list: header and format of the MJPEG stream
+    p = AviWriter_Put32(p, AVI_FOURCC('L', 'I', 'S', 'T'));
+    p = AviWriter_Put32(p, AVI_STRL_SIZE);
+    p = AviWriter_Put32(p, AVI_FOURCC('s', 't', 'r', 'l'));
+    p = AviWriter_Put32(p, AVI_FOURCC('s', 't', 'r', 'h'));
+    p = AviWriter_Put32(p, 56);
+    p = AviWriter_Put32(p, AVI_FOURCC('v', 'i', 'd', 's')); // fccType
+    p = AviWriter_Put32(p, AVI_FOURCC('M', 'J', 'P', 'G')); // fccHandler
+    p += 4 + 2 + 2 + 4;                                      // dwFlags, wPriority, wLanguage, dwInitialFrames
+    p = AviWriter_Put32(p, usPerFrame);                      // dwScale (rate / scale = frames per second)
+    p = AviWriter_Put32(p, 1000000);                         // dwRate
+    p = AviWriter_Put32(p, 0);                               // dwStart
+    p = AviWriter_Put32(p, writer.frameCount);               // dwLength
+    p = AviWriter_Put32(p, suggested);                       // dwSuggestedBufferSize
+    p = AviWriter_Put32(p, 0xFFFFFFFF);                      // dwQuality (default)
+    p = AviWriter_Put32(p, 0);                               // dwSampleSize
+    p += 4;                                                  // rcFrame left, top
+    p = AviWriter_Put16(p, writer.width);                    // rcFrame right
+    p = AviWriter_Put16(p, writer.height);                   // rcFrame bottom
+    p = AviWriter_Put32(p, AVI_FOURCC('s', 't', 'r', 'f'));
+    p = AviWriter_Put32(p, 40);
+    p = AviWriter_Put32(p, 40);                              // biSize
+    p = AviWriter_Put32(p, writer.width);                    // biWidth
+    p = AviWriter_Put32(p, writer.height);                   // biHeight
+    p = AviWriter_Put16(p, 1);                               // biPlanes
+    p = AviWriter_Put16(p, 24);                              // biBitCount
+    p = AviWriter_Put32(p, AVI_FOURCC('M', 'J', 'P', 'G'));  // biCompression
+    p = AviWriter_Put32(p, (uint32_t)writer.width * writer.height * 3); // biSizeImage
+    p += 16;                                                 // Resolution and palette (unused)
+    // Padding up to the movi list, then the movi list header
+    p = AviWriter_Put32(p, AVI_FOURCC('J', 'U', 'N', 'K'));
+    p = AviWriter_Put32(p, AVI_MOVI_OFFSET - AVI_JUNK_OFFSET - 8);
+    p = out + AVI_MOVI_OFFSET;
+    p = AviWriter_Put32(p, AVI_FOURCC('L', 'I', 'S', 'T'));
+    p = AviWriter_Put32(p, 4 + writer.moviBytes);
+    AviWriter_Put32(p, AVI_FOURCC('m', 'o', 'v', 'i'));
+}
+
+/**
+ * @brief Write the full write buffer to the card as one block.
+ * @param writer Open writer
+ */
+static void AviWriter_FlushChunk(AviWriter &writer) {
+    int64_t start = esp_timer_get_time();
+    if (writer.file.write(writer.buffer, AVI_WRITE_CHUNK) != AVI_WRITE_CHUNK) writer.failed = true;
+    Metrics_Observe(METRIC_HIST_VIDEO_WRITE, esp_timer_get_time() - start);
+    writer.bufferUsed = 0;
+}
+
+/**
+ * @brief Append bytes to the write buffer, writing every block that fills up.
+ * @param writer Open writer
+ * @param data Bytes to append
+ * @param length Number of bytes
+ */
+static void AviWriter_Append(AviWriter &writer, const uint8_t *data, size_t length) {
+    while (length > 0 && !writer.failed) {
+        size_t room = AVI_WRITE_CHUNK - writer.bufferUsed;
+        size_t part = length < room ? length : room;
+        memcpy(writer.buffer + writer.bufferUsed, data, part);
+        writer.bufferUsed += part;
+        data += part;
+        length -= part;
+        if (writer.bufferUsed == AVI_WRITE_CHUNK) AviWriter_FlushChunk(writer);
+    }
+}
+
+/**
+ * @brief Start an AVI file: allocate the buffers, preallocate the file and reserve the header.
+ * Preallocation extends the file to preallocBytes with a seek past the end, so the file
+ * system links the clusters once here instead of on every write while recording.
+ * @param writer Writer to initialize
+ * @param file File opened for writing (owned by the writer until AviWriter_Close)
+ * @param maxFrames idx1 capacity
+ * @param preallocBytes Bytes to reserve on the card up front (0 = grow as needed)
+ * @return true on success (the file is left open either way; call AviWriter_Close to release it and the buffers)
+ */
+bool AviWriter_Open(AviWriter &writer, File file, uint32_t maxFrames, uint32_t preallocBytes) {
+    writer = AviWriter();
+    writer.file = file;
+    writer.maxFrames = maxFrames;
+    writer.buffer = (uint8_t *)heap_caps_malloc(AVI_WRITE_CHUNK, MALLOC_CAP_SPIRAM);
+    writer.index = (AviIndexEntry *)heap_caps_malloc(maxFrames * sizeof(AviIndexEntry), MALLOC_CAP_SPIRAM);
+    if (!writer.buffer || !writer.index) {
+        Serial.println("[AviWriter] Out of PSRAM!");
+        writer.failed = true;
+        return false;
+    }
+    if (preallocBytes > AVI_HEADER_SIZE) {
+        bool extended = file.seek(preallocBytes - 1) && file.write((uint8_t)0) == 1 && file.seek(0);
+        if (!extended) {
+            Serial.println("[AviWriter] Preallocation failed!");
+            writer.failed = true;
+            return false;
+        }
+    }
+    memset(writer.buffer, 0, AVI_HEADER_SIZE); // Placeholder header, rebuilt on close
+    writer.bufferUsed = AVI_HEADER_SIZE;
+    return true;
+}
+
+/**
+ * @brief Append one JPEG frame.
+ * @param writer Open writer
+ * @param jpeg JPEG data
+ * @param length JPEG size in bytes
+ * @param width Frame width
+ * @param height Frame height
+ * @return false if the index is full or a card write failed (the frame is not added)
+ */
+bool AviWriter_AddFrame(AviWriter &writer, const uint8_t *jpeg, size_t length, uint16_t width, uint16_t height) {
+    if (writer.failed || writer.frameCount >= writer.maxFrames) return false;
+    if (writer.frameCount == 0) {
+        writer.width = width;
+        writer.height = height;
+    }
+    uint8_t chunkHeader[8];
+    AviWriter_Put32(AviWriter_Put32(chunkHeader, AVI_CHUNK_VIDEO), length);
+    AviIndexEntry &entry = writer.index[writer.frameCount];
+    entry.chunkId = AVI_CHUNK_VIDEO;
+    entry.flags = AVIIF_KEYFRAME;
+    entry.offset = 4 + writer.moviBytes; // From the 'movi' fourcc
+    entry.size = length;
+    AviWriter_Append(writer, chunkHeader, sizeof(chunkHeader));
+    AviWriter_Append(writer, jpeg, length);
+    static const uint8_t pad = 0;
+    if (length & 1) AviWriter_Append(writer, &pad, 1); // Chunks start on even offsets
+    if (writer.failed) return false;
+    writer.moviBytes += sizeof(chunkHeader) + ((length + 1) & ~1);
+    if (length > writer.maxFrameBytes) writer.maxFrameBytes = length;
+    writer.frameCount++;
+    return true;
+}
+
+/**
+ * @brief Finish the file: flush the buffer, write idx1 and the final header, close the file and free the buffers.
+ * A preallocated file that was not filled keeps its size; the unused tail becomes a JUNK chunk.
+ * @param writer Open writer
+ * @param usPerFrame Measured frame interval (sets the playback rate)
+ * @return true if the file is complete
+ */
+bool AviWriter_Close(AviWriter &writer, uint32_t usPerFrame) {
+    bool complete = !writer.failed;
+    if (complete && writer.bufferUsed > 0) { // Last partial block
+        complete = writer.file.write(writer.buffer, writer.bufferUsed) == writer.bufferUsed;
+        writer.bufferUsed = 0;
+    }
+    uint32_t end = AVI_HEADER_SIZE + writer.moviBytes;
+    if (complete) {
+        uint8_t chunkHeader[8];
+        uint32_t indexBytes = writer.frameCount * AVI_INDEX_ENTRY_SIZE;
+        AviWriter_Put32(AviWriter_Put32(chunkHeader, AVI_FOURCC('i', 'd', 'x', '1')), indexBytes);
+        complete = writer.file.write(chunkHeader, sizeof(chunkHeader)) == sizeof(chunkHeader) &&
+                   writer.file.write((const uint8_t *)writer.index, indexBytes) == indexBytes;
+        end += sizeof(chunkHeader) + indexBytes;
+    }
+    if (complete) {
+        uint32_t fileSize = writer.file.size();
+        if (fileSize > end) { // Preallocated space left: cover it with a JUNK chunk
+            uint32_t junk = fileSize - end >= 8 ? fileSize - end - 8 : 0;
+            uint8_t chunkHeader[8];
+            AviWriter_Put32(AviWriter_Put32(chunkHeader, AVI_FOURCC('J', 'U', 'N', 'K')), junk);
+            complete = writer.file.write(chunkHeader, sizeof(chunkHeader)) == sizeof(chunkHeader);
+            end += 8 + junk;
+        }
+    }
+    if (complete) {
+        AviWriter_BuildHeader(writer, usPerFrame, end - 8, writer.buffer);
+        complete = writer.file.seek(0) && writer.file.write(writer.buffer, AVI_HEADER_SIZE) == AVI_HEADER_SIZE;
+    }
+    writer.file.close();
+    heap_caps_free(writer.buffer);
+    heap_caps_free(writer.index);
+    writer.buffer = NULL;
+    writer.index = NULL;
+    return complete;
+}
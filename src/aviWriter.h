@@ -0,0 +1,71 @@
+// aviWriter.h - MJPEG AVI (RIFF) container writer
+// This header declares a small writer for single-stream MJPEG AVI files on the SD card.
+// Frames are packed into a PSRAM write buffer and reach the card only as whole
+// AVI_WRITE_CHUNK blocks at sector-aligned offsets; the idx1 index is kept in PSRAM and
+// written when the file is closed, followed by the final header.
+//
+// Key features:
+// - Fixed AVI_HEADER_SIZE header (hdrl + JUNK + movi list), rewritten with the real values on close
+// - Optional preallocation: the file is extended up front and the unused tail becomes a JUNK chunk
+// - No seeks while recording, one write per AVI_WRITE_CHUNK bytes
+// - idx1 capacity fixed at open, so a full index stops the recording cleanly
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h> // Arduino core library
+#include <FS.h> // File
+
+// Bytes before the first frame chunk (a multiple of the SD sector size)
+#define AVI_HEADER_SIZE 512
+// Size of each write to the card (a multiple of the SD sector size)
+#define AVI_WRITE_CHUNK (32 * 1024)
+
+// One idx1 entry
+struct AviIndexEntry {
+    uint32_t chunkId; // '00dc'
+    uint32_t flags;   // AVIIF_KEYFRAME (every MJPEG frame is a key frame)
+    uint32_t offset;  // Chunk offset from the 'movi' fourcc
+    uint32_t size;    // Frame size without the chunk header
+};
+
+// Writer state (one open file)
+struct AviWriter {
+    File file;               // Destination file
+    uint8_t *buffer;         // PSRAM write buffer (AVI_WRITE_CHUNK bytes)
+    size_t bufferUsed;       // Bytes waiting in the buffer
+    AviIndexEntry *index;    // PSRAM idx1 entries
+    uint32_t maxFrames;      // idx1 capacity
+    uint32_t frameCount;     // Frames added
+    uint32_t moviBytes;      // Frame chunk bytes after the 'movi' fourcc
+    uint32_t maxFrameBytes;  // Largest frame (suggested buffer size)
+    uint16_t width, height;  // Frame size (from the first frame)
+    bool failed;             // A card write failed (file is unusable)
+};
+
+/**
+ * @brief Start an AVI file: allocate the buffers, preallocate the file and reserve the header.
+ * @param writer Writer to initialize
+ * @param file File opened for writing (owned by the writer until AviWriter_Close)
+ * @param maxFrames idx1 capacity
+ * @param preallocBytes Bytes to reserve on the card up front (0 = grow as needed)
+ * @return true on success (the file is left open either way; call AviWriter_Close to release it and the buffers)
+ */
+bool AviWriter_Open(AviWriter &writer, File file, uint32_t maxFrames, uint32_t preallocBytes);
+
+/**
+ * @brief Append one JPEG frame.
+ * @param writer Open writer
+ * @param jpeg JPEG data
+ * @param length JPEG size in bytes
+ * @param width Frame width
+ * @param height Frame height
+ * @return false if the index is full or a card write failed (the frame is not added)
+ */
+bool AviWriter_AddFrame(AviWriter &writer, const uint8_t *jpeg, size_t length, uint16_t width, uint16_t height);
+
+/**
+ * @brief Finish the file: flush the buffer, write idx1 and the final header, close the file and free the buffers.
+ * @param writer Open writer
+ * @param usPerFrame Measured frame interval (sets the playback rate)
+ * @return true if the file is complete
+ */
+bool AviWriter_Close(AviWriter &writer, uint32_t usPerFrame);
@@ -0,0 +1,310 @@
+// bench.cpp - Pixel kernel benchmark suite implementation
+// This module generates the fixed test inputs, times each case and prints the results.
+// Each case is warmed up once, the number of calls per sample is doubled until a sample
+// lasts BENCH_SAMPLE_MIN_US, and the median of BENCH_SAMPLES samples is reported.
+//
+// Key features:
+// - Test frame from a seeded generator (gradients plus noise), identical on every run and target
+// - Frame buffers in PSRAM, like camera frame buffers, so memory effects are included
+// - Other tasks keep running on the device; the median keeps preemption out of the result
+
+#include "bench.h"          // Include header for this module
+#include <TJpg_Decoder.h>   // JPEG decoder
+#include <img_converters.h> // fmt2jpg (generated photo)
+#include "displayTask.h"    // DrawGrid3x3, tftDisplay, decoder mutex
+#include "pixelKernels.h"   // Kernels under test
+#include "motionDetector.h" // Motion detector per-frame cost
+#include "frameStats.h"     // Frame statistics per-frame cost
+
+// Buffers shared by the cases (allocated for one Bench_Run call)
+static uint16_t *benchFrame = NULL;    // BENCH_WIDTH x BENCH_HEIGHT test frame (panel byte order)
+static uint16_t *benchScratch = NULL;  // Kernel output, same size
+static uint16_t *benchDecoded = NULL;  // JPEG decode target, BENCH_JPEG_WIDTH x BENCH_JPEG_HEIGHT
+static uint8_t *benchPlane = NULL;     // Two luma planes of the test frame size
+static uint8_t *benchJpeg = NULL;      // Generated photo
+static size_t benchJpegLen = 0;
+static uint32_t benchHistogram[PIXEL_HISTOGRAM_BINS];
+static MotionDetector *benchMotion = NULL; // Detector state for the motion case
+static FrameStats *benchStats = NULL;      // Statistics state for the frame statistics case
+static int benchDecodedWidth = 0;      // Size of the current decode output
+static int benchDecodedHeight = 0;
+// Sprite for the sprite copy case (same parent as the preview sprite)
+static TFT_eSprite benchSprite = TFT_eSprite(&tftDisplay);
+
+// One benchmark case: fn(param) processes `pixels` pixels per call
+struct BenchCase {
+    const char *name;
+    void (*fn)(int param);
+    int param;
+    uint32_t pixels;
+    bool usesDecoder; // Needs jpegDecoderMutex
+};
+
+/**
+ * @brief Fill an image with the fixed test scene (color gradients, checkerboard and seeded noise).
+ * @param pixels Destination (RGB565, panel byte order)
+ * @param width Image width
+ * @param height Image height
+ */
+void Bench_FillScene(uint16_t *pixels, int width, int height) {
+    uint32_t seed = 0x2545F491; // Fixed seed: the scene must not change between runs
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            seed = seed * 1664525 + 1013904223; // LCG (Numerical Recipes)
+            int noise = (int)(seed >> 29) - 4;  // -4..3
+            int r = constrain(x * 31 / (width - 1) + noise / 2, 0, 31);
+            int g = constrain(y * 63 / (height - 1) + noise, 0, 63);
+            int b = constrain(((x / 16 + y / 16) & 1) ? 24 + noise / 2 : 6 + noise / 2, 0, 31); // Checkerboard
+            uint16_t value = (uint16_t)((r << 11) | (g << 5) | b);
+            pixels[y * width + x] = (uint16_t)((value >> 8) | (value << 8));
+        }
+    }
+}
+
+/**
+ * @brief JPEG decoder output callback for the decode cases. Copies each block into benchDecoded.
+ * @return true to continue decoding
+ */
+static bool Bench_JpegOutput(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t *data) {
+    for (int row = 0; row < h; row++) {
+        int dy = y + row;
+        if (dy >= benchDecodedHeight) break; // Clip partial MCU at the bottom
+        int cols = min((int)w, benchDecodedWidth - x); // Clip partial MCU at the right
+        if (cols > 0) memcpy(&benchDecoded[dy * benchDecodedWidth + x], &data[row * w], cols * sizeof(uint16_t));
+    }
+    return true;
+}
+
+static void Bench_Grid(int param) {
+    DisplayTask_DrawGrid3x3(benchScratch, BENCH_WIDTH, BENCH_HEIGHT, TFT_WHITE);
+}
+
+static void Bench_SpriteCopy(int param) {
+    benchSprite.pushImage(0, 0, BENCH_WIDTH, BENCH_HEIGHT, benchFrame); // As DisplayTask_ShowCamera does
+}
+
+static void Bench_JpegDecode(int scale) {
+    benchDecodedWidth = (BENCH_JPEG_WIDTH + scale - 1) / scale;
+    benchDecodedHeight = (BENCH_JPEG_HEIGHT + scale - 1) / scale;
+    TJpgDec.setJpgScale(scale);
+    TJpgDec.drawJpg(0, 0, benchJpeg, benchJpegLen);
+}
+
+// Kernel cases: param 0 runs the fast kernel, 1 its scalar reference
+static void Bench_SwapBytes(int ref) {
+    (ref ? PixelKernels_SwapBytesScalar : PixelKernels_SwapBytes)(benchFrame, benchScratch, BENCH_WIDTH * BENCH_HEIGHT);
+}
+
+static void Bench_Fill(int ref) {
+    (ref ? PixelKernels_FillScalar : PixelKernels_Fill)(benchScratch, BENCH_WIDTH * BENCH_HEIGHT, TFT_BLACK);
+}
+
+static void Bench_Blend(int ref) {
+    (ref ? PixelKernels_BlendScalar : PixelKernels_Blend)(benchFrame, benchScratch, benchScratch, BENCH_WIDTH * BENCH_HEIGHT, 12);
+}
+
+static void Bench_Downscale2x(int ref) {
+    (ref ? PixelKernels_Downscale2xScalar : PixelKernels_Downscale2x)(benchFrame, BENCH_WIDTH, BENCH_HEIGHT, benchScratch);
+}
+
+static void Bench_Downscale4x(int ref) {
+    (ref ? PixelKernels_Downscale4xScalar : PixelKernels_Downscale4x)(benchFrame, BENCH_WIDTH, BENCH_HEIGHT, benchScratch);
+}
+
+static void Bench_Luma(int ref) {
+    (ref ? PixelKernels_LumaScalar : PixelKernels_Luma)(benchFrame, benchPlane, BENCH_WIDTH * BENCH_HEIGHT);
+}
+
+static void Bench_Histogram(int ref) {
+    (ref ? PixelKernels_LumaHistogramScalar : PixelKernels_LumaHistogram)(benchFrame, BENCH_WIDTH * BENCH_HEIGHT,
+                                                                        benchHistogram);
+}
+
+static void Bench_AbsDiff(int ref) {
+    const uint8_t *previous = (const uint8_t *)benchScratch; // Any other plane of the same size
+    (ref ? PixelKernels_AbsDiffScalar : PixelKernels_AbsDiff)(benchPlane, previous, benchPlane + BENCH_WIDTH * BENCH_HEIGHT,
+                                                             BENCH_WIDTH * BENCH_HEIGHT);
+}
+
+// Overlay cases mark benchScratch from the frame statistics grid of benchFrame, like the preview marks the sprite
+static void Bench_FocusPeaking(int ref) {
+    (ref ? PixelKernels_FocusPeakingScalar : PixelKernels_FocusPeaking)(benchStats->luma, benchStats->cols, benchStats->rows,
+                                                                      benchScratch, BENCH_WIDTH, FRAME_STATS_STEP,
+                                                                      DISPLAY_PEAKING_THRESHOLD, DISPLAY_PEAKING_COLOR);
+}
+
+static void Bench_Zebra(int ref) {
+    (ref ? PixelKernels_ZebraScalar : PixelKernels_Zebra)(benchStats->luma, benchStats->cols, benchStats->rows, benchScratch,
+                                                        BENCH_WIDTH, FRAME_STATS_STEP, DISPLAY_ZEBRA_LUMA, 0,
+                                                        DISPLAY_ZEBRA_COLOR);
+}
+
+static void Bench_Motion(int param) {
+    MotionEvent event;
+    MotionDetector_Process(*benchMotion, benchFrame, BENCH_WIDTH, BENCH_HEIGHT, 0, event); // Static scene: no events
+}
+
+static void Bench_FrameStats(int param) {
+    FrameStats_Process(*benchStats, benchFrame, BENCH_WIDTH, BENCH_HEIGHT);
+}
+
+// Benchmark cases; pixels are input pixels, except for JPEG decode (decoded output pixels).
+// "_ref" cases time the scalar reference of the kernel above them: the ratio is the kernel's speedup.
+static const BenchCase benchCases[] = {
+    {"grid3x3", Bench_Grid, 0, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"swap_bytes", Bench_SwapBytes, 0, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"swap_bytes_ref", Bench_SwapBytes, 1, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"fill", Bench_Fill, 0, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"fill_ref", Bench_Fill, 1, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"blend", Bench_Blend, 0, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"blend_ref", Bench_Blend, 1, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"sprite_copy", Bench_SpriteCopy, 0, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"jpeg_decode_1", Bench_JpegDecode, 1, BENCH_JPEG_WIDTH * BENCH_JPEG_HEIGHT, true},
+    {"jpeg_decode_2", Bench_JpegDecode, 2, BENCH_JPEG_WIDTH * BENCH_JPEG_HEIGHT / 4, true},
+    {"jpeg_decode_4", Bench_JpegDecode, 4, BENCH_JPEG_WIDTH * BENCH_JPEG_HEIGHT / 16, true},
+    {"jpeg_decode_8", Bench_JpegDecode, 8, BENCH_JPEG_WIDTH * BENCH_JPEG_HEIGHT / 64, true},
+    {"downscale_2x", Bench_Downscale2x, 0, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"downscale_2x_ref", Bench_Downscale2x, 1, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"downscale_4x", Bench_Downscale4x, 0, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"downscale_4x_ref", Bench_Downscale4x, 1, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"luma", Bench_Luma, 0, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"luma_ref", Bench_Luma, 1, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"histogram", Bench_Histogram, 0, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"histogram_ref", Bench_Histogram, 1, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"absdiff", Bench_AbsDiff, 0, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"absdiff_ref", Bench_AbsDiff, 1, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"focus_peaking", Bench_FocusPeaking, 0, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"focus_peaking_ref", Bench_FocusPeaking, 1, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"zebra", Bench_Zebra, 0, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"zebra_ref", Bench_Zebra, 1, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"motion_detect", Bench_Motion, 0, BENCH_WIDTH * BENCH_HEIGHT, false},
+    {"frame_stats", Bench_FrameStats, 0, BENCH_WIDTH * BENCH_HEIGHT, false},
+};
+
+/**
+ * @brief Time one case.
+ * @param benchCase Case to run
+ * @param result Receives the timing
+ */
+static void Bench_Measure(const BenchCase &benchCase, BenchResult &result) {
+    benchCase.fn(benchCase.param); // Warm up caches and lazy allocations
+    uint32_t calls = 1;
+    while (calls < (1u << 20)) { // Calibrate the calls per sample
+        int64_t start = esp_timer_get_time();
+        for (uint32_t i = 0; i < calls; i++) benchCase.fn(benchCase.param);
+        if (esp_timer_get_time() - start >= BENCH_SAMPLE_MIN_US) break;
+        calls *= 2;
+    }
+    float samples[BENCH_SAMPLES];
+    for (int s = 0; s < BENCH_SAMPLES; s++) {
+        int64_t start = esp_timer_get_time();
+        for (uint32_t i = 0; i < calls; i++) benchCase.fn(benchCase.param);
+        samples[s] = (float)(esp_timer_get_time() - start) * 1000.0f / calls;
+    }
+    for (int i = 1; i < BENCH_SAMPLES; i++) { // Insertion sort (7 values)
+        for (int j = i; j > 0 && samples[j] < samples[j - 1]; j--) {
+            float t = samples[j];
+            samples[j] = samples[j - 1];
+            samples[j - 1] = t;
+        }
+    }
+    result.name = benchCase.name;
+    result.pixels = benchCase.pixels;
+    result.calls = calls;
+    result.nsPerCall = samples[BENCH_SAMPLES / 2];
+    result.bestNsPerCall = samples[0];
+    result.pixelsPerNs = result.nsPerCall > 0 ? benchCase.pixels / result.nsPerCall : 0;
+}
+
+/**
+ * @brief Release the benchmark buffers.
+ */
+static void Bench_Free() {
+    heap_caps_free(benchFrame);
+    heap_caps_free(benchScratch);
+    heap_caps_free(benchDecoded);
+    heap_caps_free(benchPlane);
+    heap_caps_free(benchMotion);
+    heap_caps_free(benchStats);
+    free(benchJpeg); // Allocated by fmt2jpg
+    benchFrame = benchScratch = benchDecoded = NULL;
+    benchPlane = NULL;
+    benchMotion = NULL;
+    benchStats = NULL;
+    benchJpeg = NULL;
+    benchJpegLen = 0;
+    benchSprite.deleteSprite();
+}
+
+/**
+ * @brief Allocate the buffers and generate the test frame and photo.
+ * @return true on success
+ */
+static bool Bench_Alloc() {
+    size_t frameBytes = BENCH_WIDTH * BENCH_HEIGHT * sizeof(uint16_t);
+    size_t photoBytes = BENCH_JPEG_WIDTH * BENCH_JPEG_HEIGHT * sizeof(uint16_t);
+    benchFrame = (uint16_t *)heap_caps_malloc(frameBytes, MALLOC_CAP_SPIRAM);
+    benchScratch = (uint16_t *)heap_caps_malloc(frameBytes, MALLOC_CAP_SPIRAM);
+    benchDecoded = (uint16_t *)heap_caps_malloc(photoBytes, MALLOC_CAP_SPIRAM);
+    benchPlane = (uint8_t *)heap_caps_calloc(2, BENCH_WIDTH * BENCH_HEIGHT, MALLOC_CAP_SPIRAM);
+    benchMotion = (MotionDetector *)heap_caps_malloc(sizeof(MotionDetector), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    benchStats = (FrameStats *)heap_caps_malloc(sizeof(FrameStats), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!benchFrame || !benchScratch || !benchDecoded || !benchPlane || !benchMotion || !benchStats ||
+        !benchSprite.createSprite(BENCH_WIDTH, BENCH_HEIGHT)) {
+        return false;
+    }
+    Bench_FillScene(benchFrame, BENCH_WIDTH, BENCH_HEIGHT);
+    memcpy(benchScratch, benchFrame, frameBytes);
+    MotionDetector_Init(*benchMotion);
+    FrameStats_Process(*benchStats, benchFrame, BENCH_WIDTH, BENCH_HEIGHT); // Luma grid for the overlay cases
+    benchSprite.setSwapBytes(false); // Frame is in panel byte order, like camera frames
+    Bench_FillScene(benchDecoded, BENCH_JPEG_WIDTH, BENCH_JPEG_HEIGHT); // Photo source, overwritten by the decodes
+    return fmt2jpg((uint8_t *)benchDecoded, photoBytes, BENCH_JPEG_WIDTH, BENCH_JPEG_HEIGHT, PIXFORMAT_RGB565,
+                   BENCH_JPEG_QUALITY, &benchJpeg, &benchJpegLen);
+}
+
+/**
+ * @brief Run the benchmark cases and print one line per case.
+ * The JPEG cases hold jpegDecoderMutex while they run.
+ * @param out Destination (e.g. Serial)
+ * @param filter Run only cases whose name contains this text (NULL or "" = all)
+ * @return Number of cases run, or -1 if the buffers could not be allocated
+ */
+int Bench_Run(Print &out, const char *filter) {
+    if (!Bench_Alloc()) {
+        out.println("[Bench] Buffer allocation failed.");
+        Bench_Free();
+        return -1;
+    }
+#if defined(NATIVE_BUILD)
+    out.printf("[Bench] Target: native, photo %u bytes, median of %d samples.\n", (unsigned)benchJpegLen, BENCH_SAMPLES);
+#else
+    out.printf("[Bench] Target: %s @ %u MHz, photo %u bytes, median of %d samples.\n", ESP.getChipModel(),
+               (unsigned)getCpuFrequencyMhz(), (unsigned)benchJpegLen, BENCH_SAMPLES);
+#endif
+    static Print *verifyOut;
+    verifyOut = &out;
+    int mismatches = PixelKernels_Verify([](const char *line) { verifyOut->printf("[Bench] %s\n", line); });
+    out.printf("[Bench] Kernel check: %s.\n", mismatches ? "FAILED" : "fast kernels match the scalar references");
+    out.printf("[Bench] %-16s %8s %7s %12s %12s %9s\n", "case", "pixels", "calls", "ns/call", "best ns", "px/ns");
+    int count = 0;
+    for (const BenchCase &benchCase : benchCases) {
+        if (filter && *filter && !strstr(benchCase.name, filter)) continue;
+        BenchResult result;
+        if (benchCase.usesDecoder) {
+            xSemaphoreTake(jpegDecoderMutex, portMAX_DELAY); // Decoder is shared with the gallery and web server
+            TJpgDec.setCallback(Bench_JpegOutput);
+            Bench_Measure(benchCase, result);
+            TJpgDec.setCallback(tft_output); // Restore display defaults
+            TJpgDec.setJpgScale(8);
+            xSemaphoreGive(jpegDecoderMutex);
+        } else {
+            Bench_Measure(benchCase, result);
+        }
+        out.printf("[Bench] %-16s %8u %7u %12.1f %12.1f %9.4f\n", result.name, (unsigned)result.pixels,
+                   (unsigned)result.calls, result.nsPerCall, result.bestNsPerCall, result.pixelsPerNs);
+        count++;
+    }
+    Bench_Free();
+    return count;
+}
@@ -0,0 +1,56 @@
+// bench.h - Pixel kernel benchmark suite
+// This header declares the micro-benchmarks of the preview and photo pixel paths. Every
+// pixel-path optimization is accepted or rejected on these numbers: run the suite before and
+// after the change on the same target and compare the px/ns column.
+//
+// Key features:
+// - Fixed, generated inputs (no camera or SD card needed), so runs are comparable across commits
+// - Cases: grid overlay, RGB565 byte swap, fill, blend, sprite copy, JPEG decode at 1/1..1/8,
+//   2:1 and 4:1 downscale, luma, histogram, absolute difference, focus peaking and zebra overlays
+// - Fast kernels are timed next to their scalar references ("_ref" cases) after PixelKernels_Verify()
+// - Median of BENCH_SAMPLES timed samples, reported as ns per call and pixels per ns
+// - Runs on the device ("bench" serial command) and on the host (native build, --bench)
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h> // Arduino core library
+
+// Frame size of the preview kernels (camera preview, QVGA)
+#define BENCH_WIDTH 320
+#define BENCH_HEIGHT 240
+// Size of the generated photo for the JPEG decode cases (VGA)
+#define BENCH_JPEG_WIDTH 640
+#define BENCH_JPEG_HEIGHT 480
+// JPEG quality of the generated photo (fmt2jpg scale, 0-100)
+#define BENCH_JPEG_QUALITY 80
+// Timed samples per case; the median is reported
+#define BENCH_SAMPLES 7
+// Minimum duration of one sample (calls are repeated until it is reached)
+#define BENCH_SAMPLE_MIN_US 2000
+
+// Result of one benchmark case
+struct BenchResult {
+    const char *name;     // Case name
+    uint32_t pixels;      // Pixels processed per call
+    uint32_t calls;       // Calls per sample
+    float nsPerCall;      // Median time per call
+    float bestNsPerCall;  // Fastest sample
+    float pixelsPerNs;    // pixels / nsPerCall
+};
+
+/**
+ * @brief Fill an image with the fixed test scene (color gradients, checkerboard and seeded noise).
+ * The scene never changes between runs, so it also serves as the input of the golden image checks.
+ * @param pixels Destination (RGB565, panel byte order)
+ * @param width Image width
+ * @param height Image height
+ */
+void Bench_FillScene(uint16_t *pixels, int width, int height);
+
+/**
+ * @brief Run the benchmark cases and print one line per case.
+ * The JPEG cases hold jpegDecoderMutex while they run.
+ * @param out Destination (e.g. Serial)
+ * @param filter Run only cases whose name contains this text (NULL or "" = all)
+ * @return Number of cases run, or -1 if the buffers could not be allocated
+ */
+int Bench_Run(Print &out, const char *filter = NULL);
@@ -7,12 +7,19 @@
 // - Camera hardware configuration (OV2640/OV5640)
 // - Preview mode (low-res, fast, RGB565)
 // - Photo mode (high-res, JPEG)
-// - Camera sensor parameter adjustment (effects, brightness, etc.)
+// - Camera sensor parameter adjustment (effects, brightness, etc.), only changed settings written
+// - Preview exposure/AWB handed over to still and video modes
 // - Frame queue for real-time preview
+// - Camera task stopped at a frame boundary on request (no fixed settle delay)
 
 #include "cameraTask.h" // Include header for this module
+#include <atomic>       // Sensor change requests from other tasks
+#include "sensorSettings.h" // Desired vs applied sensor settings
+#include "sensorExposure.h" // AE/AWB hand-over between modes
 #include "config.h"     // Include global configuration
 #include "displayTask.h"// For error display and preview integration
+#include "metrics.h"    // Pipeline counters
+#include "trace.h"      // Event tracing
 
 // Camera effect mode (0 = none, others = special effects)
 int cameraEffectMode = 0;
@@ -24,6 +31,51 @@ camera_config_t cameraConfig;
 QueueHandle_t cameraFrameQueue;
 // Pointer to camera sensor struct (for parameter adjustment)
 sensor_t *cameraSensor;
+// Mutex for camera access (held while settings are written, so the task is never deleted mid-transfer)
+extern SemaphoreHandle_t cameraMutex;
+// Settings the sensor has (valid after CameraTask_InitSensorConfig, camera owner only)
+static SensorSettings appliedSensorSettings;
+// Set by CameraTask_RequestSensorConfig, cleared once the camera task has written the change
+static std::atomic<bool> sensorConfigPending(false);
+// Converged exposure of the last preview (camera owner only)
+static SensorExposure previewExposure;
+// Set by CameraTask_Stop; the camera task parks at its next frame boundary
+static std::atomic<bool> cameraStopRequested(false);
+// Given by the camera task once it has parked (no frame buffer held, driver idle)
+static SemaphoreHandle_t cameraStoppedSemaphore;
+
+/**
+ * @brief Build the wanted sensor settings from the current mode/level.
+ * @param settings Receives the values
+ */
+static void CameraTask_DesiredSensorSettings(SensorSettings &settings) {
+    settings.contrast = cameraParamLevel;
+    settings.brightness = cameraParamLevel;
+    settings.saturation = cameraParamLevel;
+#if defined(OV2640)
+    settings.vflip = 0; // Vertical flip for OV2640
+#elif defined(OV5640)
+    settings.vflip = 1; // Vertical flip for OV5640
+#else
+    settings.vflip = 1; // Default vertical flip
+#endif
+    settings.specialEffect = cameraEffectMode;
+}
+
+/**
+ * @brief Write the settings that differ from the applied state (camera owner only).
+ * @param reason Log label
+ */
+static void CameraTask_ApplySensorSettings(const char *reason) {
+    SensorSettings desired;
+    CameraTask_DesiredSensorSettings(desired);
+    int64_t start = esp_timer_get_time();
+    int written = SensorSettings_Apply(cameraSensor, desired, appliedSensorSettings);
+    int64_t elapsed = esp_timer_get_time() - start;
+    Metrics_Observe(METRIC_HIST_SENSOR_APPLY, elapsed);
+    Serial.printf("[CameraTask] Sensor %s: %d of %d settings written (%lld us).\n", reason, written,
+                  SENSOR_SETTING_COUNT, (long long)elapsed);
+}
 
 /**
  * @brief Initialize camera configuration for preview mode (low-res, RGB565).
@@ -100,36 +152,73 @@ void CameraTask_InitPhotoConfig() {
  */
 void CameraTask(void *pvParameters) {
     while (1) {
+        if (cameraStopRequested) { // Frame boundary: nothing held, safe to delete
+            xSemaphoreGive(cameraStoppedSemaphore);
+            while (1) vTaskDelay(portMAX_DELAY); // Parked until CameraTask_Stop deletes the task
+        }
+        int64_t start = esp_timer_get_time();
+        TRACE_BEGIN("fb_get");
         camera_fb_t *fb = esp_camera_fb_get(); // Capture a frame from camera
+        TRACE_END("fb_get");
         if (!fb) { // If capture failed
+            Metrics_Add(METRIC_CAMERA_FRAMES_FAILED);
             Serial.println("[CameraTask] Camera capture failed!");
             vTaskDelay(10 / portTICK_PERIOD_MS); // Wait and retry
             continue;
         }
+        Metrics_Observe(METRIC_HIST_CAPTURE, esp_timer_get_time() - start);
+        Metrics_Add(METRIC_CAMERA_FRAMES_CAPTURED);
         if (xQueueSend(cameraFrameQueue, &fb, 0) != pdTRUE) { // Send frame to queue
             esp_camera_fb_return(fb); // If queue full, return frame buffer
+            Metrics_Add(METRIC_CAMERA_FRAMES_DROPPED);
+            TRACE_INSTANT("frame_dropped");
+        } else {
+            TRACE_INSTANT("frame_queued");
+        }
+        // Between frames: write requested sensor changes (skipped while a capture takes the camera)
+        if (sensorConfigPending && xSemaphoreTake(cameraMutex, 0) == pdTRUE) {
+            sensorConfigPending = false;
+            CameraTask_ApplySensorSettings("change");
+            xSemaphoreGive(cameraMutex);
         }
         vTaskDelay(30 / portTICK_PERIOD_MS); // Control frame rate
     }
 }
 
 /**
- * @brief Initialize camera sensor software parameters (effects, brightness, etc.).
- * Sets special effect mode, brightness, contrast, and other sensor parameters.
+ * @brief Initialize camera sensor software parameters (effects, brightness, etc.) after esp_camera_init.
+ * Starts from the driver defaults and writes only the settings that differ from them.
  */
 void CameraTask_InitSensorConfig() {
     cameraSensor = esp_camera_sensor_get(); // Get pointer to sensor struct
-    cameraSensor->set_contrast(cameraSensor, cameraParamLevel);   // Set contrast
-    cameraSensor->set_brightness(cameraSensor, cameraParamLevel); // Set brightness
-    cameraSensor->set_saturation(cameraSensor, cameraParamLevel); // Set saturation
-#if defined(OV2640)
-    cameraSensor->set_vflip(cameraSensor, 0); // Vertical flip for OV2640
-#elif defined(OV5640)
-    cameraSensor->set_vflip(cameraSensor, 1); // Vertical flip for OV5640
-#else
-    cameraSensor->set_vflip(cameraSensor, 1); // Default vertical flip
-#endif
-    cameraSensor->set_special_effect(cameraSensor, cameraEffectMode); // Set special effect
+    SensorSettings_FromStatus(cameraSensor, appliedSensorSettings); // What the fresh sensor has
+    sensorConfigPending = false; // Covered by this write
+    CameraTask_ApplySensorSettings("init");
+}
+
+/**
+ * @brief Ask the camera task to write changed sensor settings (cameraEffectMode, cameraParamLevel).
+ * Returns immediately; the change is written between two preview frames.
+ */
+void CameraTask_RequestSensorConfig() {
+    sensorConfigPending = true;
+}
+
+/**
+ * @brief Stop the camera task at a frame boundary and delete it (camera owner only).
+ * The task finishes its current frame, confirms and parks; only a task that does not confirm
+ * within the timeout (stuck in the driver) is deleted wherever it is.
+ * @param task Camera task handle
+ * @param timeoutMs Maximum wait for the confirmation
+ * @return true if the task confirmed, false if it had to be deleted without confirmation
+ */
+bool CameraTask_Stop(TaskHandle_t task, uint32_t timeoutMs) {
+    xSemaphoreTake(cameraStoppedSemaphore, 0); // Clear a stale confirmation
+    cameraStopRequested = true;
+    bool stopped = xSemaphoreTake(cameraStoppedSemaphore, timeoutMs / portTICK_PERIOD_MS) == pdTRUE;
+    vTaskDelete(task); // Parked (or stuck): the task never runs again
+    cameraStopRequested = false; // The next camera task starts running
+    return stopped;
 }
 
 /**
@@ -154,10 +243,30 @@ void CameraTask_Init() {
     }
     Serial.println("[CameraTask] Camera init done.");
     cameraFrameQueue = xQueueCreate(1, sizeof(camera_fb_t *)); // Create frame queue
-    if (!cameraFrameQueue) {
+    cameraStoppedSemaphore = xSemaphoreCreateBinary(); // CameraTask_Stop handshake
+    if (!cameraFrameQueue || !cameraStoppedSemaphore) {
         Serial.println("[CameraTask] Failed to create frame queue!");
         while (1) {}
     }
     Serial.println("[CameraTask] Frame queue created.");
     CameraTask_InitSensorConfig(); // Set sensor parameters
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Remember the converged preview exposure/AWB before the preview is stopped (camera owner only).
+ * Timelapse shots also call it, to hand their state to the next shot.
+ */
+void CameraTask_SnapshotExposure() {
+    if (!SensorExposure_Snapshot(esp_camera_sensor_get(), previewExposure)) {
+        Serial.println("[CameraTask] No exposure to hand over, the next mode starts on auto.");
+    }
+}
+
+/**
+ * @brief Start the newly initialized mode from the preview exposure/AWB (after CameraTask_InitSensorConfig).
+ * @param holdManual true for a single still (AE/AWB stay off), false to let them continue (video)
+ * @return true if the preview values were written
+ */
+bool CameraTask_RestoreExposure(bool holdManual) {
+    return SensorExposure_Restore(esp_camera_sensor_get(), previewExposure, holdManual);
+}
@@ -7,8 +7,10 @@
 // - Camera hardware configuration (OV2640/OV5640)
 // - Preview mode (low-res, fast, RGB565)
 // - Photo mode (high-res, JPEG)
-// - Camera sensor parameter adjustment (effects, brightness, etc.)
+// - Camera sensor parameter adjustment (effects, brightness, etc.), only changed settings written
+// - Preview exposure/AWB handed over to still and video modes
 // - Frame queue for real-time preview
+// - Camera task stopped at a frame boundary on request
 
 #pragma once // Prevent multiple inclusion of this header
 #include <TFT_eSPI.h> // TFT display library (for preview integration)
@@ -33,6 +35,9 @@
 #define CAM_HREF_PIN 47   // Horizontal reference
 #define CAM_PCLK_PIN 45   // Pixel clock
 
+// Longest wait for the camera task to finish its frame and stop (a few frame times)
+#define CAMERA_STOP_TIMEOUT_MS 500
+
 // External references to display and camera configuration
 extern TFT_eSPI tftDisplay;           // TFT display object (for preview)
 extern camera_config_t cameraConfig;  // Camera configuration struct
@@ -57,12 +62,38 @@ void CameraTask_InitPhotoConfig();
  */
 void CameraTask(void *pvParameters);
 
+/**
+ * @brief Stop the camera task at a frame boundary and delete it (camera owner only).
+ * @param task Camera task handle
+ * @param timeoutMs Maximum wait for the task's confirmation before it is deleted anyway
+ * @return true if the task confirmed, false if it had to be deleted without confirmation
+ */
+bool CameraTask_Stop(TaskHandle_t task, uint32_t timeoutMs);
+
 /**
  * @brief Initialize the camera hardware, create frame queue, and set sensor parameters.
  */
 void CameraTask_Init();
 
 /**
- * @brief Initialize camera sensor software parameters (effects, brightness, etc.).
+ * @brief Initialize camera sensor software parameters (effects, brightness, etc.) after esp_camera_init.
+ */
+void CameraTask_InitSensorConfig();
+
+/**
+ * @brief Ask the camera task to write changed sensor settings (cameraEffectMode, cameraParamLevel).
+ */
+void CameraTask_RequestSensorConfig();
+
+/**
+ * @brief Remember the converged preview exposure/AWB before the preview is stopped (camera owner only).
+ * Timelapse shots also call it, to hand their state to the next shot.
+ */
+void CameraTask_SnapshotExposure();
+
+/**
+ * @brief Start the newly initialized mode from the preview exposure/AWB (after CameraTask_InitSensorConfig).
+ * @param holdManual true for a single still (AE/AWB stay off), false to let them continue (video)
+ * @return true if the preview values were written
  */
-void CameraTask_InitSensorConfig();
\ No newline at end of file
+bool CameraTask_RestoreExposure(bool holdManual);
@@ -6,6 +6,7 @@
 // - Camera model selection (OV2640 or OV5640)
 // - Display driver selection (ST7789, ILI9341, etc.)
 // - Used by camera and display modules for hardware compatibility
+// - Optional diagnostics (event tracing), motion detection and timelapse interval
 
 #pragma once // Prevent multiple inclusion of this header
 
@@ -16,4 +17,27 @@
 // Display driver selection (see TFT_eSPI User_Setup.h for details)
 // file at ".pio/libdeps/esp32-s3-devkitc-1/TFT_eSPI/User_Setup.h"
 // #define ST7789_DRIVER // Uncomment for ST7789 display
-// #define ILI9341_DRIVER // Uncomment for ILI9341 display
\ No newline at end of file
+// #define ILI9341_DRIVER // Uncomment for ILI9341 display
+
+// Event tracing (see trace.h). Uncomment to record begin/end events and enable /trace.
+// #define ENABLE_TRACE
+
+// Key edge logging. Uncomment to print every raw key edge in the input replay timeline format
+// (see inputReplay.h), to record real button presses for the replay harness.
+// #define KEY_LOG_EDGES
+
+// Motion detection on the preview stream (see motionTask.h). Uncomment to run the detector on
+// preview frames and log motion start/end events.
+// #define ENABLE_MOTION
+// Take a photo on every motion start event (needs ENABLE_MOTION).
+// #define MOTION_AUTO_CAPTURE
+// Save the preview frames around every motion start event, including the ones before it
+// (needs ENABLE_MOTION; pre-roll, post-roll and cooldown in motionCapture.h).
+// #define MOTION_CAPTURE
+// Luma change a cell needs to count as motion (default 24; lower = more sensitive).
+// #define MOTION_SENSITIVITY 16
+// Only watch this area of the preview frame: x, y, w, h in preview pixels (default: whole frame).
+// #define MOTION_ROI 0, 120, 320, 120
+
+// Timelapse interval in seconds for the Down key long press (see timelapseTask.h, default 60).
+// #define TIMELAPSE_INTERVAL_S 10
@@ -5,18 +5,30 @@
 // - Photo saving with visual feedback
 // - Error display for hardware issues
 // - 3x3 grid overlay for composition
+// - Focus peaking and zebra overlays (Top key, after the camera effects)
+// - Captures start once the preview exposure has settled (frame statistics), not after fixed delays
 //
 // The display task uses double buffering (TFT_eSprite) to avoid flicker and provides a user-friendly interface.
 // All functions and variables are documented for beginner understanding.
 
 #include <Arduino.h>           // Arduino core library for basic types and functions
 #include <TJpg_Decoder.h>      // JPEG decoder library for displaying images
+#include <atomic>              // Preview settle state read by the capture path
 #include "displayTask.h"       // Header for display task functions and variables
 #include "cameraTask.h"        // Header for camera task functions and variables
 #include "image.h"             // Header for image data arrays (icons, splash, etc.)
 #include "tfCard.h"            // Header for SD card functions
 #include "keyTask.h"           // Header for key/button input functions
 #include "config.h"            // Global configuration header
+#include "metrics.h"           // Pipeline counters
+#include "trace.h"             // Event tracing
+#include "taskConfig.h"        // Task placement table
+#include "profiler.h"          // Per-core CPU load
+#include "pixelKernels.h"      // Grid overlay kernel
+#include "frameStats.h"        // Per-frame luma statistics
+#include "motionTask.h"        // Motion detection on preview frames
+#include "videoTask.h"         // Video recording state
+#include "timelapseTask.h"     // Timelapse state
 
 // Indicates if the "Saving..." popup should be shown on the display
 bool isSavingPopupVisible = false;
@@ -27,63 +39,196 @@ TFT_eSPI tftDisplay;
 // Off-screen sprite buffer for double buffering (avoids flicker)
 TFT_eSprite spriteBuffer = TFT_eSprite(&tftDisplay);
 
-// Index of the currently displayed photo in gallery mode (1-based)
-volatile int currentPhotoIdx = -1;
-// True if in photo gallery mode, false for live preview mode
-volatile bool isPhotoViewMode = false;
 // Timing variables for FPS calculation
 static unsigned long lastFrameMillis = 0; // Last time FPS was updated
 static int frameCount = 0;                // Frame count for FPS
 float frameRate = 0;                      // Calculated FPS value
+// Values shown on the HUD, sampled from the metrics counters
+struct HudValues {
+    int latencyMs;     // Capture-to-display latency
+    int pushTenthsMs;  // SPI push time (0.1 ms)
+    uint32_t drops;    // Frames dropped by the camera queue
+    int cpuLoad[2];    // CPU load per core (%)
+    uint32_t heapKb;   // Free internal heap
+    uint32_t psramKb;  // Free PSRAM
+    int sdQueue;       // Photos waiting for the SD writer
+    int lumaTenths;    // Preview frame statistics (frameStats.h)
+    int p5, p95;
+    int shadowPermille, highlightPermille;
+    int sharpness;
+};
+// Last sampled values and the text lines formatted from them
+static HudValues hudValues;
+static char hudLines[7][40];
+// Time of the last HUD sample
+static unsigned long lastHudMillis = 0;
+// Zebra stripe offset, advanced every frame so the stripes crawl
+static int zebraPhase = 0;
+// Statistics of the last preview frame (display task only)
+static FrameStats previewStats;
+// Exposure/white balance convergence of the preview (display task only)
+static FrameStatsSettle previewSettle;
+// Preview frames analysed so far, and how many of the last ones were stable (read by the capture path)
+static std::atomic<uint32_t> previewStatsFrames(0);
+static std::atomic<uint32_t> previewStableFrames(0);
+// Preview/gallery UI state (only touched by the display task)
+static UiState uiState;
+// Queue of DisplayEvent values for the display task
+QueueHandle_t displayEventQueue = NULL;
+// Given by the display task once all preview frames are released for a capture
+static SemaphoreHandle_t framesReleasedSemaphore;
+// Queue set the display task waits on (camera frames + display events)
+static QueueSetHandle_t displayEventSet;
+// A capture waits for the queued preview frame, which is returned when the set selects it (display task only)
+static bool framesReleasePending = false;
 // Pointer to the current camera frame buffer
 camera_fb_t *frameBuffer = NULL;
 // External task handle for camera task (used to pause/resume camera)
 extern TaskHandle_t cameraTaskHandle;
-// Mutex for camera access (if needed for thread safety)
-extern SemaphoreHandle_t camMutex;
+// Mutex for camera access (serializes still captures)
+extern SemaphoreHandle_t cameraMutex;
+// Mutex protecting the shared JPEG decoder (gallery and web thumbnails)
+SemaphoreHandle_t jpegDecoderMutex;
 
 /**
- * @brief Save a photo from the camera to the SD card.
- * This function pauses the camera preview, switches to high-res photo mode,
- * captures a frame, saves it to SD, and restores preview mode.
- * Visual feedback is provided on the display, and all steps are logged.
+ * @brief Wait until the preview exposure/white balance has settled (capture path, preview running).
+ * Polls the display task's frame statistics: at least minFrames new frames must have been shown
+ * (so the popup is on screen) and the last FRAME_STATS_SETTLED_FRAMES of them stable.
+ * @param minFrames New preview frames to wait for at least
+ * @param timeoutMs Maximum wait time
+ * @return true if the preview settled, false on timeout
  */
-void DisplayTask_SavePhoto() {
-    Serial.println("[DisplayTask] Photo save started.");
-    isSavingPopupVisible = true; // Show "Saving..." popup
-    vTaskDelay(100 / portTICK_PERIOD_MS); // Allow popup to be visible
-    // Pause camera task to avoid resource conflict
+static bool DisplayTask_WaitPreviewSettled(uint32_t minFrames, uint32_t timeoutMs) {
+    uint32_t first = previewStatsFrames;
+    int64_t deadline = esp_timer_get_time() + (int64_t)timeoutMs * 1000;
+    while (previewStatsFrames - first < minFrames || previewStableFrames < FRAME_STATS_SETTLED_FRAMES) {
+        if (esp_timer_get_time() >= deadline) return false;
+        vTaskDelay(DISPLAY_SETTLE_POLL_MS / portTICK_PERIOD_MS);
+    }
+    return true;
+}
+
+/**
+ * @brief Stop the live preview and release the camera driver (caller holds cameraMutex).
+ * Stops the camera task at a frame boundary, has the display task give back its preview frames and
+ * deinitializes the camera, so a still capture or a recording can reinitialize it in another mode.
+ * Each stage ends on a confirmation rather than a fixed delay; the waits are logged and observed.
+ */
+void DisplayTask_StopPreview() {
+    int64_t start = esp_timer_get_time();
     if (cameraTaskHandle != NULL) {
-        vTaskDelete(cameraTaskHandle); // Stop camera task
+        if (!CameraTask_Stop(cameraTaskHandle, CAMERA_STOP_TIMEOUT_MS)) { // Returns once no frame is in flight
+            Metrics_Add(METRIC_CAMERA_STOP_TIMEOUTS);
+            Serial.println("[DisplayTask] Camera task did not stop in time, deleted.");
+        }
         cameraTaskHandle = NULL;
-        Serial.println("[DisplayTask] Camera task deleted.");
-        vTaskDelay(30 / portTICK_PERIOD_MS); // Wait for resources to be released
     }
-    esp_camera_deinit(); // Deinitialize camera hardware
-    vTaskDelay(100 / portTICK_PERIOD_MS); // Ensure hardware is released
+    int64_t stopped = esp_timer_get_time();
+    if (!DisplayTask_PauseForCapture()) { // Display task must give back queued preview frames
+        Serial.println("[DisplayTask] Display task was busy, frames released late.");
+    }
+    int64_t released = esp_timer_get_time();
+    CameraTask_SnapshotExposure(); // Converged AE/AWB for the next mode
+    int64_t deinitStart = esp_timer_get_time();
+    esp_camera_deinit(); // Synchronous: DMA, XCLK and frame buffers are released on return
+    int64_t end = esp_timer_get_time();
+    Metrics_Observe(METRIC_HIST_WAIT_CAMERA_STOP, stopped - start);
+    Metrics_Observe(METRIC_HIST_WAIT_FRAMES, released - stopped);
+    Metrics_Observe(METRIC_HIST_CAMERA_DEINIT, end - deinitStart);
+    Serial.printf("[DisplayTask] Preview stopped: camera task %d ms, frames released %d ms, deinit %d ms.\n",
+                  (int)((stopped - start) / 1000), (int)((released - stopped) / 1000), (int)((end - deinitStart) / 1000));
+}
+
+/**
+ * @brief Reinitialize the camera in preview mode and restart the camera task (caller holds cameraMutex).
+ * The camera must be deinitialized; posts DISPLAY_EVENT_CAPTURE_DONE once the preview runs again.
+ */
+void DisplayTask_ResumePreview() {
+    CameraTask_InitPreviewConfig(); // Restore preview mode (low-res RGB565)
+    esp_camera_init(&cameraConfig); // Re-initialize camera for preview
+    CameraTask_InitSensorConfig(); // Set sensor parameters
+    Serial.println("[DisplayTask] Switched back to camera mode.");
+    TaskConfig_Start(TASK_CAMERA, CameraTask, NULL, &cameraTaskHandle); // Restart camera task
+    Serial.println("[DisplayTask] Camera task restarted.");
+    DisplayTask_PostEvent(DISPLAY_EVENT_CAPTURE_DONE);
+}
+
+/**
+ * @brief Capture a still photo and hand the JPEG frame buffer to a consumer.
+ * This function pauses the camera preview, switches to high-res photo mode,
+ * captures a frame, passes it to the consumer, and restores preview mode.
+ * Shared by the shutter key and the web /capture endpoint; calls are serialized by cameraMutex.
+ * @param options Resolution, quality and flash settings for this capture
+ * @param consumer Called with the captured JPEG frame (buffer is only valid during the call)
+ * @param arg User argument passed to the consumer
+ * @return true if a frame was captured and consumed
+ */
+bool DisplayTask_CapturePhoto(const CaptureOptions &options, CaptureConsumer consumer, void *arg) {
+    if (VideoTask_IsRecording() || TimelapseTask_IsRunning()) { // The camera belongs to the recorder/timelapse
+        Serial.println("[DisplayTask] Recording or timelapse in progress, photo skipped.");
+        return false;
+    }
+    xSemaphoreTake(cameraMutex, portMAX_DELAY); // One capture at a time
+    Serial.println("[DisplayTask] Photo capture started.");
+    isSavingPopupVisible = true; // Show "Saving..." popup
+    if (options.flash) KeyTask_SetLED(true); // Flash on, the preview exposure adapts to it
+    // Popup on screen and AE/AWB converged (with the flash: give the light a few frames to show)
+    int64_t settleStart = esp_timer_get_time();
+    bool settled = DisplayTask_WaitPreviewSettled(options.flash ? FRAME_STATS_SETTLED_FRAMES : 1, DISPLAY_SETTLE_TIMEOUT_MS);
+    int64_t settleUs = esp_timer_get_time() - settleStart;
+    Metrics_Observe(METRIC_HIST_WAIT_SETTLE, settleUs);
+    if (!settled) Metrics_Add(METRIC_CAPTURE_SETTLE_TIMEOUTS);
+    Serial.printf("[DisplayTask] Preview %s after %d ms.\n", settled ? "settled" : "not settled, timeout", (int)(settleUs / 1000));
+    DisplayTask_StopPreview(); // Release the camera driver
     CameraTask_InitPhotoConfig(); // Switch to photo mode (high-res JPEG)
+    if (options.frameSize != FRAMESIZE_INVALID) cameraConfig.frame_size = options.frameSize; // Requested resolution
+    if (options.quality > 0) cameraConfig.jpeg_quality = options.quality; // Requested JPEG quality
     Serial.println("[DisplayTask] Picture mode activated.");
     esp_err_t err = esp_camera_init(&cameraConfig); // Re-initialize camera
-    CameraTask_InitSensorConfig(); // Set sensor parameters
+    bool captured = false;
     if (err != ESP_OK) {
         Serial.printf("[DisplayTask] Camera reinit JPEG failed: %d\n", err);
-        return;
+    } else {
+        CameraTask_InitSensorConfig(); // Set sensor parameters
+        CameraTask_RestoreExposure(true); // First frame usable (the preview has settled, with the flash if any)
+        camera_fb_t *fb = esp_camera_fb_get(); // Capture a frame
+        if (fb) {
+            consumer(fb, arg); // Save, send, ...
+            esp_camera_fb_return(fb); // Return frame buffer to driver
+            captured = true;
+            Serial.println("[DisplayTask] Photo taken.");
+        } else {
+            Serial.println("[DisplayTask] Photo capture failed!");
+        }
+        esp_camera_deinit(); // Deinitialize camera again (synchronous, the preview can init right away)
     }
-    camera_fb_t *fb = esp_camera_fb_get(); // Capture a frame
-    TfCard_WritePhoto(fb->buf, fb->len); // Save to SD card
-    esp_camera_fb_return(fb); // Return frame buffer to driver
-    Serial.println("[DisplayTask] Photo taken.");
-    esp_camera_deinit(); // Deinitialize camera again
-    vTaskDelay(100 / portTICK_PERIOD_MS);
-    CameraTask_InitPreviewConfig(); // Restore preview mode (low-res RGB565)
-    esp_camera_init(&cameraConfig); // Re-initialize camera for preview
-    CameraTask_InitSensorConfig(); // Set sensor parameters
-    Serial.println("[DisplayTask] Switched back to camera mode.");
     KeyTask_SetLED(false); // Ensure flash LED is off
     Serial.println("[DisplayTask] LED closed.");
     isSavingPopupVisible = false; // Hide "Saving..." popup
-    xTaskCreatePinnedToCore(CameraTask, "CameraTask", 4096, NULL, 1, &cameraTaskHandle, 0); // Restart camera task
-    Serial.println("[DisplayTask] Camera task restarted.");
+    DisplayTask_ResumePreview(); // Back to live preview
+    xSemaphoreGive(cameraMutex);
+    return captured;
+}
+
+/**
+ * @brief Capture consumer that hands the JPEG to the SD writer task.
+ * Falls back to a direct write if the copy cannot be queued (the file index is locked either way).
+ * @param fb Captured JPEG frame
+ * @param arg Not used
+ */
+static void DisplayTask_WriteToCard(camera_fb_t *fb, void *arg) {
+    if (!TfCard_QueuePhoto(fb->buf, fb->len)) TfCard_WritePhoto(fb->buf, fb->len); // Save to SD card
+}
+
+/**
+ * @brief Save a photo from the camera to the SD card.
+ * Captures a still with the default photo settings and writes it to the card.
+ * Visual feedback is provided on the display, and all steps are logged.
+ * @param flash true to fire the flash LED during the capture
+ */
+void DisplayTask_SavePhoto(bool flash) {
+    CaptureOptions options = {FRAMESIZE_INVALID, 0, flash};
+    DisplayTask_CapturePhoto(options, DisplayTask_WriteToCard, NULL);
 }
 
 /**
@@ -98,6 +243,7 @@ void DisplayTask_SavePhoto() {
  * @return true if successful, false otherwise
  */
 bool tft_output(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t *data) {
+    TRACE_SCOPE("tft_output");
     if (y >= tftDisplay.height()) return 0; // Ignore blocks outside display
     tftDisplay.pushImage(x, y, w, h, data); // Draw block to display
     return 1; // Success
@@ -110,6 +256,7 @@ bool tft_output(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t *data) {
  * @param index Photo index (1-based)
  */
 void DisplayTask_ShowGallery(int index) {
+    xSemaphoreTake(jpegDecoderMutex, portMAX_DELAY); // Decoder is shared with the web server
 #if defined(OV2640)
     TJpgDec.setJpgScale(4); // Use 1/4 scale for OV2640
 #elif defined(OV5640)
@@ -143,6 +290,7 @@ void DisplayTask_ShowGallery(int index) {
     tftDisplay.pushImage(290, 105, 30, 30, camera); // Camera icon
     tftDisplay.pushImage(290, 5, 30, 30, up);       // Up icon
     tftDisplay.pushImage(290, 205, 30, 30, down);   // Down icon
+    xSemaphoreGive(jpegDecoderMutex);
     Serial.printf("[DisplayTask] Showing: %s\n", filename);
 }
 
@@ -152,6 +300,7 @@ void DisplayTask_ShowGallery(int index) {
  * Shows a splash screen for 3 seconds, then clears the display.
  */
 void DisplayTask_Init() {
+    jpegDecoderMutex = xSemaphoreCreateMutex(); // Create JPEG decoder mutex
     spiLcd.begin(LCD_SCK_PIN, LCD_MOSI_PIN, LCD_CS_PIN); // Initialize SPI bus
     tftDisplay.begin(); // Initialize TFT display
     tftDisplay.setRotation(1); // Landscape mode
@@ -175,155 +324,364 @@ void DisplayTask_Init() {
  * @param color Grid line color
  */
 void DisplayTask_DrawGrid3x3(uint16_t *image, int width, int height, uint16_t color) {
-    int cellW = width / 3; // Width of each cell
-    int cellH = height / 3; // Height of each cell
-    for (int y = 0; y < height; y++) {
-        image[y * width + cellW] = color; // Vertical line 1
-        image[y * width + 2 * cellW] = color; // Vertical line 2
-    }
-    for (int x = 0; x < width; x++) {
-        image[cellH * width + x] = color; // Horizontal line 1
-        image[2 * cellH * width + x] = color; // Horizontal line 2
-    }
+    PixelKernels_DrawGrid3x3(image, width, height, color); // Shared with the benchmark suite
 }
 
 /**
- * @brief Display an error message and halt the system.
+ * @brief Draw the error screen without halting.
  * Fills the screen with black, shows the error text in red, and displays an icon.
- * Used for critical errors such as missing hardware. The system halts in this state.
  * @param message Error message to display
  */
-void DisplayTask_ShowError(const char *message) {
+void DisplayTask_DrawError(const char *message) {
     tftDisplay.fillScreen(TFT_BLACK); // Clear display
     tftDisplay.setTextColor(TFT_RED); // Set text color to red
     tftDisplay.setTextSize(2); // Set text size
     tftDisplay.setCursor(5, 170); // Set cursor position
     tftDisplay.println(message); // Print error message
     tftDisplay.pushImage(100, 10, 128, 128, tfcard); // Show SD card icon
+}
+
+/**
+ * @brief Display an error message and halt the system.
+ * Used for critical errors such as missing hardware. The system halts in this state.
+ * @param message Error message to display
+ */
+void DisplayTask_ShowError(const char *message) {
+    DisplayTask_DrawError(message); // Error screen
     while (1) {
         delay(1000); // Halt in error state
     }
 }
 
 /**
- * @brief Show the live camera preview on the TFT display.
- * Receives frames from the camera queue, overlays grid and info, and displays FPS.
+ * @brief Sample the HUD values (at most twice per second) and reformat the text only if they changed.
+ * Reads the same lock-free counters as /metrics, so the HUD adds no work to the frame path.
+ */
+static void DisplayTask_UpdateHud() {
+    unsigned long now = millis();
+    if (now - lastHudMillis < 500) return; // Sample at 2 Hz
+    lastHudMillis = now;
+    HudValues v;
+    float load[2];
+    Profiler_GetCoreLoad(load);
+    v.latencyMs = Metrics_Get(METRIC_FRAME_LATENCY_US) / 1000;
+    v.pushTenthsMs = Metrics_Get(METRIC_DISPLAY_PUSH_US) / 100;
+    v.drops = Metrics_Get(METRIC_CAMERA_FRAMES_DROPPED);
+    v.cpuLoad[0] = (int)load[0];
+    v.cpuLoad[1] = (int)load[1];
+    v.heapKb = heap_caps_get_free_size(MALLOC_CAP_INTERNAL) / 1024;
+    v.psramKb = heap_caps_get_free_size(MALLOC_CAP_SPIRAM) / 1024;
+    v.sdQueue = TfCard_GetWriteQueueDepth();
+    v.lumaTenths = previewStats.result.meanTenths;
+    v.p5 = previewStats.result.p5;
+    v.p95 = previewStats.result.p95;
+    v.shadowPermille = previewStats.result.shadowPermille;
+    v.highlightPermille = previewStats.result.highlightPermille;
+    v.sharpness = previewStats.result.sharpness;
+    if (memcmp(&v, &hudValues, sizeof(v)) == 0) return; // Nothing changed, keep cached text
+    hudValues = v;
+    snprintf(hudLines[0], sizeof(hudLines[0]), "LAT %3d ms PUSH %d.%d ms", v.latencyMs, v.pushTenthsMs / 10, v.pushTenthsMs % 10);
+    snprintf(hudLines[1], sizeof(hudLines[1]), "DROP %u", (unsigned)v.drops);
+    snprintf(hudLines[2], sizeof(hudLines[2]), "CPU0 %3d%% CPU1 %3d%%", v.cpuLoad[0], v.cpuLoad[1]);
+    snprintf(hudLines[3], sizeof(hudLines[3]), "HEAP %uk PSRAM %uk", (unsigned)v.heapKb, (unsigned)v.psramKb);
+    snprintf(hudLines[4], sizeof(hudLines[4]), "SDQ %d", v.sdQueue);
+    snprintf(hudLines[5], sizeof(hudLines[5]), "Y %3d.%d P5 %3d P95 %3d", v.lumaTenths / 10, v.lumaTenths % 10, v.p5, v.p95);
+    snprintf(hudLines[6], sizeof(hudLines[6]), "CLIP %d/%d%% SHARP %d", v.shadowPermille / 10, v.highlightPermille / 10,
+             v.sharpness);
+}
+
+/**
+ * @brief Draw the cached HUD text lines onto the preview sprite.
+ */
+static void DisplayTask_DrawHud() {
+    spriteBuffer.setTextSize(1); // Small font (6x8)
+    spriteBuffer.setTextColor(TFT_GREEN, TFT_BLACK); // Opaque background for readability
+    for (int i = 0; i < 7; i++) {
+        spriteBuffer.drawString(hudLines[i], 5, 40 + i * 10);
+    }
+}
+
+/**
+ * @brief Compute the statistics of a preview frame and publish them (HUD, /metrics, capture readiness).
+ * @param img Frame pixels (RGB565, panel byte order)
+ * @param w Frame width
+ * @param h Frame height
+ */
+static void DisplayTask_UpdateFrameStats(const uint16_t *img, int w, int h) {
+    int64_t start = esp_timer_get_time();
+    if (!FrameStats_Process(previewStats, img, w, h)) return; // Larger than the sample grid
+    Metrics_Observe(METRIC_HIST_FRAME_STATS, esp_timer_get_time() - start);
+    const FrameStatsResult &result = previewStats.result;
+    previewStableFrames = FrameStats_Settle(previewSettle, result);
+    previewStatsFrames++; // After the stable count, so a waiter seeing the frame also sees its count
+    Metrics_Set(METRIC_FRAME_LUMA_MILLI, result.meanTenths * 100);
+    Metrics_Set(METRIC_FRAME_SHADOW_PERMILLE, result.shadowPermille);
+    Metrics_Set(METRIC_FRAME_HIGHLIGHT_PERMILLE, result.highlightPermille);
+    Metrics_Set(METRIC_FRAME_SHARPNESS_MILLI, result.sharpness > INT32_MAX / 1000 ? INT32_MAX : (int32_t)result.sharpness * 1000);
+}
+
+/**
+ * @brief Mark the sprite with the selected analysis overlay.
+ * The overlays work on the luma grid of the frame statistics, so the statistics are computed
+ * here, before the push, when an overlay is shown.
+ * @param sprite Sprite pixels (a copy of img)
+ * @param img Frame pixels (RGB565, panel byte order)
+ * @param w Frame width
+ * @param h Frame height
+ * @return true if the frame statistics were computed
+ */
+static bool DisplayTask_DrawOverlay(uint16_t *sprite, const uint16_t *img, int w, int h) {
+    if (uiState.overlay == UI_OVERLAY_NONE) return false;
+    DisplayTask_UpdateFrameStats(img, w, h);
+    if (previewStats.cols == 0) return true; // Frame larger than the sample grid: no overlay
+    int64_t start = esp_timer_get_time();
+    if (uiState.overlay == UI_OVERLAY_PEAKING) {
+        PixelKernels_FocusPeaking(previewStats.luma, previewStats.cols, previewStats.rows, sprite, w, FRAME_STATS_STEP,
+                                  DISPLAY_PEAKING_THRESHOLD, DISPLAY_PEAKING_COLOR);
+    } else {
+        zebraPhase++;
+        PixelKernels_Zebra(previewStats.luma, previewStats.cols, previewStats.rows, sprite, w, FRAME_STATS_STEP,
+                           DISPLAY_ZEBRA_LUMA, zebraPhase, DISPLAY_ZEBRA_COLOR);
+    }
+    Metrics_Observe(METRIC_HIST_PREVIEW_OVERLAY, esp_timer_get_time() - start);
+    return true;
+}
+
+/**
+ * @brief Show one camera frame as the live preview on the TFT display.
+ * Overlays grid and info, updates FPS, and returns the frame buffer to the driver.
  * Uses double buffering to avoid flicker. All UI overlays are drawn on the sprite buffer.
+ * @param frame Preview frame received from the camera queue
+ */
+void DisplayTask_ShowCamera(camera_fb_t *frame) {
+    frameBuffer = frame;
+    TRACE_INSTANT("frame_received");
+    frameCount++; // Increment frame count for FPS
+    unsigned long now = millis(); // Get current time
+    if (now - lastFrameMillis >= 1000) { // Update FPS every second
+        frameRate = frameCount * 1000.0f / (now - lastFrameMillis);
+        Metrics_Set(METRIC_DISPLAY_FPS_MILLI, (int32_t)(frameRate * 1000));
+        frameCount = 0;
+        lastFrameMillis = now;
+    }
+    TRACE_BEGIN("render");
+    int64_t renderStart = esp_timer_get_time();
+    uint16_t *img = (uint16_t *)frameBuffer->buf; // Pointer to image data
+    int w = frameBuffer->width; // Image width
+    int h = frameBuffer->height; // Image height
+    spriteBuffer.createSprite(w, h); // Create off-screen buffer
+    spriteBuffer.setSwapBytes(false); // Set byte order for RGB565
+    spriteBuffer.pushImage(0, 0, w, h, img); // Draw camera image
+    bool statsDone = DisplayTask_DrawOverlay((uint16_t *)spriteBuffer.getPointer(), img, w, h); // Focus peaking or zebra
+    DisplayTask_DrawGrid3x3((uint16_t *)spriteBuffer.getPointer(), w, h, TFT_WHITE); // Draw grid
+    spriteBuffer.setTextColor(TFT_WHITE); // Set text color for FPS
+    spriteBuffer.setTextSize(2); // Set text size
+    char infoStr[32]; // Buffer for info strings
+    sprintf(infoStr, "FPS: %d", (int)frameRate); // Format FPS string
+    spriteBuffer.drawString(infoStr, 5, 200); // Draw FPS
+    spriteBuffer.setTextColor(TFT_YELLOW); // Set text color for mode info
+    if (uiState.overlay == UI_OVERLAY_PEAKING) sprintf(infoStr, "Peak"); // Overlay instead of an effect
+    else if (uiState.overlay == UI_OVERLAY_ZEBRA) sprintf(infoStr, "Zebra");
+    else sprintf(infoStr, "Mode:%d", cameraEffectMode); // Format mode string
+    spriteBuffer.drawString(infoStr, 210, 15); // Draw mode info
+    spriteBuffer.pushImage(290, 105, 30, 30, photo); // Photo icon
+    spriteBuffer.pushImage(290, 5, 30, 30, color);   // Color icon
+    spriteBuffer.pushImage(290, 205, 30, 30, sun);   // Sun icon
+    spriteBuffer.setTextColor(TFT_YELLOW); // Set text color for light info
+    sprintf(infoStr, "light: %d", cameraParamLevel); // Format light string
+    spriteBuffer.drawString(infoStr, 195, 220); // Draw light info
+    sprintf(infoStr, "DPI: %dx%d", w, h); // Format DPI string
+    spriteBuffer.drawString(infoStr, 5, 220); // Draw DPI info
+    if (uiState.hudVisible) { // Performance HUD
+        DisplayTask_UpdateHud();
+        DisplayTask_DrawHud();
+    }
+    if (isSavingPopupVisible) { // If saving popup should be shown
+        spriteBuffer.setTextColor(TFT_YELLOW, TFT_BLACK); // Yellow text on black
+        spriteBuffer.drawString("S A V I N G ...", 80, 110); // Draw saving popup
+    }
+    TRACE_END("render");
+    TRACE_BEGIN("push_sprite");
+    int64_t pushStart = esp_timer_get_time();
+    spriteBuffer.pushSprite(0, 0); // Push sprite to display
+    int64_t pushEnd = esp_timer_get_time();
+    TRACE_END("push_sprite");
+    spriteBuffer.deleteSprite(); // Delete sprite to free memory
+    int64_t frameTime = (int64_t)frameBuffer->timestamp.tv_sec * 1000000 + frameBuffer->timestamp.tv_usec; // Driver timestamp (esp_timer)
+    if (!statsDone) DisplayTask_UpdateFrameStats(img, w, h); // After the push, like motion detection
+#if defined(ENABLE_MOTION)
+    MotionTask_OnFrame(frameBuffer); // After the push, so detection does not delay the preview
+#endif
+    esp_camera_fb_return(frameBuffer); // Return frame buffer to driver
+    Metrics_Observe(METRIC_HIST_DISPLAY_RENDER, pushStart - renderStart);
+    Metrics_Observe(METRIC_HIST_DISPLAY_PUSH, pushEnd - pushStart);
+    Metrics_Observe(METRIC_HIST_FRAME_LATENCY, pushEnd - frameTime);
+    Metrics_Set(METRIC_FRAME_LATENCY_US, pushEnd - frameTime);
+    Metrics_Set(METRIC_DISPLAY_PUSH_US, pushEnd - pushStart);
+    Metrics_Add(METRIC_DISPLAY_FRAMES);
+}
+
+/**
+ * @brief Create the display event queue and the queue set shared with the camera frame queue.
+ * Must run after CameraTask_Init (frame queue exists) and before CameraTask starts,
+ * because a queue can only join a set while it is empty.
  */
-void DisplayTask_ShowCamera() {
-    if (xQueueReceive(cameraFrameQueue, &frameBuffer, portMAX_DELAY) == pdTRUE) {
-        frameCount++; // Increment frame count for FPS
-        unsigned long now = millis(); // Get current time
-        if (now - lastFrameMillis >= 1000) { // Update FPS every second
-            frameRate = frameCount * 1000.0f / (now - lastFrameMillis);
-            frameCount = 0;
-            lastFrameMillis = now;
+void DisplayTask_InitEvents() {
+    UiState_Reset(uiState); // Power-on UI state
+    displayEventQueue = xQueueCreate(DISPLAY_EVENT_QUEUE_LEN, sizeof(DisplayEvent)); // Create event queue
+    framesReleasedSemaphore = xSemaphoreCreateBinary(); // Capture handshake
+    displayEventSet = xQueueCreateSet(1 + DISPLAY_EVENT_QUEUE_LEN); // Frame queue (length 1) + event queue
+    if (!displayEventQueue || !framesReleasedSemaphore || !displayEventSet ||
+        xQueueAddToSet(cameraFrameQueue, displayEventSet) != pdPASS ||
+        xQueueAddToSet(displayEventQueue, displayEventSet) != pdPASS) {
+        Serial.println("[DisplayTask] Failed to create display event set!");
+        while (1) {}
+    }
+    Serial.println("[DisplayTask] Event loop ready.");
+}
+
+/**
+ * @brief Post an input or system event to the display task.
+ * Never blocks; the event is dropped (and logged) if the queue is full.
+ * @param event Event to post
+ */
+void DisplayTask_PostEvent(DisplayEvent event) {
+    if (!displayEventQueue || xQueueSend(displayEventQueue, &event, 0) != pdTRUE) {
+        Serial.printf("[DisplayTask] Event %d dropped.\n", (int)event);
+    }
+}
+
+/**
+ * @brief Wait until the display task has released all preview frames for a still capture.
+ * Posts DISPLAY_EVENT_CAPTURE_START and waits for the display task's confirmation. There is no
+ * timeout: a frame still queued when the camera is deinitialized would point into freed memory.
+ * The display task always answers, at the latest after a long gallery decode.
+ * Must not be called from the display task.
+ * @return true if the display task confirmed within DISPLAY_RELEASE_WARN_MS
+ */
+bool DisplayTask_PauseForCapture() {
+    xSemaphoreTake(framesReleasedSemaphore, 0); // Clear a stale confirmation
+    DisplayEvent event = DISPLAY_EVENT_CAPTURE_START;
+    xQueueSend(displayEventQueue, &event, portMAX_DELAY); // Unlike other events, never dropped
+    if (xSemaphoreTake(framesReleasedSemaphore, DISPLAY_RELEASE_WARN_MS / portTICK_PERIOD_MS) == pdTRUE) return true;
+    Serial.println("[DisplayTask] Display task busy, still waiting for the preview frames.");
+    xSemaphoreTake(framesReleasedSemaphore, portMAX_DELAY);
+    return false;
+}
+
+/**
+ * @brief Name of a preview overlay for the serial log.
+ */
+static const char *DisplayTask_OverlayName(UiOverlay overlay) {
+    return overlay == UI_OVERLAY_PEAKING ? "focus peaking" : overlay == UI_OVERLAY_ZEBRA ? "zebra" : "off";
+}
+
+/**
+ * @brief Handle one display event according to the current mode.
+ * Key events go through the UI state machine; this function performs the resulting side effect.
+ * @param event Event received from the event queue
+ */
+static void DisplayTask_HandleEvent(DisplayEvent event) {
+    switch (event) {
+    case DISPLAY_EVENT_KEY_TOP:
+    case DISPLAY_EVENT_KEY_MID:
+    case DISPLAY_EVENT_KEY_DOWN:
+    case DISPLAY_EVENT_TOGGLE_HUD:
+    case DISPLAY_EVENT_TOGGLE_RECORD:
+    case DISPLAY_EVENT_TOGGLE_TIMELAPSE: {
+        UiOverlay overlayBefore = uiState.overlay;
+        UiAction action = UiState_Apply(uiState, event, TfCard_GetLastPhotoIndex());
+        switch (action) {
+        case UI_ACTION_SENSOR_CHANGED:
+            cameraEffectMode = uiState.effectMode;
+            cameraParamLevel = uiState.paramLevel;
+            CameraTask_RequestSensorConfig(); // Written by the camera task between frames
+            Serial.printf("[DisplayTask] Effect mode %d, param level %d.\n", cameraEffectMode, cameraParamLevel);
+            if (uiState.overlay != overlayBefore) { // Entering peaking also resets the effect
+                Serial.printf("[DisplayTask] Overlay: %s.\n", DisplayTask_OverlayName(uiState.overlay));
+            }
+            break;
+        case UI_ACTION_OVERLAY_CHANGED:
+            Serial.printf("[DisplayTask] Overlay: %s.\n", DisplayTask_OverlayName(uiState.overlay));
+            break;
+        case UI_ACTION_SHOW_PHOTO:
+            DisplayTask_ShowGallery(uiState.photoIndex);
+            Serial.printf("[DisplayTask] Gallery: showing photo %d.\n", uiState.photoIndex);
+            break;
+        case UI_ACTION_NO_PHOTOS:
+            Serial.println("[DisplayTask] No photos found, error displayed.");
+            DisplayTask_DrawError("  No photos found. \n\n  Please take a photo first. "); // Stays up until Mid returns to preview
+            break;
+        case UI_ACTION_SHOW_PREVIEW:
+            tftDisplay.setSwapBytes(false); // Set byte order for preview
+            Serial.println("[DisplayTask] Back to preview mode.");
+            break;
+        case UI_ACTION_TOGGLE_HUD:
+            Serial.printf("[DisplayTask] HUD %s.\n", uiState.hudVisible ? "on" : "off");
+            break;
+        case UI_ACTION_TOGGLE_RECORD:
+            VideoTask_Toggle(); // The recorder switches the camera on its own task
+            break;
+        case UI_ACTION_TOGGLE_TIMELAPSE:
+            TimelapseTask_Toggle(); // Runs on the timelapse task
+            break;
+        default:
+            break;
         }
-        uint16_t *img = (uint16_t *)frameBuffer->buf; // Pointer to image data
-        int w = frameBuffer->width; // Image width
-        int h = frameBuffer->height; // Image height
-        spriteBuffer.createSprite(w, h); // Create off-screen buffer
-        spriteBuffer.setSwapBytes(false); // Set byte order for RGB565
-        spriteBuffer.pushImage(0, 0, w, h, img); // Draw camera image
-        DisplayTask_DrawGrid3x3((uint16_t *)spriteBuffer.getPointer(), w, h, TFT_WHITE); // Draw grid
-        spriteBuffer.setTextColor(TFT_WHITE); // Set text color for FPS
-        spriteBuffer.setTextSize(2); // Set text size
-        char infoStr[32]; // Buffer for info strings
-        sprintf(infoStr, "FPS: %d", (int)frameRate); // Format FPS string
-        spriteBuffer.drawString(infoStr, 5, 200); // Draw FPS
-        spriteBuffer.setTextColor(TFT_YELLOW); // Set text color for mode info
-        sprintf(infoStr, "Mode:%d", cameraEffectMode); // Format mode string
-        spriteBuffer.drawString(infoStr, 210, 15); // Draw mode info
-        spriteBuffer.pushImage(290, 105, 30, 30, photo); // Photo icon
-        spriteBuffer.pushImage(290, 5, 30, 30, color);   // Color icon
-        spriteBuffer.pushImage(290, 205, 30, 30, sun);   // Sun icon
-        spriteBuffer.setTextColor(TFT_YELLOW); // Set text color for light info
-        sprintf(infoStr, "light: %d", cameraParamLevel); // Format light string
-        spriteBuffer.drawString(infoStr, 195, 220); // Draw light info
-        sprintf(infoStr, "DPI: %dx%d", w, h); // Format DPI string
-        spriteBuffer.drawString(infoStr, 5, 220); // Draw DPI info
-        if (isSavingPopupVisible) { // If saving popup should be shown
-            spriteBuffer.setTextColor(TFT_YELLOW, TFT_BLACK); // Yellow text on black
-            spriteBuffer.drawString("S A V I N G ...", 80, 110); // Draw saving popup
+        break;
+    }
+    case DISPLAY_EVENT_CAPTURE_START: { // Release every preview frame before the camera is deinitialized
+        // The camera task is stopped, so at most the one queued frame is left. It is taken through the
+        // queue set like any frame (receiving it here would leave its set entry behind).
+        framesReleasePending = uxQueueMessagesWaiting(cameraFrameQueue) > 0; // Overwrites any earlier flag
+        if (uiState.mode == UI_MODE_PREVIEW) { // No frames will arrive, draw the popup directly
+            tftDisplay.setTextSize(2);
+            tftDisplay.setTextColor(TFT_YELLOW, TFT_BLACK);
+            const char *label = VideoTask_IsRecording() ? "R E C ..." : TimelapseTask_IsRunning() ? "T I M E L A P S E" : "S A V I N G ...";
+            tftDisplay.drawString(label, 80, 110);
         }
-        spriteBuffer.pushSprite(0, 0); // Push sprite to display
-        spriteBuffer.deleteSprite(); // Delete sprite to free memory
-        esp_camera_fb_return(frameBuffer); // Return frame buffer to driver
+        if (!framesReleasePending) xSemaphoreGive(framesReleasedSemaphore); // Confirm to the capture path
+        break;
+    }
+    case DISPLAY_EVENT_CAPTURE_DONE:
+        framesReleasePending = false; // Never carried into the resumed preview
+        Serial.println("[DisplayTask] Capture done, preview resumes.");
+        break;
     }
 }
 
 /**
  * @brief Main display task loop.
- * Handles switching between live preview and gallery mode, and responds to key events.
- * In preview mode, shows live camera feed and allows mode/parameter adjustment.
- * In gallery mode, allows browsing saved photos. All state changes are logged.
+ * Event loop multiplexing preview frames and display events with a queue set, so input
+ * latency does not depend on the frame rate and a stopped camera never stalls the UI.
+ * In preview mode, frames are rendered; in gallery mode they are returned immediately.
  * @param pvParameters Not used (for FreeRTOS compatibility)
  */
 void DisplayTask(void *pvParameters) {
-    static bool galleryLoaded = false; // True if gallery has been loaded
     while (1) {
-        if (keyMidState == 0) { // If in preview mode
-            tftDisplay.setSwapBytes(false); // Set byte order for preview
-            galleryLoaded = false; // Reset gallery state
-            isPhotoViewMode = false; // Not in gallery mode
-            DisplayTask_ShowCamera(); // Show live camera preview
-            // Handle top key: change camera effect mode
-            if (keyTopState == 1) {
-                keyTopState = 0;
-                if (cameraEffectMode > 5) {
-                    cameraEffectMode = 0;
-                } else {
-                    ++cameraEffectMode;
-                }
-                CameraTask_InitSensorConfig(); // Update sensor config
-                Serial.printf("[DisplayTask] Effect mode changed: %d\n", cameraEffectMode);
-            }
-            // Handle down key: change camera parameter level
-            if (keyDownState == 1) {
-                keyDownState = 0;
-                if (cameraParamLevel > 1) {
-                    cameraParamLevel = -2;
-                } else {
-                    ++cameraParamLevel;
-                }
-                CameraTask_InitSensorConfig(); // Update sensor config
-                Serial.printf("[DisplayTask] Param level changed: %d\n", cameraParamLevel);
+        QueueSetMemberHandle_t ready = xQueueSelectFromSet(displayEventSet, DISPLAY_TICK_MS / portTICK_PERIOD_MS);
+        if (ready == displayEventQueue) {
+            DisplayEvent event;
+            if (xQueueReceive(displayEventQueue, &event, 0) == pdTRUE) {
+                DisplayTask_HandleEvent(event);
             }
-        } else { // If in gallery mode
-            // Enter gallery mode on mid key
-            if (!galleryLoaded) {
-                int lastIdx = TfCard_GetNextPhotoIndex() - 1; // Get last photo index
-                if (lastIdx >= 1) {
-                    currentPhotoIdx = lastIdx; // Set current photo index
-                    DisplayTask_ShowGallery(currentPhotoIdx); // Show last photo
-                    isPhotoViewMode = true; // In gallery mode
-                    Serial.printf("[DisplayTask] Entered gallery mode, showing photo %d.\n", currentPhotoIdx);
+        } else if (ready == cameraFrameQueue) {
+            camera_fb_t *fb = NULL;
+            if (xQueueReceive(cameraFrameQueue, &fb, 0) == pdTRUE) {
+                if (framesReleasePending) { // Last frame before a capture: not drawn over the popup
+                    esp_camera_fb_return(fb);
+                    framesReleasePending = false;
+                    xSemaphoreGive(framesReleasedSemaphore); // Confirm to the capture path
+                } else if (uiState.mode == UI_MODE_GALLERY) {
+                    DisplayTask_UpdateFrameStats((const uint16_t *)fb->buf, fb->width, fb->height); // Capture readiness
+                    esp_camera_fb_return(fb); // Not shown in gallery mode, give it back right away
                 } else {
-                    DisplayTask_ShowError("  No photos found. \n\n  Please take a photo first. "); // Show error
-                    Serial.println("[DisplayTask] No photos found, error displayed.");
-                }
-                galleryLoaded = true; // Mark gallery as loaded
-            }
-            // Gallery navigation with top/down keys
-            if (isPhotoViewMode) {
-                if (keyTopState == 1) { // Previous photo
-                    keyTopState = 0;
-                    if (currentPhotoIdx > 1) {
-                        --currentPhotoIdx;
-                        DisplayTask_ShowGallery(currentPhotoIdx);
-                        Serial.printf("[DisplayTask] Gallery: previous photo %d.\n", currentPhotoIdx);
-                    }
-                }
-                if (keyDownState == 1) { // Next photo
-                    keyDownState = 0;
-                    if (currentPhotoIdx < TfCard_GetNextPhotoIndex() - 1) {
-                        ++currentPhotoIdx;
-                        DisplayTask_ShowGallery(currentPhotoIdx);
-                        Serial.printf("[DisplayTask] Gallery: next photo %d.\n", currentPhotoIdx);
-                    }
+                    DisplayTask_ShowCamera(fb); // Show live camera preview
                 }
             }
+        } else if (millis() - lastFrameMillis > 1000 && frameRate != 0) { // Timer tick: no frames for a while
+            frameRate = 0;
+            Metrics_Set(METRIC_DISPLAY_FPS_MILLI, 0);
         }
-        vTaskDelay(10 / portTICK_PERIOD_MS); // Control refresh rate
     }
 }
\ No newline at end of file
@@ -13,12 +13,31 @@
 #pragma once // Prevent multiple inclusion of this header
 #include <Arduino.h> // Arduino core library
 #include <TFT_eSPI.h> // TFT display library
+#include <esp_camera.h> // Camera frame buffer type
+#include "uiState.h" // UI state machine and display events
 
 // SPI bus object for the TFT display
 extern SPIClass spiLcd;
 // TFT display object
 extern TFT_eSPI tftDisplay;
 
+// Length of the display event queue
+#define DISPLAY_EVENT_QUEUE_LEN 8
+// Display task timer tick when no frame or event arrives
+#define DISPLAY_TICK_MS 100
+// Longest wait for the preview exposure/white balance to settle before a still capture
+#define DISPLAY_SETTLE_TIMEOUT_MS 1000
+// Poll interval of that wait
+#define DISPLAY_SETTLE_POLL_MS 5
+// Frame release wait after which a capture logs that the display task is busy (it keeps waiting)
+#define DISPLAY_RELEASE_WARN_MS 500
+// Focus peaking: edge magnitude (PixelKernels_FocusPeaking) from which a sample is marked, and the mark color
+#define DISPLAY_PEAKING_THRESHOLD 16
+#define DISPLAY_PEAKING_COLOR TFT_RED
+// Zebra: luma from which a sample counts as overexposed (95 %), and the stripe color
+#define DISPLAY_ZEBRA_LUMA 242
+#define DISPLAY_ZEBRA_COLOR TFT_BLACK
+
 // Pin definitions for the TFT display (change according to your hardware)
 #define LCD_MOSI_PIN 2      // Master Out Slave In (data to display)
 #define LCD_MISO_PIN -1     // Master In Slave Out (not used)
@@ -28,12 +47,55 @@ extern TFT_eSPI tftDisplay;
 #define LCD_RST_PIN -1      // Reset pin (not used)
 #define LCD_BLK_PIN 1       // Backlight control
 
+// Mutex protecting the shared JPEG decoder (TJpgDec) between the gallery and the web server
+extern SemaphoreHandle_t jpegDecoderMutex;
+
+/**
+ * @brief JPEG decoder pixel output callback that draws blocks to the TFT display.
+ * @param x X coordinate of the block
+ * @param y Y coordinate of the block
+ * @param w Width of the block
+ * @param h Height of the block
+ * @param data Pointer to pixel data (RGB565 format)
+ * @return true if successful, false otherwise
+ */
+bool tft_output(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t *data);
+
 /**
  * @brief Main display task loop. Handles preview/gallery switching and key events.
  * @param pvParameters Not used (for FreeRTOS compatibility)
  */
 void DisplayTask(void *pvParameters);
 
+/**
+ * @brief Create the display event queue and queue set (after CameraTask_Init, before tasks start).
+ */
+void DisplayTask_InitEvents();
+
+/**
+ * @brief Post an input or system event to the display task (never blocks).
+ * @param event Event to post
+ */
+void DisplayTask_PostEvent(DisplayEvent event);
+
+/**
+ * @brief Wait until the display task has released all preview frames for a still capture.
+ * Has no timeout: the camera must not be deinitialized while a preview frame is still queued.
+ * Must not be called from the display task.
+ * @return true if the display task confirmed within DISPLAY_RELEASE_WARN_MS
+ */
+bool DisplayTask_PauseForCapture();
+
+/**
+ * @brief Stop the live preview and release the camera driver (caller holds cameraMutex).
+ */
+void DisplayTask_StopPreview();
+
+/**
+ * @brief Reinitialize the camera in preview mode and restart the camera task (caller holds cameraMutex).
+ */
+void DisplayTask_ResumePreview();
+
 /**
  * @brief Draw a 3x3 grid overlay on an image buffer for composition guidance.
  * @param image Pointer to image buffer (RGB565)
@@ -48,6 +110,12 @@ void DisplayTask_DrawGrid3x3(uint16_t *image, int width, int height, uint16_t co
  */
 void DisplayTask_Init();
 
+/**
+ * @brief Draw the error screen (message and SD card icon) without halting.
+ * @param message Error message to display
+ */
+void DisplayTask_DrawError(const char *message);
+
 /**
  * @brief Display an error message and halt the system.
  * @param message Error message to display
@@ -63,10 +131,36 @@ extern TaskHandle_t displayTaskHandle;
 // Task handle for the camera task (for external access)
 extern TaskHandle_t cameraTaskHandle;
 
+// Options for a single still capture
+struct CaptureOptions {
+    framesize_t frameSize; // Resolution (FRAMESIZE_INVALID = photo mode default)
+    int quality;           // JPEG quality 1-63 (0 = photo mode default)
+    bool flash;            // Fire the flash LED during the capture
+};
+
+// Consumer of a captured JPEG frame (the buffer is only valid during the call)
+typedef void (*CaptureConsumer)(camera_fb_t *fb, void *arg);
+
+/**
+ * @brief Capture a still photo and hand the JPEG frame buffer to a consumer, with UI feedback.
+ * @param options Resolution, quality and flash settings for this capture
+ * @param consumer Called with the captured JPEG frame
+ * @param arg User argument passed to the consumer
+ * @return true if a frame was captured and consumed
+ */
+bool DisplayTask_CapturePhoto(const CaptureOptions &options, CaptureConsumer consumer, void *arg);
+
 /**
  * @brief Save a photo from the camera to the SD card, with UI feedback.
+ * @param flash true to fire the flash LED during the capture
+ */
+void DisplayTask_SavePhoto(bool flash = false);
+
+/**
+ * @brief Show one camera preview frame with overlays and return it to the driver.
+ * @param frame Preview frame (RGB565, sensor byte order)
  */
-void DisplayTask_SavePhoto();
+void DisplayTask_ShowCamera(camera_fb_t *frame);
 
 /**
  * @brief Display a photo from SD card in gallery mode.
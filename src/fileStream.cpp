@@ -0,0 +1,124 @@
+// fileStream.cpp - SD-to-socket streaming implementation
+// This module implements a double-buffered file streaming engine for the web server.
+// A reader task pinned to core 0 reads large blocks from the SD card into one buffer
+// while the calling task pushes the other buffer to the TCP socket.
+//
+// Key features:
+// - Two FILE_STREAM_BLOCK_SIZE buffers exchanged through FreeRTOS queues
+// - Block-sized reads keep file offsets sector aligned (multi-sector SD transfers)
+// - Early abort when the client disconnects
+// - CRC-32 computed on the sender side while the data is in cache
+
+#include "fileStream.h" // Include header for this module
+#include <rom/crc.h>    // ROM CRC-32 routine
+#include "taskConfig.h" // Task placement table
+
+// Message passed from the reader task to the sender for each filled buffer
+struct StreamBlock {
+    int index;  // Buffer index (0 or 1)
+    size_t len; // Number of valid bytes (0 = end of file or read error)
+};
+
+// The two streaming buffers
+static uint8_t *streamBuffers[2] = {NULL, NULL};
+// Queue of buffer indices the reader may fill
+static QueueHandle_t streamFreeQueue;
+// Queue of filled blocks waiting to be sent
+static QueueHandle_t streamFullQueue;
+// Queue of stream jobs (file pointers) for the reader task
+static QueueHandle_t streamJobQueue;
+// Set by the sender when the client goes away, so the reader stops early
+static volatile bool streamAbort = false;
+// Throughput of the last completed stream (MB/s)
+static float streamLastRate = 0;
+
+/**
+ * @brief SD reader task. Waits for a job, then fills free buffers until end of file.
+ * @param pvParameters Not used (for FreeRTOS compatibility)
+ */
+static void FileStream_ReaderTask(void *pvParameters) {
+    File *file = NULL;
+    while (1) {
+        xQueueReceive(streamJobQueue, &file, portMAX_DELAY); // Wait for a new stream
+        while (1) {
+            StreamBlock block;
+            xQueueReceive(streamFreeQueue, &block.index, portMAX_DELAY); // Wait for a free buffer
+            block.len = streamAbort ? 0 : file->read(streamBuffers[block.index], FILE_STREAM_BLOCK_SIZE);
+            xQueueSend(streamFullQueue, &block, portMAX_DELAY); // Hand buffer to the sender
+            if (block.len == 0) break; // End of file, error or abort
+        }
+    }
+}
+
+/**
+ * @brief Allocate the stream buffers and start the SD reader task.
+ * Buffers are taken from internal RAM when possible (faster for WiFi), PSRAM otherwise.
+ */
+void FileStream_Init() {
+    for (int i = 0; i < 2; i++) {
+        streamBuffers[i] = (uint8_t *)heap_caps_malloc(FILE_STREAM_BLOCK_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!streamBuffers[i]) {
+            streamBuffers[i] = (uint8_t *)heap_caps_malloc(FILE_STREAM_BLOCK_SIZE, MALLOC_CAP_SPIRAM);
+        }
+        if (!streamBuffers[i]) {
+            Serial.println("[FileStream] Failed to allocate stream buffer!");
+            while (1) {}
+        }
+    }
+    streamFreeQueue = xQueueCreate(2, sizeof(int));
+    streamFullQueue = xQueueCreate(2, sizeof(StreamBlock));
+    streamJobQueue = xQueueCreate(1, sizeof(File *));
+    TaskConfig_Start(TASK_STREAM, FileStream_ReaderTask, NULL, NULL); // Start SD reader
+    Serial.println("[FileStream] Stream engine ready.");
+}
+
+/**
+ * @brief Stream an open file to a TCP client using double-buffered reads.
+ * While the reader fills one buffer from SD on core 0, this task writes the other
+ * to the socket. Logs the sustained throughput when done.
+ * @param file Open file (read position is used as the start)
+ * @param client Connected TCP client
+ * @param crc Optional CRC-32 accumulator, updated with the streamed data
+ * @return Number of bytes written to the client
+ */
+size_t FileStream_Send(File &file, WiFiClient &client, uint32_t *crc) {
+    File *job = &file;
+    size_t total = 0;
+    unsigned long start = micros();
+    streamAbort = false;
+    for (int i = 0; i < 2; i++) {
+        xQueueSend(streamFreeQueue, &i, 0); // Both buffers start free
+    }
+    xQueueSend(streamJobQueue, &job, portMAX_DELAY); // Start the reader
+    while (1) {
+        StreamBlock block;
+        xQueueReceive(streamFullQueue, &block, portMAX_DELAY); // Wait for a filled buffer
+        if (block.len == 0) break; // Reader finished
+        if (!streamAbort) {
+            const uint8_t *data = streamBuffers[block.index];
+            if (crc) *crc = crc32_le(*crc, data, block.len); // Update CRC while data is hot
+            size_t sent = client.write(data, block.len); // Push block to the socket
+            total += sent;
+            if (sent != block.len) {
+                streamAbort = true; // Client gone, let the reader stop
+                Serial.println("[FileStream] Client disconnected, stream aborted.");
+            }
+        }
+        xQueueSend(streamFreeQueue, &block.index, portMAX_DELAY); // Give buffer back to the reader
+    }
+    xQueueReset(streamFreeQueue); // Drop the remaining free slot for the next stream
+    unsigned long elapsed = micros() - start;
+    if (elapsed > 0) {
+        streamLastRate = (float)total / elapsed; // Bytes per microsecond = MB/s
+    }
+    Serial.printf("[FileStream] %u bytes in %lu ms (%.2f MB/s)\n", (unsigned)total, elapsed / 1000, streamLastRate);
+    return total;
+}
+
+/**
+ * @brief Get the sustained throughput of the last completed stream.
+ * @return Throughput in MB/s
+ */
+float FileStream_GetLastRate() {
+    return streamLastRate;
+}
@@ -0,0 +1,38 @@
+// fileStream.h - SD-to-socket streaming module
+// This header declares the double-buffered streaming engine used by the web server
+// to send files from the SD card to a TCP client.
+//
+// Key features:
+// - Reader task (core 0, see taskConfig) fills large aligned blocks from the SD card
+// - Caller (WebTask, core 1) pushes the filled blocks to the socket in parallel
+// - Two buffers ping-pong between reader and sender, so SPI and WiFi overlap
+// - Optional CRC-32 of the streamed data, sustained MB/s reporting
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h>    // Arduino core library
+#include <FS.h>         // File type
+#include <WiFiClient.h> // TCP client type
+
+// Size of each streaming block (multiple of the 512-byte SD sector)
+#define FILE_STREAM_BLOCK_SIZE (32 * 1024)
+
+/**
+ * @brief Allocate the stream buffers and start the SD reader task.
+ */
+void FileStream_Init();
+
+/**
+ * @brief Stream an open file to a TCP client using double-buffered reads.
+ * The HTTP headers must already have been sent. Only one stream may run at a time.
+ * @param file Open file (read position is used as the start)
+ * @param client Connected TCP client
+ * @param crc Optional CRC-32 accumulator, updated with the streamed data
+ * @return Number of bytes written to the client
+ */
+size_t FileStream_Send(File &file, WiFiClient &client, uint32_t *crc = NULL);
+
+/**
+ * @brief Get the sustained throughput of the last completed stream.
+ * @return Throughput in MB/s
+ */
+float FileStream_GetLastRate();
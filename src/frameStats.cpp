@@ -0,0 +1,110 @@
+// frameStats.cpp - Per-frame image statistics implementation
+// One pass converts the sample grid to luma (one row of samples at a time through the luma
+// kernel), a second pass builds the histogram and a third computes the Laplacian
+// 4*c - left - right - up - down at every inner sample. All sums are integers, so the
+// results are exact and the synthetic frames in test/test_frame_stats can check them for equality.
+//
+// Key features:
+// - Mean, percentiles and clipping ratios from one histogram
+// - Sharpness = variance of the Laplacian (flat or blurred frames score low, fine texture and sharp edges high)
+// - Settling = frame-to-frame change of mean luma and red/blue cast below a limit for a few frames
+
+#include "frameStats.h" // Include header for this module
+#include <stdlib.h> // abs
+#include <string.h> // memset
+
+/**
+ * @brief Compute the statistics of one frame.
+ * @param stats Statistics state (result and histogram are overwritten)
+ * @param frame RGB565 pixels in sensor (panel) byte order
+ * @param width Frame width (at most FRAME_STATS_MAX_COLS * FRAME_STATS_STEP)
+ * @param height Frame height (at most FRAME_STATS_MAX_ROWS * FRAME_STATS_STEP)
+ * @return false if the frame is empty or too large (result cleared)
+ */
+bool FrameStats_Process(FrameStats &stats, const uint16_t *frame, int width, int height) {
+    stats.result = FrameStatsResult();
+    int cols = width / FRAME_STATS_STEP, rows = height / FRAME_STATS_STEP;
+    if (!frame || cols < 3 || rows < 3 || cols > FRAME_STATS_MAX_COLS || rows > FRAME_STATS_MAX_ROWS) {
+        stats.cols = stats.rows = 0;
+        return false;
+    }
+    stats.cols = cols;
+    stats.rows = rows;
+    int32_t rbSum = 0;
+    for (int y = 0; y < rows; y++) { // Luma of the sample grid, red/blue cast while gathering the row
+        const uint16_t *src = frame + (size_t)y * FRAME_STATS_STEP * width;
+        for (int x = 0; x < cols; x++) {
+            uint16_t pixel = src[x * FRAME_STATS_STEP];
+            stats.row[x] = pixel;
+            rbSum += ((pixel >> 3) & 0x1F) - ((pixel >> 8) & 0x1F); // Red and blue fields in panel byte order
+        }
+        PixelKernels_Luma(stats.row, stats.luma + y * cols, cols);
+    }
+    uint32_t total = (uint32_t)cols * rows;
+    memset(stats.histogram, 0, sizeof(stats.histogram));
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < total; i++) {
+        stats.histogram[stats.luma[i]]++;
+        sum += stats.luma[i];
+    }
+    uint32_t shadow = 0, highlight = 0;
+    for (int value = 0; value <= FRAME_STATS_SHADOW_LUMA; value++) shadow += stats.histogram[value];
+    for (int value = FRAME_STATS_HIGHLIGHT_LUMA; value < PIXEL_HISTOGRAM_BINS; value++) highlight += stats.histogram[value];
+    int64_t lapSum = 0, lapSquares = 0;
+    for (int y = 1; y < rows - 1; y++) { // Laplacian over the inner samples
+        const uint8_t *line = stats.luma + y * cols;
+        for (int x = 1; x < cols - 1; x++) {
+            int lap = 4 * line[x] - line[x - 1] - line[x + 1] - line[x - cols] - line[x + cols];
+            lapSum += lap;
+            lapSquares += lap * lap;
+        }
+    }
+    int64_t inner = (int64_t)(cols - 2) * (rows - 2);
+    FrameStatsResult &result = stats.result;
+    result.samples = total;
+    result.meanTenths = (uint16_t)(((uint64_t)sum * 10 + total / 2) / total);
+    result.p5 = FrameStats_Percentile(stats.histogram, total, 50);
+    result.p50 = FrameStats_Percentile(stats.histogram, total, 500);
+    result.p95 = FrameStats_Percentile(stats.histogram, total, 950);
+    result.shadowPermille = (uint16_t)((uint64_t)shadow * 1000 / total);
+    result.highlightPermille = (uint16_t)((uint64_t)highlight * 1000 / total);
+    result.sharpness = (uint32_t)((lapSquares - lapSum * lapSum / inner) / inner);
+    result.rbTenths = (int16_t)(rbSum * 10 / (int32_t)total);
+    return true;
+}
+
+/**
+ * @brief Track exposure/white balance convergence: feed every frame's result in order.
+ * @param settle Settle state (zero-initialize to start over)
+ * @param result Statistics of the next frame
+ * @return Consecutive stable frames so far (settled at FRAME_STATS_SETTLED_FRAMES or more)
+ */
+uint32_t FrameStats_Settle(FrameStatsSettle &settle, const FrameStatsResult &result) {
+    if (settle.primed && abs(result.meanTenths - settle.meanTenths) < FRAME_STATS_SETTLED_LUMA_TENTHS &&
+        abs(result.rbTenths - settle.rbTenths) < FRAME_STATS_SETTLED_RB_TENTHS) {
+        settle.stableFrames++;
+    } else {
+        settle.stableFrames = 0; // First frame, or still adapting
+    }
+    settle.primed = true;
+    settle.meanTenths = result.meanTenths;
+    settle.rbTenths = result.rbTenths;
+    return settle.stableFrames;
+}
+
+/**
+ * @brief Find a percentile in a luma histogram.
+ * @param histogram PIXEL_HISTOGRAM_BINS counters
+ * @param total Sum of the counters
+ * @param permille Percentile in per mille (500 = median)
+ * @return Lowest luma with at least permille of the samples at or below it
+ */
+uint8_t FrameStats_Percentile(const uint32_t *histogram, uint32_t total, int permille) {
+    uint64_t needed = (uint64_t)total * permille;
+    uint64_t count = 0;
+    for (int value = 0; value < PIXEL_HISTOGRAM_BINS; value++) {
+        count += histogram[value];
+        if (count * 1000 >= needed) return (uint8_t)value;
+    }
+    return PIXEL_HISTOGRAM_BINS - 1;
+}
@@ -0,0 +1,86 @@
+// frameStats.h - Per-frame image statistics
+// This header declares the statistics stage for preview frames: luma histogram, mean and
+// percentile brightness, highlight/shadow clipping and a sharpness score (variance of the
+// Laplacian). The frame is sampled on a regular grid (every FRAME_STATS_STEP-th pixel of every
+// FRAME_STATS_STEP-th row), so a QVGA frame costs 160x120 luma conversions. Like the motion
+// detector it has no Arduino or FreeRTOS dependencies and runs the same on the host.
+//
+// Key features:
+// - Luma through the pixel kernels (PixelKernels_Luma), same weights as the motion detector
+// - Percentiles from the histogram (no sorting)
+// - Laplacian variance on the sampled grid: higher means more fine detail (in focus, not blurred by motion)
+// - Settle tracking across frames (FrameStats_Settle): AE/AWB convergence before a capture
+// - Checked on synthetic frames with known statistics in test/test_frame_stats
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stdint.h> // Fixed-width integer types
+#include "pixelKernels.h" // PIXEL_HISTOGRAM_BINS
+
+// Sampling step in both directions (frame pixels per sample)
+#define FRAME_STATS_STEP 2
+// Largest sample grid (QVGA preview frames)
+#define FRAME_STATS_MAX_COLS 160
+#define FRAME_STATS_MAX_ROWS 120
+// Luma at or below / at or above which a sample counts as clipped
+#define FRAME_STATS_SHADOW_LUMA 8
+#define FRAME_STATS_HIGHLIGHT_LUMA 247
+// The preview counts as settled (AE/AWB converged) once the mean luma and the red/blue cast
+// moved less than these between consecutive frames, FRAME_STATS_SETTLED_FRAMES times in a row
+#define FRAME_STATS_SETTLED_LUMA_TENTHS 20
+#define FRAME_STATS_SETTLED_RB_TENTHS 5
+#define FRAME_STATS_SETTLED_FRAMES 3
+
+// Statistics of one frame
+struct FrameStatsResult {
+    uint32_t samples;           // Samples taken
+    uint16_t meanTenths;        // Mean luma x10 (0..2550)
+    uint8_t p5, p50, p95;       // Luma percentiles
+    uint16_t shadowPermille;    // Samples at or below FRAME_STATS_SHADOW_LUMA
+    uint16_t highlightPermille; // Samples at or above FRAME_STATS_HIGHLIGHT_LUMA
+    uint32_t sharpness;         // Variance of the 4-neighbour Laplacian over the sampled grid
+    int16_t rbTenths;           // Mean red minus blue (5-bit channels) x10: the white balance cast
+};
+
+// Statistics state (about 20 KB: keep it in static or heap memory, not on a task stack)
+struct FrameStats {
+    int cols, rows;                                       // Sample grid of the last frame
+    FrameStatsResult result;                              // Statistics of the last frame
+    uint32_t histogram[PIXEL_HISTOGRAM_BINS];             // Luma histogram of the last frame
+    uint16_t row[FRAME_STATS_MAX_COLS];                   // Sampled pixels of one row
+    alignas(4) uint8_t luma[FRAME_STATS_MAX_COLS * FRAME_STATS_MAX_ROWS]; // Luma of the sample grid (word aligned for the overlay kernels)
+};
+
+// Convergence of the statistics over consecutive frames
+struct FrameStatsSettle {
+    bool primed;           // A previous frame is known
+    uint16_t meanTenths;   // Previous frame's mean luma
+    int16_t rbTenths;      // Previous frame's red/blue cast
+    uint32_t stableFrames; // Consecutive frames within the settle limits
+};
+
+/**
+ * @brief Compute the statistics of one frame.
+ * @param stats Statistics state (result and histogram are overwritten)
+ * @param frame RGB565 pixels in sensor (panel) byte order
+ * @param width Frame width (at most FRAME_STATS_MAX_COLS * FRAME_STATS_STEP)
+ * @param height Frame height (at most FRAME_STATS_MAX_ROWS * FRAME_STATS_STEP)
+ * @return false if the frame is empty or too large (result cleared)
+ */
+bool FrameStats_Process(FrameStats &stats, const uint16_t *frame, int width, int height);
+
+/**
+ * @brief Find a percentile in a luma histogram.
+ * @param histogram PIXEL_HISTOGRAM_BINS counters
+ * @param total Sum of the counters
+ * @param permille Percentile in per mille (500 = median)
+ * @return Lowest luma with at least permille of the samples at or below it
+ */
+uint8_t FrameStats_Percentile(const uint32_t *histogram, uint32_t total, int permille);
+
+/**
+ * @brief Track exposure/white balance convergence: feed every frame's result in order.
+ * @param settle Settle state (zero-initialize to start over)
+ * @param result Statistics of the next frame
+ * @return Consecutive stable frames so far (settled at FRAME_STATS_SETTLED_FRAMES or more)
+ */
+uint32_t FrameStats_Settle(FrameStatsSettle &settle, const FrameStatsResult &result);
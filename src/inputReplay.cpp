@@ -0,0 +1,150 @@
+// inputReplay.cpp - Deterministic input replay harness implementation
+// This module replays edge timelines through KeyGesture and UiState with a virtual clock.
+// The loop mirrors KeyTask: at each step it jumps to the earliest of the next edge and the
+// next recognizer deadline, ticks every key, then applies the edge.
+//
+// Key features:
+// - No sleeping: virtual time jumps straight to the next deadline or edge
+// - Gestures mapped to UI events through UiState_MapGesture, like KeyTask_DefaultHandler
+// - Scenarios (clicks, contact bounce, double click, long press, gallery) in test/test_input_replay
+
+#include "inputReplay.h" // Include header for this module
+#include <stdio.h> // sscanf
+#include <string.h> // strncmp, strchr
+
+/**
+ * @brief Record a gesture and apply its UI event.
+ * @param result Replay result to update
+ * @param key Key that produced the gesture
+ * @param gesture Recognized gesture
+ * @param nowMs Virtual decision time
+ * @param lastEdgeMs Time of the last edge of that key
+ * @param photoCount Photos on the simulated card
+ */
+static void InputReplay_Emit(ReplayResult &result, KeyId key, KeyGestureType gesture, uint32_t nowMs,
+                             uint32_t lastEdgeMs, int photoCount) {
+    if (result.eventCount < REPLAY_MAX_EVENTS) {
+        ReplayEvent &event = result.events[result.eventCount++];
+        event.timeMs = nowMs;
+        event.key = key;
+        event.gesture = gesture;
+        event.latencyMs = nowMs - lastEdgeMs;
+    }
+    DisplayEvent displayEvent;
+    if (UiState_MapGesture(key, gesture, displayEvent)) {
+        UiState_Apply(result.ui, displayEvent, photoCount);
+    }
+}
+
+/**
+ * @brief Replay an edge timeline through fresh key recognizers and a fresh UI state.
+ * Pending deadlines are drained after the last edge, so trailing single clicks are emitted.
+ * @param edges Edges sorted by time
+ * @param edgeCount Number of edges
+ * @param photoCount Number of the last photo on the simulated card (0 = none)
+ * @param result Receives the emitted gestures and the final UI state
+ */
+void InputReplay_Run(const ReplayEdge *edges, int edgeCount, int photoCount, ReplayResult &result) {
+    KeyGesture keys[KEY_ID_COUNT];
+    uint32_t lastEdgeMs[KEY_ID_COUNT] = {0};
+    result.eventCount = 0;
+    UiState_Reset(result.ui);
+    int next = 0;
+    while (true) {
+        // Earliest pending deadline over all keys
+        bool hasDeadline = false;
+        uint32_t wakeMs = 0;
+        for (int i = 0; i < KEY_ID_COUNT; i++) {
+            uint32_t deadline;
+            if (!keys[i].nextDeadline(deadline)) continue;
+            if (!hasDeadline || (int32_t)(deadline - wakeMs) < 0) wakeMs = deadline;
+            hasDeadline = true;
+        }
+        bool hasEdge = next < edgeCount;
+        if (!hasEdge && !hasDeadline) break; // Timeline done and nothing pending
+        if (hasEdge && (!hasDeadline || (int32_t)(edges[next].timeMs - wakeMs) <= 0)) {
+            wakeMs = edges[next].timeMs; // The edge comes first (KeyTask wakes on the queue)
+        } else {
+            hasEdge = false;
+        }
+        for (int i = 0; i < KEY_ID_COUNT; i++) { // Deadlines first, then the edge
+            KeyGestureType gesture = keys[i].onTick(wakeMs);
+            if (gesture != KEY_GESTURE_NONE) InputReplay_Emit(result, (KeyId)i, gesture, wakeMs, lastEdgeMs[i], photoCount);
+        }
+        if (hasEdge) {
+            const ReplayEdge &edge = edges[next++];
+            lastEdgeMs[edge.key] = edge.timeMs;
+            KeyGestureType gesture = keys[edge.key].onEdge(edge.pressed, edge.timeMs);
+            if (gesture != KEY_GESTURE_NONE) InputReplay_Emit(result, edge.key, gesture, wakeMs, edge.timeMs, photoCount);
+        }
+    }
+}
+
+/**
+ * @brief Get a short name for a key ("cam", "top", "mid", "down").
+ */
+const char *InputReplay_KeyName(KeyId key) {
+    static const char *names[KEY_ID_COUNT] = {"cam", "top", "mid", "down"};
+    return key < KEY_ID_COUNT ? names[key] : "?";
+}
+
+/**
+ * @brief Get a short name for a gesture ("single", "double", "long").
+ */
+const char *InputReplay_GestureName(KeyGestureType gesture) {
+    switch (gesture) {
+    case KEY_GESTURE_SINGLE: return "single";
+    case KEY_GESTURE_DOUBLE: return "double";
+    case KEY_GESTURE_LONG: return "long";
+    default: return "none";
+    }
+}
+
+/**
+ * @brief Parse a text timeline.
+ * Blank lines and lines starting with '#' are skipped. A leading "[Tag]" is ignored, so lines
+ * logged by KeyTask with KEY_LOG_EDGES can be pasted directly.
+ * @param text Timeline text, one "<timeMs> <key> <down|up>" edge per line
+ * @param edges Receives the parsed edges
+ * @param maxEdges Capacity of edges
+ * @return Number of edges parsed, or -1 on a malformed line or overflow
+ */
+int InputReplay_Parse(const char *text, ReplayEdge *edges, int maxEdges) {
+    int count = 0;
+    const char *line = text;
+    while (line && *line) {
+        const char *end = strchr(line, '\n');
+        int length = end ? (int)(end - line) : (int)strlen(line);
+        char buffer[64];
+        if (length >= (int)sizeof(buffer)) return -1; // Line too long to be an edge
+        memcpy(buffer, line, length);
+        buffer[length] = '\0';
+        line = end ? end + 1 : NULL;
+
+        const char *p = buffer;
+        while (*p == ' ' || *p == '\t' || *p == '\r') p++;
+        if (*p == '[') { // Skip a log tag such as "[KeyTask]"
+            const char *close = strchr(p, ']');
+            if (!close) return -1;
+            p = close + 1;
+        }
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0' || *p == '\r' || *p == '#') continue; // Blank line or comment
+
+        unsigned long timeMs;
+        char keyName[8], level[8];
+        if (sscanf(p, "%lu %7s %7s", &timeMs, keyName, level) != 3) return -1;
+        int key = -1;
+        for (int i = 0; i < KEY_ID_COUNT; i++) {
+            if (strcmp(keyName, InputReplay_KeyName((KeyId)i)) == 0) key = i;
+        }
+        bool pressed = strcmp(level, "down") == 0;
+        if (key < 0 || (!pressed && strcmp(level, "up") != 0)) return -1;
+        if (count >= maxEdges) return -1;
+        edges[count].timeMs = timeMs;
+        edges[count].key = (KeyId)key;
+        edges[count].pressed = pressed;
+        count++;
+    }
+    return count;
+}
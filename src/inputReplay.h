@@ -0,0 +1,71 @@
+// inputReplay.h - Deterministic input replay harness
+// This header declares a harness that feeds scripted or recorded key edge timelines into the
+// key gesture recognizer and the UI state machine with a virtual clock. It has no Arduino or
+// FreeRTOS dependencies, so it runs in the unit tests and replays key timelines in the native build.
+//
+// Key features:
+// - Virtual clock driven by KeyGesture::nextDeadline(), exactly like KeyTask sleeps
+// - Emitted gestures with their decision latency, and the final UiState
+// - Text timeline format "<timeMs> <cam|top|mid|down> <down|up>", one edge per line
+// - Regression tests for DOUBLE_CLICK_MS, LONG_PRESS_MS and DEBOUNCE_MS in test/test_input_replay
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stdint.h> // Fixed-width integer types
+#include "keyGesture.h" // Gesture recognizer
+#include "uiState.h" // UI state machine
+
+// Maximum number of gestures recorded per replay
+#define REPLAY_MAX_EVENTS 32
+
+// One raw key edge of a timeline
+struct ReplayEdge {
+    uint32_t timeMs; // Edge timestamp (milliseconds, non-decreasing)
+    KeyId key;       // Key that changed
+    bool pressed;    // Level after the edge (true = pressed)
+};
+
+// One gesture emitted during a replay
+struct ReplayEvent {
+    uint32_t timeMs;        // Virtual time the gesture was decided
+    KeyId key;              // Key that produced it
+    KeyGestureType gesture; // Recognized gesture
+    uint32_t latencyMs;     // Time from the last edge of that key to the decision
+};
+
+// Outcome of a replay
+struct ReplayResult {
+    ReplayEvent events[REPLAY_MAX_EVENTS]; // Emitted gestures, in order
+    int eventCount;                        // Number of valid entries in events
+    UiState ui;                            // UI state after the last gesture
+};
+
+/**
+ * @brief Replay an edge timeline through fresh key recognizers and a fresh UI state.
+ * Pending deadlines are drained after the last edge, so trailing single clicks are emitted.
+ * @param edges Edges sorted by time
+ * @param edgeCount Number of edges
+ * @param photoCount Number of the last photo on the simulated card (0 = none)
+ * @param result Receives the emitted gestures and the final UI state
+ */
+void InputReplay_Run(const ReplayEdge *edges, int edgeCount, int photoCount, ReplayResult &result);
+
+/**
+ * @brief Parse a text timeline.
+ * Blank lines and lines starting with '#' are skipped. A leading "[Tag]" is ignored, so lines
+ * logged by KeyTask with KEY_LOG_EDGES can be pasted directly.
+ * @param text Timeline text, one "<timeMs> <key> <down|up>" edge per line
+ * @param edges Receives the parsed edges
+ * @param maxEdges Capacity of edges
+ * @return Number of edges parsed, or -1 on a malformed line or overflow
+ */
+int InputReplay_Parse(const char *text, ReplayEdge *edges, int maxEdges);
+
+/**
+ * @brief Get a short name for a key ("cam", "top", "mid", "down").
+ */
+const char *InputReplay_KeyName(KeyId key);
+
+/**
+ * @brief Get a short name for a gesture ("single", "double", "long").
+ */
+const char *InputReplay_GestureName(KeyGestureType gesture);
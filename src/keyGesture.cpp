@@ -0,0 +1,108 @@
+// keyGesture.cpp - Key debouncer and gesture recognizer implementation
+// This module implements the KeyGesture state machine. The gesture rules match the original
+// polled handleKey logic; only the time source changed from millis() polling to edge timestamps.
+//
+// Key features:
+// - First edge accepted immediately, later edges within DEBOUNCE_MS resolved when the lockout ends
+// - Double click is decided on the second press, single click after DOUBLE_CLICK_MS without one
+// - Long press decided while held; its release produces nothing
+
+#include "keyGesture.h" // Include header for this module
+
+/**
+ * @brief Create a recognizer for a released key.
+ */
+KeyGesture::KeyGesture()
+    : state(IDLE), rawPressed(false), stablePressed(false), hasAccepted(false),
+      lastAcceptedMs(0), pressStartMs(0), lastReleaseMs(0) {}
+
+/**
+ * @brief Apply a debounced level change to the gesture state machine.
+ * @param pressed New debounced level
+ * @param nowMs Time of the change
+ * @return Gesture decided by this change, or KEY_GESTURE_NONE
+ */
+KeyGestureType KeyGesture::accept(bool pressed, uint32_t nowMs) {
+    if (pressed == stablePressed) return KEY_GESTURE_NONE; // Bounced back to the same level
+    stablePressed = pressed;
+    hasAccepted = true;
+    lastAcceptedMs = nowMs;
+    if (pressed) {
+        if (state == IDLE) {
+            pressStartMs = nowMs; // Record press time
+            state = PRESSED;
+        } else if (state == WAIT_SECOND && nowMs - lastReleaseMs < DOUBLE_CLICK_MS) {
+            state = IDLE; // Release of the second press is ignored
+            return KEY_GESTURE_DOUBLE;
+        }
+    } else {
+        if (state == PRESSED) {
+            lastReleaseMs = nowMs; // Record release time
+            state = WAIT_SECOND; // Wait for possible double click
+        } else if (state == LONG_PRESSED) {
+            state = IDLE;
+        }
+    }
+    return KEY_GESTURE_NONE;
+}
+
+/**
+ * @brief Feed a raw edge.
+ * @param pressed Level after the edge (true = pressed)
+ * @param nowMs Edge timestamp in milliseconds
+ * @return Gesture decided by this edge, or KEY_GESTURE_NONE
+ */
+KeyGestureType KeyGesture::onEdge(bool pressed, uint32_t nowMs) {
+    rawPressed = pressed;
+    if (hasAccepted && nowMs - lastAcceptedMs < DEBOUNCE_MS) {
+        return KEY_GESTURE_NONE; // Inside the lockout, settled by onTick
+    }
+    return accept(pressed, nowMs);
+}
+
+/**
+ * @brief Advance time without an edge (debounce settle, long press, double click timeout).
+ * @param nowMs Current time in milliseconds
+ * @return Gesture decided by the passage of time, or KEY_GESTURE_NONE
+ */
+KeyGestureType KeyGesture::onTick(uint32_t nowMs) {
+    if (rawPressed != stablePressed && nowMs - lastAcceptedMs >= DEBOUNCE_MS) {
+        KeyGestureType gesture = accept(rawPressed, nowMs); // Level settled after the lockout
+        if (gesture != KEY_GESTURE_NONE) return gesture;
+    }
+    if (state == PRESSED && nowMs - pressStartMs > LONG_PRESS_MS) {
+        state = LONG_PRESSED;
+        return KEY_GESTURE_LONG;
+    }
+    if (state == WAIT_SECOND && nowMs - lastReleaseMs > DOUBLE_CLICK_MS) {
+        state = IDLE;
+        return KEY_GESTURE_SINGLE;
+    }
+    return KEY_GESTURE_NONE;
+}
+
+/**
+ * @brief Get the next time onTick() may produce something.
+ * @param deadlineMs Receives the deadline in milliseconds
+ * @return false if nothing is pending (sleep until the next edge)
+ */
+bool KeyGesture::nextDeadline(uint32_t &deadlineMs) const {
+    bool pending = false;
+    uint32_t base = lastAcceptedMs; // Deadlines are compared relative to a recent time to survive wrap-around
+    uint32_t best = 0;
+    if (rawPressed != stablePressed) {
+        best = DEBOUNCE_MS;
+        pending = true;
+    }
+    if (state == PRESSED) {
+        uint32_t d = pressStartMs + LONG_PRESS_MS + 1 - base;
+        if (!pending || d < best) best = d;
+        pending = true;
+    } else if (state == WAIT_SECOND) {
+        uint32_t d = lastReleaseMs + DOUBLE_CLICK_MS + 1 - base;
+        if (!pending || d < best) best = d;
+        pending = true;
+    }
+    deadlineMs = base + best;
+    return pending;
+}
@@ -0,0 +1,80 @@
+// keyGesture.h - Key debouncer and gesture recognizer
+// This header declares the per-key state machine that turns timestamped raw edges into
+// single click, double click and long press gestures.
+// It has no Arduino or FreeRTOS dependencies and is driven purely by the timestamps it is given,
+// so it runs the same on the device (KeyTask) and on the host with a virtual clock.
+//
+// Key features:
+// - Edge debouncing with immediate acceptance of the first edge (no added press latency)
+// - Single, double and long press detection (DOUBLE_CLICK_MS, LONG_PRESS_MS)
+// - nextDeadline() tells the caller when to wake up next, so no periodic polling is needed
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stdint.h> // Fixed-width integer types
+
+// Timing constants for key event detection (in milliseconds)
+#define DOUBLE_CLICK_MS 400 // Max interval between clicks for double click
+#define LONG_PRESS_MS 800   // Min duration for long press
+#define DEBOUNCE_MS 30      // Edges closer than this to the last accepted edge are contact bounce
+
+// Gestures reported by the recognizer
+enum KeyGestureType {
+    KEY_GESTURE_NONE,   // Nothing decided
+    KEY_GESTURE_SINGLE, // Press + release, no second press within DOUBLE_CLICK_MS
+    KEY_GESTURE_DOUBLE, // Second press within DOUBLE_CLICK_MS of the first release
+    KEY_GESTURE_LONG    // Held longer than LONG_PRESS_MS
+};
+
+/**
+ * @brief Debouncer and gesture state machine for one key.
+ * Call onTick(now) whenever the deadline passes or before onEdge(), and onEdge() for each raw edge.
+ */
+class KeyGesture {
+public:
+    KeyGesture();
+
+    /**
+     * @brief Feed a raw edge.
+     * @param pressed Level after the edge (true = pressed)
+     * @param nowMs Edge timestamp in milliseconds
+     * @return Gesture decided by this edge, or KEY_GESTURE_NONE
+     */
+    KeyGestureType onEdge(bool pressed, uint32_t nowMs);
+
+    /**
+     * @brief Advance time without an edge (debounce settle, long press, double click timeout).
+     * @param nowMs Current time in milliseconds
+     * @return Gesture decided by the passage of time, or KEY_GESTURE_NONE
+     */
+    KeyGestureType onTick(uint32_t nowMs);
+
+    /**
+     * @brief Get the next time onTick() may produce something.
+     * @param deadlineMs Receives the deadline in milliseconds
+     * @return false if nothing is pending (sleep until the next edge)
+     */
+    bool nextDeadline(uint32_t &deadlineMs) const;
+
+    /**
+     * @brief Check whether the key is currently considered pressed (debounced).
+     */
+    bool isPressed() const { return stablePressed; }
+
+private:
+    enum State {
+        IDLE,         // No press
+        PRESSED,      // Key is pressed
+        WAIT_SECOND,  // Released, waiting for a second press (double click)
+        LONG_PRESSED  // Held past LONG_PRESS_MS, waiting for release
+    };
+
+    KeyGestureType accept(bool pressed, uint32_t nowMs);
+
+    State state;
+    bool rawPressed;          // Level of the last raw edge
+    bool stablePressed;       // Debounced level
+    bool hasAccepted;         // At least one edge accepted (lockout active)
+    uint32_t lastAcceptedMs;  // Time of the last accepted edge
+    uint32_t pressStartMs;    // Time of the current press
+    uint32_t lastReleaseMs;   // Time of the last release (for double click)
+};
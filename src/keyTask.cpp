@@ -1,156 +1,192 @@
 // keyTask.cpp - Key input task implementation
-// This module implements debounced, interrupt-driven key/button input handling for the ESP32 system.
-// It supports single, double, and long press detection for four keys, and controls a flash LED.
-// Key events are used for camera shutter, navigation, and UI mode switching.
+// This module implements interrupt-driven key/button input handling for the ESP32 system.
+// GPIO interrupts timestamp each edge and push it to a queue; KeyTask sleeps on that queue,
+// feeds the edges to one KeyGesture recognizer per key, and delivers typed input events
+// to subscribers. The task only wakes for edges and gesture deadlines.
 //
 // Key features:
-// - Interrupt-based key press detection (fast, low-latency)
-// - Debouncing and state machine for reliable input
-// - Single, double, and long press event detection
+// - Edge ISRs (both directions) with microsecond timestamps
+// - Debouncing and single/double/long press recognition driven by timestamps
+// - Subscriber list for typed InputEvent delivery
+// - Wake-up and press-to-action latency metrics
 // - Flash LED control for camera
-// - Key state variables for UI logic
 
 #include "keyTask.h" // Include header for this module
+#include <esp_timer.h> // Microsecond clock
+#include <hal/gpio_ll.h> // ISR-safe GPIO level read
+#include <driver/gpio.h> // Light sleep wake-up pins
+#include <esp_sleep.h> // Light sleep wake-up sources
+#include "metrics.h" // Input counters
+#include "config.h" // KEY_LOG_EDGES switch
+#include "inputReplay.h" // Key names for edge logging
 
-// Timing constants for key event detection (in milliseconds)
-#define DOUBLE_CLICK_MS 400 // Max interval between clicks for double click
-#define LONG_PRESS_MS 800   // Min duration for long press
-#define DEBOUNCE_MS 100     // Debounce time for key press
-
-// Enumeration for key state machine
-enum KeyState {
-    KEY_IDLE,         // No press
-    KEY_PRESSED,      // Key is pressed
-    KEY_WAIT_SECOND,  // Waiting for second press (double click)
-    KEY_LONG_PRESSED  // Key is held for long press
+// One raw edge captured by an ISR
+struct KeyEdge {
+    uint8_t key;     // KeyId
+    uint8_t pressed; // 1 = pressed (pin low), 0 = released
+    int64_t timeUs;  // Edge timestamp (esp_timer)
 };
 
 // Structure to hold key information and state
 struct KeyInfo {
     int pin;              // GPIO pin number for the key
-    KeyState state;       // Current state of the key
-    unsigned long pressStart; // Timestamp when key was pressed
-    unsigned long lastPress;  // Timestamp of last release (for double click)
-    bool flag;            // Set by ISR when key is pressed (interrupt flag)
-    bool skipSingle;      // Skip single click if double/long detected
+    const char *name;     // Name of the key (for debug output)
+    KeyGesture gesture;   // Debouncer and gesture recognizer
+    int64_t pressStartUs; // Timestamp of the last accepted press
 };
 
-// Array of all keys (camera, top, mid, down)
-KeyInfo keyArray[4] = {
-    {KEY_CAM_PIN, KEY_IDLE, 0, 0, false, true}, // Camera shutter key
-    {KEY_TOP_PIN, KEY_IDLE, 0, 0, false, true}, // Top navigation key
-    {KEY_MID_PIN, KEY_IDLE, 0, 0, false, true}, // Middle key
-    {KEY_DOWN_PIN, KEY_IDLE, 0, 0, false, true} // Down navigation key
+// Array of all keys (camera, top, mid, down), indexed by KeyId
+KeyInfo keyArray[KEY_ID_COUNT] = {
+    {KEY_CAM_PIN, "Cam", KeyGesture(), 0},  // Camera shutter key
+    {KEY_TOP_PIN, "Top", KeyGesture(), 0},  // Top navigation key
+    {KEY_MID_PIN, "Mid", KeyGesture(), 0},  // Middle key
+    {KEY_DOWN_PIN, "Down", KeyGesture(), 0} // Down navigation key
 };
 
-// Key state variables for UI logic
-int keyMidState = 0;   // 0 = preview mode, 1 = gallery mode
-int keyTopState = 0;   // 1 = pressed, 0 = released
-int keyDownState = 0;  // 1 = pressed, 0 = released
+// Queue of raw edges from the ISRs to KeyTask
+static QueueHandle_t keyEdgeQueue;
+// Input event subscribers
+static InputHandler subscriberHandlers[KEY_MAX_SUBSCRIBERS];
+static void *subscriberArgs[KEY_MAX_SUBSCRIBERS];
+static int subscriberCount = 0;
+
+/**
+ * @brief Queue an edge from interrupt context.
+ * @param key Key that changed
+ */
+static inline void IRAM_ATTR KeyTask_QueueEdge(KeyId key) {
+    KeyEdge edge;
+    edge.key = key;
+    edge.pressed = gpio_ll_get_level(&GPIO, (gpio_num_t)keyArray[key].pin) == 0; // Active low
+    edge.timeUs = esp_timer_get_time();
+    BaseType_t woken = pdFALSE;
+    xQueueSendFromISR(keyEdgeQueue, &edge, &woken); // Dropped if full (bounce storm)
+    if (woken) portYIELD_FROM_ISR();
+}
+
+// Interrupt Service Routines (ISR) for each key (both edges)
+void IRAM_ATTR onKeyCam() { KeyTask_QueueEdge(KEY_ID_CAM); }
+void IRAM_ATTR onKeyTop() { KeyTask_QueueEdge(KEY_ID_TOP); }
+void IRAM_ATTR onKeyMid() { KeyTask_QueueEdge(KEY_ID_MID); }
+void IRAM_ATTR onKeyDown() { KeyTask_QueueEdge(KEY_ID_DOWN); }
 
-// Interrupt Service Routines (ISR) for each key
-// These are called on falling edge (key press) and set the flag for the main task
-void IRAM_ATTR onKeyCam() { keyArray[0].flag = true; }
-void IRAM_ATTR onKeyTop() { keyArray[1].flag = true; }
-void IRAM_ATTR onKeyMid() { keyArray[2].flag = true; }
-void IRAM_ATTR onKeyDown() { keyArray[3].flag = true; }
+/**
+ * @brief Default subscriber: camera key takes photos, other keys drive the UI.
+ * Camera key: single = take photo, double/long = take photo with flash.
+ * Other keys: mapped to display events by UiState_MapGesture (the button layout).
+ * @param event Recognized input event
+ * @param arg Not used
+ */
+static void KeyTask_DefaultHandler(const InputEvent &event, void *arg) {
+    if (event.key == KEY_ID_CAM) {
+        if (event.gesture == KEY_GESTURE_SINGLE) {
+            Serial.println("[KeyTask] Photo taken (single).");
+            DisplayTask_SavePhoto();
+        } else {
+            Serial.printf("[KeyTask] Photo taken with flash (%s).\n", event.gesture == KEY_GESTURE_DOUBLE ? "double" : "long");
+            DisplayTask_SavePhoto(true);
+        }
+        return;
+    }
+    DisplayEvent displayEvent;
+    if (UiState_MapGesture(event.key, event.gesture, displayEvent)) {
+        DisplayTask_PostEvent(displayEvent);
+    }
+}
 
 /**
- * @brief Initialize all keys and the flash LED, set up interrupts.
- * Configures GPIO pins, sets up pull-ups, and attaches ISRs for each key.
+ * @brief Initialize all keys and the flash LED, set up interrupts and the edge queue.
+ * Configures GPIO pins, sets up pull-ups, and attaches ISRs for both edges of each key.
  */
 void KeyTask_Init() {
-    for (int i = 0; i < 4; i++) {
+    keyEdgeQueue = xQueueCreate(KEY_EDGE_QUEUE_LEN, sizeof(KeyEdge)); // Create edge queue
+    for (int i = 0; i < KEY_ID_COUNT; i++) {
         pinMode(keyArray[i].pin, INPUT_PULLUP); // Set key pin as input with pull-up
     }
     pinMode(LED_FLASH_PIN, OUTPUT); // Set flash LED pin as output
     digitalWrite(LED_FLASH_PIN, HIGH); // Turn off flash LED (active low)
-    // Attach interrupts for each key (falling edge = press)
-    attachInterrupt(digitalPinToInterrupt(KEY_CAM_PIN), onKeyCam, FALLING);
-    attachInterrupt(digitalPinToInterrupt(KEY_TOP_PIN), onKeyTop, FALLING);
-    attachInterrupt(digitalPinToInterrupt(KEY_MID_PIN), onKeyMid, FALLING);
-    attachInterrupt(digitalPinToInterrupt(KEY_DOWN_PIN), onKeyDown, FALLING);
+    // Attach interrupts for each key (both edges: press and release)
+    attachInterrupt(digitalPinToInterrupt(KEY_CAM_PIN), onKeyCam, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(KEY_TOP_PIN), onKeyTop, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(KEY_MID_PIN), onKeyMid, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(KEY_DOWN_PIN), onKeyDown, CHANGE);
+    KeyTask_Subscribe(KeyTask_DefaultHandler, NULL); // Camera and UI actions
     Serial.println("[KeyTask] Keys initialized."); // Debug output
 }
 
 /**
- * @brief Handle key state machine and event detection for a single key.
- * Detects single, double, and long press events, and calls the appropriate callback.
- * @param key Reference to KeyInfo struct for this key
- * @param name Name of the key (for debug output)
- * @param stateVar Reference to state variable for this key (for UI logic)
- * @param singleClick Callback for single click event
- * @param doubleClick Callback for double click event
- * @param longPress Callback for long press event
+ * @brief Subscribe to input events.
+ * @param handler Called from KeyTask for every recognized gesture
+ * @param arg User argument passed to the handler
+ * @return true if subscribed, false if the subscriber table is full
  */
-void handleKey(KeyInfo &key, const char *name, int &stateVar, void (*singleClick)(), void (*doubleClick)(), void (*longPress)()) {
-    unsigned long now = millis(); // Current time
-    if (key.flag) { // If ISR set the flag (key pressed)
-        key.flag = false; // Clear flag
-        if (key.state == KEY_IDLE) {
-            key.pressStart = now; // Record press time
-            key.state = KEY_PRESSED; // Go to pressed state
-            key.skipSingle = false; // Reset skip flag
-        } else if (key.state == KEY_WAIT_SECOND && (now - key.lastPress) < DOUBLE_CLICK_MS) {
-            if (doubleClick) doubleClick(); // Call double click callback
-            Serial.printf("[KeyTask] %s double click.\n", name);
-            key.state = KEY_IDLE; // Reset state
-            key.skipSingle = true; // Skip single click
-        }
-    }
-    if (key.state == KEY_PRESSED && (now - key.pressStart > LONG_PRESS_MS)) {
-        if (longPress) longPress(); // Call long press callback
-        Serial.printf("[KeyTask] %s long press.\n", name);
-        key.state = KEY_LONG_PRESSED; // Go to long pressed state
-        key.skipSingle = true; // Skip single click
-    }
-    if ((key.state == KEY_PRESSED || key.state == KEY_LONG_PRESSED) && digitalRead(key.pin) == HIGH) {
-        if (key.state == KEY_PRESSED) {
-            key.lastPress = now; // Record release time
-            key.state = KEY_WAIT_SECOND; // Wait for possible double click
-        } else {
-            key.state = KEY_IDLE; // Reset state
-        }
-    }
-    if (key.state == KEY_WAIT_SECOND && (now - key.lastPress > DOUBLE_CLICK_MS)) {
-        if (!key.skipSingle && singleClick) {
-            singleClick(); // Call single click callback
-            Serial.printf("[KeyTask] %s single click.\n", name);
-        }
-        key.state = KEY_IDLE; // Reset state
-    }
+bool KeyTask_Subscribe(InputHandler handler, void *arg) {
+    if (subscriberCount >= KEY_MAX_SUBSCRIBERS) return false;
+    subscriberHandlers[subscriberCount] = handler;
+    subscriberArgs[subscriberCount] = arg;
+    ++subscriberCount;
+    return true;
 }
 
-// Callback functions for each key event
-// Camera key: single = take photo, double/long = take photo with flash
-void camSingleClick() { Serial.println("[KeyTask] Photo taken (single)."); DisplayTask_SavePhoto(); }
-void camDoubleClick() { Serial.println("[KeyTask] Photo taken with flash (double)."); KeyTask_SetLED(true); DisplayTask_SavePhoto(); KeyTask_SetLED(false); }
-void camLongPress() { Serial.println("[KeyTask] Photo taken with flash (long)."); KeyTask_SetLED(true); DisplayTask_SavePhoto(); KeyTask_SetLED(false); }
-// Top key: single = set state for mode up
-void topSingleClick() { keyTopState = 1; }
-void topDoubleClick() {}
-void topLongPress() {}
-// Middle key: single = toggle gallery/preview
-void midSingleClick() { keyMidState = !keyMidState; }
-void midDoubleClick() {}
-void midLongPress() {}
-// Down key: single = set state for mode down
-void downSingleClick() { keyDownState = 1; }
-void downDoubleClick() {}
-void downLongPress() {}
+/**
+ * @brief Deliver a recognized gesture to all subscribers and record its latency.
+ * @param key Key that produced the gesture
+ * @param gesture Recognized gesture
+ * @param decidedUs Time of the edge or deadline that decided the gesture
+ */
+static void KeyTask_Dispatch(KeyId key, KeyGestureType gesture, int64_t decidedUs) {
+    static const char *gestureNames[] = {"none", "single click", "double click", "long press"};
+    InputEvent event = {key, gesture, keyArray[key].pressStartUs, decidedUs};
+    Metrics_Observe(METRIC_HIST_INPUT_LATENCY, esp_timer_get_time() - decidedUs); // Decision-to-action
+    Serial.printf("[KeyTask] %s %s (%d ms after press).\n", keyArray[key].name, gestureNames[gesture],
+                  (int)((esp_timer_get_time() - event.pressUs) / 1000)); // Press-to-action latency
+    for (int i = 0; i < subscriberCount; i++) {
+        subscriberHandlers[i](event, subscriberArgs[i]);
+    }
+}
 
 /**
- * @brief Main key input task loop. Handles debouncing and event detection for all keys.
- * Should be run as a FreeRTOS task. Continuously checks key states and calls event handlers.
+ * @brief Main key input task loop.
+ * Sleeps on the edge queue until an edge arrives or the earliest gesture deadline passes,
+ * then advances every recognizer and dispatches the gestures they produce.
  * @param pvParameters Not used (for FreeRTOS compatibility)
  */
 void KeyTask(void *pvParameters) {
     while (1) {
-        handleKey(keyArray[0], "Cam", keyMidState, camSingleClick, camDoubleClick, camLongPress); // Camera key
-        handleKey(keyArray[1], "Top", keyTopState, topSingleClick, topDoubleClick, topLongPress); // Top key
-        handleKey(keyArray[2], "Mid", keyMidState, midSingleClick, midDoubleClick, midLongPress); // Middle key
-        handleKey(keyArray[3], "Down", keyDownState, downSingleClick, downDoubleClick, downLongPress); // Down key
-        vTaskDelay(10 / portTICK_PERIOD_MS); // Small delay to yield CPU
+        // Earliest pending deadline over all keys
+        uint32_t nowMs = esp_timer_get_time() / 1000;
+        TickType_t wait = portMAX_DELAY;
+        for (int i = 0; i < KEY_ID_COUNT; i++) {
+            uint32_t deadline;
+            if (!keyArray[i].gesture.nextDeadline(deadline)) continue;
+            int32_t remaining = (int32_t)(deadline - nowMs);
+            TickType_t ticks = remaining > 0 ? pdMS_TO_TICKS(remaining) + 1 : 0;
+            if (ticks < wait) wait = ticks;
+        }
+        KeyEdge edge;
+        bool hasEdge = xQueueReceive(keyEdgeQueue, &edge, wait) == pdTRUE; // Sleep
+        Metrics_Add(METRIC_KEY_WAKEUPS);
+        int64_t nowUs = hasEdge ? edge.timeUs : esp_timer_get_time();
+        nowMs = nowUs / 1000;
+        for (int i = 0; i < KEY_ID_COUNT; i++) { // Deadlines first, then the edge
+            uint32_t deadline = nowMs;
+            keyArray[i].gesture.nextDeadline(deadline);
+            KeyGestureType gesture = keyArray[i].gesture.onTick(nowMs);
+            if (gesture != KEY_GESTURE_NONE) {
+                int32_t late = (int32_t)(nowMs - deadline); // How long after its deadline we woke up
+                KeyTask_Dispatch((KeyId)i, gesture, nowUs - (late > 0 ? late : 0) * 1000LL);
+            }
+        }
+        if (hasEdge) {
+#if defined(KEY_LOG_EDGES)
+            Serial.printf("[KeyTask] %u %s %s\n", (unsigned)nowMs, InputReplay_KeyName((KeyId)edge.key), edge.pressed ? "down" : "up");
+#endif
+            KeyInfo &key = keyArray[edge.key];
+            bool wasPressed = key.gesture.isPressed();
+            KeyGestureType gesture = key.gesture.onEdge(edge.pressed, nowMs);
+            if (!wasPressed && key.gesture.isPressed()) key.pressStartUs = edge.timeUs;
+            if (gesture != KEY_GESTURE_NONE) KeyTask_Dispatch((KeyId)edge.key, gesture, edge.timeUs);
+        }
     }
 }
 
@@ -160,4 +196,26 @@ void KeyTask(void *pvParameters) {
  */
 void KeyTask_SetLED(bool on) {
     digitalWrite(LED_FLASH_PIN, on ? LOW : HIGH); // Active low: LOW = on, HIGH = off
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Let a low level on any key wake the chip from light sleep (timelapse mode).
+ * The keys are active low with pull-ups, so a press wakes the chip. Wake-up needs level
+ * interrupts, so call KeyTask_DisableSleepWakeup right after waking to get the edge ISRs back.
+ */
+void KeyTask_EnableSleepWakeup() {
+    for (int i = 0; i < KEY_ID_COUNT; i++) {
+        gpio_wakeup_enable((gpio_num_t)keyArray[i].pin, GPIO_INTR_LOW_LEVEL);
+    }
+    esp_sleep_enable_gpio_wakeup();
+}
+
+/**
+ * @brief Undo KeyTask_EnableSleepWakeup: restore edge interrupts on the key pins.
+ */
+void KeyTask_DisableSleepWakeup() {
+    for (int i = 0; i < KEY_ID_COUNT; i++) {
+        gpio_wakeup_disable((gpio_num_t)keyArray[i].pin);
+        gpio_set_intr_type((gpio_num_t)keyArray[i].pin, GPIO_INTR_ANYEDGE); // As attached with CHANGE
+    }
+}
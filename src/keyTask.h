@@ -1,17 +1,19 @@
 // keyTask.h - Key input task module
-// This header declares all functions and variables related to the key/button input task.
-// It provides interfaces for initializing keys, handling key events, controlling the flash LED,
-// and managing key states for camera/photo navigation and UI interaction.
+// This header declares all functions and types related to the key/button input task.
+// It provides interfaces for initializing keys, subscribing to typed input events,
+// and controlling the flash LED.
 //
 // Key features:
-// - Debounced, interrupt-driven key input
-// - Single, double, and long press detection
+// - GPIO interrupts timestamp every edge and queue it (no polling)
+// - Debouncing and single/double/long press recognition (keyGesture.h)
+// - Typed input events delivered to subscribers
 // - Flash LED control
-// - Key state variables for UI logic
 
 #pragma once // Prevent multiple inclusion of this header
 #include <Arduino.h> // Arduino core library
 #include "displayTask.h" // For display feedback
+#include "keyGesture.h" // Gesture types
+#include "uiState.h" // Key identifiers
 
 // Pin definitions for keys and flash LED (change according to your hardware)
 #define KEY_CAM_PIN 10      // Camera shutter key (take photo)
@@ -20,16 +22,35 @@
 #define KEY_DOWN_PIN 7      // Down navigation key (mode down/next)
 #define LED_FLASH_PIN 6     // Flash LED control pin
 
-// Key state variables (used by display task and others)
-extern int keyTopState;     // State of the top key (1 = pressed, 0 = released)
-extern int keyMidState;     // State of the middle key (toggle: 0 = preview, 1 = gallery)
-extern int keyDownState;    // State of the down key (1 = pressed, 0 = released)
+// Length of the ISR edge queue
+#define KEY_EDGE_QUEUE_LEN 16
+// Maximum number of input event subscribers
+#define KEY_MAX_SUBSCRIBERS 4
+
+// Typed input event delivered to subscribers
+struct InputEvent {
+    KeyId key;               // Key that produced the gesture
+    KeyGestureType gesture;  // Single, double or long press
+    int64_t pressUs;         // Time the gesture's press started (esp_timer)
+    int64_t decidedUs;       // Time the input that decided the gesture happened (edge or deadline)
+};
+
+// Input event subscriber (called from KeyTask)
+typedef void (*InputHandler)(const InputEvent &event, void *arg);
 
 /**
- * @brief Initialize all keys and the flash LED, set up interrupts.
+ * @brief Initialize all keys and the flash LED, set up interrupts and the edge queue.
  */
 void KeyTask_Init();
 
+/**
+ * @brief Subscribe to input events.
+ * @param handler Called from KeyTask for every recognized gesture
+ * @param arg User argument passed to the handler
+ * @return true if subscribed, false if the subscriber table is full
+ */
+bool KeyTask_Subscribe(InputHandler handler, void *arg);
+
 /**
  * @brief Control the flash LED (on/off).
  * @param on true to turn on, false to turn off
@@ -37,7 +58,17 @@ void KeyTask_Init();
 void KeyTask_SetLED(bool on);
 
 /**
- * @brief Main key input task loop. Handles debouncing and event detection.
+ * @brief Let a low level on any key wake the chip from light sleep (timelapse mode).
+ */
+void KeyTask_EnableSleepWakeup();
+
+/**
+ * @brief Undo KeyTask_EnableSleepWakeup: restore edge interrupts on the key pins.
+ */
+void KeyTask_DisableSleepWakeup();
+
+/**
+ * @brief Main key input task loop. Sleeps until an edge arrives or a gesture deadline passes.
  * @param pvParameters Not used (for FreeRTOS compatibility)
  */
-void KeyTask(void *pvParameters);
\ No newline at end of file
+void KeyTask(void *pvParameters);
@@ -6,7 +6,7 @@
 // - Initializes serial port for debugging
 // - Initializes display, keys, SD card, camera, and web server
 // - Starts FreeRTOS tasks for camera, display, web server, and key input
-// - Main loop is empty (all logic is in tasks)
+// - Main loop serves a small serial command console (diagnostics)
 
 #include <SD.h>            // SD card library
 #include <Arduino.h>       // Arduino core library
@@ -16,6 +16,13 @@
 #include "tfCard.h"        // SD card module
 #include "webTask.h"       // Web server module
 #include "keyTask.h"       // Key input module
+#include "trace.h"         // Event tracing
+#include "taskConfig.h"    // Task placement table
+#include "profiler.h"      // Per-task CPU and stack profiling
+#include "bench.h"         // Pixel kernel benchmarks
+#include "motionTask.h"    // Motion detection
+#include "videoTask.h"     // Video recording
+#include "timelapseTask.h" // Timelapse mode
 
 // Mutex for camera access (if needed for thread safety)
 SemaphoreHandle_t cameraMutex;
@@ -29,24 +36,82 @@ void setup() {
     Serial.begin(115200); // Start serial port for debugging
     Serial.println("[Main] System setup started."); // Debug output
     cameraMutex = xSemaphoreCreateMutex(); // Create mutex for camera access
+#if defined(ENABLE_TRACE)
+    Trace_Init(); // Allocate trace rings before any task records events
+#endif
     DisplayTask_Init(); // Initialize TFT display
     KeyTask_Init();     // Initialize keys and flash LED
     TfCard_Init();      // Initialize SD card
     CameraTask_InitPreviewConfig(); // Set camera to preview mode
     CameraTask_Init(); // Initialize camera hardware
+    DisplayTask_InitEvents(); // Display event loop (needs the camera frame queue)
     WebTask_Init();    // Initialize web server
+    VideoTask_Init();  // Video recorder tasks (idle until a recording is requested)
+    TimelapseTask_Init(); // Timelapse task (idle until a timelapse is requested)
+#if defined(ENABLE_MOTION)
+    MotionTask_Init(); // Motion detector (fed by DisplayTask)
+#endif
     // Start FreeRTOS tasks for camera, display, web server, and key input
-    xTaskCreatePinnedToCore(CameraTask, "CameraTask", 4096, NULL, 1, &cameraTaskHandle, 0);
-    xTaskCreatePinnedToCore(DisplayTask, "DisplayTask", 4096, NULL, 1, NULL, 1);
-    xTaskCreatePinnedToCore(WebTask, "WebTask", 4096, NULL, 1, NULL, 1);
-    xTaskCreatePinnedToCore(KeyTask, "KeyTask", 4096, NULL, 3, NULL, 1);
+    // (stack sizes, priorities and cores come from taskConfigTable)
+    TaskConfig_Start(TASK_CAMERA, CameraTask, NULL, &cameraTaskHandle);
+    TaskConfig_Start(TASK_DISPLAY, DisplayTask, NULL, NULL);
+    TaskConfig_Start(TASK_WEB, WebTask, NULL, NULL);
+    TaskConfig_Start(TASK_KEY, KeyTask, NULL, NULL);
+#if defined(ENABLE_MOTION)
+    TaskConfig_Start(TASK_MOTION, MotionTask, NULL, NULL);
+#endif
+    Profiler_Init(); // Start run-time statistics sampling
     Serial.println("[Main] System setup completed."); // Debug output
 }
 
 /**
- * @brief Arduino main loop. Not used (all logic is in FreeRTOS tasks).
+ * @brief Arduino main loop. Serves the serial command console; all other logic is in FreeRTOS tasks.
+ * Commands: "profile" (per-task CPU/stack table), "bench [filter]" (pixel kernel benchmarks),
+ * "record" (start/stop video recording), "timelapse start [seconds]", "timelapse stop",
+ * "trace" (dump Chrome trace JSON), "trace clear".
  */
-void loop() {}
+void loop() {
+    if (!Serial.available()) {
+        delay(50); // Nothing to do, yield CPU
+        return;
+    }
+    String command = Serial.readStringUntil('\n'); // Read one command line
+    command.trim();
+    bool handled = command.length() == 0; // Ignore empty lines
+    if (command == "profile") {
+        Profiler_PrintSerial();
+        handled = true;
+    } else if (command == "bench" || command.startsWith("bench ")) {
+        String filter = command.substring(5); // Optional case name filter
+        filter.trim();
+        Bench_Run(Serial, filter.c_str());
+        handled = true;
+    } else if (command == "record") {
+        VideoTask_Toggle();
+        handled = true;
+    } else if (command == "timelapse start" || command.startsWith("timelapse start ")) {
+        long seconds = command.substring(15).toInt(); // Optional interval
+        if (seconds > 0) TimelapseTask_Start(seconds * 1000);
+        else if (!TimelapseTask_IsRunning()) TimelapseTask_Toggle();
+        handled = true;
+    } else if (command == "timelapse stop") {
+        TimelapseTask_Stop();
+        handled = true;
+    }
+#if defined(ENABLE_TRACE)
+    if (command == "trace") {
+        Trace_DumpSerial();
+        handled = true;
+    } else if (command == "trace clear") {
+        Trace_Clear();
+        Serial.println("[Main] Trace cleared.");
+        handled = true;
+    }
+#endif
+    if (!handled) {
+        Serial.printf("[Main] Unknown command: %s\n", command.c_str());
+    }
+}
 
 /*
 WIFI_Name: ESP32-CAM
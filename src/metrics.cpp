@@ -0,0 +1,183 @@
+// metrics.cpp - Pipeline metrics implementation
+// This module stores the pipeline counters, gauges and histograms and renders them in
+// Prometheus text format. Hot paths only do relaxed atomic adds; everything expensive
+// (heap walks, task lists, formatting) happens when /metrics is scraped.
+//
+// Key features:
+// - Counter/gauge/histogram storage with metric names and help text
+// - 64-bit byte counters, printed as exact integers
+// - Heap and PSRAM free/largest block
+// - Task stack high-water marks (FreeRTOS trace facility)
+// - Per-core CPU load from the profiler's latest sample
+
+#include "metrics.h"           // Include header for this module
+#include <esp_heap_caps.h>     // Heap statistics
+#include <freertos/FreeRTOS.h> // Task list and run-time stats
+#include <freertos/task.h>
+#include "profiler.h"          // Per-core CPU load
+
+std::atomic<uint32_t> metricCounters[METRIC_COUNTER_COUNT];
+std::atomic<uint64_t> metricByteCounters[METRIC_BYTE_COUNTER_COUNT];
+std::atomic<int32_t> metricGauges[METRIC_GAUGE_COUNT];
+MetricHistogramData metricHistograms[METRIC_HISTOGRAM_COUNT];
+// Upper bounds of the finite histogram buckets (microseconds)
+const uint32_t metricBucketBoundsUs[METRIC_BUCKET_COUNT] = {
+    500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000
+};
+
+// Names and help text, in enum order
+static const char *counterNames[METRIC_COUNTER_COUNT][2] = {
+    {"camera_frames_captured_total", "Frames returned by the camera driver"},
+    {"camera_frames_failed_total", "Camera frame grabs that failed"},
+    {"camera_frames_dropped_total", "Frames dropped because the preview queue was full"},
+    {"display_frames_total", "Preview frames pushed to the display"},
+    {"sd_writes_total", "Photo files written to the SD card"},
+    {"http_requests_total", "HTTP requests handled"},
+    {"key_task_wakeups_total", "KeyTask wake-ups (rate at idle should be 0)"},
+    {"motion_events_total", "Motion start events"},
+    {"motion_frames_saved_total", "Motion capture frames handed to the SD writer"},
+    {"motion_frames_dropped_total", "Motion capture frames lost because the encoder or SD writer was behind"},
+    {"video_frames_total", "Video frames written to AVI files"},
+    {"video_frames_dropped_total", "Video frames lost because the AVI writer was behind"},
+    {"timelapse_shots_total", "Timelapse shots taken"},
+    {"timelapse_missed_total", "Timelapse slots skipped because the previous shot overran"},
+    {"sensor_writes_total", "Sensor setter calls issued over SCCB"},
+    {"sensor_writes_skipped_total", "Sensor setter calls skipped because the value was already applied"},
+    {"capture_settle_timeouts_total", "Captures taken before the preview exposure and white balance settled"},
+    {"camera_stop_timeouts_total", "Camera task deleted without confirming its stop"},
+};
+static const char *byteCounterNames[METRIC_BYTE_COUNTER_COUNT][2] = {
+    {"sd_write_bytes_total", "Bytes written to photo files"},
+    {"http_response_bytes_total", "HTTP response body bytes sent"},
+};
+static const char *gaugeNames[METRIC_GAUGE_COUNT][2] = {
+    {"display_fps", "Preview frame rate"},
+    {"frame_latency_last_ms", "Capture-to-display latency of the last preview frame"},
+    {"display_push_last_ms", "SPI push time of the last preview frame"},
+    {"video_fps", "Sustained frame rate written by the current or last recording"},
+    {"frame_luma_mean", "Mean luma (0-255) of the last preview frame"},
+    {"frame_clipped_shadow_ratio", "Share of the last preview frame at or below the shadow clip level"},
+    {"frame_clipped_highlight_ratio", "Share of the last preview frame at or above the highlight clip level"},
+    {"frame_sharpness", "Laplacian variance of the last preview frame (higher = more fine detail)"},
+};
+static const char *histogramNames[METRIC_HISTOGRAM_COUNT][2] = {
+    {"camera_capture_seconds", "Time spent in esp_camera_fb_get"},
+    {"display_render_seconds", "Preview sprite composition time"},
+    {"display_push_seconds", "Preview sprite SPI push time"},
+    {"frame_latency_seconds", "Frame capture to end of display push"},
+    {"sd_write_seconds", "Photo file write time"},
+    {"input_latency_seconds", "Time from the deciding key edge or deadline to event dispatch"},
+    {"motion_detect_seconds", "Motion detector and pre-roll copy time per processed preview frame"},
+    {"motion_capture_latency_seconds", "Motion trigger to first captured frame written to the SD card"},
+    {"video_write_seconds", "AVI block write time (AVI_WRITE_CHUNK bytes)"},
+    {"timelapse_awake_seconds", "Timelapse awake time per shot (wake-up to ready-to-sleep)"},
+    {"timelapse_jitter_seconds", "Timelapse deviation of the time between shots from the interval"},
+    {"sensor_apply_seconds", "Time spent writing changed sensor settings"},
+    {"frame_stats_seconds", "Frame statistics time per preview frame"},
+    {"capture_settle_wait_seconds", "Wait for the preview exposure and white balance to settle before a capture"},
+    {"preview_camera_stop_wait_seconds", "Wait for the camera task to stop at a frame boundary"},
+    {"preview_frames_release_wait_seconds", "Wait for the display task to release its preview frames"},
+    {"camera_deinit_seconds", "esp_camera_deinit time when the preview stops"},
+    {"preview_overlay_seconds", "Focus peaking or zebra overlay time per preview frame"},
+};
+
+/**
+ * @brief Append one metric sample line.
+ */
+static void Metrics_Line(String &out, const char *name, const char *labels, double value) {
+    char line[160];
+    snprintf(line, sizeof(line), "esp32cam_%s%s %.6g\n", name, labels, value);
+    out += line;
+}
+
+/**
+ * @brief Append one counter sample line (printed as an integer, exact beyond 2^32).
+ */
+static void Metrics_CountLine(String &out, const char *name, uint64_t value) {
+    char line[160];
+    snprintf(line, sizeof(line), "esp32cam_%s %llu\n", name, (unsigned long long)value);
+    out += line;
+}
+
+/**
+ * @brief Append HELP and TYPE lines for a metric.
+ */
+static void Metrics_Header(String &out, const char *name, const char *help, const char *type) {
+    out += "# HELP esp32cam_";
+    out += name;
+    out += " ";
+    out += help;
+    out += "\n# TYPE esp32cam_";
+    out += name;
+    out += " ";
+    out += type;
+    out += "\n";
+}
+
+/**
+ * @brief Render all metrics in Prometheus text exposition format.
+ * @return Metrics page
+ */
+String Metrics_Render() {
+    String out;
+    out.reserve(4096);
+    char labels[64];
+    for (int i = 0; i < METRIC_COUNTER_COUNT; i++) {
+        Metrics_Header(out, counterNames[i][0], counterNames[i][1], "counter");
+        Metrics_CountLine(out, counterNames[i][0], Metrics_Get((MetricCounter)i));
+    }
+    for (int i = 0; i < METRIC_BYTE_COUNTER_COUNT; i++) {
+        Metrics_Header(out, byteCounterNames[i][0], byteCounterNames[i][1], "counter");
+        Metrics_CountLine(out, byteCounterNames[i][0], Metrics_Get((MetricByteCounter)i));
+    }
+    for (int i = 0; i < METRIC_GAUGE_COUNT; i++) {
+        Metrics_Header(out, gaugeNames[i][0], gaugeNames[i][1], "gauge");
+        Metrics_Line(out, gaugeNames[i][0], "", Metrics_Get((MetricGauge)i) / 1000.0);
+    }
+    for (int i = 0; i < METRIC_HISTOGRAM_COUNT; i++) {
+        const char *name = histogramNames[i][0];
+        MetricHistogramData &h = metricHistograms[i];
+        Metrics_Header(out, name, histogramNames[i][1], "histogram");
+        String bucketName = String(name) + "_bucket";
+        uint32_t cumulative = 0;
+        for (int b = 0; b <= METRIC_BUCKET_COUNT; b++) {
+            cumulative += h.buckets[b].load(std::memory_order_relaxed);
+            if (b < METRIC_BUCKET_COUNT) {
+                snprintf(labels, sizeof(labels), "{le=\"%g\"}", metricBucketBoundsUs[b] / 1e6);
+            } else {
+                snprintf(labels, sizeof(labels), "{le=\"+Inf\"}");
+            }
+            Metrics_Line(out, bucketName.c_str(), labels, cumulative);
+        }
+        Metrics_Line(out, (String(name) + "_sum").c_str(), "", h.sumUs.load(std::memory_order_relaxed) / 1e6);
+        Metrics_Line(out, (String(name) + "_count").c_str(), "", h.count.load(std::memory_order_relaxed));
+    }
+    // Memory
+    Metrics_Header(out, "heap_free_bytes", "Free heap by region", "gauge");
+    Metrics_Line(out, "heap_free_bytes", "{region=\"internal\"}", heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+    Metrics_Line(out, "heap_free_bytes", "{region=\"psram\"}", heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    Metrics_Header(out, "heap_largest_block_bytes", "Largest free block by region", "gauge");
+    Metrics_Line(out, "heap_largest_block_bytes", "{region=\"internal\"}", heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+    Metrics_Line(out, "heap_largest_block_bytes", "{region=\"psram\"}", heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM));
+#if configUSE_TRACE_FACILITY
+    // Task stack high-water marks
+    UBaseType_t count = uxTaskGetNumberOfTasks();
+    TaskStatus_t *tasks = (TaskStatus_t *)malloc(count * sizeof(TaskStatus_t));
+    if (tasks) {
+        count = uxTaskGetSystemState(tasks, count, NULL);
+        Metrics_Header(out, "task_stack_free_min_bytes", "Minimum free stack ever seen per task", "gauge");
+        for (UBaseType_t i = 0; i < count; i++) {
+            snprintf(labels, sizeof(labels), "{task=\"%s\"}", tasks[i].pcTaskName);
+            Metrics_Line(out, "task_stack_free_min_bytes", labels, tasks[i].usStackHighWaterMark);
+        }
+        free(tasks);
+    }
+#endif
+    // CPU load
+    float load[2];
+    Profiler_GetCoreLoad(load);
+    Metrics_Header(out, "cpu_load_percent", "CPU load per core over the last profiler interval (-1 = unavailable)", "gauge");
+    Metrics_Line(out, "cpu_load_percent", "{core=\"0\"}", load[0]);
+    Metrics_Line(out, "cpu_load_percent", "{core=\"1\"}", load[1]);
+    return out;
+}
@@ -0,0 +1,172 @@
+// metrics.h - Pipeline metrics module
+// This header declares the counters, gauges and latency histograms collected across the
+// camera, display, SD card and web server modules, and the Prometheus text exporter.
+//
+// Key features:
+// - Lock-free counters (relaxed atomics, safe from any task or core)
+// - 64-bit byte counters (HTTP and SD traffic does not wrap at 4 GiB)
+// - Fixed-bucket latency histograms in microseconds
+// - Heap/PSRAM, task stack and per-core CPU load sampled at export time
+// - Prometheus text exposition format for the /metrics endpoint
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h> // Arduino core library
+#include <atomic>    // Lock-free counters
+
+// Monotonic counters
+enum MetricCounter {
+    METRIC_CAMERA_FRAMES_CAPTURED, // Frames returned by esp_camera_fb_get
+    METRIC_CAMERA_FRAMES_FAILED,   // esp_camera_fb_get returned NULL
+    METRIC_CAMERA_FRAMES_DROPPED,  // Frame queue full, frame returned unused
+    METRIC_DISPLAY_FRAMES,         // Preview frames pushed to the TFT
+    METRIC_SD_WRITES,              // Photo files written
+    METRIC_HTTP_REQUESTS,          // HTTP requests handled
+    METRIC_KEY_WAKEUPS,            // KeyTask wake-ups (edges and gesture deadlines)
+    METRIC_MOTION_EVENTS,          // Motion start events
+    METRIC_MOTION_FRAMES_SAVED,    // Motion capture frames handed to the SD writer
+    METRIC_MOTION_FRAMES_DROPPED,  // Motion capture frames lost (encoder or SD writer behind)
+    METRIC_VIDEO_FRAMES,           // Video frames written to the AVI file
+    METRIC_VIDEO_FRAMES_DROPPED,   // Video frames lost (AVI writer behind)
+    METRIC_TIMELAPSE_SHOTS,        // Timelapse shots taken
+    METRIC_TIMELAPSE_MISSED,       // Timelapse slots skipped because a shot overran
+    METRIC_SENSOR_WRITES,          // Sensor setter calls issued (SCCB transactions)
+    METRIC_SENSOR_WRITES_SKIPPED,  // Sensor setter calls saved because the value was already applied
+    METRIC_CAPTURE_SETTLE_TIMEOUTS, // Captures taken before the preview exposure/white balance settled
+    METRIC_CAMERA_STOP_TIMEOUTS,   // Camera task deleted without confirming its stop
+    METRIC_COUNTER_COUNT
+};
+
+// Monotonic byte counters (64 bits: a 32-bit byte count wraps after 4 GiB)
+enum MetricByteCounter {
+    METRIC_SD_WRITE_BYTES, // Bytes written to photo files
+    METRIC_HTTP_BYTES,     // HTTP response body bytes sent
+    METRIC_BYTE_COUNTER_COUNT
+};
+
+// Instantaneous values
+enum MetricGauge {
+    METRIC_DISPLAY_FPS_MILLI, // Preview frame rate x1000
+    METRIC_FRAME_LATENCY_US,  // Last frame capture-to-display latency
+    METRIC_DISPLAY_PUSH_US,   // Last preview SPI push time
+    METRIC_VIDEO_FPS_MILLI,   // Sustained video frame rate x1000 (current or last recording)
+    METRIC_FRAME_LUMA_MILLI,  // Mean luma of the last preview frame x1000
+    METRIC_FRAME_SHADOW_PERMILLE,    // Clipped shadow samples of the last preview frame
+    METRIC_FRAME_HIGHLIGHT_PERMILLE, // Clipped highlight samples of the last preview frame
+    METRIC_FRAME_SHARPNESS_MILLI,    // Sharpness (Laplacian variance) of the last preview frame x1000
+    METRIC_GAUGE_COUNT
+};
+
+// Latency histograms (microseconds)
+enum MetricHistogram {
+    METRIC_HIST_CAPTURE,        // esp_camera_fb_get duration
+    METRIC_HIST_DISPLAY_RENDER, // Sprite composition (image + overlays)
+    METRIC_HIST_DISPLAY_PUSH,   // pushSprite over SPI
+    METRIC_HIST_FRAME_LATENCY,  // Frame timestamp to end of display push
+    METRIC_HIST_SD_WRITE,       // Photo file write
+    METRIC_HIST_INPUT_LATENCY,  // Deciding key edge/deadline to input event dispatch
+    METRIC_HIST_MOTION,         // Motion detector (and pre-roll copy) time per processed preview frame
+    METRIC_HIST_MOTION_CAPTURE, // Motion trigger to first captured frame written to the SD card
+    METRIC_HIST_VIDEO_WRITE,    // AVI block write to the SD card
+    METRIC_HIST_TIMELAPSE_AWAKE,  // Timelapse wake-up to ready-to-sleep per shot
+    METRIC_HIST_TIMELAPSE_JITTER, // Timelapse shot-to-shot deviation from the interval
+    METRIC_HIST_SENSOR_APPLY,   // Writing changed sensor settings (per user action or reinit)
+    METRIC_HIST_FRAME_STATS,    // Frame statistics per preview frame
+    METRIC_HIST_WAIT_SETTLE,    // Capture: wait for the preview exposure/white balance to settle
+    METRIC_HIST_WAIT_CAMERA_STOP, // Preview stop: wait for the camera task to stop at a frame boundary
+    METRIC_HIST_WAIT_FRAMES,    // Preview stop: wait for the display task to release its frames
+    METRIC_HIST_CAMERA_DEINIT,  // Preview stop: esp_camera_deinit
+    METRIC_HIST_PREVIEW_OVERLAY, // Focus peaking or zebra overlay per preview frame
+    METRIC_HISTOGRAM_COUNT
+};
+
+// Number of finite histogram buckets (an implicit +Inf bucket follows)
+#define METRIC_BUCKET_COUNT 10
+
+// Histogram storage: per-bucket counts (non-cumulative), sample count and sum
+struct MetricHistogramData {
+    std::atomic<uint32_t> buckets[METRIC_BUCKET_COUNT + 1];
+    std::atomic<uint32_t> count;
+    std::atomic<uint64_t> sumUs; // 64 bits: a 32-bit microsecond sum wraps after about 71 minutes
+};
+
+extern std::atomic<uint32_t> metricCounters[METRIC_COUNTER_COUNT];
+extern std::atomic<uint64_t> metricByteCounters[METRIC_BYTE_COUNTER_COUNT];
+extern std::atomic<int32_t> metricGauges[METRIC_GAUGE_COUNT];
+extern MetricHistogramData metricHistograms[METRIC_HISTOGRAM_COUNT];
+extern const uint32_t metricBucketBoundsUs[METRIC_BUCKET_COUNT];
+
+/**
+ * @brief Add to a counter. Lock-free, usable from any task.
+ * @param counter Counter to update
+ * @param n Amount to add
+ */
+inline void Metrics_Add(MetricCounter counter, uint32_t n = 1) {
+    metricCounters[counter].fetch_add(n, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Add to a byte counter. Usable from any task (a short critical section on the ESP32,
+ * like the histogram sums).
+ * @param counter Byte counter to update
+ * @param bytes Bytes to add
+ */
+inline void Metrics_Add(MetricByteCounter counter, uint64_t bytes) {
+    metricByteCounters[counter].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Set a gauge value. Lock-free, usable from any task.
+ * @param gauge Gauge to update
+ * @param value New value
+ */
+inline void Metrics_Set(MetricGauge gauge, int32_t value) {
+    metricGauges[gauge].store(value, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Record one latency sample. Usable from any task (the 64-bit sum is a short critical
+ * section on the ESP32, which has no 64-bit atomics; the counts are lock-free).
+ * @param histogram Histogram to update
+ * @param us Sample in microseconds
+ */
+inline void Metrics_Observe(MetricHistogram histogram, uint32_t us) {
+    int bucket = 0;
+    while (bucket < METRIC_BUCKET_COUNT && us > metricBucketBoundsUs[bucket]) ++bucket;
+    MetricHistogramData &h = metricHistograms[histogram];
+    h.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    h.count.fetch_add(1, std::memory_order_relaxed);
+    h.sumUs.fetch_add(us, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Read a counter.
+ * @param counter Counter to read
+ * @return Current value
+ */
+inline uint32_t Metrics_Get(MetricCounter counter) {
+    return metricCounters[counter].load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Read a byte counter.
+ * @param counter Byte counter to read
+ * @return Current value
+ */
+inline uint64_t Metrics_Get(MetricByteCounter counter) {
+    return metricByteCounters[counter].load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Read a gauge.
+ * @param gauge Gauge to read
+ * @return Current value
+ */
+inline int32_t Metrics_Get(MetricGauge gauge) {
+    return metricGauges[gauge].load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Render all metrics in Prometheus text exposition format.
+ * @return Metrics page
+ */
+String Metrics_Render();
@@ -0,0 +1,180 @@
+// motionCapture.cpp - Motion-triggered capture implementation
+// This module owns the PSRAM pre-roll ring and the encoder task. Slots change hands through an
+// atomic state: DisplayTask fills free and pre-roll slots, the encoder task only reads queued
+// slots and frees them once encoded.
+//
+// Key features:
+// - Fixed ring of MOTION_PREROLL_FRAMES + MOTION_POSTROLL_FRAMES + 1 preview-size slots
+// - Oldest pre-roll slot reused while idle, frames dropped (and counted) only when the encoder is behind
+// - Encoded frames handed to the SD writer without another copy (TfCard_QueueOwnedPhoto)
+
+#include "motionCapture.h" // Include header for this module
+#include <esp_timer.h> // Microsecond clock
+#include <esp_heap_caps.h> // PSRAM allocation
+#include <img_converters.h> // fmt2jpg
+#include <atomic> // Slot states shared with the encoder task
+#include "motionDetector.h" // Largest detector frame size
+#include "tfCard.h" // SD writer queue
+#include "metrics.h" // Capture counters
+#include "taskConfig.h" // Task placement table
+
+// Ring size and largest frame a slot holds (the detector's largest frame)
+#define MOTION_CAPTURE_SLOTS (MOTION_PREROLL_FRAMES + MOTION_POSTROLL_FRAMES + 1)
+#define MOTION_CAPTURE_MAX_PIXELS (MOTION_MAX_COLS * MOTION_CELL_SIZE * MOTION_MAX_ROWS * MOTION_CELL_SIZE)
+
+// Owner of a ring slot
+enum CaptureSlotState : uint8_t {
+    CAPTURE_SLOT_FREE,    // Unused (DisplayTask may fill it)
+    CAPTURE_SLOT_PREROLL, // Holds a recent frame (DisplayTask may reuse it)
+    CAPTURE_SLOT_QUEUED   // Waiting for or being encoded (encoder task frees it)
+};
+
+// One preview frame in PSRAM
+struct CaptureSlot {
+    uint16_t *pixels;                // RGB565, panel byte order
+    int width, height;               // Frame size
+    uint32_t sequence;               // Fill order (oldest pre-roll = smallest)
+    std::atomic<uint8_t> state;      // CaptureSlotState
+};
+
+// Encoder work item
+struct CaptureJob {
+    uint8_t slot;     // Slot to encode
+    bool first;       // First frame of a trigger (latency to its file write is measured on it)
+    int64_t triggerUs; // Time the trigger frame was offered
+};
+
+static CaptureSlot captureSlots[MOTION_CAPTURE_SLOTS];
+// Jobs from DisplayTask to the encoder task (one per slot, so sends never fail)
+static QueueHandle_t captureJobQueue = NULL;
+// Ring bookkeeping (DisplayTask only)
+static uint32_t captureSequence = 0;
+static int postRollLeft = 0;         // Frames still to queue for the current trigger
+static bool nextIsFirst = false;     // Next queued frame is the first of a trigger
+static int64_t triggerUs = 0;        // Time of the current trigger
+static bool hasTriggered = false;    // A trigger happened (cooldown applies)
+static uint32_t lastTriggerMs = 0;   // Frame time of the last trigger
+
+/**
+ * @brief Encoder task: encodes queued slots to JPEG, frees them and passes the JPEG to the SD writer.
+ * @param pvParameters Not used (for FreeRTOS compatibility)
+ */
+static void MotionCapture_EncoderTask(void *pvParameters) {
+    CaptureJob job;
+    while (1) {
+        xQueueReceive(captureJobQueue, &job, portMAX_DELAY); // Wait for a frame
+        CaptureSlot &slot = captureSlots[job.slot];
+        uint8_t *jpeg = NULL;
+        size_t jpegLen = 0;
+        bool encoded = fmt2jpg((uint8_t *)slot.pixels, slot.width * slot.height * 2, slot.width, slot.height,
+                               PIXFORMAT_RGB565, MOTION_CAPTURE_QUALITY, &jpeg, &jpegLen);
+        slot.state.store(CAPTURE_SLOT_FREE, std::memory_order_release); // Reusable as soon as it is encoded
+        if (!encoded) {
+            Metrics_Add(METRIC_MOTION_FRAMES_DROPPED);
+            continue;
+        }
+        bool queued = TfCard_QueueOwnedPhoto(jpeg, jpegLen, MOTION_CAPTURE_WRITE_WAIT_MS / portTICK_PERIOD_MS,
+                                             job.first ? METRIC_HIST_MOTION_CAPTURE : METRIC_HISTOGRAM_COUNT,
+                                             job.triggerUs); // Latency ends when the SD writer has written it
+        Metrics_Add(queued ? METRIC_MOTION_FRAMES_SAVED : METRIC_MOTION_FRAMES_DROPPED);
+    }
+}
+
+/**
+ * @brief Allocate the PSRAM frame ring and start the encoder task.
+ * @return true on success (capture stays disabled otherwise)
+ */
+bool MotionCapture_Init() {
+    for (int i = 0; i < MOTION_CAPTURE_SLOTS; i++) {
+        captureSlots[i].pixels = (uint16_t *)heap_caps_malloc(MOTION_CAPTURE_MAX_PIXELS * sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+        captureSlots[i].state.store(CAPTURE_SLOT_FREE, std::memory_order_relaxed);
+        if (!captureSlots[i].pixels) {
+            Serial.println("[MotionCapture] Out of PSRAM, capture disabled!");
+            for (int j = 0; j < i; j++) heap_caps_free(captureSlots[j].pixels);
+            return false;
+        }
+    }
+    captureJobQueue = xQueueCreate(MOTION_CAPTURE_SLOTS, sizeof(CaptureJob));
+    TaskConfig_Start(TASK_MOTION_CAPTURE, MotionCapture_EncoderTask, NULL, NULL); // Start encoder
+    Serial.printf("[MotionCapture] %d pre-roll + %d post-roll frames, cooldown %d ms.\n", MOTION_PREROLL_FRAMES,
+                  MOTION_POSTROLL_FRAMES, MOTION_CAPTURE_COOLDOWN_MS);
+    return true;
+}
+
+/**
+ * @brief Hand a filled slot to the encoder task.
+ * @param index Slot index
+ */
+static void MotionCapture_Queue(int index) {
+    captureSlots[index].state.store(CAPTURE_SLOT_QUEUED, std::memory_order_release);
+    CaptureJob job = {(uint8_t)index, nextIsFirst, triggerUs};
+    nextIsFirst = false;
+    xQueueSend(captureJobQueue, &job, 0); // One entry per slot: never full
+}
+
+/**
+ * @brief Find the oldest pre-roll slot and count the pre-roll slots.
+ * @param count Receives the number of pre-roll slots
+ * @return Index of the oldest pre-roll slot, or -1 if there is none
+ */
+static int MotionCapture_OldestPreroll(int &count) {
+    int oldest = -1;
+    count = 0;
+    for (int i = 0; i < MOTION_CAPTURE_SLOTS; i++) {
+        if (captureSlots[i].state.load(std::memory_order_acquire) != CAPTURE_SLOT_PREROLL) continue;
+        count++;
+        if (oldest < 0 || (int32_t)(captureSlots[i].sequence - captureSlots[oldest].sequence) < 0) oldest = i;
+    }
+    return oldest;
+}
+
+/**
+ * @brief Offer a preview frame to the ring (called by MotionTask_OnFrame for every detector frame).
+ * @param frame Preview frame (RGB565)
+ * @param timeMs Frame timestamp
+ * @param trigger true if the detector reported a motion start on this frame
+ */
+void MotionCapture_OnFrame(const camera_fb_t *frame, uint32_t timeMs, bool trigger) {
+    if (!captureJobQueue || frame->width * frame->height > MOTION_CAPTURE_MAX_PIXELS) return;
+    int count;
+    if (trigger && postRollLeft == 0 && (!hasTriggered || timeMs - lastTriggerMs >= MOTION_CAPTURE_COOLDOWN_MS)) {
+        hasTriggered = true;
+        lastTriggerMs = timeMs;
+        triggerUs = esp_timer_get_time();
+        nextIsFirst = true;
+        int preroll = 0;
+        for (int oldest = MotionCapture_OldestPreroll(count); oldest >= 0; oldest = MotionCapture_OldestPreroll(count)) {
+            MotionCapture_Queue(oldest); // Frames before the trigger, oldest first
+            preroll++;
+        }
+        postRollLeft = MOTION_POSTROLL_FRAMES + 1; // The trigger frame and the ones after it
+        Serial.printf("[MotionCapture] Triggered at %u ms, saving %d pre-roll frame(s).\n", (unsigned)timeMs, preroll);
+    }
+    if (postRollLeft == 0 && MOTION_PREROLL_FRAMES == 0) return; // Nothing to keep while idle
+
+    // Slot for this frame: while idle, the oldest pre-roll frame once the ring is full
+    int oldest = MotionCapture_OldestPreroll(count);
+    int index = postRollLeft == 0 && count >= MOTION_PREROLL_FRAMES ? oldest : -1;
+    for (int i = 0; i < MOTION_CAPTURE_SLOTS && index < 0; i++) {
+        if (captureSlots[i].state.load(std::memory_order_acquire) == CAPTURE_SLOT_FREE) index = i;
+    }
+    if (index < 0 && postRollLeft == 0) index = oldest;
+    if (index < 0) { // Every slot is waiting for the encoder
+        if (postRollLeft > 0) {
+            Metrics_Add(METRIC_MOTION_FRAMES_DROPPED);
+            postRollLeft--;
+        }
+        return;
+    }
+    CaptureSlot &slot = captureSlots[index];
+    memcpy(slot.pixels, frame->buf, frame->width * frame->height * sizeof(uint16_t));
+    slot.width = frame->width;
+    slot.height = frame->height;
+    slot.sequence = captureSequence++;
+    if (postRollLeft > 0) {
+        postRollLeft--;
+        MotionCapture_Queue(index);
+    } else {
+        slot.state.store(CAPTURE_SLOT_PREROLL, std::memory_order_release);
+    }
+}
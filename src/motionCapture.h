@@ -0,0 +1,44 @@
+// motionCapture.h - Motion-triggered capture with pre-roll
+// This header declares the capture path behind the motion detector. The preview frames the
+// detector looks at are kept in a small PSRAM ring; when motion starts, the ring (the frames
+// before the trigger), the trigger frame and a few frames after it are handed to a worker task
+// that encodes them to JPEG and queues them for the SD writer. Nothing on the frame path waits
+// for the encoder or the card, so the trigger-to-first-saved-frame latency only depends on the
+// encoder.
+//
+// Key features:
+// - MOTION_PREROLL_FRAMES before and MOTION_POSTROLL_FRAMES after each trigger, preview resolution
+// - Cooldown between triggers (MOTION_CAPTURE_COOLDOWN_MS)
+// - Ring slots are never copied twice: the worker encodes straight from the slot and frees it
+// - Trigger latency, saved and dropped frames exported as metrics
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h> // Arduino core library
+#include <esp_camera.h> // camera_fb_t
+
+// Frames kept from before the trigger
+#define MOTION_PREROLL_FRAMES 4
+// Frames saved after the trigger frame
+#define MOTION_POSTROLL_FRAMES 4
+// Minimum time between two triggers
+#define MOTION_CAPTURE_COOLDOWN_MS 10000
+// JPEG quality of the saved frames (fmt2jpg scale, 0-100)
+#define MOTION_CAPTURE_QUALITY 80
+// How long the worker waits for room in the SD write queue before dropping a frame
+#define MOTION_CAPTURE_WRITE_WAIT_MS 2000
+
+/**
+ * @brief Allocate the PSRAM frame ring and start the encoder task.
+ * @return true on success (capture stays disabled otherwise)
+ */
+bool MotionCapture_Init();
+
+/**
+ * @brief Offer a preview frame to the ring (called by MotionTask_OnFrame for every detector frame).
+ * Copies the frame into a free slot; on a trigger outside the cooldown, queues the pre-roll,
+ * this frame and the next MOTION_POSTROLL_FRAMES frames for saving.
+ * @param frame Preview frame (RGB565)
+ * @param timeMs Frame timestamp
+ * @param trigger true if the detector reported a motion start on this frame
+ */
+void MotionCapture_OnFrame(const camera_fb_t *frame, uint32_t timeMs, bool trigger);
@@ -0,0 +1,169 @@
+// motionDetector.cpp - Motion detector implementation
+// This module implements the luma grid, background model and start/end event logic.
+//
+// Key features:
+// - One pass over the grid: difference, threshold, bounding box and background update
+// - No allocation: all state lives in the MotionDetector struct
+
+#include "motionDetector.h" // Include header for this module
+#include "pixelKernels.h" // Downscale and luma kernels
+
+/**
+ * @brief Fill a configuration with the defaults (MOTION_CELL_THRESHOLD, MOTION_MIN_CELLS, whole frame).
+ * @param config Configuration to fill
+ */
+void MotionDetector_DefaultConfig(MotionConfig &config) {
+    config.cellThreshold = MOTION_CELL_THRESHOLD;
+    config.minCells = MOTION_MIN_CELLS;
+    config.roiCount = 0;
+}
+
+/**
+ * @brief Set up a detector: apply a configuration and forget any previous state.
+ * @param detector Detector state
+ * @param config Settings (NULL = defaults)
+ */
+void MotionDetector_Init(MotionDetector &detector, const MotionConfig *config) {
+    if (config) {
+        detector.config = *config;
+        if (detector.config.roiCount > MOTION_MAX_ROIS) detector.config.roiCount = MOTION_MAX_ROIS;
+    } else {
+        MotionDetector_DefaultConfig(detector.config);
+    }
+    MotionDetector_Reset(detector);
+}
+
+/**
+ * @brief Forget the background model and any motion in progress (the configuration is kept).
+ * @param detector Detector state
+ */
+void MotionDetector_Reset(MotionDetector &detector) {
+    detector.cols = detector.rows = 0;
+    detector.watchedCells = 0;
+    detector.frames = 0;
+    detector.motionFrames = 0;
+    detector.active = false;
+    detector.lastMotionMs = 0;
+    detector.activeBox = MotionBox{0, 0, 0, 0};
+    detector.peakScore = 0;
+    detector.lastBox = MotionBox{0, 0, 0, 0};
+    detector.lastScore = 0;
+}
+
+/**
+ * @brief Grow a box to contain another one.
+ */
+static void MotionDetector_Union(MotionBox &box, const MotionBox &other) {
+    int16_t x1 = box.x + box.w > other.x + other.w ? box.x + box.w : other.x + other.w;
+    int16_t y1 = box.y + box.h > other.y + other.h ? box.y + box.h : other.y + other.h;
+    box.x = box.x < other.x ? box.x : other.x;
+    box.y = box.y < other.y ? box.y : other.y;
+    box.w = x1 - box.x;
+    box.h = y1 - box.y;
+}
+
+/**
+ * @brief Mark the cells whose center lies inside a region of interest (all cells without regions).
+ */
+static void MotionDetector_BuildWatchMask(MotionDetector &detector) {
+    const MotionConfig &config = detector.config;
+    detector.watchedCells = 0;
+    for (int y = 0; y < detector.rows; y++) {
+        int cy = y * MOTION_CELL_SIZE + MOTION_CELL_SIZE / 2;
+        for (int x = 0; x < detector.cols; x++) {
+            int cx = x * MOTION_CELL_SIZE + MOTION_CELL_SIZE / 2;
+            bool inside = config.roiCount == 0;
+            for (int i = 0; i < config.roiCount && !inside; i++) {
+                const MotionBox &roi = config.roi[i];
+                inside = cx >= roi.x && cx < roi.x + roi.w && cy >= roi.y && cy < roi.y + roi.h;
+            }
+            detector.watched[y * detector.cols + x] = inside;
+            detector.watchedCells += inside;
+        }
+    }
+}
+
+/**
+ * @brief Feed one frame to the detector.
+ * @param detector Detector state
+ * @param frame RGB565 pixels in sensor (panel) byte order
+ * @param width Frame width (at most MOTION_MAX_COLS * MOTION_CELL_SIZE)
+ * @param height Frame height (at most MOTION_MAX_ROWS * MOTION_CELL_SIZE)
+ * @param timeMs Frame timestamp
+ * @param event Receives the event, if any
+ * @return true if an event was reported
+ */
+bool MotionDetector_Process(MotionDetector &detector, const uint16_t *frame, int width, int height, uint32_t timeMs,
+                            MotionEvent &event) {
+    int cols = width / MOTION_CELL_SIZE, rows = height / MOTION_CELL_SIZE;
+    if (cols <= 0 || rows <= 0 || cols > MOTION_MAX_COLS || rows > MOTION_MAX_ROWS) return false;
+    if (cols != detector.cols || rows != detector.rows) { // First frame or new resolution
+        MotionDetector_Reset(detector);
+        detector.cols = cols;
+        detector.rows = rows;
+        MotionDetector_BuildWatchMask(detector);
+    }
+    if (detector.watchedCells == 0) return false; // Regions of interest outside the frame
+    int count = cols * rows;
+    PixelKernels_Downscale4x(frame, width, height, detector.cells);
+    PixelKernels_Luma(detector.cells, detector.luma, count);
+    if (detector.frames++ == 0) { // Seed the model with the first frame
+        for (int i = 0; i < count; i++) detector.background[i] = detector.luma[i] << 8;
+        return false;
+    }
+
+    int threshold = detector.config.cellThreshold;
+    int changed = 0;
+    int minX = cols, minY = rows, maxX = -1, maxY = -1;
+    for (int y = 0; y < rows; y++) {
+        uint16_t *background = &detector.background[y * cols];
+        const uint8_t *luma = &detector.luma[y * cols];
+        const uint8_t *watched = &detector.watched[y * cols];
+        for (int x = 0; x < cols; x++) {
+            int target = luma[x] << 8;
+            int diff = (int)luma[x] - (background[x] >> 8);
+            bool moving = diff > threshold || diff < -threshold;
+            background[x] += (target - (int)background[x]) >> (moving ? MOTION_LEARN_SHIFT_MOVING : MOTION_LEARN_SHIFT);
+            if (!moving || !watched[x]) continue; // Background is learned everywhere, motion only counted where watched
+            changed++;
+            if (x < minX) minX = x;
+            if (x > maxX) maxX = x;
+            if (y < minY) minY = y;
+            if (y > maxY) maxY = y;
+        }
+    }
+    uint16_t score = (uint16_t)(changed * 1000 / detector.watchedCells);
+    if (score > MOTION_GLOBAL_PERMILLE) { // Exposure or lighting change: relearn instead of reporting
+        for (int i = 0; i < count; i++) detector.background[i] = detector.luma[i] << 8;
+        changed = 0;
+        score = 0;
+    }
+    bool motion = changed >= detector.config.minCells;
+    detector.lastScore = motion ? score : 0;
+    detector.lastBox = motion ? MotionBox{(int16_t)(minX * MOTION_CELL_SIZE), (int16_t)(minY * MOTION_CELL_SIZE),
+                                          (int16_t)((maxX - minX + 1) * MOTION_CELL_SIZE),
+                                          (int16_t)((maxY - minY + 1) * MOTION_CELL_SIZE)}
+                              : MotionBox{0, 0, 0, 0};
+    if (detector.frames <= MOTION_WARMUP_FRAMES) return false; // Still learning the background
+
+    if (motion) {
+        detector.motionFrames++;
+        detector.lastMotionMs = timeMs;
+        if (detector.active) {
+            MotionDetector_Union(detector.activeBox, detector.lastBox);
+            if (score > detector.peakScore) detector.peakScore = score;
+            return false;
+        }
+        if (detector.motionFrames < MOTION_START_FRAMES) return false;
+        detector.active = true;
+        detector.activeBox = detector.lastBox;
+        detector.peakScore = score;
+        event = MotionEvent{MOTION_EVENT_START, timeMs, detector.lastBox, score};
+        return true;
+    }
+    detector.motionFrames = 0;
+    if (!detector.active || timeMs - detector.lastMotionMs < MOTION_END_MS) return false;
+    detector.active = false;
+    event = MotionEvent{MOTION_EVENT_END, timeMs, detector.activeBox, detector.peakScore};
+    return true;
+}
@@ -0,0 +1,118 @@
+// motionDetector.h - Motion detector for the preview stream
+// This header declares a frame-differencing motion detector. Each RGB565 preview frame is
+// reduced to a luma grid (4x4 pixel cells), compared with a running background model, and
+// the changed cells are turned into start/end motion events with a bounding box and a score.
+// It has no Arduino or FreeRTOS dependencies and is driven purely by the frames and timestamps
+// it is given, so it runs the same on the device (MotionTask) and on the host (motionReplay.h).
+//
+// Key features:
+// - Downsampling and luma through the pixel kernels (about 1/16 of the frame is touched twice)
+// - Background model: exponential average per cell, learned slower where motion is seen
+// - Global changes (auto exposure, lights switched) reset the model instead of firing events
+// - Start after MOTION_START_FRAMES consecutive motion frames, end after MOTION_END_MS of quiet
+// - Run-time sensitivity and regions of interest (MotionConfig)
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stdint.h> // Fixed-width integer types
+#include <stddef.h> // NULL
+
+// Frame pixels per luma cell side
+#define MOTION_CELL_SIZE 4
+// Largest luma grid (QVGA preview frames)
+#define MOTION_MAX_COLS 80
+#define MOTION_MAX_ROWS 60
+// Default luma difference from the background for a cell to count as changed
+#define MOTION_CELL_THRESHOLD 24
+// Default number of changed cells needed for a motion frame
+#define MOTION_MIN_CELLS 8
+// Maximum number of regions of interest
+#define MOTION_MAX_ROIS 4
+// Changed cells (per mille of the watched cells) above which the change is global and the model is reset
+#define MOTION_GLOBAL_PERMILLE 600
+// Consecutive motion frames before a start event
+#define MOTION_START_FRAMES 2
+// Time without motion frames before an end event
+#define MOTION_END_MS 1500
+// Frames used to learn the background before events are reported
+#define MOTION_WARMUP_FRAMES 8
+// Background learning rate (1 / 2^shift per frame) for quiet and changed cells
+#define MOTION_LEARN_SHIFT 4
+#define MOTION_LEARN_SHIFT_MOVING 7
+
+// Motion event types
+enum MotionEventType {
+    MOTION_EVENT_START, // Motion began (box and score of the deciding frame)
+    MOTION_EVENT_END    // Motion ended (union box and peak score of the whole motion)
+};
+
+// Rectangle in frame pixels
+struct MotionBox {
+    int16_t x, y, w, h;
+};
+
+// Detector settings (MotionDetector_Init)
+struct MotionConfig {
+    uint8_t cellThreshold;          // Luma difference for a changed cell (lower = more sensitive)
+    uint16_t minCells;              // Changed cells needed for a motion frame
+    uint8_t roiCount;               // Number of regions of interest (0 = whole frame)
+    MotionBox roi[MOTION_MAX_ROIS]; // Regions in frame pixels; cells whose center is outside all of them are ignored
+};
+
+// Motion event reported by MotionDetector_Process()
+struct MotionEvent {
+    MotionEventType type;
+    uint32_t timeMs;  // Timestamp of the frame that decided the event
+    MotionBox box;    // Changed area
+    uint16_t score;   // Changed cells per mille of the watched cells
+};
+
+// Detector state (about 29 KB: keep it in static or heap memory, not on a task stack)
+struct MotionDetector {
+    MotionConfig config;        // Sensitivity and regions of interest
+    int cols, rows;             // Luma grid size (0 = not initialized)
+    int watchedCells;           // Cells inside the regions of interest
+    uint32_t frames;            // Frames processed since the last reset
+    int motionFrames;           // Consecutive motion frames
+    bool active;                // Between start and end events
+    uint32_t lastMotionMs;      // Time of the last motion frame
+    MotionBox activeBox;        // Union of the boxes since the start event
+    uint16_t peakScore;         // Highest score since the start event
+    MotionBox lastBox;          // Changed area of the last frame (w = 0 if none)
+    uint16_t lastScore;         // Score of the last frame
+    uint16_t background[MOTION_MAX_COLS * MOTION_MAX_ROWS]; // Background luma, 8.8 fixed point
+    uint16_t cells[MOTION_MAX_COLS * MOTION_MAX_ROWS];      // Downscaled frame (RGB565)
+    uint8_t luma[MOTION_MAX_COLS * MOTION_MAX_ROWS];        // Luma of the downscaled frame
+    uint8_t watched[MOTION_MAX_COLS * MOTION_MAX_ROWS];     // 1 for cells inside the regions of interest
+};
+
+/**
+ * @brief Fill a configuration with the defaults (MOTION_CELL_THRESHOLD, MOTION_MIN_CELLS, whole frame).
+ * @param config Configuration to fill
+ */
+void MotionDetector_DefaultConfig(MotionConfig &config);
+
+/**
+ * @brief Set up a detector: apply a configuration and forget any previous state.
+ * @param detector Detector state
+ * @param config Settings (NULL = defaults)
+ */
+void MotionDetector_Init(MotionDetector &detector, const MotionConfig *config = NULL);
+
+/**
+ * @brief Forget the background model and any motion in progress (the configuration is kept).
+ * @param detector Detector state
+ */
+void MotionDetector_Reset(MotionDetector &detector);
+
+/**
+ * @brief Feed one frame to the detector.
+ * @param detector Detector state
+ * @param frame RGB565 pixels in sensor (panel) byte order
+ * @param width Frame width (at most MOTION_MAX_COLS * MOTION_CELL_SIZE)
+ * @param height Frame height (at most MOTION_MAX_ROWS * MOTION_CELL_SIZE)
+ * @param timeMs Frame timestamp
+ * @param event Receives the event, if any
+ * @return true if an event was reported
+ */
+bool MotionDetector_Process(MotionDetector &detector, const uint16_t *frame, int width, int height, uint32_t timeMs,
+                            MotionEvent &event);
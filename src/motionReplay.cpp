@@ -0,0 +1,108 @@
+// motionReplay.cpp - Motion detector replay harness implementation
+// This module parses, formats and compares motion events in the text format shared by the
+// motion log, recorded sequences (expected.txt) and the synthetic scenes in test/test_motion_replay.
+//
+// Key features:
+// - Parser accepts pasted log lines ("[Motion] ..."), comments and blank lines
+// - Comparison with time and box tolerances, one report line per mismatch
+
+#include "motionReplay.h" // Include header for this module
+#include <stdio.h> // snprintf, sscanf
+#include <string.h> // strchr, strcmp, memcpy
+
+/**
+ * @brief Parse an expected event list.
+ * Blank lines and lines starting with '#' are skipped. A leading "[Tag]" is ignored, so lines
+ * logged by MotionTask can be pasted directly. The score is optional and not compared.
+ * @param text Event list, one "<timeMs> <start|end> <x> <y> <w> <h> [score]" event per line
+ * @param events Receives the parsed events
+ * @param maxEvents Capacity of events
+ * @return Number of events parsed, or -1 on a malformed line or overflow
+ */
+int MotionReplay_Parse(const char *text, MotionEvent *events, int maxEvents) {
+    int count = 0;
+    const char *line = text;
+    while (line && *line) {
+        const char *end = strchr(line, '\n');
+        int length = end ? (int)(end - line) : (int)strlen(line);
+        char buffer[96];
+        if (length >= (int)sizeof(buffer)) return -1; // Line too long to be an event
+        memcpy(buffer, line, length);
+        buffer[length] = '\0';
+        line = end ? end + 1 : NULL;
+
+        const char *p = buffer;
+        while (*p == ' ' || *p == '\t' || *p == '\r') p++;
+        if (*p == '[') { // Skip a log tag such as "[Motion]"
+            const char *close = strchr(p, ']');
+            if (!close) return -1;
+            p = close + 1;
+        }
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0' || *p == '\r' || *p == '#') continue; // Blank line or comment
+
+        unsigned long timeMs;
+        char type[8];
+        int x, y, w, h, score = 0;
+        int fields = sscanf(p, "%lu %7s %d %d %d %d %d", &timeMs, type, &x, &y, &w, &h, &score);
+        bool start = strcmp(type, "start") == 0;
+        if (fields < 6 || (!start && strcmp(type, "end") != 0)) return -1;
+        if (count >= maxEvents) return -1;
+        MotionEvent &event = events[count++];
+        event.type = start ? MOTION_EVENT_START : MOTION_EVENT_END;
+        event.timeMs = timeMs;
+        event.box = MotionBox{(int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h};
+        event.score = (uint16_t)score;
+    }
+    return count;
+}
+
+/**
+ * @brief Format an event in the text event format (without newline).
+ */
+void MotionReplay_Format(const MotionEvent &event, char *line, size_t size) {
+    snprintf(line, size, "%u %s %d %d %d %d %u", (unsigned)event.timeMs,
+             event.type == MOTION_EVENT_START ? "start" : "end", event.box.x, event.box.y, event.box.w, event.box.h,
+             (unsigned)event.score);
+}
+
+/**
+ * @brief Check that two values differ by at most a tolerance.
+ */
+static bool MotionReplay_Near(int a, int b, int tolerance) {
+    return a - b <= tolerance && b - a <= tolerance;
+}
+
+/**
+ * @brief Compare reported events with expected events (same order, types equal, times and boxes
+ * within MOTION_REPLAY_TIME_TOLERANCE_MS and MOTION_REPLAY_BOX_TOLERANCE).
+ * @param log Receives one line per mismatch (may be NULL)
+ * @return Number of mismatches (0 = equal)
+ */
+int MotionReplay_Compare(const MotionEvent *expected, int expectedCount, const MotionEvent *actual, int actualCount,
+                         MotionLog log) {
+    char line[160], got[48], want[48];
+    int mismatches = 0;
+    if (actualCount != expectedCount) {
+        snprintf(line, sizeof(line), "  %d events, expected %d", actualCount, expectedCount);
+        if (log) log(line);
+        mismatches++;
+    }
+    for (int i = 0; i < actualCount && i < expectedCount; i++) {
+        const MotionEvent &a = actual[i];
+        const MotionEvent &e = expected[i];
+        if (a.type == e.type && MotionReplay_Near((int)a.timeMs, (int)e.timeMs, MOTION_REPLAY_TIME_TOLERANCE_MS) &&
+            MotionReplay_Near(a.box.x, e.box.x, MOTION_REPLAY_BOX_TOLERANCE) &&
+            MotionReplay_Near(a.box.y, e.box.y, MOTION_REPLAY_BOX_TOLERANCE) &&
+            MotionReplay_Near(a.box.x + a.box.w, e.box.x + e.box.w, MOTION_REPLAY_BOX_TOLERANCE) &&
+            MotionReplay_Near(a.box.y + a.box.h, e.box.y + e.box.h, MOTION_REPLAY_BOX_TOLERANCE)) {
+            continue;
+        }
+        MotionReplay_Format(a, got, sizeof(got));
+        MotionReplay_Format(e, want, sizeof(want));
+        snprintf(line, sizeof(line), "  event %d is %s, expected %s", i, got, want);
+        if (log) log(line);
+        mismatches++;
+    }
+    return mismatches;
+}
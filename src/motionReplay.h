@@ -0,0 +1,46 @@
+// motionReplay.h - Motion detector replay harness
+// This header declares the event parser and comparison used to check motion detector output
+// against expectations. It has no Arduino or FreeRTOS dependencies, so the synthetic scenes run
+// in the unit tests (test/test_motion_replay) and recorded sequences on the host (--motion DIR).
+//
+// Key features:
+// - Text event format "<timeMs> <start|end> <x> <y> <w> <h> [score]", one event per line
+// - Comparison with time and box tolerances (recordings differ slightly between runs and machines)
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stddef.h> // size_t
+#include "motionDetector.h" // Detector and event types
+
+// Maximum number of events recorded per sequence
+#define MOTION_REPLAY_MAX_EVENTS 32
+// Allowed difference of an event's time and of each box edge when comparing
+#define MOTION_REPLAY_TIME_TOLERANCE_MS 200
+#define MOTION_REPLAY_BOX_TOLERANCE 16
+
+// Log callback for mismatch reports (one line per call, no trailing newline)
+typedef void (*MotionLog)(const char *line);
+
+/**
+ * @brief Parse an expected event list.
+ * Blank lines and lines starting with '#' are skipped. A leading "[Tag]" is ignored, so lines
+ * logged by MotionTask can be pasted directly. The score is optional and not compared.
+ * @param text Event list, one "<timeMs> <start|end> <x> <y> <w> <h> [score]" event per line
+ * @param events Receives the parsed events
+ * @param maxEvents Capacity of events
+ * @return Number of events parsed, or -1 on a malformed line or overflow
+ */
+int MotionReplay_Parse(const char *text, MotionEvent *events, int maxEvents);
+
+/**
+ * @brief Format an event in the text event format (without newline).
+ */
+void MotionReplay_Format(const MotionEvent &event, char *line, size_t size);
+
+/**
+ * @brief Compare reported events with expected events (same order, types equal, times and boxes
+ * within MOTION_REPLAY_TIME_TOLERANCE_MS and MOTION_REPLAY_BOX_TOLERANCE).
+ * @param log Receives one line per mismatch (may be NULL)
+ * @return Number of mismatches (0 = equal)
+ */
+int MotionReplay_Compare(const MotionEvent *expected, int expectedCount, const MotionEvent *actual, int actualCount,
+                         MotionLog log);
@@ -0,0 +1,126 @@
+// motionTask.cpp - Motion detection task implementation
+// This module runs the motion detector on preview frames inside DisplayTask and forwards the
+// events to MotionTask through a queue, so subscribers (photo capture, recording) never block
+// the preview loop.
+//
+// Key features:
+// - Detector state allocated once in internal RAM (PSRAM fallback)
+// - Events dropped, not waited for, when MotionTask falls behind
+// - Optional photo capture on motion start (MOTION_AUTO_CAPTURE in config.h)
+// - Optional pre-roll capture of the preview frames around motion start (MOTION_CAPTURE in config.h)
+
+#include "motionTask.h" // Include header for this module
+#include <esp_timer.h> // Microsecond clock
+#include <esp_heap_caps.h> // heap_caps_malloc
+#include "displayTask.h" // DisplayTask_SavePhoto
+#include "metrics.h" // Motion counters
+#include "motionReplay.h" // Event text format
+#include "motionCapture.h" // Pre-roll capture
+
+// Detector state (owned by DisplayTask once the preview runs)
+static MotionDetector *motionDetector = NULL;
+// Events from DisplayTask to MotionTask
+static QueueHandle_t motionEventQueue = NULL;
+// Preview frames seen (for MOTION_FRAME_STRIDE)
+static uint32_t motionFrameCount = 0;
+
+// Motion event subscribers
+static MotionHandler subscriberHandlers[MOTION_MAX_SUBSCRIBERS];
+static void *subscriberArgs[MOTION_MAX_SUBSCRIBERS];
+static int subscriberCount = 0;
+
+#if defined(MOTION_AUTO_CAPTURE)
+/**
+ * @brief Take a photo when motion starts.
+ * @param event Motion event
+ * @param arg Not used
+ */
+static void MotionTask_CaptureHandler(const MotionEvent &event, void *arg) {
+    if (event.type != MOTION_EVENT_START) return;
+    Serial.println("[Motion] Photo taken (motion).");
+    DisplayTask_SavePhoto();
+}
+#endif
+
+/**
+ * @brief Allocate the detector and create the event queue. Call before DisplayTask starts.
+ */
+void MotionTask_Init() {
+    motionDetector = (MotionDetector *)heap_caps_malloc(sizeof(MotionDetector), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!motionDetector) motionDetector = (MotionDetector *)heap_caps_malloc(sizeof(MotionDetector), MALLOC_CAP_SPIRAM);
+    if (!motionDetector) {
+        Serial.println("[Motion] Out of memory, detection disabled!");
+        return;
+    }
+    MotionConfig config;
+    MotionDetector_DefaultConfig(config);
+#if defined(MOTION_SENSITIVITY)
+    config.cellThreshold = MOTION_SENSITIVITY;
+#endif
+#if defined(MOTION_ROI)
+    config.roi[0] = MotionBox{MOTION_ROI};
+    config.roiCount = 1;
+#endif
+    MotionDetector_Init(*motionDetector, &config);
+#if defined(MOTION_CAPTURE)
+    MotionCapture_Init();
+#endif
+    motionEventQueue = xQueueCreate(MOTION_EVENT_QUEUE_LEN, sizeof(MotionEvent));
+#if defined(MOTION_AUTO_CAPTURE)
+    MotionTask_Subscribe(MotionTask_CaptureHandler, NULL);
+#endif
+    Serial.println("[Motion] Motion detection initialized."); // Debug output
+}
+
+/**
+ * @brief Subscribe to motion events.
+ * @param handler Called from MotionTask for every start and end event
+ * @param arg User argument passed to the handler
+ * @return true if subscribed, false if the subscriber table is full
+ */
+bool MotionTask_Subscribe(MotionHandler handler, void *arg) {
+    if (subscriberCount >= MOTION_MAX_SUBSCRIBERS) return false;
+    subscriberHandlers[subscriberCount] = handler;
+    subscriberArgs[subscriberCount] = arg;
+    ++subscriberCount;
+    return true;
+}
+
+/**
+ * @brief Feed a preview frame to the detector (called by DisplayTask before returning the frame).
+ * Frames that are not RGB565 or larger than the detector grid are ignored.
+ * @param frame Preview frame
+ */
+void MotionTask_OnFrame(const camera_fb_t *frame) {
+    if (!motionDetector || frame->format != PIXFORMAT_RGB565) return;
+    if (motionFrameCount++ % MOTION_FRAME_STRIDE != 0) return;
+    int64_t start = esp_timer_get_time();
+    uint32_t timeMs = (uint32_t)(frame->timestamp.tv_sec * 1000 + frame->timestamp.tv_usec / 1000); // Driver timestamp
+    MotionEvent event;
+    bool reported = MotionDetector_Process(*motionDetector, (const uint16_t *)frame->buf, frame->width, frame->height,
+                                           timeMs, event);
+#if defined(MOTION_CAPTURE)
+    MotionCapture_OnFrame(frame, timeMs, reported && event.type == MOTION_EVENT_START);
+#endif
+    Metrics_Observe(METRIC_HIST_MOTION, esp_timer_get_time() - start);
+    if (reported) xQueueSend(motionEventQueue, &event, 0); // Dropped if MotionTask is behind
+}
+
+/**
+ * @brief Main motion task loop: waits for events and delivers them to subscribers.
+ * @param pvParameters Not used (for FreeRTOS compatibility)
+ */
+void MotionTask(void *pvParameters) {
+    if (!motionEventQueue) vTaskDelete(NULL); // Not initialized (out of memory)
+    MotionEvent event;
+    char line[48];
+    while (true) {
+        if (xQueueReceive(motionEventQueue, &event, portMAX_DELAY) != pdTRUE) continue;
+        if (event.type == MOTION_EVENT_START) Metrics_Add(METRIC_MOTION_EVENTS);
+        MotionReplay_Format(event, line, sizeof(line));
+        Serial.printf("[Motion] %s\n", line); // Same format as expected.txt of recorded sequences
+        for (int i = 0; i < subscriberCount; i++) {
+            subscriberHandlers[i](event, subscriberArgs[i]);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+// motionTask.h - Motion detection task module
+// This header declares the glue between the preview stream and the motion detector
+// (motionDetector.h): DisplayTask hands preview frames to MotionTask_OnFrame(), and MotionTask
+// delivers the resulting start/end events to subscribers outside the display loop.
+//
+// Key features:
+// - Detector runs on every MOTION_FRAME_STRIDE-th RGB565 preview frame, before the frame goes back to the driver
+// - Per-frame cost recorded in the motion_detect_seconds histogram
+// - Events logged in the replay text format (motionReplay.h) and delivered to subscribers
+// - Subscribers may capture or record: they run on MotionTask, not on the display loop
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h> // Arduino core library
+#include <esp_camera.h> // camera_fb_t
+#include "config.h" // ENABLE_MOTION switch
+#include "motionDetector.h" // Motion event types
+
+// Run the detector on every n-th preview frame (1 = every frame)
+#define MOTION_FRAME_STRIDE 2
+// Length of the event queue between DisplayTask and MotionTask
+#define MOTION_EVENT_QUEUE_LEN 4
+// Maximum number of motion event subscribers
+#define MOTION_MAX_SUBSCRIBERS 4
+
+// Motion event subscriber (called from MotionTask)
+typedef void (*MotionHandler)(const MotionEvent &event, void *arg);
+
+/**
+ * @brief Allocate the detector and create the event queue. Call before DisplayTask starts.
+ */
+void MotionTask_Init();
+
+/**
+ * @brief Subscribe to motion events.
+ * @param handler Called from MotionTask for every start and end event
+ * @param arg User argument passed to the handler
+ * @return true if subscribed, false if the subscriber table is full
+ */
+bool MotionTask_Subscribe(MotionHandler handler, void *arg);
+
+/**
+ * @brief Feed a preview frame to the detector (called by DisplayTask before returning the frame).
+ * Frames that are not RGB565 or larger than the detector grid are ignored.
+ * @param frame Preview frame
+ */
+void MotionTask_OnFrame(const camera_fb_t *frame);
+
+/**
+ * @brief Main motion task loop: waits for events and delivers them to subscribers.
+ * @param pvParameters Not used (for FreeRTOS compatibility)
+ */
+void MotionTask(void *pvParameters);
@@ -0,0 +1,665 @@
+// pixelKernels.cpp - RGB565 pixel kernels implementation
+// This module implements the pixel kernels twice: a scalar reference that mirrors the math in the
+// header comments, and a fast version used by the firmware. See bench.h for measuring them.
+//
+// Key features:
+// - Two panel order pixels (or four luma bytes) per 32-bit word where buffers are word aligned
+// - Channel arithmetic on one register: an RGB565 value spread as 0x07E0F81F keeps R, G and B
+//   apart with enough headroom to sum 16 pixels or scale by 32 without carries between channels
+// - Luma from two 256-entry tables indexed by the two bytes of a panel order pixel
+// - Preview overlays on four luma samples per word: one compare finds the (rare) samples to mark
+// - No allocation, no globals besides the read-only luma tables: safe to call from any task
+
+#include "pixelKernels.h" // Include header for this module
+#include <stdio.h> // snprintf
+#include <string.h> // memset, memcmp
+
+// 32-bit word that may alias pixel buffers (two RGB565 pixels or four luma bytes)
+typedef uint32_t __attribute__((may_alias)) PixelWord;
+
+// Spread RGB565 layout: G in bits 21..26, R in bits 11..15, B in bits 0..4
+#define PIXEL_SPREAD_MASK 0x07E0F81Fu
+
+/**
+ * @brief Swap the bytes of one RGB565 value (panel byte order <-> native).
+ */
+static inline uint16_t PixelKernels_Swap(uint16_t value) {
+    return (uint16_t)((value >> 8) | (value << 8));
+}
+
+/**
+ * @brief Swap the bytes of both RGB565 values in a word.
+ */
+static inline uint32_t PixelKernels_SwapPair(uint32_t word) {
+    return ((word & 0x00FF00FFu) << 8) | ((word >> 8) & 0x00FF00FFu);
+}
+
+/**
+ * @brief Spread a native RGB565 value so that channels can be summed and scaled in one register.
+ */
+static inline uint32_t PixelKernels_Spread(uint32_t native) {
+    return (native | (native << 16)) & PIXEL_SPREAD_MASK;
+}
+
+/**
+ * @brief Pack a spread value (channels already in range) back to native RGB565.
+ */
+static inline uint16_t PixelKernels_Pack(uint32_t spread) {
+    spread &= PIXEL_SPREAD_MASK;
+    return (uint16_t)(spread | (spread >> 16));
+}
+
+/**
+ * @brief Sum the spread channels of the two panel order pixels in a word.
+ */
+static inline uint32_t PixelKernels_SpreadPair(uint32_t word) {
+    word = PixelKernels_SwapPair(word);
+    return PixelKernels_Spread(word & 0xFFFF) + PixelKernels_Spread(word >> 16);
+}
+
+/**
+ * @brief Draw a 3x3 grid overlay on an image buffer.
+ * Useful for composition guidance in photography. Only 2 * (width + height) stores, so there is
+ * no separate fast version.
+ * @param image Pointer to image buffer (RGB565)
+ * @param width Image width
+ * @param height Image height
+ * @param color Grid line color
+ */
+void PixelKernels_DrawGrid3x3(uint16_t *image, int width, int height, uint16_t color) {
+    int cellW = width / 3; // Width of each cell
+    int cellH = height / 3; // Height of each cell
+    for (int y = 0; y < height; y++) {
+        image[y * width + cellW] = color; // Vertical line 1
+        image[y * width + 2 * cellW] = color; // Vertical line 2
+    }
+    for (int x = 0; x < width; x++) {
+        image[cellH * width + x] = color; // Horizontal line 1
+        image[2 * cellH * width + x] = color; // Horizontal line 2
+    }
+}
+
+/**
+ * @brief Scalar reference of PixelKernels_SwapBytes (one pixel at a time).
+ */
+void PixelKernels_SwapBytesScalar(const uint16_t *src, uint16_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = PixelKernels_Swap(src[i]);
+    }
+}
+
+/**
+ * @brief Swap the two bytes of each RGB565 pixel, two pixels per word.
+ * Falls back to the scalar loop when src and dst cannot both be word aligned.
+ */
+void PixelKernels_SwapBytes(const uint16_t *src, uint16_t *dst, size_t count) {
+    if ((((uintptr_t)src ^ (uintptr_t)dst) & 3) != 0) {
+        PixelKernels_SwapBytesScalar(src, dst, count);
+        return;
+    }
+    size_t i = 0;
+    if (((uintptr_t)src & 3) != 0 && count > 0) { // Leading pixel up to the word boundary
+        dst[0] = PixelKernels_Swap(src[0]);
+        i = 1;
+    }
+    const PixelWord *in = (const PixelWord *)(src + i);
+    PixelWord *out = (PixelWord *)(dst + i);
+    size_t words = (count - i) / 2;
+    size_t w = 0;
+    for (; w + 2 <= words; w += 2) { // Two words per iteration
+        uint32_t v0 = in[w], v1 = in[w + 1];
+        out[w] = PixelKernels_SwapPair(v0);
+        out[w + 1] = PixelKernels_SwapPair(v1);
+    }
+    if (w < words) out[w] = PixelKernels_SwapPair(in[w]);
+    i += words * 2;
+    if (i < count) dst[i] = PixelKernels_Swap(src[i]); // Trailing pixel
+}
+
+/**
+ * @brief Scalar reference of PixelKernels_Fill (one pixel at a time).
+ */
+void PixelKernels_FillScalar(uint16_t *dst, size_t count, uint16_t color) {
+    uint16_t panel = PixelKernels_Swap(color);
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = panel;
+    }
+}
+
+/**
+ * @brief Fill pixels with one color, two pixels per word store.
+ */
+void PixelKernels_Fill(uint16_t *dst, size_t count, uint16_t color) {
+    uint16_t panel = PixelKernels_Swap(color);
+    uint32_t pair = panel | ((uint32_t)panel << 16);
+    size_t i = 0;
+    if (((uintptr_t)dst & 3) != 0 && count > 0) { // Leading pixel up to the word boundary
+        dst[0] = panel;
+        i = 1;
+    }
+    PixelWord *out = (PixelWord *)(dst + i);
+    size_t words = (count - i) / 2;
+    size_t w = 0;
+    for (; w + 4 <= words; w += 4) { // Four words per iteration
+        out[w] = pair;
+        out[w + 1] = pair;
+        out[w + 2] = pair;
+        out[w + 3] = pair;
+    }
+    for (; w < words; w++) out[w] = pair;
+    i += words * 2;
+    if (i < count) dst[i] = panel; // Trailing pixel
+}
+
+/**
+ * @brief Scalar reference of PixelKernels_Blend (one pixel at a time, channel by channel).
+ */
+void PixelKernels_BlendScalar(const uint16_t *a, const uint16_t *b, uint16_t *dst, size_t count, uint8_t alpha) {
+    uint32_t wa = alpha > PIXEL_ALPHA_MAX ? PIXEL_ALPHA_MAX : alpha, wb = PIXEL_ALPHA_MAX - wa;
+    for (size_t i = 0; i < count; i++) {
+        uint16_t ca = PixelKernels_Swap(a[i]), cb = PixelKernels_Swap(b[i]);
+        uint32_t r = ((ca >> 11) * wa + (cb >> 11) * wb) >> 5;
+        uint32_t g = (((ca >> 5) & 0x3F) * wa + ((cb >> 5) & 0x3F) * wb) >> 5;
+        uint32_t bl = ((ca & 0x1F) * wa + (cb & 0x1F) * wb) >> 5;
+        dst[i] = PixelKernels_Swap((uint16_t)((r << 11) | (g << 5) | bl));
+    }
+}
+
+/**
+ * @brief Blend two images with all three channels weighted in one multiply each.
+ * The largest weighted channel sum (63 * 32) still fits below the next channel in the spread layout.
+ */
+void PixelKernels_Blend(const uint16_t *a, const uint16_t *b, uint16_t *dst, size_t count, uint8_t alpha) {
+    uint32_t wa = alpha > PIXEL_ALPHA_MAX ? PIXEL_ALPHA_MAX : alpha, wb = PIXEL_ALPHA_MAX - wa;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t mix = PixelKernels_Spread(PixelKernels_Swap(a[i])) * wa + PixelKernels_Spread(PixelKernels_Swap(b[i])) * wb;
+        dst[i] = PixelKernels_Swap(PixelKernels_Pack(mix >> 5));
+    }
+}
+
+/**
+ * @brief Scalar reference of PixelKernels_Downscale2x (one pixel at a time, channel by channel).
+ */
+void PixelKernels_Downscale2xScalar(const uint16_t *src, int width, int height, uint16_t *dst) {
+    int outW = width / 2, outH = height / 2;
+    for (int y = 0; y < outH; y++) {
+        const uint16_t *row0 = &src[(size_t)(2 * y) * width];
+        const uint16_t *row1 = row0 + width;
+        uint16_t *out = &dst[(size_t)y * outW];
+        for (int x = 0; x < outW; x++) {
+            uint16_t a = PixelKernels_Swap(row0[2 * x]), b = PixelKernels_Swap(row0[2 * x + 1]);
+            uint16_t c = PixelKernels_Swap(row1[2 * x]), d = PixelKernels_Swap(row1[2 * x + 1]);
+            uint32_t r = ((a >> 11) + (b >> 11) + (c >> 11) + (d >> 11) + 2) >> 2;
+            uint32_t g = (((a >> 5) & 0x3F) + ((b >> 5) & 0x3F) + ((c >> 5) & 0x3F) + ((d >> 5) & 0x3F) + 2) >> 2;
+            uint32_t bl = ((a & 0x1F) + (b & 0x1F) + (c & 0x1F) + (d & 0x1F) + 2) >> 2;
+            out[x] = PixelKernels_Swap((uint16_t)((r << 11) | (g << 5) | bl)); // Back to panel byte order
+        }
+    }
+}
+
+/**
+ * @brief 2x2 box downscale on spread pixels, reading two source pixels per word.
+ * Needs word aligned rows (aligned src, even width); other layouts use the scalar loop.
+ */
+void PixelKernels_Downscale2x(const uint16_t *src, int width, int height, uint16_t *dst) {
+    if (((uintptr_t)src & 3) != 0 || (width & 1) != 0) {
+        PixelKernels_Downscale2xScalar(src, width, height, dst);
+        return;
+    }
+    int outW = width / 2, outH = height / 2;
+    const uint32_t round = (2u << 21) | (2u << 11) | 2u; // +2 per channel before dividing by 4
+    for (int y = 0; y < outH; y++) {
+        const PixelWord *row0 = (const PixelWord *)&src[(size_t)(2 * y) * width];
+        const PixelWord *row1 = row0 + width / 2;
+        uint16_t *out = &dst[(size_t)y * outW];
+        for (int x = 0; x < outW; x++) {
+            uint32_t sum = PixelKernels_SpreadPair(row0[x]) + PixelKernels_SpreadPair(row1[x]) + round;
+            out[x] = PixelKernels_Swap(PixelKernels_Pack(sum >> 2));
+        }
+    }
+}
+
+/**
+ * @brief Scalar reference of PixelKernels_Downscale4x (one pixel at a time, channel by channel).
+ */
+void PixelKernels_Downscale4xScalar(const uint16_t *src, int width, int height, uint16_t *dst) {
+    int outW = width / 4, outH = height / 4;
+    for (int y = 0; y < outH; y++) {
+        for (int x = 0; x < outW; x++) {
+            uint32_t r = 8, g = 8, bl = 8; // Rounding
+            for (int dy = 0; dy < 4; dy++) {
+                for (int dx = 0; dx < 4; dx++) {
+                    uint16_t c = PixelKernels_Swap(src[(size_t)(4 * y + dy) * width + 4 * x + dx]);
+                    r += c >> 11;
+                    g += (c >> 5) & 0x3F;
+                    bl += c & 0x1F;
+                }
+            }
+            dst[(size_t)y * outW + x] = PixelKernels_Swap((uint16_t)(((r >> 4) << 11) | ((g >> 4) << 5) | (bl >> 4)));
+        }
+    }
+}
+
+/**
+ * @brief 4x4 box downscale on spread pixels (sums of 16 channels still fit their fields).
+ * Needs word aligned rows (aligned src, even width); other layouts use the scalar loop.
+ */
+void PixelKernels_Downscale4x(const uint16_t *src, int width, int height, uint16_t *dst) {
+    if (((uintptr_t)src & 3) != 0 || (width & 1) != 0) {
+        PixelKernels_Downscale4xScalar(src, width, height, dst);
+        return;
+    }
+    int outW = width / 4, outH = height / 4;
+    int stride = width / 2; // Row stride in words
+    const uint32_t round = (8u << 21) | (8u << 11) | 8u; // +8 per channel before dividing by 16
+    for (int y = 0; y < outH; y++) {
+        const PixelWord *row = (const PixelWord *)&src[(size_t)(4 * y) * width];
+        uint16_t *out = &dst[(size_t)y * outW];
+        for (int x = 0; x < outW; x++) {
+            const PixelWord *block = row + 2 * x;
+            uint32_t sum = round;
+            for (int dy = 0; dy < 4; dy++) {
+                sum += PixelKernels_SpreadPair(block[dy * stride]) + PixelKernels_SpreadPair(block[dy * stride + 1]);
+            }
+            out[x] = PixelKernels_Swap(PixelKernels_Pack(sum >> 4));
+        }
+    }
+}
+
+/**
+ * @brief Luma of a native RGB565 value (reference math).
+ */
+static inline uint8_t PixelKernels_LumaOf(uint16_t value) {
+    uint32_t r = (value >> 11) << 3, g = ((value >> 5) & 0x3F) << 2, b = (value & 0x1F) << 3;
+    return (uint8_t)((77 * r + 150 * g + 29 * b) >> 8); // Weights sum to 256, so the result is at most 255
+}
+
+// Luma weight sums split by the two bytes of a panel order pixel: luma = (high[byte0] + low[byte1]) >> 8
+struct PixelLumaTables {
+    uint16_t high[256]; // R5 and the upper 3 bits of G6
+    uint16_t low[256];  // The lower 3 bits of G6 and B5
+};
+
+/**
+ * @brief Build the luma tables. The weighted sum is linear in the channel bits, so it splits exactly.
+ */
+static PixelLumaTables PixelKernels_BuildLumaTables() {
+    PixelLumaTables tables;
+    for (uint32_t v = 0; v < 256; v++) {
+        tables.high[v] = (uint16_t)(77 * ((v >> 3) << 3) + 150 * ((v & 7) << 5));
+        tables.low[v] = (uint16_t)(150 * ((v >> 5) << 2) + 29 * ((v & 0x1F) << 3));
+    }
+    return tables;
+}
+
+/**
+ * @brief Get the luma tables (built on first use).
+ */
+static const PixelLumaTables &PixelKernels_GetLumaTables() {
+    static const PixelLumaTables tables = PixelKernels_BuildLumaTables();
+    return tables;
+}
+
+/**
+ * @brief Scalar reference of PixelKernels_Luma (one pixel at a time, channel by channel).
+ */
+void PixelKernels_LumaScalar(const uint16_t *src, uint8_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = PixelKernels_LumaOf(PixelKernels_Swap(src[i]));
+    }
+}
+
+/**
+ * @brief Convert pixels to luma with two table lookups per pixel (no byte swap, no multiplies).
+ */
+void PixelKernels_Luma(const uint16_t *src, uint8_t *dst, size_t count) {
+    const PixelLumaTables &tables = PixelKernels_GetLumaTables();
+    const uint8_t *bytes = (const uint8_t *)src; // Panel order: high byte first
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (uint8_t)((tables.high[bytes[2 * i]] + tables.low[bytes[2 * i + 1]]) >> 8);
+    }
+}
+
+/**
+ * @brief Scalar reference of PixelKernels_LumaHistogram (one pixel at a time, channel by channel).
+ */
+void PixelKernels_LumaHistogramScalar(const uint16_t *src, size_t count, uint32_t *histogram) {
+    memset(histogram, 0, PIXEL_HISTOGRAM_BINS * sizeof(uint32_t));
+    for (size_t i = 0; i < count; i++) {
+        histogram[PixelKernels_LumaOf(PixelKernels_Swap(src[i]))]++;
+    }
+}
+
+/**
+ * @brief Luma histogram with the table lookups of PixelKernels_Luma.
+ */
+void PixelKernels_LumaHistogram(const uint16_t *src, size_t count, uint32_t *histogram) {
+    const PixelLumaTables &tables = PixelKernels_GetLumaTables();
+    const uint8_t *bytes = (const uint8_t *)src;
+    memset(histogram, 0, PIXEL_HISTOGRAM_BINS * sizeof(uint32_t));
+    for (size_t i = 0; i < count; i++) {
+        histogram[(tables.high[bytes[2 * i]] + tables.low[bytes[2 * i + 1]]) >> 8]++;
+    }
+}
+
+/**
+ * @brief Scalar reference of PixelKernels_AbsDiff (one byte at a time).
+ */
+void PixelKernels_AbsDiffScalar(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+    }
+}
+
+/**
+ * @brief |a - b| of four bytes at once.
+ * Per-byte subtraction without carries between bytes, then negation of the bytes that borrowed.
+ */
+static inline uint32_t PixelKernels_AbsDiff4(uint32_t a, uint32_t b) {
+    const uint32_t high = 0x80808080u;
+    uint32_t diff = ((a | high) - (b & ~high)) ^ ((a ^ ~b) & high); // a - b per byte (mod 256)
+    uint32_t borrow = (((~a & b) | (~(a ^ b) & diff)) & high) >> 7; // 1 in each byte where a < b
+    return (diff ^ (borrow * 0xFF)) + borrow; // Two's complement negation of those bytes (never carries)
+}
+
+/**
+ * @brief Absolute difference of two planes, four bytes per word.
+ * Falls back to the scalar loop when the three buffers cannot all be word aligned.
+ */
+void PixelKernels_AbsDiff(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t count) {
+    uintptr_t phase = (uintptr_t)a & 3;
+    if (((uintptr_t)b & 3) != phase || ((uintptr_t)dst & 3) != phase) {
+        PixelKernels_AbsDiffScalar(a, b, dst, count);
+        return;
+    }
+    size_t head = phase ? 4 - phase : 0; // Bytes up to the word boundary
+    if (head > count) head = count;
+    PixelKernels_AbsDiffScalar(a, b, dst, head);
+    size_t words = (count - head) / 4;
+    const PixelWord *wa = (const PixelWord *)(a + head), *wb = (const PixelWord *)(b + head);
+    PixelWord *out = (PixelWord *)(dst + head);
+    for (size_t w = 0; w < words; w++) {
+        out[w] = PixelKernels_AbsDiff4(wa[w], wb[w]);
+    }
+    size_t done = head + words * 4;
+    PixelKernels_AbsDiffScalar(a + done, b + done, dst + done, count - done);
+}
+
+/**
+ * @brief Compare four bytes at once: 0x80 in each byte where a >= b, 0 elsewhere.
+ * Same borrow detection as PixelKernels_AbsDiff4.
+ */
+static inline uint32_t PixelKernels_AtLeast4(uint32_t a, uint32_t b) {
+    const uint32_t high = 0x80808080u;
+    uint32_t diff = ((a | high) - (b & ~high)) ^ ((a ^ ~b) & high);
+    uint32_t borrow = ((~a & b) | (~(a ^ b) & diff)) & high; // 0x80 where a < b
+    return borrow ^ high;
+}
+
+/**
+ * @brief Set the step x step block of an image whose top left pixel is (x, y).
+ */
+static inline void PixelKernels_MarkBlock(uint16_t *dst, int width, int x, int y, int step, uint16_t stored) {
+    for (int dy = 0; dy < step; dy++) {
+        uint16_t *out = dst + (size_t)(y + dy) * width + x;
+        for (int dx = 0; dx < step; dx++) out[dx] = stored;
+    }
+}
+
+/**
+ * @brief Set the pixels of a step x step block that lie on a zebra stripe.
+ */
+static inline void PixelKernels_MarkStripes(uint16_t *dst, int width, int x, int y, int step, int phase, uint16_t stored) {
+    for (int dy = 0; dy < step; dy++) {
+        uint16_t *out = dst + (size_t)(y + dy) * width + x;
+        for (int dx = 0; dx < step; dx++) {
+            if (((unsigned)(x + dx + y + dy + phase) & PIXEL_ZEBRA_STRIPE) == 0) out[dx] = stored;
+        }
+    }
+}
+
+/**
+ * @brief Scalar reference of PixelKernels_FocusPeaking (one sample at a time).
+ */
+void PixelKernels_FocusPeakingScalar(const uint8_t *luma, int cols, int rows, uint16_t *dst, int width, int step,
+                                     uint8_t threshold, uint16_t color) {
+    uint16_t stored = PixelKernels_Swap(color);
+    for (int y = 1; y < rows - 1; y++) {
+        const uint8_t *line = luma + (size_t)y * cols;
+        for (int x = 1; x < cols - 1; x++) {
+            int dx = line[x + 1] > line[x - 1] ? line[x + 1] - line[x - 1] : line[x - 1] - line[x + 1];
+            int dy = line[x + cols] > line[x - cols] ? line[x + cols] - line[x - cols] : line[x - cols] - line[x + cols];
+            if ((dx >> 1) + (dy >> 1) >= threshold) PixelKernels_MarkBlock(dst, width, x * step, y * step, step, stored);
+        }
+    }
+}
+
+/**
+ * @brief Focus peaking on four samples per 32-bit word (SWAR in portable C).
+ * The horizontal neighbours come from shifting the row words by one byte (little-endian targets),
+ * both differences are halved so their sum fits a byte, and words without a mark cost one compare.
+ * Falls back to the scalar loop when the rows are not word aligned.
+ */
+void PixelKernels_FocusPeaking(const uint8_t *luma, int cols, int rows, uint16_t *dst, int width, int step,
+                               uint8_t threshold, uint16_t color) {
+    if (((uintptr_t)luma & 3) || (cols & 3)) {
+        PixelKernels_FocusPeakingScalar(luma, cols, rows, dst, width, step, threshold, color);
+        return;
+    }
+    uint16_t stored = PixelKernels_Swap(color);
+    uint32_t limit = threshold * 0x01010101u;
+    size_t words = (size_t)cols / 4;
+    for (int y = 1; y < rows - 1; y++) {
+        const PixelWord *center = (const PixelWord *)(luma + (size_t)y * cols);
+        const PixelWord *above = center - words, *below = center + words;
+        uint32_t previous = 0, current = center[0];
+        for (size_t w = 0; w < words; w++) {
+            uint32_t next = w + 1 < words ? center[w + 1] : 0;
+            uint32_t left = (current << 8) | (previous >> 24); // Byte i = sample at x - 1
+            uint32_t right = (current >> 8) | (next << 24);    // Byte i = sample at x + 1
+            uint32_t magnitude = ((PixelKernels_AbsDiff4(right, left) >> 1) & 0x7F7F7F7Fu) +
+                                 ((PixelKernels_AbsDiff4(below[w], above[w]) >> 1) & 0x7F7F7F7Fu);
+            uint32_t marks = PixelKernels_AtLeast4(magnitude, limit);
+            for (int i = 0; marks; i++, marks >>= 8) { // Only words with a mark get here
+                int x = (int)(w * 4) + i;
+                if ((marks & 0x80) && x >= 1 && x < cols - 1) { // The border samples have no neighbours
+                    PixelKernels_MarkBlock(dst, width, x * step, y * step, step, stored);
+                }
+            }
+            previous = current;
+            current = next;
+        }
+    }
+}
+
+/**
+ * @brief Scalar reference of PixelKernels_Zebra (one sample at a time).
+ */
+void PixelKernels_ZebraScalar(const uint8_t *luma, int cols, int rows, uint16_t *dst, int width, int step,
+                              uint8_t threshold, int phase, uint16_t color) {
+    uint16_t stored = PixelKernels_Swap(color);
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < cols; x++) {
+            if (luma[(size_t)y * cols + x] >= threshold) {
+                PixelKernels_MarkStripes(dst, width, x * step, y * step, step, phase, stored);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Zebra stripes with a four-sample SWAR compare per 32-bit word (most words have no mark).
+ * Falls back to the scalar loop when the rows are not word aligned.
+ */
+void PixelKernels_Zebra(const uint8_t *luma, int cols, int rows, uint16_t *dst, int width, int step,
+                        uint8_t threshold, int phase, uint16_t color) {
+    if (((uintptr_t)luma & 3) || (cols & 3)) {
+        PixelKernels_ZebraScalar(luma, cols, rows, dst, width, step, threshold, phase, color);
+        return;
+    }
+    uint16_t stored = PixelKernels_Swap(color);
+    uint32_t limit = threshold * 0x01010101u;
+    const PixelWord *samples = (const PixelWord *)luma;
+    size_t words = (size_t)cols / 4 * rows;
+    for (size_t w = 0; w < words; w++) {
+        uint32_t marks = PixelKernels_AtLeast4(samples[w], limit);
+        for (int i = 0; marks; i++, marks >>= 8) {
+            if (!(marks & 0x80)) continue;
+            size_t index = w * 4 + i;
+            int x = (int)(index % cols), y = (int)(index / cols);
+            PixelKernels_MarkStripes(dst, width, x * step, y * step, step, phase, stored);
+        }
+    }
+}
+
+// State of the verification input generator
+static uint32_t verifySeed;
+
+/**
+ * @brief Fill a buffer with pseudo-random bytes (LCG, seeded per kernel).
+ */
+static void PixelKernels_Random(void *buffer, size_t size) {
+    uint8_t *bytes = (uint8_t *)buffer;
+    for (size_t i = 0; i < size; i++) {
+        verifySeed = verifySeed * 1664525 + 1013904223;
+        bytes[i] = (uint8_t)(verifySeed >> 24);
+    }
+}
+
+/**
+ * @brief Report a mismatch.
+ * @return 1 (one failing kernel)
+ */
+static int PixelKernels_Fail(void (*log)(const char *line), const char *kernel, int count, int offset) {
+    if (log) {
+        char line[96];
+        snprintf(line, sizeof(line), "%s: differs from the scalar reference (count %d, offset %d)", kernel, count, offset);
+        log(line);
+    }
+    return 1;
+}
+
+/**
+ * @brief Compare every fast kernel with its scalar reference on seeded random inputs,
+ * all lengths up to 67 and all buffer alignments.
+ * Output buffers are compared in full, so writes past the end are caught as well.
+ * @param log Called with one line per failing kernel (may be NULL)
+ * @return Number of failing kernels (0 = all identical)
+ */
+int PixelKernels_Verify(void (*log)(const char *line)) {
+    const int maxCount = 67;
+    static uint16_t srcA[maxCount + 4], srcB[maxCount + 4], outFast[maxCount + 4], outRef[maxCount + 4];
+    static uint8_t planeA[maxCount + 4], planeB[maxCount + 4], planeFast[maxCount + 4], planeRef[maxCount + 4];
+    static uint16_t image[20 * 12 + 2], scaledFast[10 * 6 + 2], scaledRef[10 * 6 + 2];
+    static uint16_t overlayFast[40 * 24], overlayRef[40 * 24];
+    alignas(4) static uint8_t overlayLuma[20 * 12 + 4]; // Word aligned: offset 0 takes the fast paths
+    static uint32_t histFast[PIXEL_HISTOGRAM_BINS], histRef[PIXEL_HISTOGRAM_BINS];
+    int failures = 0;
+    bool swapOk = true, fillOk = true, blendOk = true, lumaOk = true, histOk = true, diffOk = true;
+    verifySeed = 1;
+    for (int count = 0; count <= maxCount; count++) {
+        for (int offset = 0; offset < 4; offset++) {
+            int pixelOffset = offset & 1; // Pixel buffers: word aligned or not
+            PixelKernels_Random(srcA, sizeof(srcA));
+            PixelKernels_Random(srcB, sizeof(srcB));
+            PixelKernels_Random(outFast, sizeof(outFast));
+            memcpy(outRef, outFast, sizeof(outRef));
+            PixelKernels_SwapBytes(srcA + pixelOffset, outFast + (offset >> 1), count);
+            PixelKernels_SwapBytesScalar(srcA + pixelOffset, outRef + (offset >> 1), count);
+            if (swapOk && memcmp(outFast, outRef, sizeof(outRef)) != 0) {
+                swapOk = false;
+                failures += PixelKernels_Fail(log, "swap_bytes", count, offset);
+            }
+            uint16_t color = srcB[0];
+            PixelKernels_Fill(outFast + pixelOffset, count, color);
+            PixelKernels_FillScalar(outRef + pixelOffset, count, color);
+            if (fillOk && memcmp(outFast, outRef, sizeof(outRef)) != 0) {
+                fillOk = false;
+                failures += PixelKernels_Fail(log, "fill", count, offset);
+            }
+            static const uint8_t alphas[] = {0, 1, 16, 31, PIXEL_ALPHA_MAX};
+            for (uint8_t alpha : alphas) {
+                PixelKernels_Blend(srcA + pixelOffset, srcB, outFast, count, alpha);
+                PixelKernels_BlendScalar(srcA + pixelOffset, srcB, outRef, count, alpha);
+                if (blendOk && memcmp(outFast, outRef, sizeof(outRef)) != 0) {
+                    blendOk = false;
+                    failures += PixelKernels_Fail(log, "blend", count, alpha);
+                }
+            }
+            PixelKernels_Random(planeFast, sizeof(planeFast));
+            memcpy(planeRef, planeFast, sizeof(planeRef));
+            PixelKernels_Luma(srcA + pixelOffset, planeFast + offset, count);
+            PixelKernels_LumaScalar(srcA + pixelOffset, planeRef + offset, count);
+            if (lumaOk && memcmp(planeFast, planeRef, sizeof(planeRef)) != 0) {
+                lumaOk = false;
+                failures += PixelKernels_Fail(log, "luma", count, offset);
+            }
+            PixelKernels_LumaHistogram(srcA + pixelOffset, count, histFast);
+            PixelKernels_LumaHistogramScalar(srcA + pixelOffset, count, histRef);
+            if (histOk && memcmp(histFast, histRef, sizeof(histRef)) != 0) {
+                histOk = false;
+                failures += PixelKernels_Fail(log, "histogram", count, offset);
+            }
+            PixelKernels_Random(planeA, sizeof(planeA));
+            PixelKernels_Random(planeB, sizeof(planeB));
+            for (int shift = 0; shift < 4; shift++) { // b and dst at every alignment relative to a
+                PixelKernels_AbsDiff(planeA + offset, planeB + shift, planeFast + offset, count);
+                PixelKernels_AbsDiffScalar(planeA + offset, planeB + shift, planeRef + offset, count);
+            }
+            if (diffOk && memcmp(planeFast, planeRef, sizeof(planeRef)) != 0) {
+                diffOk = false;
+                failures += PixelKernels_Fail(log, "absdiff", count, offset);
+            }
+        }
+    }
+    bool scale2Ok = true, scale4Ok = true;
+    bool peakingOk = true, zebraOk = true;
+    for (int width = 1; width <= 20; width++) {
+        for (int height = 1; height <= 12; height++) {
+            for (int offset = 0; offset < 2; offset++) {
+                PixelKernels_Random(image, sizeof(image));
+                PixelKernels_Random(scaledFast, sizeof(scaledFast));
+                memcpy(scaledRef, scaledFast, sizeof(scaledRef));
+                PixelKernels_Downscale2x(image + offset, width, height, scaledFast);
+                PixelKernels_Downscale2xScalar(image + offset, width, height, scaledRef);
+                if (scale2Ok && memcmp(scaledFast, scaledRef, sizeof(scaledRef)) != 0) {
+                    scale2Ok = false;
+                    failures += PixelKernels_Fail(log, "downscale_2x", width * height, offset);
+                }
+                PixelKernels_Downscale4x(image + offset, width, height, scaledFast);
+                PixelKernels_Downscale4xScalar(image + offset, width, height, scaledRef);
+                if (scale4Ok && memcmp(scaledFast, scaledRef, sizeof(scaledRef)) != 0) {
+                    scale4Ok = false;
+                    failures += PixelKernels_Fail(log, "downscale_4x", width * height, offset);
+                }
+            }
+        }
+    }
+    for (int cols = 1; cols <= 20; cols++) { // Overlays: aligned planes (fast path) and offset ones (fallback)
+        for (int rows = 1; rows <= 12; rows++) {
+            for (int variant = 0; variant < 4; variant++) {
+                int offset = variant & 1, step = 1 + (variant >> 1);
+                const uint8_t *luma = overlayLuma + offset;
+                PixelKernels_Random(overlayLuma, sizeof(overlayLuma));
+                PixelKernels_Random(overlayFast, sizeof(overlayFast));
+                memcpy(overlayRef, overlayFast, sizeof(overlayRef));
+                uint8_t threshold = (uint8_t)(1 + cols * rows % 97); // From "every sample" to a few
+                uint16_t color = overlayFast[0];
+                PixelKernels_FocusPeaking(luma, cols, rows, overlayFast, 40, step, threshold, color);
+                PixelKernels_FocusPeakingScalar(luma, cols, rows, overlayRef, 40, step, threshold, color);
+                if (peakingOk && memcmp(overlayFast, overlayRef, sizeof(overlayRef)) != 0) {
+                    peakingOk = false;
+                    failures += PixelKernels_Fail(log, "focus_peaking", cols * rows, variant);
+                }
+                threshold = (uint8_t)(100 + cols * rows % 150);
+                PixelKernels_Zebra(luma, cols, rows, overlayFast, 40, step, threshold, cols + variant, color);
+                PixelKernels_ZebraScalar(luma, cols, rows, overlayRef, 40, step, threshold, cols + variant, color);
+                if (zebraOk && memcmp(overlayFast, overlayRef, sizeof(overlayRef)) != 0) {
+                    zebraOk = false;
+                    failures += PixelKernels_Fail(log, "zebra", cols * rows, variant);
+                }
+            }
+        }
+    }
+    return failures;
+}
@@ -0,0 +1,155 @@
+// pixelKernels.h - RGB565 pixel kernels
+// This header declares the per-pixel loops of the preview and photo paths: grid overlay, byte
+// order conversion, fill, blend, 2:1 and 4:1 box downscaling, luma conversion, luma histogram,
+// absolute difference of luma planes, and the focus peaking and zebra preview overlays.
+// The kernels have no Arduino or FreeRTOS dependencies, so the benchmark suite (bench.h) and
+// the native build run exactly the code the device runs.
+//
+// Key features:
+// - Frame pixels are RGB565 in panel byte order (big-endian), as the camera and sprites store them
+// - Each kernel has a plain scalar reference (...Scalar) and a fast version that works on 32-bit
+//   words (two pixels or four luma bytes at a time) or lookup tables
+// - Fast and reference versions give bit-identical results; PixelKernels_Verify() checks this
+// - The fast versions are portable C (word-parallel SWAR), not ESP32-S3 PIE vector code
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stdint.h> // Fixed-width integer types
+#include <stddef.h> // size_t
+
+// Number of luma histogram bins (8-bit luma)
+#define PIXEL_HISTOGRAM_BINS 256
+// Blend weight of the first image at full strength (PixelKernels_Blend alpha range 0..PIXEL_ALPHA_MAX)
+#define PIXEL_ALPHA_MAX 32
+// Zebra stripe width in pixels (diagonal stripes, one marked and one clear per period, power of two)
+#define PIXEL_ZEBRA_STRIPE 4
+
+/**
+ * @brief Draw a 3x3 grid overlay on an image buffer.
+ * @param image Pointer to image buffer (RGB565)
+ * @param width Image width
+ * @param height Image height
+ * @param color Grid line color (stored as is)
+ */
+void PixelKernels_DrawGrid3x3(uint16_t *image, int width, int height, uint16_t color);
+
+/**
+ * @brief Swap the two bytes of each RGB565 pixel (panel byte order <-> native).
+ * @param src Source pixels
+ * @param dst Destination pixels (may be the same buffer as src)
+ * @param count Number of pixels
+ */
+void PixelKernels_SwapBytes(const uint16_t *src, uint16_t *dst, size_t count);
+void PixelKernels_SwapBytesScalar(const uint16_t *src, uint16_t *dst, size_t count);
+
+/**
+ * @brief Fill pixels with one color.
+ * @param dst Destination pixels (panel byte order)
+ * @param count Number of pixels
+ * @param color Native RGB565 color (stored in panel byte order)
+ */
+void PixelKernels_Fill(uint16_t *dst, size_t count, uint16_t color);
+void PixelKernels_FillScalar(uint16_t *dst, size_t count, uint16_t color);
+
+/**
+ * @brief Blend two images per channel: dst = (a * alpha + b * (PIXEL_ALPHA_MAX - alpha)) / PIXEL_ALPHA_MAX.
+ * @param a First image (panel byte order)
+ * @param b Second image (panel byte order)
+ * @param dst Destination (may be a or b)
+ * @param count Number of pixels
+ * @param alpha Weight of a, 0..PIXEL_ALPHA_MAX
+ */
+void PixelKernels_Blend(const uint16_t *a, const uint16_t *b, uint16_t *dst, size_t count, uint8_t alpha);
+void PixelKernels_BlendScalar(const uint16_t *a, const uint16_t *b, uint16_t *dst, size_t count, uint8_t alpha);
+
+/**
+ * @brief Downscale an image by 2 in both directions, averaging each 2x2 block per channel (rounded).
+ * @param src Source pixels (RGB565, panel byte order)
+ * @param width Source width (an odd last column is dropped)
+ * @param height Source height (an odd last row is dropped)
+ * @param dst Destination, (width / 2) x (height / 2) pixels in panel byte order
+ */
+void PixelKernels_Downscale2x(const uint16_t *src, int width, int height, uint16_t *dst);
+void PixelKernels_Downscale2xScalar(const uint16_t *src, int width, int height, uint16_t *dst);
+
+/**
+ * @brief Downscale an image by 4 in both directions, averaging each 4x4 block per channel (rounded).
+ * @param src Source pixels (RGB565, panel byte order)
+ * @param width Source width (columns beyond a multiple of 4 are dropped)
+ * @param height Source height (rows beyond a multiple of 4 are dropped)
+ * @param dst Destination, (width / 4) x (height / 4) pixels in panel byte order
+ */
+void PixelKernels_Downscale4x(const uint16_t *src, int width, int height, uint16_t *dst);
+void PixelKernels_Downscale4xScalar(const uint16_t *src, int width, int height, uint16_t *dst);
+
+/**
+ * @brief Convert pixels to 8-bit luma (BT.601 weights, channels expanded by shifting).
+ * @param src Source pixels (RGB565, panel byte order)
+ * @param dst Destination, one byte per pixel
+ * @param count Number of pixels
+ */
+void PixelKernels_Luma(const uint16_t *src, uint8_t *dst, size_t count);
+void PixelKernels_LumaScalar(const uint16_t *src, uint8_t *dst, size_t count);
+
+/**
+ * @brief Count the 8-bit luma (as PixelKernels_Luma) of each pixel into a histogram.
+ * @param src Source pixels (RGB565, panel byte order)
+ * @param count Number of pixels
+ * @param histogram PIXEL_HISTOGRAM_BINS counters, overwritten
+ */
+void PixelKernels_LumaHistogram(const uint16_t *src, size_t count, uint32_t *histogram);
+void PixelKernels_LumaHistogramScalar(const uint16_t *src, size_t count, uint32_t *histogram);
+
+/**
+ * @brief Absolute difference of two 8-bit planes: dst = |a - b|.
+ * @param a First plane
+ * @param b Second plane
+ * @param dst Destination (may be a or b)
+ * @param count Number of bytes
+ */
+void PixelKernels_AbsDiff(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t count);
+void PixelKernels_AbsDiffScalar(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t count);
+
+/**
+ * @brief Focus peaking: mark the image where a luma plane of it has strong edges.
+ * Edge magnitude = |L(x+1) - L(x-1)| / 2 + |L(y+1) - L(y-1)| / 2 (each half rounded down); each inner
+ * sample with a magnitude of at least threshold marks its step x step block of the image.
+ * @param luma Luma plane, cols x rows samples (e.g. the frame statistics grid)
+ * @param cols Samples per row (word aligned rows, cols a multiple of 4, take the fast path)
+ * @param rows Rows of samples
+ * @param dst Image to mark (RGB565, panel byte order), at least (cols * step) x (rows * step); other pixels are left as they are
+ * @param width Image width
+ * @param step Image pixels per sample in both directions
+ * @param threshold Smallest marked magnitude (1..254)
+ * @param color Native RGB565 mark color (stored in panel byte order)
+ */
+void PixelKernels_FocusPeaking(const uint8_t *luma, int cols, int rows, uint16_t *dst, int width, int step,
+                               uint8_t threshold, uint16_t color);
+void PixelKernels_FocusPeakingScalar(const uint8_t *luma, int cols, int rows, uint16_t *dst, int width, int step,
+                                     uint8_t threshold, uint16_t color);
+
+/**
+ * @brief Zebra stripes: mark overexposed areas of the image with diagonal stripes.
+ * Every sample with a luma of at least threshold marks the pixels of its step x step block that lie on a
+ * stripe ((x + y + phase) / PIXEL_ZEBRA_STRIPE even, in image pixels).
+ * @param luma Luma plane, cols x rows samples (e.g. the frame statistics grid)
+ * @param cols Samples per row (word aligned rows, cols a multiple of 4, take the fast path)
+ * @param rows Rows of samples
+ * @param dst Image to mark (RGB565, panel byte order), at least (cols * step) x (rows * step); other pixels are left as they are
+ * @param width Image width
+ * @param step Image pixels per sample in both directions
+ * @param threshold Smallest marked luma
+ * @param phase Stripe offset (advance it per frame to make the stripes crawl)
+ * @param color Native RGB565 stripe color (stored in panel byte order)
+ */
+void PixelKernels_Zebra(const uint8_t *luma, int cols, int rows, uint16_t *dst, int width, int step,
+                        uint8_t threshold, int phase, uint16_t color);
+void PixelKernels_ZebraScalar(const uint8_t *luma, int cols, int rows, uint16_t *dst, int width, int step,
+                              uint8_t threshold, int phase, uint16_t color);
+
+/**
+ * @brief Compare every fast kernel with its scalar reference on seeded random inputs,
+ * all lengths up to 67 and all buffer alignments.
+ * @param log Called with one line per failing kernel (may be NULL)
+ * @return Number of failing kernels (0 = all identical)
+ */
+int PixelKernels_Verify(void (*log)(const char *line));
@@ -0,0 +1,261 @@
+// profiler.cpp - Per-task CPU and stack profiling implementation
+// This module runs a low-priority task that samples uxTaskGetSystemState every
+// PROFILER_INTERVAL_MS, turns run-time counter deltas into CPU shares, and keeps the
+// latest profile for the serial console, /profile, /metrics and the HUD.
+//
+// Key features:
+// - Per-task CPU share needs configGENERATE_RUN_TIME_STATS (reported as -1 otherwise)
+// - Stack high-water marks only need configUSE_TRACE_FACILITY
+// - Task list read into a buffer sized from uxTaskGetNumberOfTasks() at each sample; tables
+//   longer than PROFILER_MAX_TASKS are cut when published, never dropped
+// - Configured stack sizes joined from taskConfigTable to show headroom
+// - Core load without run-time stats: a tick hook on each core counts the ticks that land in
+//   that core's idle task (a statistical sample, 1 ms resolution at the default tick rate)
+
+#include "profiler.h"          // Include header for this module
+#include <esp_timer.h>         // Microsecond clock
+#include <esp_freertos_hooks.h> // Per-core tick hooks
+#include <atomic>              // Tick counters shared with the tick hooks
+#include <freertos/FreeRTOS.h> // Task list and run-time stats
+#include <freertos/task.h>
+#include "taskConfig.h"        // Configured stack sizes
+
+// Latest published profile and its lock
+static SystemProfile latestProfile;
+static SemaphoreHandle_t profileMutex;
+
+// Ticks seen by each core's tick hook, and how many of them interrupted its idle task
+static std::atomic<uint32_t> tickCount[2];
+static std::atomic<uint32_t> idleTickCount[2];
+static TaskHandle_t idleTasks[2];
+
+/**
+ * @brief Tick hook, registered on both cores (interrupt context): count the tick and whether the
+ * idle task was running.
+ */
+static void IRAM_ATTR Profiler_TickHook() {
+    BaseType_t core = xPortGetCoreID();
+    tickCount[core].fetch_add(1, std::memory_order_relaxed);
+    if (xTaskGetCurrentTaskHandle() == idleTasks[core]) idleTickCount[core].fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Turn the tick counts since the previous call into per-core load.
+ * @param load Receives the load of core 0 and core 1 in percent (-1 if no ticks were counted)
+ */
+static void Profiler_SampleTicks(float load[2]) {
+    static uint32_t lastTicks[2], lastIdleTicks[2];
+    for (int core = 0; core < 2; core++) {
+        uint32_t idle = idleTickCount[core].load(std::memory_order_relaxed); // Before the total: idle <= total
+        uint32_t ticks = tickCount[core].load(std::memory_order_relaxed);
+        uint32_t elapsed = ticks - lastTicks[core];
+        load[core] = elapsed ? constrain(100.0f - (idle - lastIdleTicks[core]) * 100.0f / elapsed, 0.0f, 100.0f) : -1;
+        lastTicks[core] = ticks;
+        lastIdleTicks[core] = idle;
+    }
+}
+
+#if configUSE_TRACE_FACILITY
+// Run-time counters from a sample, matched by task handle
+struct RunTimeSample {
+    TaskHandle_t handle;
+    uint32_t runTime;
+};
+// Sample buffers, grown to the task count plus PROFILER_TASK_HEADROOM (profiler task only)
+static TaskStatus_t *status = NULL;
+static RunTimeSample *samples = NULL;
+static RunTimeSample *lastSamples = NULL;
+static UBaseType_t sampleCapacity = 0;
+static int lastSampleCount = 0;
+static int64_t lastSampleTime = 0;
+
+/**
+ * @brief Grow the sample buffers to hold at least the given number of tasks.
+ * @param capacity Required number of entries
+ * @return true if the buffers are large enough
+ */
+static bool Profiler_Reserve(UBaseType_t capacity) {
+    if (capacity <= sampleCapacity) return true;
+    TaskStatus_t *newStatus = (TaskStatus_t *)realloc(status, capacity * sizeof(TaskStatus_t));
+    if (newStatus) status = newStatus;
+    RunTimeSample *newSamples = (RunTimeSample *)realloc(samples, capacity * sizeof(RunTimeSample));
+    if (newSamples) samples = newSamples;
+    RunTimeSample *newLastSamples = (RunTimeSample *)realloc(lastSamples, capacity * sizeof(RunTimeSample));
+    if (newLastSamples) lastSamples = newLastSamples;
+    if (!newStatus || !newSamples || !newLastSamples) return false;
+    sampleCapacity = capacity;
+    return true;
+}
+
+/**
+ * @brief Look up the configured stack size of a task by name.
+ * @return Stack size in bytes, or 0 if the task is not in taskConfigTable
+ */
+static uint32_t Profiler_ConfiguredStack(const char *name) {
+    for (int i = 0; i < TASK_COUNT; i++) {
+        if (strcmp(taskConfigTable[i].name, name) == 0) return taskConfigTable[i].stackSize;
+    }
+    return 0;
+}
+
+/**
+ * @brief Take one sample and publish the resulting profile. Keeps the previous profile if the
+ * task list cannot be read.
+ * @param tickLoad Tick-sampled core load, used where the idle task run time is unavailable
+ */
+static void Profiler_Sample(const float tickLoad[2]) {
+    static SystemProfile profile;
+    // uxTaskGetSystemState returns 0 if the buffer is too small (tasks created since the
+    // count); retry once with a fresh count before giving up until the next interval
+    UBaseType_t count = 0;
+    for (int attempt = 0; attempt < 2 && count == 0; attempt++) {
+        if (!Profiler_Reserve(uxTaskGetNumberOfTasks() + PROFILER_TASK_HEADROOM)) {
+            Serial.println("[Profiler] Out of memory for the task list.");
+            return;
+        }
+        count = uxTaskGetSystemState(status, sampleCapacity, NULL);
+    }
+    if (count == 0) return;
+    int64_t now = esp_timer_get_time();
+    int64_t elapsed = lastSampleTime ? now - lastSampleTime : 0;
+    profile.taskCount = min((int)count, PROFILER_MAX_TASKS);
+    profile.taskTotal = count;
+    profile.coreLoad[0] = tickLoad[0];
+    profile.coreLoad[1] = tickLoad[1];
+    profile.intervalMs = elapsed / 1000;
+    for (UBaseType_t i = 0; i < count; i++) {
+        float cpuPercent = -1;
+        samples[i].handle = status[i].xHandle;
+        samples[i].runTime = status[i].ulRunTimeCounter;
+#if configGENERATE_RUN_TIME_STATS
+        for (int j = 0; j < lastSampleCount && elapsed > 0; j++) {
+            if (lastSamples[j].handle != status[i].xHandle) continue;
+            cpuPercent = (status[i].ulRunTimeCounter - lastSamples[j].runTime) * 100.0f / elapsed;
+        }
+        for (int core = 0; core < 2; core++) {
+            if (status[i].xHandle == xTaskGetIdleTaskHandleForCPU(core) && cpuPercent >= 0) {
+                profile.coreLoad[core] = constrain(100.0f - cpuPercent, 0.0f, 100.0f);
+            }
+        }
+#endif
+        if (i >= PROFILER_MAX_TASKS) continue; // Counted in taskTotal and the core load only
+        TaskProfile &task = profile.tasks[i];
+        strncpy(task.name, status[i].pcTaskName, sizeof(task.name) - 1);
+        task.name[sizeof(task.name) - 1] = '\0';
+        task.core = status[i].xCoreID == tskNO_AFFINITY ? -1 : (int)status[i].xCoreID;
+        task.priority = status[i].uxCurrentPriority;
+        task.stackFreeMin = status[i].usStackHighWaterMark;
+        task.stackSize = Profiler_ConfiguredStack(task.name);
+        task.cpuPercent = cpuPercent;
+    }
+    RunTimeSample *previous = lastSamples; // This sample becomes the baseline of the next one
+    lastSamples = samples;
+    samples = previous;
+    lastSampleCount = count;
+    lastSampleTime = now;
+    xSemaphoreTake(profileMutex, portMAX_DELAY);
+    latestProfile = profile;
+    xSemaphoreGive(profileMutex);
+}
+#endif
+
+/**
+ * @brief Profiler task loop. Samples run-time statistics at a fixed interval.
+ * @param pvParameters Not used (for FreeRTOS compatibility)
+ */
+static void ProfilerTask(void *pvParameters) {
+    while (1) {
+        float tickLoad[2];
+        Profiler_SampleTicks(tickLoad);
+#if configUSE_TRACE_FACILITY
+        Profiler_Sample(tickLoad);
+#else
+        xSemaphoreTake(profileMutex, portMAX_DELAY);
+        latestProfile.coreLoad[0] = tickLoad[0];
+        latestProfile.coreLoad[1] = tickLoad[1];
+        xSemaphoreGive(profileMutex);
+#endif
+        vTaskDelay(PROFILER_INTERVAL_MS / portTICK_PERIOD_MS);
+    }
+}
+
+/**
+ * @brief Start the profiler sampling task.
+ */
+void Profiler_Init() {
+    profileMutex = xSemaphoreCreateMutex();
+    latestProfile.taskCount = latestProfile.taskTotal = 0;
+    latestProfile.coreLoad[0] = latestProfile.coreLoad[1] = -1;
+#if !configUSE_TRACE_FACILITY
+    Serial.println("[Profiler] FreeRTOS trace facility disabled, no task data available.");
+#endif
+    for (int core = 0; core < 2; core++) {
+        idleTasks[core] = xTaskGetIdleTaskHandleForCPU(core);
+        if (esp_register_freertos_tick_hook_for_cpu(Profiler_TickHook, core) != ESP_OK) {
+            Serial.printf("[Profiler] No tick hook on core %d, its load needs run-time stats.\n", core);
+        }
+    }
+    TaskConfig_Start(TASK_PROFILER, ProfilerTask, NULL, NULL);
+}
+
+/**
+ * @brief Copy the latest system profile.
+ * @param out Destination
+ */
+void Profiler_GetProfile(SystemProfile &out) {
+    xSemaphoreTake(profileMutex, portMAX_DELAY);
+    out = latestProfile;
+    xSemaphoreGive(profileMutex);
+}
+
+/**
+ * @brief Get the latest per-core utilization.
+ * @param load Receives the load of core 0 and core 1 in percent (-1 if unavailable)
+ */
+void Profiler_GetCoreLoad(float load[2]) {
+    xSemaphoreTake(profileMutex, portMAX_DELAY);
+    load[0] = latestProfile.coreLoad[0];
+    load[1] = latestProfile.coreLoad[1];
+    xSemaphoreGive(profileMutex);
+}
+
+/**
+ * @brief Print the latest profile as a table to the serial port.
+ */
+void Profiler_PrintSerial() {
+    static SystemProfile profile;
+    Profiler_GetProfile(profile);
+    Serial.printf("[Profiler] Interval %u ms, core0 %.1f%%, core1 %.1f%%\n",
+                  (unsigned)profile.intervalMs, profile.coreLoad[0], profile.coreLoad[1]);
+    Serial.println("[Profiler] task             core prio   cpu%  stack free/size");
+    for (int i = 0; i < profile.taskCount; i++) {
+        const TaskProfile &t = profile.tasks[i];
+        Serial.printf("[Profiler] %-16s %4d %4d %6.1f  %5u/%u\n", t.name, t.core, t.priority,
+                      t.cpuPercent, (unsigned)t.stackFreeMin, (unsigned)t.stackSize);
+    }
+    if (profile.taskTotal > profile.taskCount) {
+        Serial.printf("[Profiler] %d more task(s) not shown\n", profile.taskTotal - profile.taskCount);
+    }
+}
+
+/**
+ * @brief Render the latest profile as JSON.
+ * @return JSON document
+ */
+String Profiler_RenderJson() {
+    static SystemProfile profile;
+    Profiler_GetProfile(profile);
+    char buf[160];
+    snprintf(buf, sizeof(buf), "{\"interval_ms\":%u,\"core_load\":[%.1f,%.1f],\"task_total\":%d,\"tasks\":[",
+             (unsigned)profile.intervalMs, profile.coreLoad[0], profile.coreLoad[1], profile.taskTotal);
+    String json = buf;
+    for (int i = 0; i < profile.taskCount; i++) {
+        const TaskProfile &t = profile.tasks[i];
+        snprintf(buf, sizeof(buf),
+                 "%s{\"name\":\"%s\",\"core\":%d,\"priority\":%d,\"cpu\":%.1f,\"stack_free_min\":%u,\"stack_size\":%u}",
+                 i ? "," : "", t.name, t.core, t.priority, t.cpuPercent, (unsigned)t.stackFreeMin, (unsigned)t.stackSize);
+        json += buf;
+    }
+    json += "]}";
+    return json;
+}
@@ -0,0 +1,66 @@
+// profiler.h - Per-task CPU and stack profiling module
+// This header declares the profiling service that periodically samples FreeRTOS run-time
+// statistics and publishes per-task CPU usage, stack high-water marks and per-core load.
+//
+// Key features:
+// - Background sampler task (interval PROFILER_INTERVAL_MS)
+// - Per-task CPU share, core, priority and minimum free stack
+// - Per-core utilization from idle task run time, or from tick sampling when run-time stats are off
+// - Reports over serial ("profile" command) and HTTP (/profile, JSON)
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h> // Arduino core library
+
+// Sampling interval of the profiler task
+#define PROFILER_INTERVAL_MS 2000
+// Maximum number of tasks kept in a published profile (the sampler reads every task)
+#define PROFILER_MAX_TASKS 32
+// Spare status slots for tasks created between counting the tasks and reading their state
+#define PROFILER_TASK_HEADROOM 4
+
+// Profile of one task over the last interval
+struct TaskProfile {
+    char name[16];          // Task name
+    int core;               // Core affinity (-1 = not pinned)
+    int priority;           // Current priority
+    float cpuPercent;       // Share of one core over the interval (-1 = unavailable)
+    uint32_t stackFreeMin;  // Minimum free stack ever seen (bytes)
+    uint32_t stackSize;     // Configured stack size from taskConfigTable (0 = unknown)
+};
+
+// Profile of the whole system over the last interval
+struct SystemProfile {
+    TaskProfile tasks[PROFILER_MAX_TASKS];
+    int taskCount;
+    int taskTotal;          // Tasks in the system (more than taskCount when the table is full)
+    float coreLoad[2];      // Utilization per core in percent (-1 = unavailable)
+    uint32_t intervalMs;    // Length of the sampled interval
+};
+
+/**
+ * @brief Start the profiler sampling task.
+ */
+void Profiler_Init();
+
+/**
+ * @brief Copy the latest system profile.
+ * @param out Destination
+ */
+void Profiler_GetProfile(SystemProfile &out);
+
+/**
+ * @brief Get the latest per-core utilization.
+ * @param load Receives the load of core 0 and core 1 in percent (-1 if unavailable)
+ */
+void Profiler_GetCoreLoad(float load[2]);
+
+/**
+ * @brief Print the latest profile as a table to the serial port.
+ */
+void Profiler_PrintSerial();
+
+/**
+ * @brief Render the latest profile as JSON.
+ * @return JSON document
+ */
+String Profiler_RenderJson();
@@ -0,0 +1,176 @@
+// sensorExposure.cpp - Auto exposure / white balance hand-over implementation
+// Exposure is counted in sensor lines, and a line lasts longer or shorter depending on the
+// mode's pixel clock and line length. The snapshot stores the line duration next to the
+// exposure (in units that only have to be consistent for one sensor), and the restore keeps
+// exposure time x gain constant: the new exposure is filled up to the frame length of the new
+// mode and any remainder goes into gain, the same split the sensors' own AEC makes.
+//
+// Key features:
+// - OV2640: AEC[15:0] in REG45/AEC/REG04, GAIN, COM8 auto bits, line time from COM7 mode and CLKRC
+// - OV5640: 0x3500-0x3502 exposure, 0x350A/B gain, 0x3400-0x3405 AWB gains, line time from HTS and PLL
+// - Unsupported sensors or an unconverged preview leave the sensor on auto
+
+#include "sensorExposure.h" // Include header for this module
+
+// OV2640 sensor bank registers (bit 8 selects the bank in get_reg/set_reg)
+#define OV2640_BANK_SENSOR 0x100
+#define OV2640_GAIN (OV2640_BANK_SENSOR | 0x00)
+#define OV2640_REG04 (OV2640_BANK_SENSOR | 0x04)  // AEC[1:0]
+#define OV2640_AEC (OV2640_BANK_SENSOR | 0x10)    // AEC[9:2]
+#define OV2640_CLKRC (OV2640_BANK_SENSOR | 0x11)  // Clock doubler and divider
+#define OV2640_COM7 (OV2640_BANK_SENSOR | 0x12)   // Resolution mode
+#define OV2640_COM8 (OV2640_BANK_SENSOR | 0x13)   // AEC/AGC enable
+#define OV2640_REG45 (OV2640_BANK_SENSOR | 0x45)  // AEC[15:10]
+#define OV2640_COM8_AUTO 0x05                     // AGC (bit 2) and AEC (bit 0) on
+#define OV2640_MAX_GAIN16 (31 << 4)               // 2^4 x (1 + 15/16)
+
+// OV5640 registers
+#define OV5640_SC_PLL_CTRL0 0x3034 // MIPI bit mode
+#define OV5640_SC_PLL_CTRL1 0x3035 // System clock divider
+#define OV5640_SC_PLL_CTRL2 0x3036 // PLL multiplier
+#define OV5640_SC_PLL_CTRL3 0x3037 // PLL root divider, pre-divider
+#define OV5640_SYS_ROOT_DIV 0x3108 // SCLK divider
+#define OV5640_AWB_R_GAIN 0x3400   // 12-bit gains: R, G, B at 0x3400/0x3402/0x3404
+#define OV5640_AWB_G_GAIN 0x3402
+#define OV5640_AWB_B_GAIN 0x3404
+#define OV5640_AWB_MANUAL 0x3406   // Bit 0: manual AWB
+#define OV5640_AEC_PK_EXPOSURE 0x3500 // 20-bit exposure in 1/16 lines
+#define OV5640_AEC_PK_MANUAL 0x3503   // Bit 0: manual AEC, bit 1: manual AGC
+#define OV5640_AEC_PK_REAL_GAIN 0x350A // 10-bit gain x16
+#define OV5640_TIMING_HTS 0x380C
+#define OV5640_TIMING_VTS 0x380E
+#define OV5640_MAX_GAIN16 0x3FF
+
+/**
+ * @brief OV2640 gain register to gain x16 (each of bits 7..4 doubles, bits 3..0 add 1/16 steps).
+ */
+static uint32_t SensorExposure_Ov2640GainToX16(int reg) {
+    return (16 + (reg & 0x0F)) << __builtin_popcount((reg >> 4) & 0x0F);
+}
+
+/**
+ * @brief Gain x16 to the OV2640 gain register (inverse of SensorExposure_Ov2640GainToX16).
+ */
+static int SensorExposure_Ov2640GainFromX16(uint32_t gain16) {
+    int doublings = 0;
+    while ((gain16 >> doublings) > 31 && doublings < 4) doublings++;
+    uint32_t fraction = (gain16 >> doublings) - 16;
+    return (((1 << doublings) - 1) << 4) | (fraction > 15 ? 15 : fraction);
+}
+
+/**
+ * @brief OV2640 line duration and frame length of the current mode.
+ * UXGA lines take about twice as long as SVGA/CIF lines at the same clock.
+ */
+static void SensorExposure_Ov2640Timing(sensor_t *sensor, uint64_t &lineTime, uint32_t &maxLines) {
+    int mode = sensor->get_reg(sensor, OV2640_COM7, 0x70);
+    int clkrc = sensor->get_reg(sensor, OV2640_CLKRC, 0xFF);
+    uint64_t clockPeriod = ((clkrc & 0x3F) + 1) * ((clkrc & 0x80) ? 1 : 2); // x2: the doubler halves it
+    if (mode == 0x00) lineTime = 2 * clockPeriod, maxLines = 1248; // UXGA
+    else if (mode == 0x40) lineTime = clockPeriod, maxLines = 672; // SVGA
+    else lineTime = clockPeriod, maxLines = 336;                   // CIF
+}
+
+/**
+ * @brief OV5640 line duration (HTS / system clock) and frame length of the current mode.
+ */
+static void SensorExposure_Ov5640Timing(sensor_t *sensor, uint64_t &lineTime, uint32_t &maxLines) {
+    int bitMode = sensor->get_reg(sensor, OV5640_SC_PLL_CTRL0, 0x0F);
+    int sysDiv = sensor->get_reg(sensor, OV5640_SC_PLL_CTRL1, 0xF0) >> 4;
+    int multiplier = sensor->get_reg(sensor, OV5640_SC_PLL_CTRL2, 0xFF);
+    int pll3 = sensor->get_reg(sensor, OV5640_SC_PLL_CTRL3, 0x1F);
+    int sclkDiv = 1 << sensor->get_reg(sensor, OV5640_SYS_ROOT_DIV, 0x03);
+    uint64_t hts = sensor->get_reg(sensor, OV5640_TIMING_HTS, 0xFFFF);
+    uint32_t vts = sensor->get_reg(sensor, OV5640_TIMING_VTS, 0xFFFF);
+    uint64_t preDiv = (pll3 & 0x0F) ? (pll3 & 0x0F) : 1;
+    uint64_t rootDiv = (pll3 & 0x10) ? 2 : 1;
+    uint64_t bitDiv2 = bitMode == 10 ? 5 : 4; // x2: 10-bit mode divides by 2.5
+    if (sysDiv == 0) sysDiv = 16;
+    lineTime = multiplier > 0 ? hts * preDiv * sysDiv * rootDiv * bitDiv2 * sclkDiv * 1000 / multiplier : 0;
+    maxLines = vts > 4 ? vts - 4 : 0;
+}
+
+/**
+ * @brief Read the current exposure, gain and AWB state from the running sensor.
+ * @param sensor Initialized sensor (auto exposure running)
+ * @param exposure Receives the snapshot
+ * @return false if the sensor is not supported or has no exposure yet
+ */
+bool SensorExposure_Snapshot(sensor_t *sensor, SensorExposure &exposure) {
+    exposure = SensorExposure();
+    if (!sensor) return false;
+    uint32_t maxLines;
+    exposure.pid = sensor->id.PID;
+    if (exposure.pid == OV2640_PID) {
+        exposure.lines = (sensor->get_reg(sensor, OV2640_REG45, 0x3F) << 10) |
+                         (sensor->get_reg(sensor, OV2640_AEC, 0xFF) << 2) | sensor->get_reg(sensor, OV2640_REG04, 0x03);
+        exposure.gain16 = SensorExposure_Ov2640GainToX16(sensor->get_reg(sensor, OV2640_GAIN, 0xFF));
+        SensorExposure_Ov2640Timing(sensor, exposure.lineTime, maxLines);
+    } else if (exposure.pid == OV5640_PID) {
+        exposure.lines = sensor->get_reg(sensor, OV5640_AEC_PK_EXPOSURE, 0xFFFFF) >> 4;
+        exposure.gain16 = sensor->get_reg(sensor, OV5640_AEC_PK_REAL_GAIN, 0x3FF);
+        exposure.awbRed = sensor->get_reg(sensor, OV5640_AWB_R_GAIN, 0xFFF);
+        exposure.awbGreen = sensor->get_reg(sensor, OV5640_AWB_G_GAIN, 0xFFF);
+        exposure.awbBlue = sensor->get_reg(sensor, OV5640_AWB_B_GAIN, 0xFFF);
+        exposure.hasAwb = exposure.awbRed > 0 && exposure.awbGreen > 0 && exposure.awbBlue > 0;
+        SensorExposure_Ov5640Timing(sensor, exposure.lineTime, maxLines);
+    } else {
+        return false;
+    }
+    exposure.valid = exposure.lines > 0 && exposure.gain16 > 0 && exposure.lineTime > 0;
+    return exposure.valid;
+}
+
+/**
+ * @brief Write a snapshot to the sensor after a mode switch, scaled to the new line time.
+ * @param sensor Initialized sensor in the new mode
+ * @param exposure Snapshot from the previous mode
+ * @param holdManual true to keep AE/AGC/AWB off (single still), false to let them continue from the restored values
+ * @return false if the snapshot does not fit this sensor (nothing written)
+ */
+bool SensorExposure_Restore(sensor_t *sensor, const SensorExposure &exposure, bool holdManual) {
+    if (!sensor || !exposure.valid || sensor->id.PID != exposure.pid) return false;
+    uint64_t lineTime;
+    uint32_t maxLines, maxGain16;
+    if (exposure.pid == OV2640_PID) {
+        SensorExposure_Ov2640Timing(sensor, lineTime, maxLines);
+        maxGain16 = OV2640_MAX_GAIN16;
+    } else {
+        SensorExposure_Ov5640Timing(sensor, lineTime, maxLines);
+        maxGain16 = OV5640_MAX_GAIN16;
+    }
+    if (lineTime == 0 || maxLines == 0) return false;
+    // Exposure time x gain, in new-mode lines x16
+    double product = (double)exposure.lines * exposure.gain16 * exposure.lineTime / lineTime;
+    uint32_t lines = (uint32_t)(product / 16);
+    if (lines > maxLines) lines = maxLines; // Frame length limit: the rest goes into gain
+    if (lines < 1) lines = 1;
+    uint32_t gain16 = (uint32_t)(product / lines + 0.5);
+    if (gain16 < 16) gain16 = 16;
+    if (gain16 > maxGain16) gain16 = maxGain16;
+    if (exposure.pid == OV2640_PID) {
+        sensor->set_reg(sensor, OV2640_COM8, OV2640_COM8_AUTO, 0); // AEC/AGC off
+        sensor->set_reg(sensor, OV2640_REG45, 0x3F, lines >> 10);
+        sensor->set_reg(sensor, OV2640_AEC, 0xFF, lines >> 2);
+        sensor->set_reg(sensor, OV2640_REG04, 0x03, lines);
+        sensor->set_reg(sensor, OV2640_GAIN, 0xFF, SensorExposure_Ov2640GainFromX16(gain16));
+        if (!holdManual) sensor->set_reg(sensor, OV2640_COM8, OV2640_COM8_AUTO, OV2640_COM8_AUTO);
+    } else {
+        sensor->set_reg(sensor, OV5640_AEC_PK_MANUAL, 0x03, 0x03); // AEC/AGC off
+        sensor->set_reg(sensor, OV5640_AEC_PK_EXPOSURE, 0xFFFFF, lines << 4);
+        sensor->set_reg(sensor, OV5640_AEC_PK_REAL_GAIN, 0x3FF, gain16);
+        if (exposure.hasAwb) {
+            sensor->set_reg(sensor, OV5640_AWB_MANUAL, 0x01, 0x01); // AWB off
+            sensor->set_reg(sensor, OV5640_AWB_R_GAIN, 0xFFF, exposure.awbRed);
+            sensor->set_reg(sensor, OV5640_AWB_G_GAIN, 0xFFF, exposure.awbGreen);
+            sensor->set_reg(sensor, OV5640_AWB_B_GAIN, 0xFFF, exposure.awbBlue);
+            if (!holdManual) sensor->set_reg(sensor, OV5640_AWB_MANUAL, 0x01, 0);
+        }
+        if (!holdManual) sensor->set_reg(sensor, OV5640_AEC_PK_MANUAL, 0x03, 0);
+    }
+    Serial.printf("[SensorExposure] Restored %u lines x%u.%02u (was %u lines x%u.%02u)%s.\n", (unsigned)lines,
+                  (unsigned)(gain16 / 16), (unsigned)(gain16 % 16 * 100 / 16), (unsigned)exposure.lines,
+                  (unsigned)(exposure.gain16 / 16), (unsigned)(exposure.gain16 % 16 * 100 / 16),
+                  exposure.hasAwb ? ", AWB gains" : "");
+    return true;
+}
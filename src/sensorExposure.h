@@ -0,0 +1,43 @@
+// sensorExposure.h - Auto exposure / white balance hand-over between sensor modes
+// This header declares the snapshot/restore of the converged AE/AGC (and, on the OV5640, AWB)
+// state. esp_camera_init resets the sensor, so the first frame after a switch from preview to
+// a still or video mode would otherwise be taken before auto exposure has converged. The
+// snapshot is read from the running preview; the restore converts it to the new mode's line
+// time and writes it as manual exposure/gain before the first frame is grabbed.
+//
+// Key features:
+// - Exposure x gain product kept constant across modes (line time from the sensor's clock and timing registers)
+// - Exposure limited to the new mode's frame length, the rest moved into gain
+// - OV2640 and OV5640 register maps; other sensors are left on auto
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h> // Arduino core library
+#include <esp_camera.h> // sensor_t
+
+// Converged AE/AWB state of one sensor mode
+struct SensorExposure {
+    bool valid;         // Snapshot taken from a running, supported sensor
+    uint16_t pid;       // Sensor the values belong to
+    uint32_t lines;     // Exposure in lines
+    uint32_t gain16;    // Analog gain x16
+    uint64_t lineTime;  // Line duration in sensor-specific units (only ratios are used)
+    bool hasAwb;        // AWB gains below are valid (OV5640)
+    uint16_t awbRed, awbGreen, awbBlue; // AWB channel gains (raw register values)
+};
+
+/**
+ * @brief Read the current exposure, gain and AWB state from the running sensor.
+ * @param sensor Initialized sensor (auto exposure running)
+ * @param exposure Receives the snapshot
+ * @return false if the sensor is not supported or has no exposure yet
+ */
+bool SensorExposure_Snapshot(sensor_t *sensor, SensorExposure &exposure);
+
+/**
+ * @brief Write a snapshot to the sensor after a mode switch, scaled to the new line time.
+ * @param sensor Initialized sensor in the new mode
+ * @param exposure Snapshot from the previous mode
+ * @param holdManual true to keep AE/AGC/AWB off (single still), false to let them continue from the restored values
+ * @return false if the snapshot does not fit this sensor (nothing written)
+ */
+bool SensorExposure_Restore(sensor_t *sensor, const SensorExposure &exposure, bool holdManual);
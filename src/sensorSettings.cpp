@@ -0,0 +1,76 @@
+// sensorSettings.cpp - Desired vs applied sensor settings implementation
+// The diff is a bit mask over SensorSetting; Apply walks it and calls the matching sensor_t
+// setter. The metrics count both the setter calls issued and the ones the diff saved, so
+// the SCCB traffic per user action can be compared with rewriting every setting.
+//
+// Key features:
+// - One setter call per changed setting
+// - Unchanged settings skipped and counted
+
+#include "sensorSettings.h" // Include header for this module
+#include "metrics.h" // Sensor write counters
+
+/**
+ * @brief Read the managed settings from the driver status (what the sensor currently has).
+ * @param sensor Initialized sensor
+ * @param settings Receives the values
+ */
+void SensorSettings_FromStatus(const sensor_t *sensor, SensorSettings &settings) {
+    settings.contrast = sensor->status.contrast;
+    settings.brightness = sensor->status.brightness;
+    settings.saturation = sensor->status.saturation;
+    settings.vflip = sensor->status.vflip;
+    settings.specialEffect = sensor->status.special_effect;
+}
+
+/**
+ * @brief Find the settings that differ.
+ * @param desired Wanted values
+ * @param applied Values the sensor has
+ * @return Bit mask of SensorSetting values that need a write
+ */
+uint32_t SensorSettings_Diff(const SensorSettings &desired, const SensorSettings &applied) {
+    uint32_t mask = 0;
+    if (desired.contrast != applied.contrast) mask |= 1u << SENSOR_SETTING_CONTRAST;
+    if (desired.brightness != applied.brightness) mask |= 1u << SENSOR_SETTING_BRIGHTNESS;
+    if (desired.saturation != applied.saturation) mask |= 1u << SENSOR_SETTING_SATURATION;
+    if (desired.vflip != applied.vflip) mask |= 1u << SENSOR_SETTING_VFLIP;
+    if (desired.specialEffect != applied.specialEffect) mask |= 1u << SENSOR_SETTING_SPECIAL_EFFECT;
+    return mask;
+}
+
+/**
+ * @brief Write the settings that differ and update the applied state for each successful write.
+ * @param sensor Initialized sensor
+ * @param desired Wanted values
+ * @param applied Values the sensor has (updated)
+ * @return Number of setter calls issued (0 if nothing changed)
+ */
+int SensorSettings_Apply(sensor_t *sensor, const SensorSettings &desired, SensorSettings &applied) {
+    uint32_t mask = SensorSettings_Diff(desired, applied);
+    int written = 0;
+    for (int setting = 0; setting < SENSOR_SETTING_COUNT; setting++) {
+        if (!(mask & (1u << setting))) continue;
+        written++;
+        switch (setting) {
+        case SENSOR_SETTING_CONTRAST:
+            if (sensor->set_contrast(sensor, desired.contrast) == 0) applied.contrast = desired.contrast;
+            break;
+        case SENSOR_SETTING_BRIGHTNESS:
+            if (sensor->set_brightness(sensor, desired.brightness) == 0) applied.brightness = desired.brightness;
+            break;
+        case SENSOR_SETTING_SATURATION:
+            if (sensor->set_saturation(sensor, desired.saturation) == 0) applied.saturation = desired.saturation;
+            break;
+        case SENSOR_SETTING_VFLIP:
+            if (sensor->set_vflip(sensor, desired.vflip) == 0) applied.vflip = desired.vflip;
+            break;
+        case SENSOR_SETTING_SPECIAL_EFFECT:
+            if (sensor->set_special_effect(sensor, desired.specialEffect) == 0) applied.specialEffect = desired.specialEffect;
+            break;
+        }
+    }
+    Metrics_Add(METRIC_SENSOR_WRITES, written);
+    Metrics_Add(METRIC_SENSOR_WRITES_SKIPPED, SENSOR_SETTING_COUNT - written);
+    return written;
+}
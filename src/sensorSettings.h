@@ -0,0 +1,57 @@
+// sensorSettings.h - Desired vs applied sensor settings
+// This header declares the settings layer between the UI and the sensor driver. Each sensor_t
+// setter is one or more SCCB transactions, so instead of re-issuing every setting when one of
+// them changes, the caller keeps the state it wants (desired) next to the state the sensor is
+// known to have (applied) and only the settings that differ are written.
+//
+// Key features:
+// - Applied state taken from the driver status after esp_camera_init (driver defaults are not rewritten)
+// - A setting only counts as applied when its setter succeeded (failed writes are retried)
+// - Written and skipped setter calls counted in the sensor metrics
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h> // Arduino core library
+#include <esp_camera.h> // sensor_t
+
+// Settings managed by this layer, one setter each
+enum SensorSetting {
+    SENSOR_SETTING_CONTRAST,
+    SENSOR_SETTING_BRIGHTNESS,
+    SENSOR_SETTING_SATURATION,
+    SENSOR_SETTING_VFLIP,
+    SENSOR_SETTING_SPECIAL_EFFECT,
+    SENSOR_SETTING_COUNT
+};
+
+// Values of the managed settings
+struct SensorSettings {
+    int8_t contrast;       // -2..2
+    int8_t brightness;     // -2..2
+    int8_t saturation;     // -2..2
+    uint8_t vflip;         // 0 or 1
+    uint8_t specialEffect; // 0 = none
+};
+
+/**
+ * @brief Read the managed settings from the driver status (what the sensor currently has).
+ * @param sensor Initialized sensor
+ * @param settings Receives the values
+ */
+void SensorSettings_FromStatus(const sensor_t *sensor, SensorSettings &settings);
+
+/**
+ * @brief Find the settings that differ.
+ * @param desired Wanted values
+ * @param applied Values the sensor has
+ * @return Bit mask of SensorSetting values that need a write
+ */
+uint32_t SensorSettings_Diff(const SensorSettings &desired, const SensorSettings &applied);
+
+/**
+ * @brief Write the settings that differ and update the applied state for each successful write.
+ * @param sensor Initialized sensor
+ * @param desired Wanted values
+ * @param applied Values the sensor has (updated)
+ * @return Number of setter calls issued (0 if nothing changed)
+ */
+int SensorSettings_Apply(sensor_t *sensor, const SensorSettings &desired, SensorSettings &applied);
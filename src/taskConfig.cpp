@@ -0,0 +1,40 @@
+// taskConfig.cpp - FreeRTOS task placement table
+// This module holds the stack size, priority and core of every task. Tune the values here
+// using the stack high-water marks and CPU loads reported by the profiler (/profile).
+
+#include "taskConfig.h" // Include header for this module
+
+// Placement table, indexed by TaskId
+const TaskConfig taskConfigTable[TASK_COUNT] = {
+    // name           stack  prio core
+    {"CameraTask",    4096,  1,   0}, // TASK_CAMERA
+    {"DisplayTask",   4096,  1,   1}, // TASK_DISPLAY
+    {"WebTask",       4096,  1,   1}, // TASK_WEB
+    {"KeyTask",       4096,  3,   1}, // TASK_KEY
+    {"StreamTask",    4096,  2,   0}, // TASK_STREAM
+    {"SdWriterTask",  4096,  1,   0}, // TASK_SD_WRITER
+    {"ProfilerTask",  4096,  1,   0}, // TASK_PROFILER
+    {"MotionTask",    4096,  1,   0}, // TASK_MOTION
+    {"MotionCapTask", 4096,  1,   0}, // TASK_MOTION_CAPTURE
+    {"VideoTask",     4096,  2,   0}, // TASK_VIDEO
+    {"VideoWriter",   4096,  1,   1}, // TASK_VIDEO_WRITER
+    {"TimelapseTask", 4096,  1,   0}, // TASK_TIMELAPSE
+};
+
+/**
+ * @brief Create a task pinned according to its entry in taskConfigTable.
+ * @param id Task identifier
+ * @param function Task function
+ * @param param Task parameter
+ * @param handle Receives the task handle (may be NULL)
+ * @return pdPASS on success
+ */
+BaseType_t TaskConfig_Start(TaskId id, TaskFunction_t function, void *param, TaskHandle_t *handle) {
+    const TaskConfig &config = taskConfigTable[id];
+    BaseType_t result = xTaskCreatePinnedToCore(function, config.name, config.stackSize, param,
+                                                config.priority, handle, config.core);
+    if (result != pdPASS) {
+        Serial.printf("[TaskConfig] Failed to start %s!\n", config.name);
+    }
+    return result;
+}
@@ -0,0 +1,49 @@
+// taskConfig.h - FreeRTOS task placement table
+// This header declares the table of stack sizes, priorities and cores used to start every task,
+// so placements can be tuned from profiler measurements in one place instead of at each call site.
+//
+// Key features:
+// - One entry per task (name, stack size, priority, core)
+// - TaskConfig_Start() creates a task pinned according to its entry
+// - Used by main.cpp, the photo capture path and the background service modules
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h> // Arduino core library (FreeRTOS types)
+
+// Identifiers of all tasks started by the firmware
+enum TaskId {
+    TASK_CAMERA,     // Frame capture loop (CameraTask)
+    TASK_DISPLAY,    // Preview/gallery UI (DisplayTask)
+    TASK_WEB,        // HTTP server (WebTask)
+    TASK_KEY,        // Key input (KeyTask)
+    TASK_STREAM,     // SD reader for file streaming (FileStream)
+    TASK_SD_WRITER,  // Background photo writer (TfCard)
+    TASK_PROFILER,   // Run-time statistics sampler (Profiler)
+    TASK_MOTION,     // Motion event delivery (MotionTask)
+    TASK_MOTION_CAPTURE, // Motion capture JPEG encoder (MotionCapture)
+    TASK_VIDEO,      // Video recording frame grabber (VideoTask)
+    TASK_VIDEO_WRITER, // AVI file writer (VideoTask)
+    TASK_TIMELAPSE,  // Timelapse shots and light sleep (TimelapseTask)
+    TASK_COUNT
+};
+
+// Placement of one task
+struct TaskConfig {
+    const char *name;       // Task name (shown in profiles and traces)
+    uint32_t stackSize;     // Stack size in bytes
+    UBaseType_t priority;   // FreeRTOS priority
+    BaseType_t core;        // Core the task is pinned to
+};
+
+// Placement table, indexed by TaskId
+extern const TaskConfig taskConfigTable[TASK_COUNT];
+
+/**
+ * @brief Create a task pinned according to its entry in taskConfigTable.
+ * @param id Task identifier
+ * @param function Task function
+ * @param param Task parameter
+ * @param handle Receives the task handle (may be NULL)
+ * @return pdPASS on success
+ */
+BaseType_t TaskConfig_Start(TaskId id, TaskFunction_t function, void *param, TaskHandle_t *handle);
@@ -6,13 +6,54 @@
 // - SD card initialization and error handling
 // - Photo file writing (JPEG)
 // - Automatic file index management for unique filenames
+// - Background writer task fed through a queue of PSRAM copies
+// - One mutex over index selection, file creation and the index cache (no two writers share a name)
 
 #include "tfCard.h"      // Include header for this module
 #include <esp_camera.h>   // For camera frame buffer type
 #include "displayTask.h" // For error display
+#include "metrics.h"     // Pipeline counters
+#include "trace.h"       // Event tracing
+#include "taskConfig.h"  // Task placement table
+#include <atomic>        // Pending write count shared with the writer task
 
 // SPI bus object for the SD card (VSPI bus)
 SPIClass spiSd(VSPI);
+// Cached next photo index (0 = unknown, rescan on next query; photoIndexMutex held)
+static int cachedNextIndex = 0;
+// Index the next rescan starts from (no free slot exists below it; photoIndexMutex held)
+static int scanStartIndex = 1;
+// Cached highest existing photo index (-1 = unknown, rescan on next query; photoIndexMutex held)
+static int cachedLastIndex = -1;
+// Serializes index selection + file write against each other and against cache reads/resets
+static SemaphoreHandle_t photoIndexMutex;
+
+// Photo waiting in the background write queue
+struct PendingPhoto {
+    uint8_t *data;           // PSRAM copy of the JPEG (freed by the writer)
+    size_t size;             // Size in bytes
+    MetricHistogram latency; // Observed once written (METRIC_HISTOGRAM_COUNT = none)
+    int64_t sinceUs;         // Start of that latency
+};
+// Queue feeding the background writer task
+static QueueHandle_t photoWriteQueue;
+// Photos queued or being written (decremented by the writer after each file)
+static std::atomic<int> pendingWrites(0);
+
+/**
+ * @brief Background SD writer task. Writes queued photos and frees their buffers.
+ * @param pvParameters Not used (for FreeRTOS compatibility)
+ */
+static void TfCard_WriterTask(void *pvParameters) {
+    PendingPhoto photo;
+    while (1) {
+        xQueueReceive(photoWriteQueue, &photo, portMAX_DELAY); // Wait for a photo
+        TfCard_WritePhoto(photo.data, photo.size);
+        if (photo.latency < METRIC_HISTOGRAM_COUNT) Metrics_Observe(photo.latency, esp_timer_get_time() - photo.sinceUs);
+        free(photo.data);
+        pendingWrites--;
+    }
+}
 
 /**
  * @brief Initialize the SD card and handle errors.
@@ -20,6 +61,7 @@ SPIClass spiSd(VSPI);
  * If initialization fails, displays an error and retries.
  */
 void TfCard_Init() {
+    photoIndexMutex = xSemaphoreCreateMutex(); // Before any index query
     spiSd.begin(SD_SCK_PIN, SD_MISO_PIN, SD_MOSI_PIN, SD_CS_PIN); // Initialize SPI bus for SD card
     while (1) {
         if (SD.begin(SD_CS_PIN, spiSd)) { // Try to mount SD card
@@ -32,15 +74,17 @@ void TfCard_Init() {
         }
         tftDisplay.fillScreen(TFT_BLACK); // Clear display (optional)
     }
+    photoWriteQueue = xQueueCreate(TFCARD_WRITE_QUEUE_LEN, sizeof(PendingPhoto)); // Create write queue
+    TaskConfig_Start(TASK_SD_WRITER, TfCard_WriterTask, NULL, NULL); // Start writer
 }
 
 /**
- * @brief Get the next available photo index for unique filenames.
- * Scans the SD card for existing photo files and returns the next available index.
+ * @brief Find the next free photo index (caller holds photoIndexMutex).
  * @return Next photo index (1-based)
  */
-int TfCard_GetNextPhotoIndex() {
-    int index = 1; // Start with index 1
+static int TfCard_ScanNextPhotoIndex() {
+    if (cachedNextIndex > 0) return cachedNextIndex; // Cached result still valid
+    int index = scanStartIndex; // Start below the first possible free slot
     char filename[32]; // Buffer for filename
     while (true) {
         sprintf(filename, "/photo_%d.jpg", index); // Generate filename
@@ -49,24 +93,171 @@ int TfCard_GetNextPhotoIndex() {
         }
         ++index; // Try next index
     }
+    cachedNextIndex = index; // Remember for later queries
     return index; // Return next available index
 }
 
+/**
+ * @brief Get the next available photo index for unique filenames.
+ * Scans the SD card for existing photo files and returns the next available index.
+ * The result is cached until a photo is written or the index is invalidated.
+ * @return Next photo index (1-based)
+ */
+int TfCard_GetNextPhotoIndex() {
+    xSemaphoreTake(photoIndexMutex, portMAX_DELAY);
+    int index = TfCard_ScanNextPhotoIndex();
+    xSemaphoreGive(photoIndexMutex);
+    return index;
+}
+
+/**
+ * @brief Get the index of a photo file name.
+ * Only whole, canonical names count ("photo_7.jpg", not "photo_07.jpg" or "photo_7.jpg.bak").
+ * @param name File name without directory
+ * @return Photo index (1-based), or 0 if the name is not a photo
+ */
+int TfCard_ParsePhotoName(const char *name) {
+    int index = 0, length = 0;
+    if (sscanf(name, "photo_%d.jpg%n", &index, &length) != 1 || length != (int)strlen(name) || index < 1) return 0;
+    char canonical[32];
+    sprintf(canonical, "photo_%d.jpg", index);
+    return strcmp(canonical, name) == 0 ? index : 0;
+}
+
+/**
+ * @brief Get the highest existing photo index.
+ * Unlike TfCard_GetNextPhotoIndex - 1, this is not fooled by gaps: the card is listed in a
+ * single directory pass. The result is cached until photos are removed.
+ * @return Highest photo index on the card (0 = no photos)
+ */
+int TfCard_GetLastPhotoIndex() {
+    xSemaphoreTake(photoIndexMutex, portMAX_DELAY);
+    if (cachedLastIndex < 0) {
+        int last = 0;
+        File root = SD.open("/");
+        while (root) {
+            File entry = root.openNextFile();
+            if (!entry) break;
+            const char *name = strrchr(entry.name(), '/'); // Some cores report the full path
+            int index = entry.isDirectory() ? 0 : TfCard_ParsePhotoName(name ? name + 1 : entry.name());
+            if (index > last) last = index;
+            entry.close();
+        }
+        root.close();
+        cachedLastIndex = last;
+    }
+    int last = cachedLastIndex;
+    xSemaphoreGive(photoIndexMutex);
+    return last;
+}
+
+/**
+ * @brief Invalidate the cached photo indexes after photos were removed.
+ * The next call to TfCard_GetNextPhotoIndex or TfCard_GetLastPhotoIndex rescans the card.
+ */
+void TfCard_InvalidatePhotoIndex() {
+    xSemaphoreTake(photoIndexMutex, portMAX_DELAY); // Not while a writer holds a freshly picked index
+    cachedNextIndex = 0;
+    cachedLastIndex = -1;
+    scanStartIndex = 1; // Removed photos may have opened gaps anywhere
+    xSemaphoreGive(photoIndexMutex);
+}
+
 /**
  * @brief Write a photo file to the SD card with a unique filename.
+ * Holds photoIndexMutex from index selection until the cache is updated, so concurrent
+ * writers (direct and background) never pick the same file name.
  * @param data Pointer to photo data (JPEG buffer)
  * @param size Size of photo data in bytes
  */
 void TfCard_WritePhoto(const uint8_t *data, size_t size) {
-    int photoIndex = TfCard_GetNextPhotoIndex(); // Get next available index
+    TRACE_SCOPE("sd_write_photo");
+    xSemaphoreTake(photoIndexMutex, portMAX_DELAY);
+    int photoIndex = TfCard_ScanNextPhotoIndex(); // Get next available index
     char filename[32]; // Buffer for filename
     sprintf(filename, "/photo_%d.jpg", photoIndex); // Generate unique filename
+    int64_t start = esp_timer_get_time();
     File file = SD.open(filename, FILE_WRITE); // Open file for writing
     if (file) { // If file opened successfully
         file.write(data, size); // Write photo data
         file.close(); // Close file
+        Metrics_Observe(METRIC_HIST_SD_WRITE, esp_timer_get_time() - start);
+        Metrics_Add(METRIC_SD_WRITES);
+        Metrics_Add(METRIC_SD_WRITE_BYTES, size);
+        cachedNextIndex = 0; // Next free index may be past other existing photos
+        scanStartIndex = photoIndex + 1; // Everything up to this photo is taken
+        if (cachedLastIndex >= 0 && photoIndex > cachedLastIndex) cachedLastIndex = photoIndex;
         Serial.printf("[TFCard] Photo saved: %s\n", filename); // Debug output
     } else {
         Serial.println("[TFCard] Photo save failed!"); // Debug output
     }
-}
\ No newline at end of file
+    xSemaphoreGive(photoIndexMutex);
+}
+
+/**
+ * @brief Queue a photo for the background SD writer task.
+ * The data is copied to PSRAM, so the caller's buffer can be released right away.
+ * @param data Pointer to photo data (JPEG buffer)
+ * @param size Size of photo data in bytes
+ * @return true if queued, false if out of memory or the queue is full
+ */
+bool TfCard_QueuePhoto(const uint8_t *data, size_t size) {
+    PendingPhoto photo = {(uint8_t *)heap_caps_malloc(size, MALLOC_CAP_SPIRAM), size, METRIC_HISTOGRAM_COUNT, 0};
+    if (!photo.data) {
+        Serial.println("[TFCard] No memory to queue photo!");
+        return false;
+    }
+    memcpy(photo.data, data, size);
+    pendingWrites++; // Before the send, so the writer never sees a negative count
+    if (xQueueSend(photoWriteQueue, &photo, 0) != pdTRUE) { // Never block the caller
+        pendingWrites--;
+        free(photo.data);
+        Serial.println("[TFCard] Write queue full, photo dropped!");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Queue a photo buffer for the background SD writer task without copying it.
+ * The writer takes ownership and frees the buffer with free() (also when queuing fails).
+ * @param data Heap buffer with the JPEG (e.g. from fmt2jpg)
+ * @param size Size of photo data in bytes
+ * @param timeout Ticks to wait for room in the queue
+ * @param latency Histogram that receives the time from sinceUs until the file is written (METRIC_HISTOGRAM_COUNT = none)
+ * @param sinceUs esp_timer time the latency is measured from
+ * @return true if queued
+ */
+bool TfCard_QueueOwnedPhoto(uint8_t *data, size_t size, TickType_t timeout, MetricHistogram latency, int64_t sinceUs) {
+    PendingPhoto photo = {data, size, latency, sinceUs};
+    pendingWrites++;
+    if (xQueueSend(photoWriteQueue, &photo, timeout) != pdTRUE) {
+        pendingWrites--;
+        free(data);
+        Serial.println("[TFCard] Write queue full, photo dropped!");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Get the number of photos waiting for the background writer.
+ * @return Write queue depth
+ */
+int TfCard_GetWriteQueueDepth() {
+    return photoWriteQueue ? uxQueueMessagesWaiting(photoWriteQueue) : 0;
+}
+
+/**
+ * @brief Wait until the background writer has written every queued photo.
+ * @param timeoutMs Maximum wait time
+ * @return true if no photo is queued or being written
+ */
+bool TfCard_WaitWritesDone(uint32_t timeoutMs) {
+    unsigned long start = millis();
+    while (pendingWrites > 0) {
+        if (millis() - start >= timeoutMs) return false;
+        vTaskDelay(10 / portTICK_PERIOD_MS); // Writer runs at the same priority, poll
+    }
+    return true;
+}
@@ -6,10 +6,12 @@
 // - SD card initialization and error handling
 // - Photo file writing (JPEG)
 // - Automatic file index management for unique filenames
+// - Background writer task so callers never block on the card
 
 #pragma once // Prevent multiple inclusion of this header
 #include <SD.h> // SD card library
 #include <SPI.h> // SPI library for SD card communication
+#include "metrics.h" // Latency histogram for queued photos
 
 // SPI bus object for the SD card
 extern SPIClass spiSd;
@@ -20,6 +22,9 @@ extern SPIClass spiSd;
 #define SD_MOSI_PIN 12  // Master Out Slave In
 #define SD_CS_PIN 11    // Chip Select
 
+// Maximum number of photos waiting for the background writer
+#define TFCARD_WRITE_QUEUE_LEN 4
+
 /**
  * @brief Initialize the SD card and handle errors.
  */
@@ -36,4 +41,57 @@ void TfCard_WritePhoto(const uint8_t *data, size_t size);
  * @brief Get the next available photo index for unique filenames.
  * @return Next photo index (1-based)
  */
-int TfCard_GetNextPhotoIndex();
\ No newline at end of file
+int TfCard_GetNextPhotoIndex();
+
+/**
+ * @brief Get the highest existing photo index (gaps below it are allowed).
+ * @return Highest photo index on the card (0 = no photos)
+ */
+int TfCard_GetLastPhotoIndex();
+
+/**
+ * @brief Get the index of a canonical photo file name ("photo_<n>.jpg").
+ * @param name File name without directory
+ * @return Photo index (1-based), or 0 if the name is not a photo
+ */
+int TfCard_ParsePhotoName(const char *name);
+
+/**
+ * @brief Invalidate the cached photo indexes after photos were removed.
+ */
+void TfCard_InvalidatePhotoIndex();
+
+/**
+ * @brief Queue a photo for the background SD writer task.
+ * The data is copied to PSRAM, so the caller's buffer can be released right away.
+ * @param data Pointer to photo data (JPEG buffer)
+ * @param size Size of photo data in bytes
+ * @return true if queued, false if out of memory or the queue is full
+ */
+bool TfCard_QueuePhoto(const uint8_t *data, size_t size);
+
+/**
+ * @brief Queue a photo buffer for the background SD writer task without copying it.
+ * The writer takes ownership and frees the buffer with free() (also when queuing fails).
+ * @param data Heap buffer with the JPEG (e.g. from fmt2jpg)
+ * @param size Size of photo data in bytes
+ * @param timeout Ticks to wait for room in the queue
+ * @param latency Histogram that receives the time from sinceUs until the file is written (METRIC_HISTOGRAM_COUNT = none)
+ * @param sinceUs esp_timer time the latency is measured from
+ * @return true if queued
+ */
+bool TfCard_QueueOwnedPhoto(uint8_t *data, size_t size, TickType_t timeout,
+                            MetricHistogram latency = METRIC_HISTOGRAM_COUNT, int64_t sinceUs = 0);
+
+/**
+ * @brief Get the number of photos waiting for the background writer.
+ * @return Write queue depth
+ */
+int TfCard_GetWriteQueueDepth();
+
+/**
+ * @brief Wait until the background writer has written every queued photo.
+ * @param timeoutMs Maximum wait time
+ * @return true if no photo is queued or being written
+ */
+bool TfCard_WaitWritesDone(uint32_t timeoutMs);
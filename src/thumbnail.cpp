@@ -0,0 +1,147 @@
+// thumbnail.cpp - Photo thumbnail implementation
+// This module generates small JPEG thumbnails for the web gallery and caches them on the SD card.
+// The original photo is decoded at 1/8 scale into an RGB565 buffer, encoded back to JPEG
+// and written next to the photo, so later requests are a plain file stream.
+//
+// Key features:
+// - Decode at 1/8 scale (no full-size buffer needed)
+// - JPEG encode with the camera driver's fmt2jpg
+// - SD-backed cache with hit/miss and generation time statistics
+// - Shares the JPEG decoder with the display task through jpegDecoderMutex
+
+#include "thumbnail.h"       // Include header for this module
+#include <SD.h>              // SD card library
+#include <TJpg_Decoder.h>    // JPEG decoder
+#include <img_converters.h>  // fmt2jpg (RGB565 -> JPEG)
+#include "displayTask.h"     // tft_output callback and decoder mutex
+
+// RGB565 buffer the decoder writes into, and its dimensions
+static uint16_t *thumbPixels = NULL;
+static int thumbWidth = 0;
+static int thumbHeight = 0;
+// Cache statistics
+static uint32_t thumbHits = 0;        // Requests served from the cache
+static uint32_t thumbMisses = 0;      // Requests that needed generation
+static uint32_t thumbGenTotalMs = 0;  // Total generation time (ms)
+
+/**
+ * @brief JPEG decoder output callback for thumbnails. Copies each block into thumbPixels.
+ * @param x X coordinate of the block
+ * @param y Y coordinate of the block
+ * @param w Width of the block
+ * @param h Height of the block
+ * @param data Pointer to pixel data (RGB565, byte-swapped)
+ * @return true to continue decoding
+ */
+static bool Thumbnail_Output(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t *data) {
+    for (int row = 0; row < h; row++) {
+        int dy = y + row;
+        if (dy >= thumbHeight) break; // Clip partial MCU at the bottom
+        int cols = min((int)w, thumbWidth - x); // Clip partial MCU at the right
+        if (cols > 0) memcpy(&thumbPixels[dy * thumbWidth + x], &data[row * w], cols * sizeof(uint16_t));
+    }
+    return true;
+}
+
+/**
+ * @brief Build the cache path of a photo's thumbnail.
+ * @param photoPath Photo path (e.g. "/photo_1.jpg")
+ * @return Thumbnail path (e.g. "/photo_1.thm")
+ */
+String Thumbnail_GetPath(const String &photoPath) {
+    int dot = photoPath.lastIndexOf('.');
+    return (dot < 0 ? photoPath : photoPath.substring(0, dot)) + ".thm";
+}
+
+/**
+ * @brief Decode a photo at 1/8 scale and write the encoded thumbnail to the SD card.
+ * @param photoPath Photo path
+ * @param thumbPath Destination path
+ * @return true if the thumbnail was written
+ */
+static bool Thumbnail_Generate(const String &photoPath, const String &thumbPath) {
+    bool ok = false;
+    xSemaphoreTake(jpegDecoderMutex, portMAX_DELAY); // Decoder is shared with the gallery
+    uint16_t w = 0, h = 0;
+    TJpgDec.getSdJpgSize(&w, &h, photoPath.c_str()); // Original size
+    thumbWidth = (w + 7) / 8;
+    thumbHeight = (h + 7) / 8;
+    if (thumbWidth > 0 && thumbHeight > 0) {
+        thumbPixels = (uint16_t *)heap_caps_calloc(thumbWidth * thumbHeight, sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+    }
+    if (thumbPixels) {
+        TJpgDec.setJpgScale(8); // 1/8 scale decode
+        TJpgDec.setSwapBytes(true); // Encoder expects big-endian RGB565
+        TJpgDec.setCallback(Thumbnail_Output);
+        ok = TJpgDec.drawSdJpg(0, 0, photoPath.c_str()) == JDR_OK;
+        TJpgDec.setSwapBytes(false); // Restore display defaults
+        TJpgDec.setCallback(tft_output);
+    }
+    xSemaphoreGive(jpegDecoderMutex);
+    if (!ok) {
+        free(thumbPixels);
+        thumbPixels = NULL;
+        return false;
+    }
+    uint8_t *jpg = NULL;
+    size_t jpgLen = 0;
+    ok = fmt2jpg((uint8_t *)thumbPixels, thumbWidth * thumbHeight * 2, thumbWidth, thumbHeight,
+                 PIXFORMAT_RGB565, THUMBNAIL_QUALITY, &jpg, &jpgLen); // Encode thumbnail
+    free(thumbPixels);
+    thumbPixels = NULL;
+    if (!ok) return false;
+    File file = SD.open(thumbPath, FILE_WRITE); // Write to cache
+    if (file) {
+        ok = file.write(jpg, jpgLen) == jpgLen;
+        file.close();
+    } else {
+        ok = false;
+    }
+    free(jpg);
+    if (!ok) SD.remove(thumbPath); // Never leave a truncated thumbnail behind
+    return ok;
+}
+
+/**
+ * @brief Make sure a cached thumbnail exists for a photo, generating it if needed.
+ * @param photoPath Photo path (e.g. "/photo_1.jpg")
+ * @return Thumbnail path, or an empty string if generation failed
+ */
+String Thumbnail_Get(const String &photoPath) {
+    String thumbPath = Thumbnail_GetPath(photoPath);
+    if (SD.exists(thumbPath)) { // Cache hit
+        ++thumbHits;
+        return thumbPath;
+    }
+    if (!SD.exists(photoPath)) return "";
+    ++thumbMisses;
+    unsigned long start = millis();
+    if (!Thumbnail_Generate(photoPath, thumbPath)) {
+        Serial.printf("[Thumbnail] Generation failed: %s\n", photoPath.c_str());
+        return "";
+    }
+    unsigned long elapsed = millis() - start;
+    thumbGenTotalMs += elapsed;
+    Serial.printf("[Thumbnail] Generated %s in %lu ms.\n", thumbPath.c_str(), elapsed);
+    Thumbnail_PrintStats();
+    return thumbPath;
+}
+
+/**
+ * @brief Remove the cached thumbnail of a photo, if any.
+ * @param photoPath Photo path (e.g. "/photo_1.jpg")
+ */
+void Thumbnail_Remove(const String &photoPath) {
+    String thumbPath = Thumbnail_GetPath(photoPath);
+    if (SD.exists(thumbPath)) SD.remove(thumbPath);
+}
+
+/**
+ * @brief Log cache hit rate and average generation time to the serial port.
+ */
+void Thumbnail_PrintStats() {
+    uint32_t total = thumbHits + thumbMisses;
+    Serial.printf("[Thumbnail] Cache hit rate: %u/%u (%.1f%%), avg generation: %u ms\n",
+                  (unsigned)thumbHits, (unsigned)total, total ? thumbHits * 100.0f / total : 0.0f,
+                  (unsigned)(thumbMisses ? thumbGenTotalMs / thumbMisses : 0));
+}
@@ -0,0 +1,39 @@
+// thumbnail.h - Photo thumbnail module
+// This header declares the thumbnail generator and SD-backed thumbnail cache used by the web server.
+//
+// Key features:
+// - Thumbnails decoded from the original JPEG at 1/8 scale (TJpgDec)
+// - Re-encoded as a small JPEG (esp32-camera JPEG encoder)
+// - Cached on the SD card next to the photo (photo_N.jpg -> photo_N.thm)
+// - Generation time and cache hit statistics
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h> // Arduino core library
+
+// JPEG quality used when encoding thumbnails (0-100)
+#define THUMBNAIL_QUALITY 70
+
+/**
+ * @brief Build the cache path of a photo's thumbnail.
+ * @param photoPath Photo path (e.g. "/photo_1.jpg")
+ * @return Thumbnail path (e.g. "/photo_1.thm")
+ */
+String Thumbnail_GetPath(const String &photoPath);
+
+/**
+ * @brief Make sure a cached thumbnail exists for a photo, generating it if needed.
+ * @param photoPath Photo path (e.g. "/photo_1.jpg")
+ * @return Thumbnail path, or an empty string if generation failed
+ */
+String Thumbnail_Get(const String &photoPath);
+
+/**
+ * @brief Remove the cached thumbnail of a photo, if any.
+ * @param photoPath Photo path (e.g. "/photo_1.jpg")
+ */
+void Thumbnail_Remove(const String &photoPath);
+
+/**
+ * @brief Log cache hit rate and average generation time to the serial port.
+ */
+void Thumbnail_PrintStats();
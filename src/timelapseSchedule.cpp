@@ -0,0 +1,97 @@
+// timelapseSchedule.cpp - Timelapse shot scheduling implementation
+// Due times are start + slot * interval; all comparisons use signed 32-bit differences, so the
+// schedule keeps working across the millis() wrap-around. test/test_timelapse_schedule drives
+// the schedule with a virtual clock that models timer wake-up latency, sensor start-up time,
+// shot duration and key presses during sleep, the same way TimelapseTask drives it with millis().
+//
+// Key features:
+// - Next slot chosen after each shot (overrun slots skipped and counted)
+// - Jitter measured between consecutive shots against the nominal slot distance
+
+#include "timelapseSchedule.h" // Include header for this module
+
+/**
+ * @brief Start a schedule; the first shot is due right away.
+ * @param schedule Schedule to reset
+ * @param intervalMs Time between shots (at least TIMELAPSE_MIN_INTERVAL_MS)
+ * @param nowMs Current time
+ */
+void TimelapseSchedule_Start(TimelapseSchedule &schedule, uint32_t intervalMs, uint32_t nowMs) {
+    schedule = TimelapseSchedule();
+    schedule.intervalMs = intervalMs < TIMELAPSE_MIN_INTERVAL_MS ? TIMELAPSE_MIN_INTERVAL_MS : intervalMs;
+    schedule.startMs = nowMs;
+}
+
+/**
+ * @brief Get the due time of the next shot.
+ * @param schedule Schedule
+ * @return Due time in ms
+ */
+uint32_t TimelapseSchedule_DueMs(const TimelapseSchedule &schedule) {
+    return schedule.startMs + schedule.slot * schedule.intervalMs;
+}
+
+/**
+ * @brief Get how long the device may sleep before the next shot.
+ * @param schedule Schedule
+ * @param nowMs Current time
+ * @return Milliseconds until the next shot (0 = shoot now)
+ */
+uint32_t TimelapseSchedule_SleepMs(const TimelapseSchedule &schedule, uint32_t nowMs) {
+    int32_t left = (int32_t)(TimelapseSchedule_DueMs(schedule) - nowMs);
+    return left > 0 ? (uint32_t)left : 0;
+}
+
+/**
+ * @brief Clip a wake window (time the device stays awake after an early wake-up) to the next shot.
+ * @param schedule Schedule
+ * @param nowMs Current time
+ * @param windowMs Requested window
+ * @return Window in ms that ends no later than the next shot
+ */
+uint32_t TimelapseSchedule_WakeWindowMs(const TimelapseSchedule &schedule, uint32_t nowMs, uint32_t windowMs) {
+    uint32_t left = TimelapseSchedule_SleepMs(schedule, nowMs);
+    return windowMs < left ? windowMs : left;
+}
+
+/**
+ * @brief Record a finished shot and move to the next slot in the future.
+ * @param schedule Schedule
+ * @param wakeMs Time the device last woke up
+ * @param shotMs Time the frame was captured
+ * @param doneMs Time the device is ready to sleep again
+ */
+void TimelapseSchedule_ShotDone(TimelapseSchedule &schedule, uint32_t wakeMs, uint32_t shotMs, uint32_t doneMs) {
+    uint32_t awake = doneMs - wakeMs;
+    schedule.awakeSumMs += awake;
+    if (awake > schedule.awakeMaxMs) schedule.awakeMaxMs = awake;
+    if (schedule.shots > 0) { // Distance to the previous shot against the nominal slot distance
+        int32_t error = (int32_t)(shotMs - schedule.lastShotMs) - (int32_t)((schedule.slot - schedule.lastSlot) * schedule.intervalMs);
+        uint32_t jitter = error < 0 ? -error : error;
+        schedule.jitterSumMs += jitter;
+        if (jitter > schedule.jitterMaxMs) schedule.jitterMaxMs = jitter;
+    }
+    schedule.lastShotMs = shotMs;
+    schedule.lastSlot = schedule.slot;
+    schedule.shots++;
+    schedule.slot++;
+    while ((int32_t)(TimelapseSchedule_DueMs(schedule) - doneMs) < 0) { // Already passed: skip it
+        schedule.slot++;
+        schedule.missed++;
+    }
+}
+
+/**
+ * @brief Summarize the statistics of a schedule.
+ * @param schedule Schedule
+ * @param stats Receives the summary
+ */
+void TimelapseSchedule_GetStats(const TimelapseSchedule &schedule, TimelapseStats &stats) {
+    stats.shots = schedule.shots;
+    stats.missed = schedule.missed;
+    stats.awakeAvgMs = schedule.shots ? (uint32_t)(schedule.awakeSumMs / schedule.shots) : 0;
+    stats.awakeMaxMs = schedule.awakeMaxMs;
+    stats.jitterAvgMs = schedule.shots > 1 ? (uint32_t)(schedule.jitterSumMs / (schedule.shots - 1)) : 0;
+    stats.jitterMaxMs = schedule.jitterMaxMs;
+    stats.awakePermille = schedule.shots ? (uint32_t)(schedule.awakeSumMs * 1000 / ((uint64_t)schedule.shots * schedule.intervalMs)) : 0;
+}
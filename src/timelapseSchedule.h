@@ -0,0 +1,92 @@
+// timelapseSchedule.h - Timelapse shot scheduling
+// This header declares the scheduling logic of the timelapse mode: when the next shot is due,
+// how long the device may sleep, which slots were missed because a shot overran, and the
+// awake-time and jitter statistics. It works on millisecond timestamps passed in by the caller
+// and has no Arduino or FreeRTOS dependencies, so the unit tests run the same code on a
+// virtual clock (test/test_timelapse_schedule).
+//
+// Key features:
+// - Shots anchored to start + n * interval, so shot durations and wake latency never accumulate as drift
+// - Slots that passed while a shot was still running are skipped and counted
+// - Wake windows (key presses) never extend past the next shot
+// - Awake time per shot (battery use proxy) and shot-to-shot jitter
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stdint.h> // Fixed-width integer types
+
+// Shortest allowed interval
+#define TIMELAPSE_MIN_INTERVAL_MS 1000
+
+// Schedule state and statistics
+struct TimelapseSchedule {
+    uint32_t intervalMs;  // Time between shots
+    uint32_t startMs;     // Due time of slot 0
+    uint32_t slot;        // Next slot to shoot
+    uint32_t lastShotMs;  // Capture time of the previous shot
+    uint32_t lastSlot;    // Slot of the previous shot
+    uint32_t shots;       // Shots taken
+    uint32_t missed;      // Slots skipped because a shot overran
+    uint64_t awakeSumMs;  // Sum of awake times
+    uint32_t awakeMaxMs;  // Longest awake time
+    uint64_t jitterSumMs; // Sum of shot-to-shot jitter
+    uint32_t jitterMaxMs; // Largest shot-to-shot jitter
+};
+
+// Summary of a schedule
+struct TimelapseStats {
+    uint32_t shots;        // Shots taken
+    uint32_t missed;       // Slots skipped
+    uint32_t awakeAvgMs;   // Mean awake time per shot
+    uint32_t awakeMaxMs;   // Longest awake time
+    uint32_t jitterAvgMs;  // Mean |actual - nominal| time between consecutive shots
+    uint32_t jitterMaxMs;  // Largest jitter
+    uint32_t awakePermille; // Awake share of the interval (average current proxy)
+};
+
+/**
+ * @brief Start a schedule; the first shot is due right away.
+ * @param schedule Schedule to reset
+ * @param intervalMs Time between shots (at least TIMELAPSE_MIN_INTERVAL_MS)
+ * @param nowMs Current time
+ */
+void TimelapseSchedule_Start(TimelapseSchedule &schedule, uint32_t intervalMs, uint32_t nowMs);
+
+/**
+ * @brief Get the due time of the next shot.
+ * @param schedule Schedule
+ * @return Due time in ms
+ */
+uint32_t TimelapseSchedule_DueMs(const TimelapseSchedule &schedule);
+
+/**
+ * @brief Get how long the device may sleep before the next shot.
+ * @param schedule Schedule
+ * @param nowMs Current time
+ * @return Milliseconds until the next shot (0 = shoot now)
+ */
+uint32_t TimelapseSchedule_SleepMs(const TimelapseSchedule &schedule, uint32_t nowMs);
+
+/**
+ * @brief Clip a wake window (time the device stays awake after an early wake-up) to the next shot.
+ * @param schedule Schedule
+ * @param nowMs Current time
+ * @param windowMs Requested window
+ * @return Window in ms that ends no later than the next shot
+ */
+uint32_t TimelapseSchedule_WakeWindowMs(const TimelapseSchedule &schedule, uint32_t nowMs, uint32_t windowMs);
+
+/**
+ * @brief Record a finished shot and move to the next slot in the future.
+ * @param schedule Schedule
+ * @param wakeMs Time the device last woke up
+ * @param shotMs Time the frame was captured
+ * @param doneMs Time the device is ready to sleep again
+ */
+void TimelapseSchedule_ShotDone(TimelapseSchedule &schedule, uint32_t wakeMs, uint32_t shotMs, uint32_t doneMs);
+
+/**
+ * @brief Summarize the statistics of a schedule.
+ * @param schedule Schedule
+ * @param stats Receives the summary
+ */
+void TimelapseSchedule_GetStats(const TimelapseSchedule &schedule, TimelapseStats &stats);
@@ -0,0 +1,220 @@
+// timelapseTask.cpp - Timelapse mode implementation
+// The task waits for a start request, takes the camera with the same preview stop/resume steps
+// as a still capture, and then alternates between shots and light sleep as the schedule says.
+// The sensor is only initialized for the shot itself and held in power-down otherwise.
+//
+// Key features:
+// - One camera init/deinit per shot, PWDN driven high in between
+// - AE/AWB carried from shot to shot (preview values for the first), so no shot starts from a cold sensor
+// - SD writes finished before sleeping (a sleeping writer would keep the card busy)
+// - Key wake-ups handled by a short awake window that never delays a shot
+// - Wi-Fi off for the whole timelapse (the SoftAP cannot serve through light sleep), back on at the end
+
+#include "timelapseTask.h" // Include header for this module
+#include <esp_sleep.h> // Light sleep
+#include <atomic> // State shared with the requesting tasks
+#include "timelapseSchedule.h" // Shot scheduling
+#include "cameraTask.h" // Camera configuration and pins
+#include "displayTask.h" // Preview stop/resume, backlight pin
+#include "keyTask.h" // Key wake-up sources
+#include "webTask.h" // Wi-Fi off while sleeping
+#include "tfCard.h" // SD writer queue
+#include "videoTask.h" // Recording state (the camera has one owner)
+#include "metrics.h" // Timelapse counters
+#include "config.h" // TIMELAPSE_INTERVAL_S
+#include "taskConfig.h" // Task placement table
+
+// Mutex for camera access (serializes still captures, recordings and timelapses)
+extern SemaphoreHandle_t cameraMutex;
+
+// Start requests (interval in ms)
+static QueueHandle_t timelapseStartQueue;
+// Timelapse state
+static std::atomic<bool> timelapseActive(false); // Requested or running
+static std::atomic<bool> stopRequested(false);   // TimelapseTask_Stop was called
+// Shot schedule (timelapse task only)
+static TimelapseSchedule schedule;
+
+/**
+ * @brief Hold the sensor in power-down (the driver powers it up again in esp_camera_init).
+ */
+static void TimelapseTask_PowerDownSensor() {
+#if CAM_PWDN_PIN >= 0
+    pinMode(CAM_PWDN_PIN, OUTPUT);
+    digitalWrite(CAM_PWDN_PIN, HIGH); // Active high power-down
+#endif
+}
+
+/**
+ * @brief Take one still: power the sensor up, capture, queue the JPEG for the SD writer, power it down.
+ * The sensor starts from the last exposure snapshot (the preview's before the first shot) with AE/AWB
+ * running, and the state after the shot is snapshotted for the next one.
+ * @param shotMs Receives the capture time
+ * @return true if a photo was queued
+ */
+static bool TimelapseTask_Shot(uint32_t &shotMs) {
+    bool queued = false;
+    shotMs = millis();
+    CameraTask_InitPhotoConfig(); // High-res JPEG
+    if (esp_camera_init(&cameraConfig) == ESP_OK) { // Powers the sensor up
+        CameraTask_InitSensorConfig(); // Set sensor parameters
+        CameraTask_RestoreExposure(false); // Warm start; AE/AWB keep tracking slow light changes
+        camera_fb_t *fb = esp_camera_fb_get();
+        shotMs = millis();
+        if (fb) {
+            queued = TfCard_QueuePhoto(fb->buf, fb->len); // PSRAM copy, the buffer goes back right away
+            esp_camera_fb_return(fb);
+            CameraTask_SnapshotExposure(); // Starting point for the next shot (the sensor resets in between)
+        }
+        esp_camera_deinit();
+    } else {
+        Serial.println("[Timelapse] Camera init failed!");
+    }
+    TimelapseTask_PowerDownSensor();
+    if (!TfCard_WaitWritesDone(TIMELAPSE_WRITE_WAIT_MS)) Serial.println("[Timelapse] SD writer still busy.");
+    return queued;
+}
+
+/**
+ * @brief Stay awake (backlight on) after a key press, so KeyTask can recognize a gesture.
+ * @param windowMs Time to stay awake
+ */
+static void TimelapseTask_StayAwake(uint32_t windowMs) {
+    digitalWrite(LCD_BLK_PIN, HIGH);
+    unsigned long start = millis();
+    while (!stopRequested && millis() - start < windowMs) {
+        vTaskDelay(50 / portTICK_PERIOD_MS);
+    }
+    digitalWrite(LCD_BLK_PIN, LOW);
+}
+
+/**
+ * @brief Light-sleep until the timer expires or a key is pressed.
+ * @param sleepMs Sleep time
+ * @return true if a key press ended the sleep
+ */
+static bool TimelapseTask_LightSleep(uint32_t sleepMs) {
+    KeyTask_EnableSleepWakeup();
+    esp_sleep_enable_timer_wakeup((uint64_t)sleepMs * 1000);
+    Serial.flush(); // The UART stops during light sleep
+    esp_light_sleep_start();
+    KeyTask_DisableSleepWakeup(); // Edge interrupts back for KeyTask
+    return esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO;
+}
+
+/**
+ * @brief Run one timelapse until stopped.
+ * @param intervalMs Time between shots
+ */
+static void TimelapseTask_Run(uint32_t intervalMs) {
+    xSemaphoreTake(cameraMutex, portMAX_DELAY); // No still captures while the timelapse runs
+    DisplayTask_StopPreview();
+    WebTask_StopWifi(); // No radio between shots
+    TimelapseTask_PowerDownSensor();
+    TimelapseSchedule_Start(schedule, intervalMs, millis());
+    Serial.printf("[Timelapse] Started, one shot every %u ms.\n", (unsigned)schedule.intervalMs);
+    uint32_t wakeMs = millis();
+    while (!stopRequested) {
+        uint32_t sleepMs = TimelapseSchedule_SleepMs(schedule, millis());
+        if (sleepMs >= TIMELAPSE_MIN_SLEEP_MS) {
+            digitalWrite(LCD_BLK_PIN, LOW); // Backlight off while waiting
+            bool keyWake = TimelapseTask_LightSleep(sleepMs);
+            wakeMs = millis();
+            if (keyWake) TimelapseTask_StayAwake(TimelapseSchedule_WakeWindowMs(schedule, wakeMs, TIMELAPSE_KEY_WINDOW_MS));
+            continue;
+        }
+        if (sleepMs > 0) { // Too close to the shot to sleep
+            vTaskDelay(sleepMs / portTICK_PERIOD_MS + 1);
+            continue;
+        }
+        uint32_t shotMs;
+        bool queued = TimelapseTask_Shot(shotMs);
+        uint32_t missedBefore = schedule.missed;
+        uint64_t jitterBefore = schedule.jitterSumMs;
+        TimelapseSchedule_ShotDone(schedule, wakeMs, shotMs, millis());
+        uint32_t awakeMs = millis() - wakeMs;
+        Metrics_Add(METRIC_TIMELAPSE_SHOTS);
+        Metrics_Add(METRIC_TIMELAPSE_MISSED, schedule.missed - missedBefore);
+        Metrics_Observe(METRIC_HIST_TIMELAPSE_AWAKE, (int64_t)awakeMs * 1000);
+        if (schedule.shots > 1) Metrics_Observe(METRIC_HIST_TIMELAPSE_JITTER, (int64_t)(schedule.jitterSumMs - jitterBefore) * 1000);
+        Serial.printf("[Timelapse] Shot %u %s, awake %u ms, next in %u ms.\n", (unsigned)schedule.shots,
+                      queued ? "saved" : "failed", (unsigned)awakeMs,
+                      (unsigned)TimelapseSchedule_SleepMs(schedule, millis()));
+    }
+    TimelapseStats stats;
+    TimelapseSchedule_GetStats(schedule, stats);
+    Serial.printf("[Timelapse] Stopped: %u shots, %u missed, awake %u ms/shot (max %u, %u permille), "
+                  "jitter avg %u ms (max %u).\n", (unsigned)stats.shots, (unsigned)stats.missed,
+                  (unsigned)stats.awakeAvgMs, (unsigned)stats.awakeMaxMs, (unsigned)stats.awakePermille,
+                  (unsigned)stats.jitterAvgMs, (unsigned)stats.jitterMaxMs);
+    digitalWrite(LCD_BLK_PIN, HIGH); // Backlight back on
+    WebTask_StartWifi(); // AP and web server back
+    DisplayTask_ResumePreview();
+    timelapseActive = false;
+    xSemaphoreGive(cameraMutex);
+}
+
+/**
+ * @brief Timelapse task: waits for a start request and runs it.
+ * @param pvParameters Not used (for FreeRTOS compatibility)
+ */
+static void TimelapseTask(void *pvParameters) {
+    uint32_t intervalMs;
+    while (1) {
+        xQueueReceive(timelapseStartQueue, &intervalMs, portMAX_DELAY); // Wait for a request
+        TimelapseTask_Run(intervalMs);
+    }
+}
+
+/**
+ * @brief Start the timelapse task (idle until a timelapse is requested).
+ */
+void TimelapseTask_Init() {
+    timelapseStartQueue = xQueueCreate(1, sizeof(uint32_t));
+    TaskConfig_Start(TASK_TIMELAPSE, TimelapseTask, NULL, NULL);
+}
+
+/**
+ * @brief Request a timelapse (returns immediately; the first shot is taken right away).
+ * @param intervalMs Time between shots (at least TIMELAPSE_MIN_INTERVAL_MS)
+ * @return false if a timelapse or a video recording is already running
+ */
+bool TimelapseTask_Start(uint32_t intervalMs) {
+    if (!timelapseStartQueue || VideoTask_IsRecording() || timelapseActive.exchange(true)) return false;
+    stopRequested = false;
+    xQueueSend(timelapseStartQueue, &intervalMs, 0); // Only one request can be pending
+    Serial.println("[Timelapse] Requested.");
+    return true;
+}
+
+/**
+ * @brief Request the end of the running timelapse (takes effect when the task is awake).
+ */
+void TimelapseTask_Stop() {
+    if (!timelapseActive) return;
+    stopRequested = true;
+    Serial.println("[Timelapse] Stop requested.");
+}
+
+/**
+ * @brief Start a timelapse with the configured interval, or stop the running one.
+ */
+void TimelapseTask_Toggle() {
+    if (timelapseActive) {
+        TimelapseTask_Stop();
+        return;
+    }
+#if defined(TIMELAPSE_INTERVAL_S)
+    TimelapseTask_Start(TIMELAPSE_INTERVAL_S * 1000UL);
+#else
+    TimelapseTask_Start(TIMELAPSE_DEFAULT_INTERVAL_MS);
+#endif
+}
+
+/**
+ * @brief Check whether a timelapse is running (or about to start).
+ * @return true while the camera belongs to the timelapse task
+ */
+bool TimelapseTask_IsRunning() {
+    return timelapseActive;
+}
@@ -0,0 +1,52 @@
+// timelapseTask.h - Timelapse mode with light sleep between shots
+// This header declares the timelapse task. While a timelapse runs, the preview is stopped and
+// the task owns the camera: for each shot it powers the sensor up, captures a still, hands it
+// to the SD writer, powers the sensor down (CAM_PWDN_PIN), keeps the backlight off
+// (LCD_BLK_PIN) and light-sleeps until the next shot. When to shoot and how long to sleep is
+// decided by timelapseSchedule.h, which is checked on a virtual clock.
+//
+// Key features:
+// - Start/stop with a Down key long press or the serial console ("timelapse start [s]", "timelapse stop")
+// - A key press wakes the device for TIMELAPSE_KEY_WINDOW_MS (backlight on) so it can be stopped
+// - Wi-Fi (AP and web server) is off while the timelapse runs and comes back when it stops
+// - Awake time per shot and shot-to-shot jitter as metrics and in the stop summary
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h> // Arduino core library
+
+// Interval used when none is given (overridden by TIMELAPSE_INTERVAL_S in config.h)
+#define TIMELAPSE_DEFAULT_INTERVAL_MS 60000
+// Waits shorter than this are spent awake (light sleep entry/exit is not worth it)
+#define TIMELAPSE_MIN_SLEEP_MS 50
+// Time the device stays awake after a key press wakes it
+#define TIMELAPSE_KEY_WINDOW_MS 3000
+// Longest wait for the SD writer before the next sleep
+#define TIMELAPSE_WRITE_WAIT_MS 5000
+
+/**
+ * @brief Start the timelapse task (idle until a timelapse is requested).
+ */
+void TimelapseTask_Init();
+
+/**
+ * @brief Request a timelapse (returns immediately; the first shot is taken right away).
+ * @param intervalMs Time between shots (at least TIMELAPSE_MIN_INTERVAL_MS)
+ * @return false if a timelapse or a video recording is already running
+ */
+bool TimelapseTask_Start(uint32_t intervalMs);
+
+/**
+ * @brief Request the end of the running timelapse (takes effect when the task is awake).
+ */
+void TimelapseTask_Stop();
+
+/**
+ * @brief Start a timelapse with the configured interval, or stop the running one.
+ */
+void TimelapseTask_Toggle();
+
+/**
+ * @brief Check whether a timelapse is running (or about to start).
+ * @return true while the camera belongs to the timelapse task
+ */
+bool TimelapseTask_IsRunning();
@@ -0,0 +1,92 @@
+// trace.cpp - Tracing facility implementation
+// This module owns one TraceRing per core, stamps events with esp_timer time, the current
+// core and the current task, and exports the merged rings as Chrome trace JSON.
+//
+// Key features:
+// - Rings allocated in PSRAM so tracing does not eat internal RAM
+// - Recording is a handful of stores plus one atomic add (no locks, no allocation)
+// - Export merges both cores' snapshots; viewers sort by timestamp
+
+#include "trace.h" // Include header for this module
+
+#if defined(ENABLE_TRACE)
+#include <new>          // Placement new
+#include <esp_timer.h>  // Microsecond clock
+#include "traceRing.h"  // Lock-free ring storage and exporter
+
+// One ring per core (NULL until Trace_Init)
+static TraceRing<TRACE_RING_SIZE> *traceRings[2] = {NULL, NULL};
+
+/**
+ * @brief Allocate the per-core trace rings.
+ */
+void Trace_Init() {
+    for (int core = 0; core < 2; core++) {
+        void *mem = heap_caps_malloc(sizeof(TraceRing<TRACE_RING_SIZE>), MALLOC_CAP_SPIRAM);
+        if (!mem) {
+            Serial.println("[Trace] Failed to allocate trace ring!");
+            return;
+        }
+        traceRings[core] = new (mem) TraceRing<TRACE_RING_SIZE>();
+    }
+    Serial.println("[Trace] Tracing enabled.");
+}
+
+/**
+ * @brief Record a trace event on the current core.
+ * @param name Event name (must be a string literal)
+ * @param phase TRACE_PHASE_BEGIN, TRACE_PHASE_END or TRACE_PHASE_INSTANT
+ */
+void Trace_Record(const char *name, char phase) {
+    int core = xPortGetCoreID();
+    if (!traceRings[core]) return;
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    traceRings[core]->record(esp_timer_get_time(), name, phase, core, (uint32_t)(uintptr_t)task & 0xFFFF, pcTaskGetName(task));
+}
+
+/**
+ * @brief Exporter callback that writes to a Print target.
+ */
+static void Trace_WritePrint(const char *text, size_t len, void *arg) {
+    Print *out = (Print *)arg;
+    out->write((const uint8_t *)text, len);
+}
+
+/**
+ * @brief Dump all recorded events as Chrome trace JSON to a print target (e.g. a TCP client).
+ * @param out Destination
+ * @return Number of events exported
+ */
+size_t Trace_Dump(Print &out) {
+    TraceEvent *events = (TraceEvent *)heap_caps_malloc(2 * TRACE_RING_SIZE * sizeof(TraceEvent), MALLOC_CAP_SPIRAM);
+    if (!events) {
+        out.print("{\"traceEvents\":[]}\n");
+        return 0;
+    }
+    size_t count = 0;
+    for (int core = 0; core < 2; core++) {
+        if (traceRings[core]) count += traceRings[core]->snapshot(events + count);
+    }
+    TraceRing_ExportChrome(events, count, Trace_WritePrint, &out);
+    free(events);
+    return count;
+}
+
+/**
+ * @brief Dump all recorded events as Chrome trace JSON to the serial port.
+ */
+void Trace_DumpSerial() {
+    size_t count = Trace_Dump(Serial);
+    Serial.printf("[Trace] %u events dumped.\n", (unsigned)count);
+}
+
+/**
+ * @brief Discard all recorded events.
+ */
+void Trace_Clear() {
+    for (int core = 0; core < 2; core++) {
+        if (traceRings[core]) traceRings[core]->clear();
+    }
+}
+
+#endif
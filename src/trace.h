@@ -0,0 +1,72 @@
+// trace.h - Tracing facility
+// This header declares the compile-time-enabled tracing macros and the trace exporters.
+// Define ENABLE_TRACE in config.h to record events; otherwise all macros compile to nothing.
+//
+// Key features:
+// - TRACE_BEGIN / TRACE_END / TRACE_INSTANT / TRACE_SCOPE macros
+// - Microsecond timestamps, task and core ids per event
+// - One lock-free ring buffer per core (see traceRing.h)
+// - Chrome trace JSON dump over serial or HTTP (/trace)
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h> // Arduino core library
+#include "config.h"  // ENABLE_TRACE switch
+
+// Events kept per core (oldest are overwritten)
+#define TRACE_RING_SIZE 2048
+
+#if defined(ENABLE_TRACE)
+
+/**
+ * @brief Allocate the per-core trace rings.
+ */
+void Trace_Init();
+
+/**
+ * @brief Record a trace event on the current core.
+ * @param name Event name (must be a string literal)
+ * @param phase TRACE_PHASE_BEGIN, TRACE_PHASE_END or TRACE_PHASE_INSTANT
+ */
+void Trace_Record(const char *name, char phase);
+
+/**
+ * @brief Dump all recorded events as Chrome trace JSON to the serial port.
+ */
+void Trace_DumpSerial();
+
+/**
+ * @brief Dump all recorded events as Chrome trace JSON to a print target (e.g. a TCP client).
+ * @param out Destination
+ * @return Number of events exported
+ */
+size_t Trace_Dump(Print &out);
+
+/**
+ * @brief Discard all recorded events.
+ */
+void Trace_Clear();
+
+// Records a begin event now and the matching end event when the scope exits
+class TraceScope {
+public:
+    explicit TraceScope(const char *name) : name(name) { Trace_Record(name, 'B'); }
+    ~TraceScope() { Trace_Record(name, 'E'); }
+private:
+    const char *name;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_BEGIN(name) Trace_Record(name, 'B')
+#define TRACE_END(name) Trace_Record(name, 'E')
+#define TRACE_INSTANT(name) Trace_Record(name, 'i')
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+
+#else
+
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END(name) ((void)0)
+#define TRACE_INSTANT(name) ((void)0)
+#define TRACE_SCOPE(name) ((void)0)
+
+#endif
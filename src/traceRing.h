@@ -0,0 +1,190 @@
+// traceRing.h - Lock-free trace event ring buffer
+// This header implements the storage and Chrome-trace exporter behind the tracing facility.
+// It has no Arduino or FreeRTOS dependencies, so it builds and runs on the host as well.
+//
+// Key features:
+// - Fixed-size ring of begin/end/instant events with microsecond timestamps
+// - Multi-producer safe without locks (atomic slot reservation + sequence stamps)
+// - Readers skip slots that are being overwritten instead of blocking writers
+// - Chrome trace JSON (chrome://tracing, Perfetto) exporter through a write callback, with
+//   event and task names JSON-escaped
+// - Header-only; checked by the Unity tests in test/test_trace_ring
+
+#pragma once // Prevent multiple inclusion of this header
+#include <stdint.h> // Fixed-width integer types
+#include <stdio.h>  // snprintf
+#include <string.h> // strncpy, strcmp
+#include <atomic>   // Lock-free slot reservation
+
+// Event phases (Chrome trace "ph" values)
+#define TRACE_PHASE_BEGIN 'B'
+#define TRACE_PHASE_END 'E'
+#define TRACE_PHASE_INSTANT 'i'
+
+// Maximum task name length stored per event (including terminator)
+#define TRACE_TASK_NAME_LEN 12
+
+// One trace event
+struct TraceEvent {
+    uint64_t timestampUs;                // Microsecond timestamp
+    const char *name;                    // Event name (must be a string literal)
+    char task[TRACE_TASK_NAME_LEN];      // Name of the recording task
+    uint32_t taskId;                     // Identifier of the recording task
+    uint8_t core;                        // Core the event was recorded on
+    char phase;                          // TRACE_PHASE_*
+};
+
+// Output callback used by the exporter
+typedef void (*TraceWriteFn)(const char *text, size_t len, void *arg);
+
+/**
+ * @brief Lock-free ring of trace events.
+ * @tparam Capacity Number of events kept (oldest are overwritten)
+ */
+template <size_t Capacity>
+class TraceRing {
+public:
+    TraceRing() : head(0) {
+        for (size_t i = 0; i < Capacity; i++) slots[i].seq.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Record an event. Safe to call concurrently from several tasks.
+     */
+    void record(uint64_t timestampUs, const char *name, char phase, uint8_t core, uint32_t taskId, const char *task) {
+        uint32_t index = head.fetch_add(1, std::memory_order_relaxed); // Reserve a slot
+        Slot &slot = slots[index % Capacity];
+        slot.seq.store(0, std::memory_order_release); // Mark slot as being written
+        std::atomic_thread_fence(std::memory_order_release); // Event stores stay after the mark
+        slot.event.timestampUs = timestampUs;
+        slot.event.name = name;
+        slot.event.phase = phase;
+        slot.event.core = core;
+        slot.event.taskId = taskId;
+        strncpy(slot.event.task, task ? task : "?", TRACE_TASK_NAME_LEN - 1);
+        slot.event.task[TRACE_TASK_NAME_LEN - 1] = '\0';
+        slot.seq.store(index + 1, std::memory_order_release); // Publish
+    }
+
+    /**
+     * @brief Copy a consistent snapshot of the ring, oldest event first.
+     * @param out Destination array with room for Capacity events
+     * @return Number of events copied
+     */
+    size_t snapshot(TraceEvent *out) const {
+        uint32_t end = head.load(std::memory_order_acquire);
+        uint32_t begin = end > Capacity ? end - Capacity : 0;
+        size_t count = 0;
+        for (uint32_t i = begin; i < end; i++) {
+            const Slot &slot = slots[i % Capacity];
+            if (slot.seq.load(std::memory_order_acquire) != i + 1) continue; // Being written or overwritten
+            TraceEvent copy = slot.event;
+            std::atomic_thread_fence(std::memory_order_acquire); // Copy stays before the re-check
+            if (slot.seq.load(std::memory_order_acquire) != i + 1) continue; // Changed while copying
+            out[count++] = copy;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Discard all recorded events.
+     */
+    void clear() {
+        for (size_t i = 0; i < Capacity; i++) slots[i].seq.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Total number of events ever recorded (including overwritten ones).
+     */
+    uint32_t recorded() const {
+        return head.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq; // Index + 1 when the event is complete, 0 while writing
+        TraceEvent event;
+    };
+    Slot slots[Capacity];
+    std::atomic<uint32_t> head; // Next index to reserve
+};
+
+/**
+ * @brief Clamp a snprintf result to the number of characters actually stored.
+ */
+inline int TraceRing_Clamp(int n, size_t size) {
+    return n < 0 ? 0 : (n >= (int)size ? (int)size - 1 : n);
+}
+
+/**
+ * @brief Copy text into a JSON string body, escaping quotes, backslashes and control characters.
+ * Truncates between characters (never inside an escape) and always terminates the output.
+ * @param out Destination
+ * @param size Size of out
+ * @param text Text to escape (NULL writes "?")
+ */
+inline void TraceRing_JsonEscape(char *out, size_t size, const char *text) {
+    size_t n = 0;
+    for (const char *p = text ? text : "?"; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        char escaped[7] = {(char)c, '\0'};
+        if (c == '"' || c == '\\') {
+            escaped[0] = '\\';
+            escaped[1] = (char)c;
+            escaped[2] = '\0';
+        } else if (c < 0x20) {
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        }
+        size_t len = strlen(escaped);
+        if (n + len >= size) break;
+        memcpy(out + n, escaped, len);
+        n += len;
+    }
+    out[n] = '\0';
+}
+
+/**
+ * @brief Write events as Chrome trace JSON ({"traceEvents":[...]}).
+ * Each core is a process (pid) and each task a thread (tid), with name metadata.
+ * @param events Events to export, in any order
+ * @param count Number of events
+ * @param write Output callback
+ * @param arg User argument passed to the callback
+ */
+inline void TraceRing_ExportChrome(const TraceEvent *events, size_t count, TraceWriteFn write, void *arg) {
+    char line[224];
+    char name[96];                      // Escaped event name (cut if longer)
+    char task[TRACE_TASK_NAME_LEN * 6]; // Escaped task name (an escape is up to six characters)
+    bool first = true;
+    // Thread name metadata, once per (core, task) pair
+    const size_t maxThreads = 32;
+    uint32_t seen[maxThreads];
+    uint8_t seenCore[maxThreads];
+    size_t seenCount = 0;
+    write("{\"traceEvents\":[\n", 17, arg);
+    for (size_t i = 0; i < count; i++) {
+        const TraceEvent &e = events[i];
+        bool known = false;
+        for (size_t t = 0; t < seenCount; t++) {
+            if (seen[t] == e.taskId && seenCore[t] == e.core) known = true;
+        }
+        int n;
+        if (!known && seenCount < maxThreads) {
+            seen[seenCount] = e.taskId;
+            seenCore[seenCount++] = e.core;
+            TraceRing_JsonEscape(task, sizeof(task), e.task);
+            n = snprintf(line, sizeof(line),
+                         "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                         first ? "" : ",\n", (unsigned)e.core, (unsigned)e.taskId, task);
+            write(line, TraceRing_Clamp(n, sizeof(line)), arg);
+            first = false;
+        }
+        TraceRing_JsonEscape(name, sizeof(name), e.name);
+        n = snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu,\"pid\":%u,\"tid\":%u%s}",
+                     first ? "" : ",\n", name, e.phase, (unsigned long long)e.timestampUs,
+                     (unsigned)e.core, (unsigned)e.taskId, e.phase == TRACE_PHASE_INSTANT ? ",\"s\":\"t\"" : "");
+        write(line, TraceRing_Clamp(n, sizeof(line)), arg);
+        first = false;
+    }
+    write("\n]}\n", 4, arg);
+}
@@ -0,0 +1,107 @@
+// uiState.cpp - UI state machine implementation
+// This module implements the preview/gallery transitions that used to live inline in
+// DisplayTask, so they can be replayed deterministically on the host.
+//
+// Key features:
+// - Top/Down cycle effect mode (then the peaking and zebra overlays) and parameter level in preview,
+//   browse photos in gallery
+// - Mid toggles preview/gallery (gallery opens on the most recent photo)
+// - Top long press toggles the performance HUD, Mid long press starts/stops video recording,
+//   Down long press starts/stops the timelapse
+
+#include "uiState.h" // Include header for this module
+
+/**
+ * @brief Reset a UI state to power-on defaults (preview, no effect or overlay, level 0).
+ * @param state State to reset
+ */
+void UiState_Reset(UiState &state) {
+    state.mode = UI_MODE_PREVIEW;
+    state.effectMode = 0;
+    state.paramLevel = 0;
+    state.photoIndex = 0;
+    state.hudVisible = false;
+    state.overlay = UI_OVERLAY_NONE;
+}
+
+/**
+ * @brief Apply a key display event to the UI state.
+ * @param state State to update
+ * @param event DISPLAY_EVENT_KEY_* or DISPLAY_EVENT_TOGGLE_* (others are ignored)
+ * @param photoCount Number of the last photo on the card (0 = none)
+ * @return Side effect the display task has to perform
+ */
+UiAction UiState_Apply(UiState &state, DisplayEvent event, int photoCount) {
+    switch (event) {
+    case DISPLAY_EVENT_KEY_MID: // Toggle preview/gallery
+        if (state.mode == UI_MODE_PREVIEW) {
+            state.mode = UI_MODE_GALLERY;
+            state.photoIndex = photoCount; // Open on the most recent photo
+            return photoCount >= 1 ? UI_ACTION_SHOW_PHOTO : UI_ACTION_NO_PHOTOS;
+        }
+        state.mode = UI_MODE_PREVIEW;
+        state.photoIndex = 0;
+        return UI_ACTION_SHOW_PREVIEW;
+    case DISPLAY_EVENT_KEY_TOP:
+        if (state.mode == UI_MODE_PREVIEW) { // Next camera effect mode, then the overlays, then back to none
+            if (state.overlay == UI_OVERLAY_PEAKING) {
+                state.overlay = UI_OVERLAY_ZEBRA;
+                return UI_ACTION_OVERLAY_CHANGED;
+            }
+            if (state.overlay == UI_OVERLAY_ZEBRA) {
+                state.overlay = UI_OVERLAY_NONE;
+                return UI_ACTION_OVERLAY_CHANGED;
+            }
+            if (state.effectMode >= UI_EFFECT_MODE_MAX) { // Overlays run on the unfiltered image
+                state.effectMode = 0;
+                state.overlay = UI_OVERLAY_PEAKING;
+            } else {
+                state.effectMode++;
+            }
+            return UI_ACTION_SENSOR_CHANGED;
+        }
+        if (state.photoIndex > 1) { // Previous photo
+            --state.photoIndex;
+            return UI_ACTION_SHOW_PHOTO;
+        }
+        return UI_ACTION_NONE;
+    case DISPLAY_EVENT_KEY_DOWN:
+        if (state.mode == UI_MODE_PREVIEW) { // Next camera parameter level
+            state.paramLevel = state.paramLevel >= UI_PARAM_LEVEL_MAX ? UI_PARAM_LEVEL_MIN : state.paramLevel + 1;
+            return UI_ACTION_SENSOR_CHANGED;
+        }
+        if (state.photoIndex >= 1 && state.photoIndex < photoCount) { // Next photo
+            ++state.photoIndex;
+            return UI_ACTION_SHOW_PHOTO;
+        }
+        return UI_ACTION_NONE;
+    case DISPLAY_EVENT_TOGGLE_HUD:
+        state.hudVisible = !state.hudVisible;
+        return UI_ACTION_TOGGLE_HUD;
+    case DISPLAY_EVENT_TOGGLE_RECORD: // Recording works from either screen
+        return UI_ACTION_TOGGLE_RECORD;
+    case DISPLAY_EVENT_TOGGLE_TIMELAPSE:
+        return UI_ACTION_TOGGLE_TIMELAPSE;
+    default:
+        return UI_ACTION_NONE;
+    }
+}
+
+/**
+ * @brief Map a key gesture to a display event (the button layout).
+ * The camera key is not mapped: its gestures trigger captures, not UI changes.
+ * @param key Key that produced the gesture
+ * @param gesture Recognized gesture
+ * @param event Receives the display event
+ * @return true if the gesture maps to a display event
+ */
+bool UiState_MapGesture(KeyId key, KeyGestureType gesture, DisplayEvent &event) {
+    if (key == KEY_ID_TOP && gesture == KEY_GESTURE_SINGLE) event = DISPLAY_EVENT_KEY_TOP;
+    else if (key == KEY_ID_TOP && gesture == KEY_GESTURE_LONG) event = DISPLAY_EVENT_TOGGLE_HUD;
+    else if (key == KEY_ID_MID && gesture == KEY_GESTURE_SINGLE) event = DISPLAY_EVENT_KEY_MID;
+    else if (key == KEY_ID_MID && gesture == KEY_GESTURE_LONG) event = DISPLAY_EVENT_TOGGLE_RECORD;
+    else if (key == KEY_ID_DOWN && gesture == KEY_GESTURE_SINGLE) event = DISPLAY_EVENT_KEY_DOWN;
+    else if (key == KEY_ID_DOWN && gesture == KEY_GESTURE_LONG) event = DISPLAY_EVENT_TOGGLE_TIMELAPSE;
+    else return false;
+    return true;
+}
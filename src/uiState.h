@@ -0,0 +1,100 @@
+// uiState.h - UI state machine
+// This header declares the preview/gallery state machine driven by display events, and the
+// mapping from key gestures to those events. Both are pure logic with no Arduino, FreeRTOS
+// or display dependencies, so DisplayTask and the host-side input replay share them.
+//
+// Key features:
+// - Preview/gallery mode, effect mode, preview overlay, parameter level and gallery photo index
+// - UiState_Apply() returns the side effect the display task has to perform
+// - UiState_MapGesture() is the single definition of the button layout
+
+#pragma once // Prevent multiple inclusion of this header
+#include "keyGesture.h" // Gesture types
+
+// Keys, in keyArray order
+enum KeyId {
+    KEY_ID_CAM,  // Camera shutter key
+    KEY_ID_TOP,  // Top navigation key
+    KEY_ID_MID,  // Middle key
+    KEY_ID_DOWN, // Down navigation key
+    KEY_ID_COUNT
+};
+
+// Events handled by the display task event loop
+enum DisplayEvent {
+    DISPLAY_EVENT_KEY_TOP,       // Top key single click
+    DISPLAY_EVENT_KEY_MID,       // Mid key single click (preview/gallery toggle)
+    DISPLAY_EVENT_KEY_DOWN,      // Down key single click
+    DISPLAY_EVENT_TOGGLE_HUD,    // Top key long press (performance HUD)
+    DISPLAY_EVENT_TOGGLE_RECORD, // Mid key long press (start/stop video recording)
+    DISPLAY_EVENT_TOGGLE_TIMELAPSE, // Down key long press (start/stop timelapse)
+    DISPLAY_EVENT_CAPTURE_START, // Still capture starting: release all preview frames
+    DISPLAY_EVENT_CAPTURE_DONE   // Still capture finished, preview resumes
+};
+
+// Camera effect modes cycled by the Top key (0 = none); the preview overlays follow the last one
+#define UI_EFFECT_MODE_MAX 6
+// Camera parameter levels cycled by the Down key
+#define UI_PARAM_LEVEL_MIN -2
+#define UI_PARAM_LEVEL_MAX 2
+
+// UI screens
+enum UiMode {
+    UI_MODE_PREVIEW, // Live camera preview
+    UI_MODE_GALLERY  // Saved photo browser
+};
+
+// Analysis overlays drawn over the live preview (no camera effect while one is shown)
+enum UiOverlay {
+    UI_OVERLAY_NONE,    // Plain preview
+    UI_OVERLAY_PEAKING, // Focus peaking: in-focus edges marked
+    UI_OVERLAY_ZEBRA    // Zebra stripes over overexposed areas
+};
+
+// Side effect requested by a state transition
+enum UiAction {
+    UI_ACTION_NONE,           // Nothing to do
+    UI_ACTION_SENSOR_CHANGED, // Effect mode or parameter level changed: update the sensor
+    UI_ACTION_OVERLAY_CHANGED, // Preview overlay changed (sensor unchanged)
+    UI_ACTION_SHOW_PHOTO,     // Show photo number photoIndex
+    UI_ACTION_NO_PHOTOS,      // Gallery entered but the card has no photos
+    UI_ACTION_SHOW_PREVIEW,   // Back to live preview
+    UI_ACTION_TOGGLE_HUD,     // Show or hide the performance HUD
+    UI_ACTION_TOGGLE_RECORD,  // Start or stop video recording
+    UI_ACTION_TOGGLE_TIMELAPSE // Start or stop the timelapse
+};
+
+// Complete UI state
+struct UiState {
+    UiMode mode;      // Current screen
+    int effectMode;   // Camera special effect (0..UI_EFFECT_MODE_MAX)
+    int paramLevel;   // Brightness/contrast/saturation level
+    int photoIndex;   // Photo shown in the gallery (1-based, 0 = none)
+    bool hudVisible;  // Performance HUD shown over the preview
+    UiOverlay overlay; // Analysis overlay over the preview
+};
+
+/**
+ * @brief Reset a UI state to power-on defaults (preview, no effect or overlay, level 0).
+ * @param state State to reset
+ */
+void UiState_Reset(UiState &state);
+
+/**
+ * @brief Apply a key display event to the UI state.
+ * @param state State to update
+ * @param event DISPLAY_EVENT_KEY_* or DISPLAY_EVENT_TOGGLE_* (others are ignored)
+ * @param photoCount Number of the last photo on the card (0 = none)
+ * @return Side effect the display task has to perform
+ */
+UiAction UiState_Apply(UiState &state, DisplayEvent event, int photoCount);
+
+/**
+ * @brief Map a key gesture to a display event (the button layout).
+ * The camera key is not mapped: its gestures trigger captures, not UI changes.
+ * @param key Key that produced the gesture
+ * @param gesture Recognized gesture
+ * @param event Receives the display event
+ * @return true if the gesture maps to a display event
+ */
+bool UiState_MapGesture(KeyId key, KeyGestureType gesture, DisplayEvent &event);
@@ -0,0 +1,227 @@
+// videoTask.cpp - MJPEG video recording implementation
+// Two tasks share a recording: the grabber (VideoTask) owns the camera, pulls JPEG frames and
+// passes the frame buffers on through a short queue; the writer (VideoWriter) appends them to
+// the AVI file and gives them back to the driver. When the writer falls behind, the grabber
+// returns the frame at once and counts it as dropped instead of stalling the driver.
+//
+// Key features:
+// - Camera switched with the same stop/resume steps as a still capture (cameraMutex held throughout)
+// - A NULL frame pointer tells the writer to close the file
+// - Frame rate measured from the driver timestamps of the written frames
+
+#include "videoTask.h" // Include header for this module
+#include <SD.h> // SD card library
+#include <atomic> // State shared between the control, grabber and writer tasks
+#include "aviWriter.h" // AVI container
+#include "cameraTask.h" // Camera configuration
+#include "displayTask.h" // Preview stop/resume
+#include "metrics.h" // Video counters
+#include "taskConfig.h" // Task placement table
+#include "timelapseTask.h" // Timelapse state (the camera has one owner)
+
+// Mutex for camera access (serializes still captures and recordings)
+extern SemaphoreHandle_t cameraMutex;
+
+// Recording requests (VideoOptions)
+static QueueHandle_t videoStartQueue;
+// Frame buffers from the grabber to the writer (NULL = end of recording)
+static QueueHandle_t videoFrameQueue;
+// Given by the writer once the file is closed
+static SemaphoreHandle_t videoDoneSemaphore;
+// The AVI file being written (writer task only while recording)
+static AviWriter aviWriter;
+// Recording state
+static std::atomic<bool> recordingActive(false); // Requested or running
+static std::atomic<bool> stopRequested(false);   // VideoTask_Stop was called
+static std::atomic<bool> writerStopped(false);   // Index full or card write failed
+// Progress of the current or last recording
+static char statPath[24] = "";
+static std::atomic<uint32_t> statFrames(0), statDropped(0), statBytes(0), statElapsedMs(0), statFpsMilli(0);
+
+/**
+ * @brief Writer task: appends frames to the AVI file and closes it on the end marker.
+ * @param pvParameters Not used (for FreeRTOS compatibility)
+ */
+static void VideoTask_WriterTask(void *pvParameters) {
+    camera_fb_t *fb = NULL;
+    int64_t firstUs = 0, lastUs = 0; // Driver timestamps of the first and last written frame
+    while (1) {
+        xQueueReceive(videoFrameQueue, &fb, portMAX_DELAY); // Wait for a frame
+        if (!fb) { // End of recording
+            uint32_t frames = aviWriter.frameCount;
+            uint32_t usPerFrame = frames > 1 ? (uint32_t)((lastUs - firstUs) / (frames - 1)) : 100000;
+            if (!AviWriter_Close(aviWriter, usPerFrame)) Serial.printf("[VideoTask] %s is incomplete!\n", statPath);
+            xSemaphoreGive(videoDoneSemaphore);
+            continue;
+        }
+        int64_t frameUs = (int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec;
+        size_t length = fb->len;
+        bool added = !writerStopped && AviWriter_AddFrame(aviWriter, fb->buf, length, fb->width, fb->height);
+        esp_camera_fb_return(fb); // Copied into the write buffer (or not needed any more)
+        if (!added) {
+            if (!writerStopped) Serial.println("[VideoTask] AVI index full or card write failed, stopping.");
+            writerStopped = true; // Grabber ends the recording
+            continue;
+        }
+        if (aviWriter.frameCount == 1) firstUs = frameUs;
+        lastUs = frameUs;
+        uint32_t elapsedUs = (uint32_t)(lastUs - firstUs);
+        statFrames = aviWriter.frameCount;
+        statBytes += length;
+        statElapsedMs = elapsedUs / 1000;
+        if (elapsedUs > 0) {
+            statFpsMilli = (uint32_t)((uint64_t)(aviWriter.frameCount - 1) * 1000000000ULL / elapsedUs);
+            Metrics_Set(METRIC_VIDEO_FPS_MILLI, statFpsMilli);
+        }
+        Metrics_Add(METRIC_VIDEO_FRAMES);
+    }
+}
+
+/**
+ * @brief Find the first unused /video_N.avi name.
+ * @param path Receives the name (statPath sized)
+ */
+static void VideoTask_NextPath(char *path) {
+    for (int index = 1;; index++) {
+        sprintf(path, "/video_%d.avi", index);
+        if (!SD.exists(path)) return;
+    }
+}
+
+/**
+ * @brief Run one recording: switch the camera to JPEG, grab frames until stopped, restore the preview.
+ * @param options Resolution and quality
+ */
+static void VideoTask_Record(const VideoOptions &options) {
+    xSemaphoreTake(cameraMutex, portMAX_DELAY); // No still captures while recording
+    DisplayTask_StopPreview();
+    VideoTask_NextPath(statPath);
+    statFrames = statDropped = statBytes = statElapsedMs = statFpsMilli = 0;
+    Metrics_Set(METRIC_VIDEO_FPS_MILLI, 0);
+    writerStopped = false;
+    unsigned long openStart = millis();
+    File file = SD.open(statPath, FILE_WRITE);
+    bool opened = file && AviWriter_Open(aviWriter, file, VIDEO_MAX_FRAMES, VIDEO_PREALLOC_BYTES);
+    Serial.printf("[VideoTask] %s opened in %lu ms (%lu KB preallocated).\n", statPath, millis() - openStart,
+                  VIDEO_PREALLOC_BYTES / 1024);
+    CameraTask_InitPhotoConfig(); // JPEG mode
+    cameraConfig.frame_size = options.frameSize;
+    cameraConfig.jpeg_quality = options.quality;
+    cameraConfig.fb_count = VIDEO_FB_COUNT; // Continuous capture
+    cameraConfig.grab_mode = CAMERA_GRAB_WHEN_EMPTY;
+    if (opened && esp_camera_init(&cameraConfig) == ESP_OK) {
+        CameraTask_InitSensorConfig(); // Set sensor parameters
+        CameraTask_RestoreExposure(false); // AE/AWB continue from the preview values
+        Serial.println("[VideoTask] Recording started.");
+        while (!stopRequested && !writerStopped) {
+            camera_fb_t *fb = esp_camera_fb_get();
+            if (!fb) {
+                Metrics_Add(METRIC_CAMERA_FRAMES_FAILED);
+                continue;
+            }
+            // Frames never take the end marker's slot, so one buffer always stays with the driver
+            // (the grabber is the only sender: the count can only drop between check and send)
+            bool writerBehind = uxQueueMessagesWaiting(videoFrameQueue) >= VIDEO_WRITE_QUEUE_LEN;
+            if (writerBehind || xQueueSend(videoFrameQueue, &fb, 0) != pdTRUE) { // Writer behind: give the buffer back
+                esp_camera_fb_return(fb);
+                statDropped++;
+                Metrics_Add(METRIC_VIDEO_FRAMES_DROPPED);
+            }
+        }
+        camera_fb_t *end = NULL;
+        xQueueSend(videoFrameQueue, &end, portMAX_DELAY); // Writer closes the file after the queued frames
+        xSemaphoreTake(videoDoneSemaphore, portMAX_DELAY); // Every frame buffer is back with the driver
+        esp_camera_deinit(); // Synchronous, the preview can init right away
+        Serial.printf("[VideoTask] %s: %u frames in %.1f s (%.2f fps), %u dropped, %u KB.\n", statPath,
+                      (unsigned)statFrames, statElapsedMs / 1000.0, statFpsMilli / 1000.0, (unsigned)statDropped,
+                      (unsigned)(statBytes / 1024));
+    } else {
+        Serial.println("[VideoTask] Recording could not start!");
+        if (file) {
+            AviWriter_Close(aviWriter, 0); // Closes the file and frees the buffers, also after a failed open
+            SD.remove(statPath);
+        }
+    }
+    DisplayTask_ResumePreview();
+    recordingActive = false;
+    xSemaphoreGive(cameraMutex);
+}
+
+/**
+ * @brief Grabber task: waits for a recording request and runs it.
+ * @param pvParameters Not used (for FreeRTOS compatibility)
+ */
+static void VideoTask(void *pvParameters) {
+    VideoOptions options;
+    while (1) {
+        xQueueReceive(videoStartQueue, &options, portMAX_DELAY); // Wait for a request
+        VideoTask_Record(options);
+    }
+}
+
+/**
+ * @brief Create the recorder queues and start the grabber and writer tasks (after TfCard_Init).
+ */
+void VideoTask_Init() {
+    videoStartQueue = xQueueCreate(1, sizeof(VideoOptions));
+    videoFrameQueue = xQueueCreate(VIDEO_WRITE_QUEUE_LEN + 1, sizeof(camera_fb_t *)); // + end marker (never used by frames)
+    videoDoneSemaphore = xSemaphoreCreateBinary();
+    TaskConfig_Start(TASK_VIDEO, VideoTask, NULL, NULL);
+    TaskConfig_Start(TASK_VIDEO_WRITER, VideoTask_WriterTask, NULL, NULL);
+}
+
+/**
+ * @brief Request a recording (returns immediately; the grabber task switches the camera).
+ * @param options Resolution and quality
+ * @return false if a recording is already running or requested, or a timelapse runs
+ */
+bool VideoTask_Start(const VideoOptions &options) {
+    if (!videoStartQueue || TimelapseTask_IsRunning() || recordingActive.exchange(true)) return false;
+    stopRequested = false;
+    xQueueSend(videoStartQueue, &options, 0); // Only one request can be pending
+    Serial.println("[VideoTask] Recording requested.");
+    return true;
+}
+
+/**
+ * @brief Request the end of the current recording (returns immediately).
+ */
+void VideoTask_Stop() {
+    if (!recordingActive) return;
+    stopRequested = true;
+    Serial.println("[VideoTask] Stop requested.");
+}
+
+/**
+ * @brief Start a recording with the default options, or stop the running one.
+ */
+void VideoTask_Toggle() {
+    if (recordingActive) {
+        VideoTask_Stop();
+    } else {
+        VideoOptions options = {VIDEO_DEFAULT_FRAMESIZE, VIDEO_DEFAULT_QUALITY};
+        VideoTask_Start(options);
+    }
+}
+
+/**
+ * @brief Check whether a recording is running (or about to start).
+ * @return true while the camera belongs to the recorder
+ */
+bool VideoTask_IsRecording() {
+    return recordingActive;
+}
+
+/**
+ * @brief Get the progress of the current or last recording.
+ * @param stats Receives the values
+ */
+void VideoTask_GetStats(VideoStats &stats) {
+    stats.recording = recordingActive;
+    strncpy(stats.path, statPath, sizeof(stats.path));
+    stats.frames = statFrames;
+    stats.dropped = statDropped;
+    stats.bytes = statBytes;
+    stats.elapsedMs = statElapsedMs;
+    stats.fpsMilli = statFpsMilli;
+}
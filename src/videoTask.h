@@ -0,0 +1,79 @@
+// videoTask.h - MJPEG video recording to the SD card
+// This header declares the video recorder. While recording, the preview is stopped and the
+// sensor runs in JPEG mode at VGA/SVGA; a grabber task takes frames from the driver and hands
+// them to a writer task that appends them to an AVI file (aviWriter.h). Frames the writer
+// cannot take in time are returned to the driver and counted, so the sustained frame rate
+// and drop count show what the card keeps up with.
+//
+// Key features:
+// - Start/stop from any task (Mid key long press, HTTP /record, serial), recording runs on its own tasks
+// - /video_N.avi files, preallocated, idx1 in PSRAM
+// - Sustained frame rate, written and dropped frames as metrics and in VideoTask_GetStats
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h> // Arduino core library
+#include <esp_camera.h> // framesize_t
+
+// Default recording resolution and JPEG quality (1-63, lower is better)
+#define VIDEO_DEFAULT_FRAMESIZE FRAMESIZE_VGA
+#define VIDEO_DEFAULT_QUALITY 12
+// Driver frame buffers while recording (one being filled, one queued, one being written)
+#define VIDEO_FB_COUNT 3
+// Frames waiting for the writer (VIDEO_FB_COUNT - 2 keeps a buffer free for the driver; the queue
+// has one more slot, reserved for the end marker)
+#define VIDEO_WRITE_QUEUE_LEN (VIDEO_FB_COUNT - 2)
+// idx1 capacity: recording stops when it is full (16 bytes of PSRAM per frame)
+#define VIDEO_MAX_FRAMES 18000
+// Card space reserved when a file is opened (the file grows past it if needed)
+#define VIDEO_PREALLOC_BYTES (32UL * 1024 * 1024)
+
+// Recording settings
+struct VideoOptions {
+    framesize_t frameSize; // FRAMESIZE_VGA or FRAMESIZE_SVGA
+    int quality;           // JPEG quality 1-63
+};
+
+// Progress of the current (or last) recording
+struct VideoStats {
+    bool recording;    // A recording is running
+    char path[24];     // File name
+    uint32_t frames;   // Frames written
+    uint32_t dropped;  // Frames returned unwritten (writer behind)
+    uint32_t bytes;    // JPEG bytes written
+    uint32_t elapsedMs; // First to last written frame
+    uint32_t fpsMilli; // Sustained frame rate x1000
+};
+
+/**
+ * @brief Create the recorder queues and start the grabber and writer tasks (after TfCard_Init).
+ */
+void VideoTask_Init();
+
+/**
+ * @brief Request a recording (returns immediately; the grabber task switches the camera).
+ * @param options Resolution and quality
+ * @return false if a recording is already running or requested, or a timelapse runs
+ */
+bool VideoTask_Start(const VideoOptions &options);
+
+/**
+ * @brief Request the end of the current recording (returns immediately).
+ */
+void VideoTask_Stop();
+
+/**
+ * @brief Start a recording with the default options, or stop the running one.
+ */
+void VideoTask_Toggle();
+
+/**
+ * @brief Check whether a recording is running (or about to start).
+ * @return true while the camera belongs to the recorder
+ */
+bool VideoTask_IsRecording();
+
+/**
+ * @brief Get the progress of the current or last recording.
+ * @param stats Receives the values
+ */
+void VideoTask_GetStats(VideoStats &stats);
@@ -12,12 +12,38 @@ Web address: http://192.168.4.1
 #include <SPI.h> // Include SPI library for SD card communication
 #include <SD.h> // Include SD card library
 #include "webTask.h" // Include header for this module
+#include "fileStream.h" // Double-buffered SD-to-socket streaming
+#include "thumbnail.h" // Thumbnail generation and cache
+#include "zipExport.h" // Streaming ZIP export
+#include "tfCard.h" // Photo index management
+#include "displayTask.h" // Still capture path
+#include "videoTask.h" // Video recording
+#include "metrics.h" // Pipeline counters
+#include "trace.h" // Event tracing
+#include "profiler.h" // Per-task CPU and stack profile
+#include <set> // File name set for batch delete
+#include <vector> // Collected paths for batch delete
+#include <atomic> // Wi-Fi state shared with the requesting task
 
 // WiFi AP credentials (SSID and password for the ESP32 AP)
 const char *apSsid = WIFI_SSID; // SSID for the AP
 const char *apPassword = WIFI_PASSWORD; // Password for the AP
 // HTTP server instance on port 80 (default HTTP port)
 WebServer webServer(80);
+// Wi-Fi state: requested by WebTask_StopWifi/StartWifi, applied by the web task between requests
+static std::atomic<bool> wifiOffRequested(false);
+static std::atomic<bool> wifiOff(false);
+// Given by the web task after it applied a Wi-Fi request
+static SemaphoreHandle_t wifiSwitchedSemaphore;
+
+// Send an open file as the response body using the double-buffered stream engine.
+// Headers are sent first with the exact content length, then the file body is streamed.
+void WebTask_SendFile(File &file, const String &contentType) {
+    webServer.setContentLength(file.size()); // Exact length, no chunked encoding
+    webServer.send(200, contentType, ""); // Send headers only
+    WiFiClient client = webServer.client(); // Underlying TCP client
+    Metrics_Add(METRIC_HTTP_BYTES, FileStream_Send(file, client)); // Stream file body
+}
 
 // List all image files on the SD card and serve an HTML page for file management
 // This function generates an HTML page listing all .jpg and .png files on the SD card root directory.
@@ -82,6 +108,14 @@ void WebTask_ListFiles() {
           display: flex;
           gap: 12px;
         }
+        .thumb {
+          width: 80px;
+          height: 64px;
+          object-fit: cover;
+          border-radius: 6px;
+          margin-right: 10px;
+          background: #e0eafc;
+        }
         .actions a {
           display: inline-block;
           padding: 6px 14px;
@@ -113,6 +147,18 @@ void WebTask_ListFiles() {
       <div class="container">
         <h2>📂 Photo Sets Online</h2>
         <div class="author">By 3SamuelW</div>
+        <div class="actions">
+          <a href="/export">Download all (ZIP)</a>
+          <a href="#" class="delete" onclick="return deleteAll()">Delete all</a>
+        </div>
+        <script>
+          function deleteAll() {
+            if (!confirm('Delete ALL photos?')) return false;
+            fetch('/api/delete', {method: 'POST', body: new URLSearchParams({from: 1, to: 1000000})})
+              .then(r => r.json()).then(s => { alert('Deleted ' + s.deleted + ' photos.'); location.reload(); });
+            return false;
+          }
+        </script>
         <ul>
   )rawliteral";
     while (true) {
@@ -122,6 +168,7 @@ void WebTask_ListFiles() {
         // Only show .jpg and .png files, skip directories
         if (!entry.isDirectory() && (name.endsWith(".jpg") || name.endsWith(".png"))) {
             html += "<li>"; // Start list item
+            html += "<img class='thumb' loading='lazy' src='/thumb?file=" + name + "'>"; // Thumbnail
             html += "<span class='filename'>📄 " + name + "</span>"; // Show file name
             html += "<div class='actions'>"; // Start actions div
             html += "<a href='/view?file=" + name + "' target='_blank'>View</a>"; // View link
@@ -138,6 +185,7 @@ void WebTask_ListFiles() {
     </html>
   )rawliteral";
     webServer.send(200, "text/html", html); // Send HTML page to client
+    Metrics_Add(METRIC_HTTP_BYTES, html.length());
     Serial.println("[WebTask] File list served to client."); // Debug output
 }
 
@@ -157,10 +205,9 @@ void WebTask_HandleDownload() {
         return;
     }
     String contentType = "application/octet-stream"; // Set content type for download
-    webServer.sendHeader("Content-Type", contentType); // Set HTTP headers
-    webServer.sendHeader("Content-Disposition", "attachment; filename=\"" + filename + "\"");
+    webServer.sendHeader("Content-Disposition", "attachment; filename=\"" + filename + "\""); // Set HTTP headers
     webServer.sendHeader("Connection", "close");
-    webServer.streamFile(file, contentType); // Stream file to client
+    WebTask_SendFile(file, contentType); // Stream file to client
     file.close(); // Close file
     Serial.printf("[WebTask] File downloaded: %s\n", filename.c_str()); // Debug output
 }
@@ -181,11 +228,154 @@ void WebTask_HandleView() {
         return;
     }
     String contentType = filename.endsWith(".jpg") ? "image/jpeg" : "image/png"; // Determine content type
-    webServer.streamFile(file, contentType); // Stream image to client
+    WebTask_SendFile(file, contentType); // Stream image to client
     file.close(); // Close file
     Serial.printf("[WebTask] Image viewed: %s\n", filename.c_str()); // Debug output
 }
 
+// Handle thumbnail requests. Serves a small JPEG of the photo, generating and caching it on first use.
+// This function checks for the 'file' parameter, looks up (or builds) the cached thumbnail and streams it.
+void WebTask_HandleThumb() {
+    if (!webServer.hasArg("file")) { // Check if 'file' parameter is present
+        webServer.send(400, "text/plain", "Missing file parameter"); // Send error if missing
+        Serial.println("[WebTask] Thumb failed: missing file parameter.");
+        return;
+    }
+    String filename = webServer.arg("file"); // Get file name from request
+    String thumbPath = Thumbnail_Get("/" + filename); // Cached or freshly generated thumbnail
+    File file = thumbPath.length() ? SD.open(thumbPath) : File();
+    if (!file) { // If photo missing or thumbnail could not be built
+        webServer.send(404, "text/plain", "Thumbnail not available"); // Send 404 error
+        Serial.printf("[WebTask] Thumb failed: %s\n", filename.c_str());
+        return;
+    }
+    webServer.sendHeader("Cache-Control", "max-age=86400"); // Let the browser keep it too
+    WebTask_SendFile(file, "image/jpeg"); // Stream thumbnail to client
+    file.close(); // Close file
+}
+
+// Handle bulk export requests. Streams a store-only ZIP of photo_<from>.jpg .. photo_<to>.jpg.
+// Both parameters are optional and default to the full photo range; 'to' is clamped to the last photo.
+void WebTask_HandleExport() {
+    int last = TfCard_GetLastPhotoIndex(); // Highest photo index, even with gaps below it
+    int from = webServer.hasArg("from") ? webServer.arg("from").toInt() : 1; // First photo index
+    int to = webServer.hasArg("to") ? webServer.arg("to").toInt() : last;
+    if (from < 1 || to < from) {
+        webServer.send(400, "text/plain", "Invalid photo range"); // Send error for bad range
+        Serial.printf("[WebTask] Export failed: invalid range %d-%d.\n", from, to);
+        return;
+    }
+    if (to > last) to = last; // Bounds the SD scan and the CRC table
+    int count = 0;
+    size_t size = to >= from ? ZipExport_GetSize(from, to, &count) : 0; // Exact archive size
+    if (count == 0) {
+        webServer.send(404, "text/plain", "No photos in range"); // Send 404 error
+        Serial.printf("[WebTask] Export failed: no photos in range %d-%d.\n", from, to);
+        return;
+    }
+    ZipExportEntry *entries = ZipExport_AllocEntryTable(from, to); // Before the headers, so failure is still a clean error
+    if (!entries) {
+        webServer.send(503, "text/plain", "Out of memory"); // Send error
+        Serial.println("[WebTask] Export failed: out of memory.");
+        return;
+    }
+    char disposition[64];
+    sprintf(disposition, "attachment; filename=\"photos_%d-%d.zip\"", from, to);
+    webServer.sendHeader("Content-Disposition", disposition); // Set HTTP headers
+    webServer.sendHeader("Connection", "close");
+    webServer.setContentLength(size);
+    webServer.send(200, "application/zip", ""); // Send headers only
+    WiFiClient client = webServer.client(); // Underlying TCP client
+    Metrics_Add(METRIC_HTTP_BYTES, ZipExport_Send(client, from, to, entries)); // Stream archive to client
+    free(entries);
+    Serial.printf("[WebTask] Exported %d photos (%d-%d).\n", count, from, to); // Debug output
+}
+
+// JPEG taken for /capture, copied out of the frame buffer
+struct WebCapture {
+    uint8_t *data; // PSRAM copy (NULL if out of memory)
+    size_t size;   // Size in bytes
+};
+
+// Capture consumer for /capture: only copies the JPEG to PSRAM. The frame buffer belongs to the
+// driver and the camera mutex is held until this returns, so the (slow) send happens afterwards.
+static void WebTask_CopyCapture(camera_fb_t *fb, void *arg) {
+    WebCapture *capture = (WebCapture *)arg;
+    capture->data = (uint8_t *)heap_caps_malloc(fb->len, MALLOC_CAP_SPIRAM);
+    if (!capture->data) return;
+    memcpy(capture->data, fb->buf, fb->len);
+    capture->size = fb->len;
+}
+
+// Map a resolution name (e.g. "vga", "sxga") to a camera frame size.
+// Returns FRAMESIZE_INVALID for unknown names (photo mode default is used).
+static framesize_t WebTask_ParseFrameSize(const String &name) {
+    static const struct { const char *name; framesize_t size; } sizes[] = {
+        {"qvga", FRAMESIZE_QVGA}, {"vga", FRAMESIZE_VGA}, {"svga", FRAMESIZE_SVGA},
+        {"xga", FRAMESIZE_XGA}, {"hd", FRAMESIZE_HD}, {"sxga", FRAMESIZE_SXGA},
+        {"uxga", FRAMESIZE_UXGA}, {"qxga", FRAMESIZE_QXGA}, {"qsxga", FRAMESIZE_QSXGA},
+    };
+    for (const auto &entry : sizes) {
+        if (name.equalsIgnoreCase(entry.name)) return entry.size;
+    }
+    return FRAMESIZE_INVALID;
+}
+
+// Handle remote capture requests. Takes a still through the shutter-key path and returns the JPEG.
+// Optional parameters: res (qvga..qsxga), quality (1-63), flash (1), save (1 = also write to SD).
+void WebTask_HandleCapture() {
+    CaptureOptions options = {FRAMESIZE_INVALID, 0, false};
+    if (webServer.hasArg("res")) options.frameSize = WebTask_ParseFrameSize(webServer.arg("res"));
+    if (webServer.hasArg("quality")) options.quality = constrain(webServer.arg("quality").toInt(), 1, 63);
+    options.flash = webServer.arg("flash") == "1";
+    bool save = webServer.arg("save") == "1";
+    unsigned long start = millis();
+    WebCapture capture = {NULL, 0};
+    if (!DisplayTask_CapturePhoto(options, WebTask_CopyCapture, &capture) || !capture.data) {
+        free(capture.data);
+        webServer.send(503, "text/plain", "Capture failed"); // Camera not available or out of memory
+        Serial.println("[WebTask] Capture failed.");
+        return;
+    }
+    unsigned long captured = millis(); // Camera and preview are back; only the copy is left
+    webServer.sendHeader("Cache-Control", "no-store");
+    webServer.setContentLength(capture.size);
+    webServer.send(200, "image/jpeg", ""); // Send headers only
+    Metrics_Add(METRIC_HTTP_BYTES, webServer.client().write(capture.data, capture.size)); // Send JPEG body
+    if (save) TfCard_QueueOwnedPhoto(capture.data, capture.size, 0); // The writer frees the copy
+    else free(capture.data);
+    Serial.printf("[WebTask] Capture taken in %lu ms, served in %lu ms.\n", captured - start, millis() - start); // Debug output
+}
+
+// Handle video recording requests and report the recording progress as JSON.
+// Optional parameters: action (start, stop; status otherwise), res (vga, svga, ...), quality (1-63).
+// The recording itself runs on the video tasks; download the file with /download?file=video_N.avi.
+void WebTask_HandleRecord() {
+    String action = webServer.arg("action");
+    if (action == "start") {
+        VideoOptions options = {VIDEO_DEFAULT_FRAMESIZE, VIDEO_DEFAULT_QUALITY};
+        if (webServer.hasArg("res")) {
+            framesize_t size = WebTask_ParseFrameSize(webServer.arg("res"));
+            if (size != FRAMESIZE_INVALID) options.frameSize = size;
+        }
+        if (webServer.hasArg("quality")) options.quality = constrain(webServer.arg("quality").toInt(), 1, 63);
+        if (!VideoTask_Start(options)) {
+            webServer.send(409, "text/plain", "Already recording");
+            return;
+        }
+    } else if (action == "stop") {
+        VideoTask_Stop();
+    }
+    VideoStats stats;
+    VideoTask_GetStats(stats);
+    char json[192];
+    sprintf(json, "{\"recording\":%s,\"file\":\"%s\",\"frames\":%u,\"dropped\":%u,\"bytes\":%u,\"elapsed_ms\":%u,\"fps\":%.2f}",
+            stats.recording ? "true" : "false", stats.path + (stats.path[0] == '/'), (unsigned)stats.frames,
+            (unsigned)stats.dropped, (unsigned)stats.bytes, (unsigned)stats.elapsedMs, stats.fpsMilli / 1000.0);
+    webServer.send(200, "application/json", json); // Send status
+    Serial.printf("[WebTask] Record %s: %s\n", action.length() ? action.c_str() : "status", json); // Debug output
+}
+
 // Handle file delete requests. Removes the file from SD card and redirects to home.
 // This function checks for the 'file' parameter, deletes the file, and redirects to the main page.
 void WebTask_HandleDelete() {
@@ -197,6 +387,8 @@ void WebTask_HandleDelete() {
     String filename = webServer.arg("file"); // Get file name from request
     if (SD.exists("/" + filename)) { // Check if file exists
         SD.remove("/" + filename); // Delete file from SD card
+        Thumbnail_Remove("/" + filename); // Delete cached thumbnail
+        TfCard_InvalidatePhotoIndex(); // Freed index may be reused
         webServer.sendHeader("Location", "/"); // Redirect to home page
         webServer.send(302, "text/plain", "Redirecting to home..."); // Send redirect response
         Serial.printf("[WebTask] File deleted: %s\n", filename.c_str()); // Debug output
@@ -206,30 +398,201 @@ void WebTask_HandleDelete() {
     }
 }
 
+// Handle batch delete requests (POST /api/delete).
+// Accepts either 'files' (comma-separated names) or a 'from'/'to' photo index range.
+// The root directory is walked once to collect matches (photos and their thumbnails),
+// the matches are removed, the photo index is invalidated once, and a JSON summary is returned.
+void WebTask_HandleBatchDelete() {
+    std::set<String> names; // Requested file names
+    int from = 0, to = -1; // Requested photo index range
+    if (webServer.hasArg("files")) {
+        String list = webServer.arg("files");
+        int start = 0;
+        while (start <= (int)list.length()) {
+            int comma = list.indexOf(',', start);
+            if (comma < 0) comma = list.length();
+            String name = list.substring(start, comma);
+            name.trim();
+            if (name.length()) names.insert(name);
+            start = comma + 1;
+        }
+    } else if (webServer.hasArg("from") && webServer.hasArg("to")) {
+        from = webServer.arg("from").toInt();
+        to = webServer.arg("to").toInt();
+    } else {
+        webServer.send(400, "application/json", "{\"error\":\"missing files or from/to\"}"); // Send error if missing
+        Serial.println("[WebTask] Batch delete failed: missing parameters.");
+        return;
+    }
+    unsigned long start = millis();
+    std::vector<String> victims; // Files to remove, collected in a single directory pass
+    int matched = 0;
+    File root = SD.open("/");
+    while (true) {
+        File entry = root.openNextFile();
+        if (!entry) break;
+        String name = entry.name();
+        bool isDir = entry.isDirectory();
+        entry.close();
+        if (isDir) continue;
+        String photo = name.endsWith(".thm") ? name.substring(0, name.length() - 4) + ".jpg" : name; // Thumbnail owner
+        bool hit = names.count(photo) > 0;
+        if (!hit && to >= from) {
+            int index = TfCard_ParsePhotoName(photo.c_str()); // Whole, canonical name only
+            hit = index > 0 && index >= from && index <= to;
+        }
+        if (!hit) continue;
+        if (name == photo) ++matched;
+        victims.push_back("/" + name);
+    }
+    root.close();
+    int deleted = 0, failed = 0;
+    for (const String &path : victims) {
+        bool isThumb = path.endsWith(".thm");
+        if (SD.remove(path)) {
+            if (!isThumb) ++deleted;
+        } else if (!isThumb) {
+            ++failed;
+        }
+    }
+    TfCard_InvalidatePhotoIndex(); // Update the photo index once for the whole batch
+    unsigned long elapsed = millis() - start;
+    int requested = names.size() ? (int)names.size() : matched; // A range requests whatever exists in it
+    char json[128];
+    sprintf(json, "{\"requested\":%d,\"deleted\":%d,\"failed\":%d,\"not_found\":%d,\"elapsed_ms\":%lu}",
+            requested, deleted, failed, requested - matched, elapsed);
+    webServer.send(200, "application/json", json); // Send summary
+    Serial.printf("[WebTask] Batch delete: %s\n", json); // Debug output
+}
+
+// Serve pipeline metrics in Prometheus text format.
+void WebTask_HandleMetrics() {
+    String page = Metrics_Render(); // Sample gauges and format all metrics
+    webServer.send(200, "text/plain; version=0.0.4", page);
+    Metrics_Add(METRIC_HTTP_BYTES, page.length());
+}
+
+// Serve the latest per-task CPU and stack profile as JSON.
+void WebTask_HandleProfile() {
+    String json = Profiler_RenderJson();
+    webServer.send(200, "application/json", json);
+    Metrics_Add(METRIC_HTTP_BYTES, json.length());
+}
+
+#if defined(ENABLE_TRACE)
+// Print target that collects output and sends it as HTTP chunks (one chunk per full buffer)
+class WebTask_ChunkedPrint : public Print {
+public:
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *data, size_t len) override {
+        for (size_t i = 0; i < len; i++) {
+            buffer[used++] = data[i];
+            if (used == sizeof(buffer)) sendChunk();
+        }
+        return len;
+    }
+    void sendChunk() {
+        if (used) webServer.sendContent((const char *)buffer, used); // Framed as one chunk
+        used = 0;
+    }
+private:
+    uint8_t buffer[1024];
+    size_t used = 0;
+};
+
+// Serve the recorded trace events as Chrome trace JSON (open in chrome://tracing or Perfetto).
+void WebTask_HandleTrace() {
+    webServer.setContentLength(CONTENT_LENGTH_UNKNOWN); // Length unknown: chunked transfer encoding
+    webServer.sendHeader("Content-Disposition", "attachment; filename=\"trace.json\"");
+    webServer.send(200, "application/json", ""); // Send headers only
+    WebTask_ChunkedPrint out;
+    Trace_Dump(out);
+    out.sendChunk(); // Remainder
+    webServer.sendContent(""); // Empty final chunk ends the body
+}
+#endif
+
+// Register a route whose requests are counted in the HTTP metrics.
+static void WebTask_Route(const char *uri, HTTPMethod method, void (*handler)()) {
+    webServer.on(uri, method, [uri, handler]() {
+        TRACE_SCOPE(uri);
+        Metrics_Add(METRIC_HTTP_REQUESTS);
+        handler();
+    });
+}
+
 // Initialize WiFi AP and start the HTTP server with all routes
 // This function sets up the ESP32 as a WiFi AP, starts the HTTP server, and registers all URL handlers.
 void WebTask_Init() {
+    wifiSwitchedSemaphore = xSemaphoreCreateBinary();
     WiFi.softAP(apSsid, apPassword); // Start WiFi AP
     IPAddress ip = WiFi.softAPIP(); // Get AP IP address
     Serial.print("[WebTask] AP started. IP address: ");
     Serial.println(ip); // Print IP address
-    webServer.on("/", HTTP_GET, WebTask_ListFiles); // Register handler for file list
-    webServer.on("/view", HTTP_GET, WebTask_HandleView); // Register handler for image view
-    webServer.on("/download", HTTP_GET, WebTask_HandleDownload); // Register handler for download
-    webServer.on("/delete", HTTP_GET, WebTask_HandleDelete); // Register handler for delete
+    WebTask_Route("/", HTTP_GET, WebTask_ListFiles); // Register handler for file list
+    WebTask_Route("/view", HTTP_GET, WebTask_HandleView); // Register handler for image view
+    WebTask_Route("/download", HTTP_GET, WebTask_HandleDownload); // Register handler for download
+    WebTask_Route("/thumb", HTTP_GET, WebTask_HandleThumb); // Register handler for thumbnails
+    WebTask_Route("/export", HTTP_GET, WebTask_HandleExport); // Register handler for ZIP export
+    WebTask_Route("/capture", HTTP_GET, WebTask_HandleCapture); // Register handler for remote capture
+    WebTask_Route("/record", HTTP_GET, WebTask_HandleRecord); // Register handler for video recording
+    WebTask_Route("/delete", HTTP_GET, WebTask_HandleDelete); // Register handler for delete
+    WebTask_Route("/metrics", HTTP_GET, WebTask_HandleMetrics); // Register handler for metrics
+    WebTask_Route("/profile", HTTP_GET, WebTask_HandleProfile); // Register handler for task profile
+#if defined(ENABLE_TRACE)
+    WebTask_Route("/trace", HTTP_GET, WebTask_HandleTrace); // Register handler for trace dump
+#endif
+    WebTask_Route("/api/delete", HTTP_POST, WebTask_HandleBatchDelete); // Register handler for batch delete
     webServer.onNotFound([]() { // Handler for unknown URLs
         webServer.send(404, "text/plain", "404: Not Found");
         Serial.println("[WebTask] 404 Not Found.");
     });
+    FileStream_Init(); // Start SD reader task for file streaming
     webServer.begin(); // Start HTTP server
     Serial.println("[WebTask] Web server started."); // Debug output
 }
 
+// Ask the web task to switch Wi-Fi off or on and wait until it has (never mid-request).
+static void WebTask_RequestWifi(bool off) {
+    if (!wifiSwitchedSemaphore || (wifiOff == off && wifiOffRequested == off)) return; // Nothing to do
+    xSemaphoreTake(wifiSwitchedSemaphore, 0); // Drop a stale confirmation
+    wifiOffRequested = off;
+    if (xSemaphoreTake(wifiSwitchedSemaphore, WEB_WIFI_SWITCH_TIMEOUT_MS / portTICK_PERIOD_MS) != pdTRUE) {
+        Serial.println("[WebTask] Web task busy, Wi-Fi switch still pending.");
+    }
+}
+
+// Stop the HTTP server and the AP, and turn the radio off. Returns once the web task has done so.
+void WebTask_StopWifi() {
+    WebTask_RequestWifi(true);
+}
+
+// Bring the AP and the HTTP server back after WebTask_StopWifi.
+void WebTask_StartWifi() {
+    WebTask_RequestWifi(false);
+}
+
 // Main web server task loop. Handles incoming HTTP requests.
-// This function should be run as a FreeRTOS task. It continuously processes HTTP requests.
+// This function should be run as a FreeRTOS task. It continuously processes HTTP requests,
+// and switches Wi-Fi off and on between requests when asked to.
 void WebTask(void *pvParameters) {
     while (1) {
-        webServer.handleClient(); // Handle incoming HTTP client requests
+        bool off = wifiOffRequested;
+        if (off != wifiOff) {
+            if (off) {
+                webServer.stop(); // Close the listening socket
+                WiFi.softAPdisconnect(true); // Drop the stations and the AP
+                WiFi.mode(WIFI_OFF); // Radio off
+                Serial.println("[WebTask] Wi-Fi off.");
+            } else {
+                WiFi.softAP(apSsid, apPassword); // Start WiFi AP again
+                webServer.begin(); // Start HTTP server again
+                Serial.println("[WebTask] Wi-Fi back on.");
+            }
+            wifiOff = off;
+            xSemaphoreGive(wifiSwitchedSemaphore);
+        }
+        if (!off) webServer.handleClient(); // Handle incoming HTTP client requests
         vTaskDelay(30 / portTICK_PERIOD_MS); // Small delay to yield CPU
     }
 }
\ No newline at end of file
@@ -8,10 +8,26 @@ Web address: http://192.168.4.1
 
 #define WIFI_SSID "ESP32-CAM"
 #define WIFI_PASSWORD "MyPassword"
+// Longest wait for the web task to switch Wi-Fi off or on (it finishes the current request first)
+#define WEB_WIFI_SWITCH_TIMEOUT_MS 5000
 
+#include <FS.h>
+
+void WebTask_SendFile(File &file, const String &contentType);
 void WebTask_ListFiles();
 void WebTask_HandleDownload();
 void WebTask_HandleView();
+void WebTask_HandleThumb();
+void WebTask_HandleExport();
+void WebTask_HandleCapture();
+void WebTask_HandleRecord();
+void WebTask_HandleMetrics();
+void WebTask_HandleProfile();
+void WebTask_HandleTrace();
 void WebTask_Init();
 void WebTask_HandleDelete();
+void WebTask_HandleBatchDelete();
+// Switch the AP and HTTP server off (e.g. for light sleep) and back on; both wait until the web task has done it
+void WebTask_StopWifi();
+void WebTask_StartWifi();
 void WebTask(void *pvParameters);
\ No newline at end of file
@@ -0,0 +1,213 @@
+// zipExport.cpp - Streaming ZIP export implementation
+// This module writes a store-only (uncompressed) ZIP archive of photo_N.jpg files directly
+// to a TCP client. Each file body goes through the double-buffered stream engine, which
+// also updates the CRC-32; the CRC is then written in a data descriptor after the body.
+//
+// Key features:
+// - Local header, file data, data descriptor per photo, then central directory
+// - Only CRC, size and offset of each entry are kept in memory (16 bytes per photo, PSRAM)
+// - Sizes and CRC are left zero in the local header (flag bit 3) and given in the data descriptor
+// - A short write stops the archive, so the client sees a truncated response
+// - Archive size computed from file sizes alone, before any data is sent
+
+#include "zipExport.h"  // Include header for this module
+#include <SD.h>         // SD card library
+#include "fileStream.h" // Double-buffered SD-to-socket streaming
+
+// ZIP record sizes (without file name)
+#define ZIP_LOCAL_HEADER_SIZE 30
+#define ZIP_DATA_DESCRIPTOR_SIZE 16
+#define ZIP_CENTRAL_HEADER_SIZE 46
+#define ZIP_END_RECORD_SIZE 22
+// General purpose flag: sizes and CRC follow the data in a data descriptor
+#define ZIP_FLAG_DATA_DESCRIPTOR 0x0008
+// DOS date for 1980-01-01 (the board has no real-time clock)
+#define ZIP_DOS_DATE 0x0021
+
+/**
+ * @brief Store a 16-bit little-endian value.
+ */
+static uint8_t *ZipExport_Put16(uint8_t *p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+    return p + 2;
+}
+
+/**
+ * @brief Store a 32-bit little-endian value.
+ */
+static uint8_t *ZipExport_Put32(uint8_t *p, uint32_t v) {
+    p = ZipExport_Put16(p, v & 0xFFFF);
+    return ZipExport_Put16(p, v >> 16);
+}
+
+/**
+ * @brief Build the archive entry name and SD path of a photo.
+ * @param index Photo index
+ * @param name Receives the entry name (e.g. "photo_1.jpg")
+ * @param path Receives the SD path (e.g. "/photo_1.jpg")
+ */
+static void ZipExport_PhotoName(int index, char *name, char *path) {
+    sprintf(name, "photo_%d.jpg", index);
+    sprintf(path, "/%s", name);
+}
+
+/**
+ * @brief Compute the exact size of the ZIP archive for a photo range.
+ * @param from First photo index (inclusive)
+ * @param to Last photo index (inclusive)
+ * @param count Receives the number of photos found in the range (may be NULL)
+ * @return Archive size in bytes
+ */
+size_t ZipExport_GetSize(int from, int to, int *count) {
+    size_t total = ZIP_END_RECORD_SIZE;
+    int found = 0;
+    char name[32], path[32];
+    for (int i = from; i <= to; i++) {
+        ZipExport_PhotoName(i, name, path);
+        File file = SD.open(path);
+        if (!file) continue; // Gaps in the range are skipped
+        size_t nameLen = strlen(name);
+        total += ZIP_LOCAL_HEADER_SIZE + nameLen + file.size() + ZIP_DATA_DESCRIPTOR_SIZE;
+        total += ZIP_CENTRAL_HEADER_SIZE + nameLen;
+        file.close();
+        ++found;
+    }
+    if (count) *count = found;
+    return total;
+}
+
+/**
+ * @brief Allocate the entry table for a photo range (PSRAM, one entry per index).
+ * Call before sending the HTTP headers, so running out of memory can still be reported.
+ * @param from First photo index (inclusive)
+ * @param to Last photo index (inclusive, not below from)
+ * @return Table to pass to ZipExport_Send and release with free(), or NULL
+ */
+ZipExportEntry *ZipExport_AllocEntryTable(int from, int to) {
+    ZipExportEntry *entries = (ZipExportEntry *)heap_caps_calloc(to - from + 1, sizeof(ZipExportEntry), MALLOC_CAP_SPIRAM);
+    if (!entries) Serial.println("[ZipExport] Failed to allocate entry table!");
+    return entries;
+}
+
+/**
+ * @brief Write a buffer to the client and count it.
+ * @param offset Running archive offset, advanced by the bytes actually written
+ * @return true if the whole buffer was written
+ */
+static bool ZipExport_Write(WiFiClient &client, const uint8_t *data, size_t size, size_t &offset) {
+    size_t written = client.write(data, size);
+    offset += written;
+    return written == size;
+}
+
+/**
+ * @brief Stream a store-only ZIP archive of a photo range to a client.
+ * Pass 1 streams local headers, data and data descriptors while recording each entry's
+ * CRC, size and offset as sent. Pass 2 writes the central directory and end record from
+ * that table, without touching the card again. A short write stops the archive there.
+ * @param client Connected TCP client
+ * @param from First photo index (inclusive)
+ * @param to Last photo index (inclusive)
+ * @param entries Table from ZipExport_AllocEntryTable for the same range
+ * @return Number of bytes written to the client
+ */
+size_t ZipExport_Send(WiFiClient &client, int from, int to, ZipExportEntry *entries) {
+    if (to < from || !entries) return 0;
+    uint8_t header[ZIP_CENTRAL_HEADER_SIZE];
+    char name[32], path[32];
+    size_t offset = 0; // Bytes written so far (= offset of the next record)
+    size_t centralSize = 0;
+    int count = 0;
+    bool ok = true;
+    unsigned long start = millis();
+    // Pass 1: local header + file data + data descriptor for each photo
+    for (int i = from; i <= to && ok; i++) {
+        ZipExport_PhotoName(i, name, path);
+        File file = SD.open(path);
+        if (!file) continue;
+        ZipExportEntry &entry = entries[count];
+        entry.index = i;
+        entry.offset = offset;
+        uint16_t nameLen = strlen(name);
+        size_t size = file.size();
+        uint8_t *p = header;
+        p = ZipExport_Put32(p, 0x04034b50);               // Local file header signature
+        p = ZipExport_Put16(p, 20);                       // Version needed (2.0)
+        p = ZipExport_Put16(p, ZIP_FLAG_DATA_DESCRIPTOR); // Flags
+        p = ZipExport_Put16(p, 0);                        // Method: store
+        p = ZipExport_Put16(p, 0);                        // Modification time
+        p = ZipExport_Put16(p, ZIP_DOS_DATE);             // Modification date
+        p = ZipExport_Put32(p, 0);                        // CRC-32 (in data descriptor)
+        p = ZipExport_Put32(p, 0);                        // Compressed size (in data descriptor)
+        p = ZipExport_Put32(p, 0);                        // Uncompressed size (in data descriptor)
+        p = ZipExport_Put16(p, nameLen);                  // File name length
+        p = ZipExport_Put16(p, 0);                        // Extra field length
+        ok = ZipExport_Write(client, header, ZIP_LOCAL_HEADER_SIZE, offset) &&
+             ZipExport_Write(client, (const uint8_t *)name, nameLen, offset);
+        if (ok) {
+            entry.crc = 0;
+            entry.size = FileStream_Send(file, client, &entry.crc); // File data, CRC computed on the fly
+            offset += entry.size;
+            ok = entry.size == size;
+        }
+        file.close();
+        if (!ok) break; // Client gave up or the card failed; the response is truncated here
+        p = header;
+        p = ZipExport_Put32(p, 0x08074b50); // Data descriptor signature
+        p = ZipExport_Put32(p, entry.crc);
+        p = ZipExport_Put32(p, entry.size);
+        p = ZipExport_Put32(p, entry.size);
+        ok = ZipExport_Write(client, header, ZIP_DATA_DESCRIPTOR_SIZE, offset);
+        ++count;
+    }
+    if (!ok) {
+        Serial.printf("[ZipExport] Stopped after %u bytes, archive truncated.\n", (unsigned)offset);
+        return offset;
+    }
+    // Pass 2: central directory from the recorded entries
+    size_t centralOffset = offset;
+    for (int n = 0; n < count && ok; n++) {
+        const ZipExportEntry &entry = entries[n];
+        ZipExport_PhotoName(entry.index, name, path);
+        uint16_t nameLen = strlen(name);
+        uint8_t *p = header;
+        p = ZipExport_Put32(p, 0x02014b50);               // Central directory header signature
+        p = ZipExport_Put16(p, 20);                       // Version made by
+        p = ZipExport_Put16(p, 20);                       // Version needed
+        p = ZipExport_Put16(p, ZIP_FLAG_DATA_DESCRIPTOR); // Flags
+        p = ZipExport_Put16(p, 0);                        // Method: store
+        p = ZipExport_Put16(p, 0);                        // Modification time
+        p = ZipExport_Put16(p, ZIP_DOS_DATE);             // Modification date
+        p = ZipExport_Put32(p, entry.crc);                // CRC-32
+        p = ZipExport_Put32(p, entry.size);               // Compressed size
+        p = ZipExport_Put32(p, entry.size);               // Uncompressed size
+        p = ZipExport_Put16(p, nameLen);                  // File name length
+        p = ZipExport_Put16(p, 0);                        // Extra field length
+        p = ZipExport_Put16(p, 0);                        // Comment length
+        p = ZipExport_Put16(p, 0);                        // Disk number
+        p = ZipExport_Put16(p, 0);                        // Internal attributes
+        p = ZipExport_Put32(p, 0);                        // External attributes
+        p = ZipExport_Put32(p, entry.offset);             // Offset of local header
+        ok = ZipExport_Write(client, header, ZIP_CENTRAL_HEADER_SIZE, offset) &&
+             ZipExport_Write(client, (const uint8_t *)name, nameLen, offset);
+        centralSize += ZIP_CENTRAL_HEADER_SIZE + nameLen;
+    }
+    if (!ok) {
+        Serial.printf("[ZipExport] Stopped after %u bytes, archive truncated.\n", (unsigned)offset);
+        return offset;
+    }
+    // End of central directory record
+    uint8_t *p = header;
+    p = ZipExport_Put32(p, 0x06054b50); // End of central directory signature
+    p = ZipExport_Put16(p, 0);          // Number of this disk
+    p = ZipExport_Put16(p, 0);          // Disk with central directory
+    p = ZipExport_Put16(p, count);      // Entries on this disk
+    p = ZipExport_Put16(p, count);      // Total entries
+    p = ZipExport_Put32(p, centralSize);
+    p = ZipExport_Put32(p, centralOffset);
+    p = ZipExport_Put16(p, 0);          // Comment length
+    ZipExport_Write(client, header, ZIP_END_RECORD_SIZE, offset);
+    Serial.printf("[ZipExport] %d photos, %u bytes in %lu ms.\n", count, (unsigned)offset, millis() - start);
+    return offset;
+}
@@ -0,0 +1,50 @@
+// zipExport.h - Streaming ZIP export module
+// This header declares the bulk photo export used by the web server's /export endpoint.
+//
+// Key features:
+// - Store-only ZIP archive of a photo index range
+// - Streamed straight from the SD card to the socket (no temp files)
+// - CRC-32 computed on the fly and emitted in data descriptors
+// - Exact archive size known up front (Content-Length, resumable progress bars)
+
+#pragma once // Prevent multiple inclusion of this header
+#include <Arduino.h>    // Arduino core library
+#include <WiFiClient.h> // TCP client type
+
+/**
+ * @brief Compute the exact size of the ZIP archive for a photo range.
+ * @param from First photo index (inclusive)
+ * @param to Last photo index (inclusive)
+ * @param count Receives the number of photos found in the range (may be NULL)
+ * @return Archive size in bytes
+ */
+size_t ZipExport_GetSize(int from, int to, int *count);
+
+// Archive entry as actually written by pass 1, replayed into the central directory
+struct ZipExportEntry {
+    int index;       // Photo index
+    uint32_t crc;    // CRC-32 of the data sent
+    uint32_t size;   // Bytes of data sent
+    uint32_t offset; // Offset of the local header in the archive
+};
+
+/**
+ * @brief Allocate the entry table for a photo range (PSRAM, one entry per index).
+ * Call before sending the HTTP headers, so running out of memory can still be reported.
+ * @param from First photo index (inclusive)
+ * @param to Last photo index (inclusive, not below from)
+ * @return Table to pass to ZipExport_Send and release with free(), or NULL
+ */
+ZipExportEntry *ZipExport_AllocEntryTable(int from, int to);
+
+/**
+ * @brief Stream a store-only ZIP archive of a photo range to a client.
+ * The HTTP headers (with ZipExport_GetSize as length) must already have been sent.
+ * A short write ends the response early (truncated, no central directory).
+ * @param client Connected TCP client
+ * @param from First photo index (inclusive)
+ * @param to Last photo index (inclusive)
+ * @param entries Table from ZipExport_AllocEntryTable for the same range
+ * @return Number of bytes written to the client
+ */
+size_t ZipExport_Send(WiFiClient &client, int from, int to, ZipExportEntry *entries);
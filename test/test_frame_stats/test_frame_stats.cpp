@@ -0,0 +1,184 @@
+// test_frame_stats.cpp - Frame statistics tests
+// Unity tests for the frame statistics stage. Each test draws a synthetic frame with known
+// statistics, runs FrameStats_Process and compares every value; the settle test feeds a simulated
+// auto exposure sequence through FrameStats_Settle. Run with: pio test -e native
+//
+// Key features:
+// - Uniform gray, black/white split, step ramp, checkerboard sharp and defocused
+// - All sums are integers, so the expected values are checked for equality
+// - AE settling: settles at the expected frame, a flash starts the count over
+
+#include <unity.h>      // Unity test framework
+#include <string.h>     // memset
+#include "frameStats.h" // Module under test
+
+// Synthetic scene size (QVGA, as the preview)
+#define FRAME_STATS_SCENE_WIDTH 320
+#define FRAME_STATS_SCENE_HEIGHT 240
+
+// Expected statistics of a synthetic frame. Gray levels are multiples of 8, whose luma is
+// the level itself, so the expected values follow directly from the drawing (the checkerboard
+// sharpness is 128^2 x E[(h + v)^2], h/v = sample next to a vertical/horizontal edge).
+struct FrameStatsExpect {
+    uint16_t meanTenths;                        // Expected result
+    uint8_t p5, p50, p95;
+    uint16_t shadowPermille, highlightPermille;
+    uint32_t sharpnessMin, sharpnessMax;        // Accepted sharpness range
+};
+
+/**
+ * @brief Uniform mid gray: every statistic sits at 128, nothing clipped, no detail.
+ */
+static void FrameStats_SceneUniform(uint8_t *gray, uint8_t *temp) {
+    memset(gray, 128, FRAME_STATS_SCENE_WIDTH * FRAME_STATS_SCENE_HEIGHT);
+}
+
+/**
+ * @brief Left half black, right half 248: half of the samples clipped at each end, one edge.
+ */
+static void FrameStats_SceneSplit(uint8_t *gray, uint8_t *temp) {
+    for (int y = 0; y < FRAME_STATS_SCENE_HEIGHT; y++) {
+        for (int x = 0; x < FRAME_STATS_SCENE_WIDTH; x++) {
+            gray[y * FRAME_STATS_SCENE_WIDTH + x] = x < FRAME_STATS_SCENE_WIDTH / 2 ? 0 : 248;
+        }
+    }
+}
+
+/**
+ * @brief Horizontal ramp of 32 levels (0, 8, .., 248), 10 pixels each: uniform histogram, small steps.
+ */
+static void FrameStats_SceneRamp(uint8_t *gray, uint8_t *temp) {
+    for (int y = 0; y < FRAME_STATS_SCENE_HEIGHT; y++) {
+        for (int x = 0; x < FRAME_STATS_SCENE_WIDTH; x++) {
+            gray[y * FRAME_STATS_SCENE_WIDTH + x] = (uint8_t)(x / 10 * 8);
+        }
+    }
+}
+
+/**
+ * @brief Checkerboard of 16-pixel squares, 64 and 192.
+ */
+static void FrameStats_SceneChecker(uint8_t *gray, uint8_t *temp) {
+    for (int y = 0; y < FRAME_STATS_SCENE_HEIGHT; y++) {
+        for (int x = 0; x < FRAME_STATS_SCENE_WIDTH; x++) {
+            gray[y * FRAME_STATS_SCENE_WIDTH + x] = ((x / 16 + y / 16) & 1) ? 192 : 64;
+        }
+    }
+}
+
+/**
+ * @brief The checkerboard out of focus: 9x9 box blur (edges clamped), levels rounded to multiples of 8.
+ */
+static void FrameStats_SceneCheckerDefocused(uint8_t *gray, uint8_t *temp) {
+    const int radius = 4, size = 2 * radius + 1;
+    FrameStats_SceneChecker(temp, NULL);
+    for (int pass = 0; pass < 2; pass++) { // Horizontal into gray, then vertical back into temp
+        const uint8_t *src = pass == 0 ? temp : gray;
+        uint8_t *dst = pass == 0 ? gray : temp;
+        for (int y = 0; y < FRAME_STATS_SCENE_HEIGHT; y++) {
+            for (int x = 0; x < FRAME_STATS_SCENE_WIDTH; x++) {
+                int sum = 0;
+                for (int k = -radius; k <= radius; k++) {
+                    int sx = pass == 0 ? x + k : x, sy = pass == 0 ? y : y + k;
+                    sx = sx < 0 ? 0 : sx >= FRAME_STATS_SCENE_WIDTH ? FRAME_STATS_SCENE_WIDTH - 1 : sx;
+                    sy = sy < 0 ? 0 : sy >= FRAME_STATS_SCENE_HEIGHT ? FRAME_STATS_SCENE_HEIGHT - 1 : sy;
+                    sum += src[sy * FRAME_STATS_SCENE_WIDTH + sx];
+                }
+                dst[y * FRAME_STATS_SCENE_WIDTH + x] = (uint8_t)((sum + size / 2) / size);
+            }
+        }
+    }
+    for (int i = 0; i < FRAME_STATS_SCENE_WIDTH * FRAME_STATS_SCENE_HEIGHT; i++) gray[i] = (uint8_t)((temp[i] + 4) / 8 * 8);
+}
+
+/**
+ * @brief Convert a gray scene to an RGB565 frame in panel byte order.
+ */
+static void FrameStats_ToFrame(const uint8_t *gray, uint16_t *frame) {
+    for (int i = 0; i < FRAME_STATS_SCENE_WIDTH * FRAME_STATS_SCENE_HEIGHT; i++) {
+        uint16_t color = (uint16_t)(((gray[i] >> 3) << 11) | ((gray[i] >> 2) << 5) | (gray[i] >> 3));
+        frame[i] = (uint16_t)((color << 8) | (color >> 8));
+    }
+}
+
+// Simulated auto exposure after a scene change: the luma error halves per frame (settles at the
+// 9th frame, the first with three consecutive steps under the limit), the white balance cast
+// converges earlier; the last frame is a flash firing and must start the count over.
+static const uint16_t frameStatsSettleMean[] = {400, 840, 1060, 1170, 1225, 1252, 1266, 1273, 1276, 1278, 2000};
+static const int16_t frameStatsSettleRb[] = {-40, -20, -10, -5, -2, -1, 0, 0, 0, 0, 0};
+#define FRAME_STATS_SETTLE_EXPECTED 8 // Frame index
+
+/**
+ * @brief Draw a scene, compute its statistics and compare them with the expected values.
+ * @param draw Scene in gray levels (temp: scratch of the same size)
+ */
+static void FrameStats_Check(void (*draw)(uint8_t *gray, uint8_t *temp), const FrameStatsExpect &expect) {
+    static FrameStats stats; // Kept off the stack
+    static uint8_t gray[FRAME_STATS_SCENE_WIDTH * FRAME_STATS_SCENE_HEIGHT];
+    static uint8_t temp[FRAME_STATS_SCENE_WIDTH * FRAME_STATS_SCENE_HEIGHT];
+    static uint16_t frame[FRAME_STATS_SCENE_WIDTH * FRAME_STATS_SCENE_HEIGHT];
+    draw(gray, temp);
+    FrameStats_ToFrame(gray, frame);
+    TEST_ASSERT_TRUE(FrameStats_Process(stats, frame, FRAME_STATS_SCENE_WIDTH, FRAME_STATS_SCENE_HEIGHT));
+    const FrameStatsResult &r = stats.result;
+    TEST_ASSERT_EQUAL_INT_MESSAGE(expect.meanTenths, r.meanTenths, "mean luma (tenths)");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(expect.p5, r.p5, "5th percentile");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(expect.p50, r.p50, "median");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(expect.p95, r.p95, "95th percentile");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(expect.shadowPermille, r.shadowPermille, "clipped shadows");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(expect.highlightPermille, r.highlightPermille, "clipped highlights");
+    TEST_ASSERT_TRUE_MESSAGE(r.sharpness >= expect.sharpnessMin && r.sharpness <= expect.sharpnessMax, "sharpness");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, r.rbTenths, "colour cast of a gray scene");
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_uniform_gray(void) {
+    FrameStats_Check(FrameStats_SceneUniform, {1280, 128, 128, 128, 0, 0, 0, 0});
+}
+
+static void test_black_white_split(void) {
+    FrameStats_Check(FrameStats_SceneSplit, {1240, 0, 0, 248, 500, 500, 778, 778});
+}
+
+static void test_step_ramp(void) {
+    FrameStats_Check(FrameStats_SceneRamp, {1240, 8, 120, 240, 62, 31, 25, 25});
+}
+
+static void test_checkerboard(void) {
+    FrameStats_Check(FrameStats_SceneChecker, {1280, 64, 64, 192, 0, 0, 9698, 9698});
+}
+
+static void test_checkerboard_defocused(void) {
+    // Mean shifted by the rounding to multiples of 8, under a tenth of the sharp checkerboard's sharpness
+    FrameStats_Check(FrameStats_SceneCheckerDefocused, {1289, 64, 128, 192, 0, 0, 1, 969});
+}
+
+static void test_ae_settling(void) {
+    FrameStatsSettle settle = FrameStatsSettle();
+    FrameStatsResult result = FrameStatsResult();
+    int settledAt = -1;
+    uint32_t stable = 0;
+    const int frames = sizeof(frameStatsSettleMean) / sizeof(frameStatsSettleMean[0]);
+    for (int i = 0; i < frames; i++) {
+        result.meanTenths = frameStatsSettleMean[i];
+        result.rbTenths = frameStatsSettleRb[i];
+        stable = FrameStats_Settle(settle, result);
+        if (settledAt < 0 && stable >= FRAME_STATS_SETTLED_FRAMES) settledAt = i;
+    }
+    TEST_ASSERT_EQUAL_INT_MESSAGE(FRAME_STATS_SETTLE_EXPECTED, settledAt, "settled at frame");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, stable, "stable frames after the flash");
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_uniform_gray);
+    RUN_TEST(test_black_white_split);
+    RUN_TEST(test_step_ramp);
+    RUN_TEST(test_checkerboard);
+    RUN_TEST(test_checkerboard_defocused);
+    RUN_TEST(test_ae_settling);
+    return UNITY_END();
+}
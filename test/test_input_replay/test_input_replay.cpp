@@ -0,0 +1,170 @@
+// test_input_replay.cpp - Input replay tests
+// Unity tests for the key gesture recognizer and the UI state machine. Each test replays a
+// scripted edge timeline with InputReplay_Run on a virtual clock and checks the gestures, their
+// decision times and the final UI state. Run with: pio test -e native
+//
+// Key features:
+// - Expected times follow from DOUBLE_CLICK_MS 400, LONG_PRESS_MS 800 and DEBOUNCE_MS 30
+// - Clicks, contact bounce, double click, long press, gallery browsing and the overlay cycle
+// - Timeline parser checks (log tags, comments, malformed lines)
+
+#include <unity.h>       // Unity test framework
+#include <stdio.h>       // snprintf
+#include "inputReplay.h" // Module under test
+
+// Maximum number of edges and expected gestures in a scenario
+#define REPLAY_SCENARIO_MAX_EDGES 16
+#define REPLAY_SCENARIO_MAX_GESTURES 8
+
+// Expected gesture of a scenario
+struct ReplayExpect {
+    KeyId key;              // Expected key
+    KeyGestureType gesture; // Expected gesture
+    uint32_t timeMs;        // Expected decision time
+};
+
+// Scenario: timeline, card contents and expected outcome
+struct ReplayScenario {
+    const char *timeline;                              // Edge timeline in text format
+    int photoCount;                                    // Photos on the simulated card
+    int expectCount;                                   // Number of expected gestures
+    ReplayExpect expect[REPLAY_SCENARIO_MAX_GESTURES]; // Expected gestures, in order
+    UiState ui;                                        // Expected final UI state
+};
+
+/**
+ * @brief Replay a scenario and check gestures, decision times and final UI state.
+ */
+static void InputReplay_Check(const ReplayScenario &scenario) {
+    ReplayEdge edges[REPLAY_SCENARIO_MAX_EDGES];
+    int edgeCount = InputReplay_Parse(scenario.timeline, edges, REPLAY_SCENARIO_MAX_EDGES);
+    TEST_ASSERT_TRUE_MESSAGE(edgeCount >= 0, "malformed timeline");
+    static ReplayResult result; // Kept off the stack
+    InputReplay_Run(edges, edgeCount, scenario.photoCount, result);
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(scenario.expectCount, result.eventCount, "gesture count");
+    char message[96];
+    for (int i = 0; i < result.eventCount; i++) {
+        const ReplayEvent &got = result.events[i];
+        const ReplayExpect &want = scenario.expect[i];
+        snprintf(message, sizeof(message), "gesture %d is %s %s @%u ms", i, InputReplay_KeyName(got.key),
+                 InputReplay_GestureName(got.gesture), (unsigned)got.timeMs);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(want.key, got.key, message);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(want.gesture, got.gesture, message);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(want.timeMs, got.timeMs, message);
+    }
+    TEST_ASSERT_EQUAL_INT_MESSAGE(scenario.ui.mode, result.ui.mode, "ui mode");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(scenario.ui.effectMode, result.ui.effectMode, "ui effect mode");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(scenario.ui.paramLevel, result.ui.paramLevel, "ui parameter level");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(scenario.ui.photoIndex, result.ui.photoIndex, "ui photo index");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(scenario.ui.hudVisible, result.ui.hudVisible, "ui HUD");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(scenario.ui.overlay, result.ui.overlay, "ui overlay");
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_single_click(void) {
+    static const ReplayScenario scenario = {
+        "0 top down\n80 top up\n", 0,
+        1, {{KEY_ID_TOP, KEY_GESTURE_SINGLE, 481}},
+        {UI_MODE_PREVIEW, 1, 0, 0, false}};
+    InputReplay_Check(scenario);
+}
+
+static void test_bounced_single_click(void) {
+    static const ReplayScenario scenario = {
+        "0 top down\n5 top up\n12 top down\n90 top up\n95 top down\n110 top up\n", 0,
+        1, {{KEY_ID_TOP, KEY_GESTURE_SINGLE, 491}},
+        {UI_MODE_PREVIEW, 1, 0, 0, false}};
+    InputReplay_Check(scenario);
+}
+
+static void test_double_click(void) {
+    static const ReplayScenario scenario = {
+        "0 cam down\n60 cam up\n200 cam down\n260 cam up\n", 0,
+        1, {{KEY_ID_CAM, KEY_GESTURE_DOUBLE, 200}},
+        {UI_MODE_PREVIEW, 0, 0, 0, false}};
+    InputReplay_Check(scenario);
+}
+
+static void test_slow_double_click(void) {
+    static const ReplayScenario scenario = {
+        "0 down down\n50 down up\n500 down down\n550 down up\n", 0,
+        2, {{KEY_ID_DOWN, KEY_GESTURE_SINGLE, 451}, {KEY_ID_DOWN, KEY_GESTURE_SINGLE, 951}},
+        {UI_MODE_PREVIEW, 0, 2, 0, false}};
+    InputReplay_Check(scenario);
+}
+
+static void test_long_press_toggles_hud(void) {
+    static const ReplayScenario scenario = {
+        "0 top down\n1000 top up\n", 0,
+        1, {{KEY_ID_TOP, KEY_GESTURE_LONG, 801}},
+        {UI_MODE_PREVIEW, 0, 0, 0, true}};
+    InputReplay_Check(scenario);
+}
+
+static void test_gallery_browsing(void) {
+    static const ReplayScenario scenario = {
+        "0 mid down\n50 mid up\n1000 top down\n1050 top up\n2000 top down\n2050 top up\n"
+        "3000 top down\n3050 top up\n4000 down down\n4050 down up\n", 3,
+        5, {{KEY_ID_MID, KEY_GESTURE_SINGLE, 451}, {KEY_ID_TOP, KEY_GESTURE_SINGLE, 1451},
+            {KEY_ID_TOP, KEY_GESTURE_SINGLE, 2451}, {KEY_ID_TOP, KEY_GESTURE_SINGLE, 3451},
+            {KEY_ID_DOWN, KEY_GESTURE_SINGLE, 4451}},
+        {UI_MODE_GALLERY, 0, 0, 2, false}};
+    InputReplay_Check(scenario);
+}
+
+static void test_empty_gallery(void) {
+    static const ReplayScenario scenario = {
+        "0 mid down\n50 mid up\n1000 down down\n1050 down up\n", 0,
+        2, {{KEY_ID_MID, KEY_GESTURE_SINGLE, 451}, {KEY_ID_DOWN, KEY_GESTURE_SINGLE, 1451}},
+        {UI_MODE_GALLERY, 0, 0, 0, false}};
+    InputReplay_Check(scenario);
+}
+
+static void test_top_cycles_effects_into_overlays(void) {
+    static const ReplayScenario scenario = {
+        "0 top down\n50 top up\n1000 top down\n1050 top up\n2000 top down\n2050 top up\n3000 top down\n3050 top up\n"
+        "4000 top down\n4050 top up\n5000 top down\n5050 top up\n6000 top down\n6050 top up\n7000 top down\n7050 top up\n", 0,
+        8, {{KEY_ID_TOP, KEY_GESTURE_SINGLE, 451}, {KEY_ID_TOP, KEY_GESTURE_SINGLE, 1451},
+            {KEY_ID_TOP, KEY_GESTURE_SINGLE, 2451}, {KEY_ID_TOP, KEY_GESTURE_SINGLE, 3451},
+            {KEY_ID_TOP, KEY_GESTURE_SINGLE, 4451}, {KEY_ID_TOP, KEY_GESTURE_SINGLE, 5451},
+            {KEY_ID_TOP, KEY_GESTURE_SINGLE, 6451}, {KEY_ID_TOP, KEY_GESTURE_SINGLE, 7451}},
+        {UI_MODE_PREVIEW, 0, 0, 0, false, UI_OVERLAY_ZEBRA}};
+    InputReplay_Check(scenario);
+}
+
+static void test_parse_log_lines(void) {
+    ReplayEdge edges[4];
+    int count = InputReplay_Parse("# pasted from the console\n[KeyTask] 10 top down\n\n[KeyTask] 90 top up\r\n", edges, 4);
+    TEST_ASSERT_EQUAL_INT(2, count);
+    TEST_ASSERT_EQUAL_UINT32(10, edges[0].timeMs);
+    TEST_ASSERT_EQUAL_INT(KEY_ID_TOP, edges[0].key);
+    TEST_ASSERT_TRUE(edges[0].pressed);
+    TEST_ASSERT_FALSE(edges[1].pressed);
+}
+
+static void test_parse_rejects_malformed_lines(void) {
+    ReplayEdge edges[1];
+    TEST_ASSERT_EQUAL_INT(-1, InputReplay_Parse("10 left down\n", edges, 1));
+    TEST_ASSERT_EQUAL_INT(-1, InputReplay_Parse("10 top pressed\n", edges, 1));
+    TEST_ASSERT_EQUAL_INT(-1, InputReplay_Parse("[KeyTask 10 top down\n", edges, 1));
+    TEST_ASSERT_EQUAL_INT(-1, InputReplay_Parse("10 top down\n20 top up\n", edges, 1)); // Overflow
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_single_click);
+    RUN_TEST(test_bounced_single_click);
+    RUN_TEST(test_double_click);
+    RUN_TEST(test_slow_double_click);
+    RUN_TEST(test_long_press_toggles_hud);
+    RUN_TEST(test_gallery_browsing);
+    RUN_TEST(test_empty_gallery);
+    RUN_TEST(test_top_cycles_effects_into_overlays);
+    RUN_TEST(test_parse_log_lines);
+    RUN_TEST(test_parse_rejects_malformed_lines);
+    return UNITY_END();
+}
@@ -0,0 +1,192 @@
+// test_motion_replay.cpp - Motion detector tests
+// Unity tests for the motion detector. Each test renders a synthetic frame sequence, runs it
+// through a fresh MotionDetector on a virtual 25 fps clock and compares the events with the
+// expected ones (same text format and tolerances as recorded sequences). Run with: pio test -e native
+//
+// Key features:
+// - Deterministic scenes: seeded texture plus per-frame sensor noise, no files needed
+// - Static noise, moving object, lighting change, flicker, object that stops, regions of interest
+// - Expected times follow from MOTION_START_FRAMES 2, MOTION_END_MS 1500, MOTION_LEARN_SHIFT_MOVING 7
+
+#include <unity.h>        // Unity test framework
+#include "motionReplay.h" // Module under test (parser, comparison)
+
+// Synthetic frame size (QVGA preview) and frame interval (25 fps)
+#define MOTION_SCENE_WIDTH 320
+#define MOTION_SCENE_HEIGHT 240
+#define MOTION_SCENE_FRAME_MS 40
+// Peak-to-peak sensor noise added to every pixel of the synthetic scenes
+#define MOTION_SCENE_NOISE 6
+
+/**
+ * @brief Step a xorshift generator (deterministic texture and noise).
+ */
+static uint32_t MotionReplay_Random(uint32_t &state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/**
+ * @brief Draw the static background: smooth gradient with a fixed random texture.
+ */
+static void MotionReplay_DrawBackground(uint8_t *gray) {
+    uint32_t seed = 0x2545F491;
+    for (int y = 0; y < MOTION_SCENE_HEIGHT; y++) {
+        for (int x = 0; x < MOTION_SCENE_WIDTH; x++) {
+            gray[y * MOTION_SCENE_WIDTH + x] = (uint8_t)(60 + x / 4 + y / 4 + (MotionReplay_Random(seed) & 15));
+        }
+    }
+}
+
+/**
+ * @brief Fill a rectangle of the scene, clipped to the frame.
+ */
+static void MotionReplay_DrawRect(uint8_t *gray, int x0, int y0, int w, int h, uint8_t value) {
+    for (int y = y0 < 0 ? 0 : y0; y < y0 + h && y < MOTION_SCENE_HEIGHT; y++) {
+        for (int x = x0 < 0 ? 0 : x0; x < x0 + w && x < MOTION_SCENE_WIDTH; x++) gray[y * MOTION_SCENE_WIDTH + x] = value;
+    }
+}
+
+// Scene renderers (frame index at 25 fps: frame 25 = 1000 ms)
+static void MotionReplay_SceneStatic(uint8_t *gray, int frame) {
+    (void)frame;
+    MotionReplay_DrawBackground(gray);
+}
+
+static void MotionReplay_SceneMovingObject(uint8_t *gray, int frame) {
+    MotionReplay_DrawBackground(gray);
+    if (frame >= 20 && frame < 60) MotionReplay_DrawRect(gray, 40 + (frame - 20) * 4, 100, 32, 32, 20); // Crosses left to right
+}
+
+static void MotionReplay_SceneLightingStep(uint8_t *gray, int frame) {
+    MotionReplay_DrawBackground(gray);
+    if (frame < 30) return;
+    for (int i = 0; i < MOTION_SCENE_WIDTH * MOTION_SCENE_HEIGHT; i++) gray[i] += 50; // Lights switched on
+}
+
+static void MotionReplay_SceneFlicker(uint8_t *gray, int frame) {
+    MotionReplay_DrawBackground(gray);
+    if (frame & 1) MotionReplay_DrawRect(gray, 200, 60, 6, 6, 250); // Blinking LED, below MOTION_MIN_CELLS
+}
+
+static void MotionReplay_SceneObjectStops(uint8_t *gray, int frame) {
+    MotionReplay_DrawBackground(gray);
+    if (frame >= 20) MotionReplay_DrawRect(gray, 160, 120, 40, 40, 230); // Placed and left in view
+}
+
+/**
+ * @brief Convert a gray scene to an RGB565 frame in panel byte order, adding sensor noise.
+ */
+static void MotionReplay_ToFrame(const uint8_t *gray, uint16_t *frame, uint32_t &noise) {
+    for (int i = 0; i < MOTION_SCENE_WIDTH * MOTION_SCENE_HEIGHT; i++) {
+        int value = gray[i] + (int)(MotionReplay_Random(noise) % (MOTION_SCENE_NOISE + 1)) - MOTION_SCENE_NOISE / 2;
+        value = value < 0 ? 0 : value > 255 ? 255 : value;
+        uint16_t color = (uint16_t)(((value >> 3) << 11) | ((value >> 2) << 5) | (value >> 3));
+        frame[i] = (uint16_t)((color << 8) | (color >> 8));
+    }
+}
+
+/**
+ * @brief Render a scene, run it through a fresh detector and compare the events.
+ * @param frameCount Frames to render
+ * @param render Draws the scene content (8-bit gray) of a frame
+ * @param expectedText Expected events in text format
+ * @param roi Region of interest (w = 0: whole frame)
+ */
+static void MotionReplay_Check(int frameCount, void (*render)(uint8_t *gray, int frame), const char *expectedText,
+                               MotionBox roi = MotionBox{0, 0, 0, 0}) {
+    static MotionDetector detector; // Kept off the stack
+    static uint8_t gray[MOTION_SCENE_WIDTH * MOTION_SCENE_HEIGHT];
+    static uint16_t frame[MOTION_SCENE_WIDTH * MOTION_SCENE_HEIGHT];
+    MotionEvent expected[MOTION_REPLAY_MAX_EVENTS], actual[MOTION_REPLAY_MAX_EVENTS] = {};
+    int expectedCount = MotionReplay_Parse(expectedText, expected, MOTION_REPLAY_MAX_EVENTS);
+    TEST_ASSERT_TRUE_MESSAGE(expectedCount >= 0, "malformed expected events");
+    MotionConfig config;
+    MotionDetector_DefaultConfig(config);
+    if (roi.w > 0) {
+        config.roiCount = 1;
+        config.roi[0] = roi;
+    }
+    MotionDetector_Init(detector, &config);
+    uint32_t noise = 0x9E3779B9;
+    int actualCount = 0;
+    for (int i = 0; i < frameCount; i++) {
+        render(gray, i);
+        MotionReplay_ToFrame(gray, frame, noise);
+        MotionEvent event;
+        if (!MotionDetector_Process(detector, frame, MOTION_SCENE_WIDTH, MOTION_SCENE_HEIGHT,
+                                    (uint32_t)i * MOTION_SCENE_FRAME_MS, event)) {
+            continue;
+        }
+        if (actualCount < MOTION_REPLAY_MAX_EVENTS) actual[actualCount++] = event;
+    }
+    int mismatches = MotionReplay_Compare(expected, expectedCount, actual, actualCount,
+                                          [](const char *line) { TEST_MESSAGE(line); });
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, mismatches, "events differ from the expected ones");
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_static_scene(void) {
+    MotionReplay_Check(100, MotionReplay_SceneStatic, "");
+}
+
+static void test_moving_object(void) {
+    MotionReplay_Check(120, MotionReplay_SceneMovingObject,
+                       "840 start 44 100 32 32\n"
+                       "3880 end 44 100 184 32\n");
+}
+
+static void test_lighting_change(void) {
+    MotionReplay_Check(100, MotionReplay_SceneLightingStep, "");
+}
+
+static void test_flicker(void) {
+    MotionReplay_Check(100, MotionReplay_SceneFlicker, "");
+}
+
+static void test_object_stops(void) {
+    MotionReplay_Check(300, MotionReplay_SceneObjectStops,
+                       "840 start 160 120 40 40\n"
+                       "8920 end 160 120 40 40\n");
+}
+
+static void test_motion_outside_region(void) {
+    MotionReplay_Check(120, MotionReplay_SceneMovingObject, "", MotionBox{0, 160, 320, 80});
+}
+
+static void test_motion_entering_region(void) {
+    MotionReplay_Check(120, MotionReplay_SceneMovingObject,
+                       "1760 start 160 100 8 32\n"
+                       "3880 end 160 100 68 32\n", MotionBox{160, 0, 160, 240});
+}
+
+static void test_parse_log_lines(void) {
+    MotionEvent events[2];
+    int count = MotionReplay_Parse("# blessed\n[Motion] 840 start 44 100 32 32 57\n\n3880 end 44 100 184 32\n", events, 2);
+    TEST_ASSERT_EQUAL_INT(2, count);
+    TEST_ASSERT_EQUAL_INT(MOTION_EVENT_START, events[0].type);
+    TEST_ASSERT_EQUAL_UINT32(840, events[0].timeMs);
+    TEST_ASSERT_EQUAL_INT(57, events[0].score);
+    TEST_ASSERT_EQUAL_INT(MOTION_EVENT_END, events[1].type);
+    TEST_ASSERT_EQUAL_INT(184, events[1].box.w);
+    TEST_ASSERT_EQUAL_INT(-1, MotionReplay_Parse("840 begin 44 100 32 32\n", events, 2));
+    TEST_ASSERT_EQUAL_INT(-1, MotionReplay_Parse("840 start 44 100\n", events, 2));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_static_scene);
+    RUN_TEST(test_moving_object);
+    RUN_TEST(test_lighting_change);
+    RUN_TEST(test_flicker);
+    RUN_TEST(test_object_stops);
+    RUN_TEST(test_motion_outside_region);
+    RUN_TEST(test_motion_entering_region);
+    RUN_TEST(test_parse_log_lines);
+    return UNITY_END();
+}
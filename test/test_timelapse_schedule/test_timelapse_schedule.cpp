@@ -0,0 +1,115 @@
+// test_timelapse_schedule.cpp - Timelapse schedule tests
+// Unity tests for the timelapse schedule. Each test drives the schedule with a virtual clock
+// that models timer wake-up latency, sensor start-up time, shot duration and key presses during
+// sleep, the same way TimelapseTask drives it with millis(). Run with: pio test -e native
+//
+// Key features:
+// - Capture times checked against start + n * interval (no drift from shot duration or wake latency)
+// - Overrun slots skipped and counted, key wake windows clipped to the next shot
+// - Statistics and millis() wrap-around
+
+#include <unity.h>             // Unity test framework
+#include <stdio.h>             // snprintf
+#include "timelapseSchedule.h" // Module under test
+
+// Maximum shots per scenario
+#define TIMELAPSE_SCENARIO_MAX_SHOTS 8
+
+// One virtual-clock scenario
+struct TimelapseScenario {
+    uint32_t startMs;        // millis() when the timelapse starts
+    uint32_t intervalMs;     // Shot interval
+    uint32_t wakeLatencyMs;  // Timer expiry to code running
+    uint32_t shotDelayMs;    // Start of a shot to frame captured (sensor power-up and init)
+    uint32_t keyWakeMs;      // Time of a key press during sleep, from the start (0 = none)
+    uint32_t keyWindowMs;    // Time the device stays awake after the key press
+    int shotCount;           // Shots to simulate
+    uint32_t busyMs[TIMELAPSE_SCENARIO_MAX_SHOTS];     // Start of each shot to ready-to-sleep
+    uint32_t expectedMs[TIMELAPSE_SCENARIO_MAX_SHOTS]; // Expected capture times, from the start
+    uint32_t expectedMissed; // Expected skipped slots
+};
+
+/**
+ * @brief Run a scenario on a virtual clock and check the capture times and missed slots.
+ * @param stats Receives the schedule statistics (may be NULL)
+ */
+static void TimelapseSchedule_Check(const TimelapseScenario &scenario, TimelapseStats *stats = NULL) {
+    TimelapseSchedule schedule;
+    uint32_t now = scenario.startMs, wake = now;
+    uint32_t keyWake = scenario.startMs + scenario.keyWakeMs;
+    bool keyPending = scenario.keyWakeMs != 0;
+    TimelapseSchedule_Start(schedule, scenario.intervalMs, now);
+    for (int i = 0; i < scenario.shotCount; i++) {
+        for (uint32_t sleep = TimelapseSchedule_SleepMs(schedule, now); sleep > 0;
+             sleep = TimelapseSchedule_SleepMs(schedule, now)) {
+            if (keyPending && (int32_t)(keyWake - now) > 0 && (int32_t)(keyWake - now) < (int32_t)sleep) { // Woken by the key
+                keyPending = false;
+                now = wake = keyWake;
+                now += TimelapseSchedule_WakeWindowMs(schedule, now, scenario.keyWindowMs);
+                continue;
+            }
+            now += sleep + scenario.wakeLatencyMs; // Timer wake-up
+            wake = now;
+        }
+        char message[32];
+        snprintf(message, sizeof(message), "shot %d", i);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(scenario.expectedMs[i], now + scenario.shotDelayMs - scenario.startMs, message);
+        uint32_t shot = now + scenario.shotDelayMs;
+        now += scenario.busyMs[i];
+        TimelapseSchedule_ShotDone(schedule, wake, shot, now);
+    }
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(scenario.expectedMissed, schedule.missed, "missed slots");
+    if (stats) TimelapseSchedule_GetStats(schedule, *stats);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_steady(void) {
+    static const TimelapseScenario scenario = {0, 5000, 3, 400, 0, 0, 5,
+        {800, 800, 800, 800, 800}, {400, 5403, 10403, 15403, 20403}, 0};
+    TimelapseStats stats;
+    TimelapseSchedule_Check(scenario, &stats);
+    TEST_ASSERT_EQUAL_UINT32(5, stats.shots);
+    TEST_ASSERT_EQUAL_UINT32(800, stats.awakeMaxMs);
+    TEST_ASSERT_EQUAL_UINT32(160, stats.awakePermille); // 800 ms awake per 5 s
+    TEST_ASSERT_EQUAL_UINT32(3, stats.jitterMaxMs);     // Only the first gap includes the wake latency
+}
+
+static void test_no_drift(void) {
+    // A schedule relative to the end of the previous shot would drift by about 1 s per shot here
+    static const TimelapseScenario scenario = {0, 1000, 50, 100, 0, 0, 6,
+        {900, 900, 900, 900, 900, 900}, {100, 1150, 2150, 3150, 4150, 5150}, 0};
+    TimelapseSchedule_Check(scenario);
+}
+
+static void test_overrun(void) {
+    static const TimelapseScenario scenario = {0, 2000, 5, 300, 0, 0, 4,
+        {800, 2600, 800, 800}, {300, 2305, 6305, 8305}, 1};
+    TimelapseSchedule_Check(scenario);
+}
+
+static void test_key_wake(void) {
+    // The key window (2 s from 9.5 s) ends at the due time instead of delaying the shot
+    static const TimelapseScenario scenario = {0, 10000, 5, 300, 9500, 2000, 3,
+        {800, 800, 800}, {300, 10300, 20305}, 0};
+    TimelapseSchedule_Check(scenario);
+}
+
+static void test_millis_wraparound(void) {
+    // Same as "steady", started 6 s before millis() wraps
+    static const TimelapseScenario scenario = {0xFFFFFFFFu - 6000, 5000, 3, 400, 0, 0, 5,
+        {800, 800, 800, 800, 800}, {400, 5403, 10403, 15403, 20403}, 0};
+    TimelapseSchedule_Check(scenario);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_steady);
+    RUN_TEST(test_no_drift);
+    RUN_TEST(test_overrun);
+    RUN_TEST(test_key_wake);
+    RUN_TEST(test_millis_wraparound);
+    return UNITY_END();
+}
@@ -0,0 +1,364 @@
+// test_trace_ring.cpp - Trace ring tests
+// Unity tests for the trace ring and its Chrome trace exporter. Each test records a known
+// event sequence into a small ring, exports it, parses the JSON back and compares the events
+// that come out with the ones that went in. Run with: pio test -e native
+//
+// Key features:
+// - Wraparound: only the newest Capacity events survive, oldest first
+// - Nesting: begin/end pairs stay balanced per task after the export
+// - JSON validity checked by a small strict parser (objects, arrays, strings, numbers)
+// - Names with quotes, backslashes and control characters are escaped, not passed through
+
+#include <unity.h>     // Unity test framework
+#include <stdlib.h>    // strtoull
+#include "traceRing.h" // Module under test
+
+// Ring capacity used by the scenarios (small, so wraparound is cheap to reach; more slots than thread name records)
+#define TRACE_SCENARIO_CAPACITY 64
+// Exported events the parser keeps per scenario
+#define TRACE_SCENARIO_MAX_EVENTS 128
+// Export buffer size per scenario
+#define TRACE_SCENARIO_JSON_SIZE 16384
+// Deepest begin/end nesting checked per task
+#define TRACE_SCENARIO_MAX_DEPTH 8
+
+// One event read back from the exported JSON
+struct TraceParsedEvent {
+    char name[24];       // "name" value
+    char phase;          // "ph" value
+    uint64_t timestamp;  // "ts" value (0 for metadata)
+    uint32_t pid;        // "pid" value
+    uint32_t tid;        // "tid" value
+};
+
+// Export collected into a bounded buffer
+struct TraceJsonBuffer {
+    char *text;          // NUL-terminated output
+    size_t used;         // Bytes written
+    bool overflow;       // Output did not fit
+};
+
+// Strict JSON parser state (enough JSON for the exporter's output, nothing lenient)
+struct TraceJsonParser {
+    const char *p;                       // Cursor
+    TraceParsedEvent *events;            // Parsed trace events
+    int count;                           // Events parsed
+    bool ok;                             // No syntax error so far
+};
+
+/**
+ * @brief Exporter callback that appends to a TraceJsonBuffer.
+ */
+static void TraceRing_WriteBuffer(const char *text, size_t len, void *arg) {
+    TraceJsonBuffer *buffer = (TraceJsonBuffer *)arg;
+    if (buffer->used + len >= TRACE_SCENARIO_JSON_SIZE) {
+        buffer->overflow = true;
+        return;
+    }
+    memcpy(buffer->text + buffer->used, text, len);
+    buffer->used += len;
+    buffer->text[buffer->used] = '\0';
+}
+
+/**
+ * @brief Skip JSON whitespace.
+ */
+static void TraceJson_Space(TraceJsonParser &parser) {
+    while (*parser.p == ' ' || *parser.p == '\n' || *parser.p == '\r' || *parser.p == '\t') parser.p++;
+}
+
+/**
+ * @brief Consume one expected character.
+ * @return false (and mark the parse failed) if it is not next
+ */
+static bool TraceJson_Expect(TraceJsonParser &parser, char c) {
+    TraceJson_Space(parser);
+    if (*parser.p != c) return parser.ok = false;
+    parser.p++;
+    return true;
+}
+
+/**
+ * @brief Parse a string; control characters and bad escapes are errors.
+ * @param out Receives the (truncated) value, may be NULL
+ * @param size Size of out
+ */
+static bool TraceJson_String(TraceJsonParser &parser, char *out, size_t size) {
+    if (!TraceJson_Expect(parser, '"')) return false;
+    size_t n = 0;
+    while (*parser.p != '"') {
+        char c = *parser.p++;
+        if ((unsigned char)c < 0x20) return parser.ok = false; // Includes the terminator
+        if (c == '\\') {
+            c = *parser.p++;
+            if (!strchr("\"\\/bfnrtu", c) || c == '\0') return parser.ok = false;
+        }
+        if (out && n + 1 < size) out[n++] = c;
+    }
+    parser.p++;
+    if (out) out[n] = '\0';
+    return true;
+}
+
+/**
+ * @brief Parse a non-negative integer (the exporter writes no other numbers).
+ */
+static bool TraceJson_Number(TraceJsonParser &parser, uint64_t &value) {
+    TraceJson_Space(parser);
+    if (*parser.p < '0' || *parser.p > '9') return parser.ok = false;
+    char *end;
+    value = strtoull(parser.p, &end, 10);
+    parser.p = end;
+    return true;
+}
+
+static bool TraceJson_Value(TraceJsonParser &parser, TraceParsedEvent *event, const char *key);
+
+/**
+ * @brief Parse an object; fields of interest go into event when it is not NULL.
+ */
+static bool TraceJson_Object(TraceJsonParser &parser, TraceParsedEvent *event) {
+    if (!TraceJson_Expect(parser, '{')) return false;
+    TraceJson_Space(parser);
+    if (*parser.p == '}') return parser.p++, true;
+    do {
+        char key[16];
+        if (!TraceJson_String(parser, key, sizeof(key)) || !TraceJson_Expect(parser, ':')) return false;
+        if (!TraceJson_Value(parser, event, key)) return false;
+        TraceJson_Space(parser);
+    } while (*parser.p == ',' && parser.p++);
+    return TraceJson_Expect(parser, '}');
+}
+
+/**
+ * @brief Parse any value; a top-level "traceEvents" array element becomes a parsed event.
+ * @param event Event being filled (NULL outside trace event objects)
+ * @param key Key the value belongs to ("" for array elements)
+ */
+static bool TraceJson_Value(TraceJsonParser &parser, TraceParsedEvent *event, const char *key) {
+    TraceJson_Space(parser);
+    if (*parser.p == '{') return TraceJson_Object(parser, NULL); // Nested objects ("args") are only validated
+    if (*parser.p == '[') {
+        bool events = strcmp(key, "traceEvents") == 0;
+        parser.p++;
+        TraceJson_Space(parser);
+        if (*parser.p == ']') return parser.p++, true;
+        do {
+            TraceParsedEvent parsed = {};
+            bool keep = events && parser.count < TRACE_SCENARIO_MAX_EVENTS;
+            if (events ? !TraceJson_Object(parser, keep ? &parsed : NULL) : !TraceJson_Value(parser, NULL, "")) return false;
+            if (keep) parser.events[parser.count++] = parsed;
+            TraceJson_Space(parser);
+        } while (*parser.p == ',' && parser.p++);
+        return TraceJson_Expect(parser, ']');
+    }
+    if (*parser.p == '"') {
+        char text[24];
+        if (!TraceJson_String(parser, text, sizeof(text))) return false;
+        if (event && strcmp(key, "name") == 0) strcpy(event->name, text);
+        if (event && strcmp(key, "ph") == 0) event->phase = text[0];
+        return true;
+    }
+    uint64_t value;
+    if (!TraceJson_Number(parser, value)) return false;
+    if (event && strcmp(key, "ts") == 0) event->timestamp = value;
+    if (event && strcmp(key, "pid") == 0) event->pid = (uint32_t)value;
+    if (event && strcmp(key, "tid") == 0) event->tid = (uint32_t)value;
+    return true;
+}
+
+/**
+ * @brief Export events and parse the JSON back.
+ * @param events Events to export
+ * @param count Number of events
+ * @param json Export buffer (TRACE_SCENARIO_JSON_SIZE bytes)
+ * @param parsed Receives up to TRACE_SCENARIO_MAX_EVENTS exported events (metadata included)
+ * @return Number of parsed events, or -1 if the output is not valid JSON
+ */
+static int TraceRing_ExportAndParse(const TraceEvent *events, size_t count, char *json, TraceParsedEvent *parsed) {
+    TraceJsonBuffer buffer = {json, 0, false};
+    json[0] = '\0';
+    TraceRing_ExportChrome(events, count, TraceRing_WriteBuffer, &buffer);
+    if (buffer.overflow) return -1;
+    TraceJsonParser parser = {json, parsed, 0, true};
+    if (!TraceJson_Object(parser, NULL)) return -1; // The top level object holds "traceEvents"
+    TraceJson_Space(parser);
+    return parser.ok && *parser.p == '\0' ? parser.count : -1;
+}
+
+// Event to record in a scenario
+struct TraceScenarioStep {
+    const char *name;   // Event name
+    char phase;         // TRACE_PHASE_*
+    uint32_t taskId;    // Recording task
+    uint8_t core;       // Recording core
+};
+
+// One built-in scenario
+struct TraceScenario {
+    const char *name;               // Scenario name
+    const TraceScenarioStep *steps; // Events recorded in order (timestamps 1000, 1001, ...)
+    int stepCount;                  // Number of steps
+    int repeat;                     // How often the steps are recorded
+    bool clearFirst;                // Record once, clear, then record the real sequence
+};
+
+// Two tasks on two cores, interleaved, each with nested scopes and an instant event
+static const TraceScenarioStep traceNestedSteps[] = {
+    {"frame", TRACE_PHASE_BEGIN, 1, 0},     {"sd_write", TRACE_PHASE_BEGIN, 2, 1},
+    {"decode", TRACE_PHASE_BEGIN, 1, 0},    {"convert", TRACE_PHASE_BEGIN, 1, 0},
+    {"convert", TRACE_PHASE_END, 1, 0},     {"sd_open", TRACE_PHASE_INSTANT, 2, 1},
+    {"decode", TRACE_PHASE_END, 1, 0},      {"sd_write", TRACE_PHASE_END, 2, 1},
+    {"draw", TRACE_PHASE_BEGIN, 1, 0},      {"draw", TRACE_PHASE_END, 1, 0},
+    {"frame", TRACE_PHASE_END, 1, 0},
+};
+
+// One scope per task, for wraparound and clearing
+static const TraceScenarioStep tracePairSteps[] = {
+    {"scope", TRACE_PHASE_BEGIN, 7, 0}, {"tick", TRACE_PHASE_INSTANT, 7, 0}, {"scope", TRACE_PHASE_END, 7, 0},
+};
+
+// More tasks than the exporter keeps thread names for (filled in by main)
+static TraceScenarioStep traceManyTaskSteps[40];
+
+static const TraceScenario traceScenarios[] = {
+    {"empty ring", NULL, 0, 1, false},
+    {"nested scopes", traceNestedSteps, sizeof(traceNestedSteps) / sizeof(traceNestedSteps[0]), 1, false},
+    {"wraparound", tracePairSteps, 3, 22, false}, // 66 events into 64 slots
+    {"clear", tracePairSteps, 3, 2, true},
+    {"many tasks", traceManyTaskSteps, 40, 1, false},
+};
+
+/**
+ * @brief Run one scenario: record, snapshot, export, parse and compare.
+ * @return NULL if it passed, otherwise what went wrong
+ */
+static const char *TraceRing_RunScenario(const TraceScenario &scenario) {
+    static TraceRing<TRACE_SCENARIO_CAPACITY> ring;
+    static TraceEvent snapshot[TRACE_SCENARIO_CAPACITY];
+    static char json[TRACE_SCENARIO_JSON_SIZE];
+    static TraceParsedEvent parsed[TRACE_SCENARIO_MAX_EVENTS];
+    ring.clear();
+    uint32_t before = ring.recorded();
+    uint64_t timestamp = 1000;
+    for (int pass = scenario.clearFirst ? 0 : 1; pass <= 1; pass++) {
+        if (pass == 1 && scenario.clearFirst) ring.clear();
+        for (int r = 0; r < scenario.repeat; r++) {
+            for (int i = 0; i < scenario.stepCount; i++) {
+                const TraceScenarioStep &step = scenario.steps[i];
+                ring.record(timestamp++, step.name, step.phase, step.core, step.taskId, "scenario");
+            }
+        }
+    }
+    int recorded = scenario.repeat * scenario.stepCount; // Events of the real sequence
+    int kept = recorded < TRACE_SCENARIO_CAPACITY ? recorded : TRACE_SCENARIO_CAPACITY;
+
+    // Snapshot: the newest events, oldest first, with consecutive timestamps
+    size_t count = ring.snapshot(snapshot);
+    if ((int)count != kept) return "snapshot size";
+    for (size_t i = 0; i < count; i++) {
+        if (snapshot[i].timestampUs != timestamp - kept + i) return "snapshot order";
+        if (strcmp(snapshot[i].task, "scenario") != 0) return "task name";
+    }
+    if (ring.recorded() - before != (uint32_t)(recorded * (scenario.clearFirst ? 2 : 1))) return "recorded count";
+
+    // Export: valid JSON, every snapshot event once in order, one thread name per task
+    int parsedCount = TraceRing_ExportAndParse(snapshot, count, json, parsed);
+    if (parsedCount < 0) return "invalid JSON";
+    int events = 0, metadata = 0;
+    for (int i = 0; i < parsedCount; i++) {
+        const TraceParsedEvent &e = parsed[i];
+        if (e.phase == 'M') {
+            metadata++;
+            continue;
+        }
+        const TraceEvent &s = snapshot[events++];
+        if (e.phase != s.phase || strcmp(e.name, s.name) != 0 || e.timestamp != s.timestampUs || e.pid != s.core ||
+            e.tid != s.taskId) {
+            return "exported event differs";
+        }
+    }
+    int tasks = 0;
+    for (size_t i = 0; i < count; i++) {
+        bool seen = false;
+        for (size_t j = 0; j < i; j++) seen |= snapshot[j].taskId == snapshot[i].taskId && snapshot[j].core == snapshot[i].core;
+        if (!seen) tasks++;
+    }
+    if (events != (int)count) return "exported event count";
+    if (metadata != (tasks < 32 ? tasks : 32)) return "thread name records";
+
+    // Nesting: per task, every end closes the innermost open begin of the same name. After a
+    // wraparound the oldest begins are gone, so ends with an empty stack are allowed then.
+    for (int i = 0; i < parsedCount; i++) {
+        if (parsed[i].phase != TRACE_PHASE_END) continue;
+        int depth = 0; // Open scopes of this task before event i, innermost last
+        const char *stack[TRACE_SCENARIO_MAX_DEPTH];
+        for (int j = 0; j < i; j++) {
+            const TraceParsedEvent &e = parsed[j];
+            if (e.tid != parsed[i].tid || e.pid != parsed[i].pid) continue;
+            if (e.phase == TRACE_PHASE_BEGIN && depth < TRACE_SCENARIO_MAX_DEPTH) stack[depth++] = e.name;
+            else if (e.phase == TRACE_PHASE_END && depth > 0) depth--;
+        }
+        if (depth == 0 ? recorded <= TRACE_SCENARIO_CAPACITY : strcmp(stack[depth - 1], parsed[i].name) != 0) {
+            return "unbalanced begin/end";
+        }
+    }
+    return NULL;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_empty_ring(void) {
+    const char *problem = TraceRing_RunScenario(traceScenarios[0]);
+    TEST_ASSERT_NULL_MESSAGE(problem, problem);
+}
+
+static void test_nested_scopes(void) {
+    const char *problem = TraceRing_RunScenario(traceScenarios[1]);
+    TEST_ASSERT_NULL_MESSAGE(problem, problem);
+}
+
+static void test_wraparound(void) {
+    const char *problem = TraceRing_RunScenario(traceScenarios[2]);
+    TEST_ASSERT_NULL_MESSAGE(problem, problem);
+}
+
+static void test_clear(void) {
+    const char *problem = TraceRing_RunScenario(traceScenarios[3]);
+    TEST_ASSERT_NULL_MESSAGE(problem, problem);
+}
+
+static void test_many_tasks(void) {
+    const char *problem = TraceRing_RunScenario(traceScenarios[4]);
+    TEST_ASSERT_NULL_MESSAGE(problem, problem);
+}
+
+static void test_escaped_names(void) {
+    static char json[TRACE_SCENARIO_JSON_SIZE];
+    static TraceParsedEvent parsed[TRACE_SCENARIO_MAX_EVENTS];
+    const TraceEvent events[2] = {
+        {1000, "say \"hi\"", "a\\b\"c", 1, 0, TRACE_PHASE_BEGIN},
+        {1001, "line\nbreak\t", "a\\b\"c", 1, 0, TRACE_PHASE_END},
+    };
+    int count = TraceRing_ExportAndParse(events, 2, json, parsed);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(3, count, "invalid JSON"); // Thread name + two events
+    TEST_ASSERT_EQUAL_STRING("say \"hi\"", parsed[1].name); // The parser keeps the escaped character
+    TEST_ASSERT_NOT_NULL(strstr(json, "line\\u000abreak\\u0009"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"a\\\\b\\\"c\""));
+}
+
+int main(int argc, char **argv) {
+    for (int i = 0; i < 40; i++) {
+        traceManyTaskSteps[i] = {"work", TRACE_PHASE_INSTANT, (uint32_t)(100 + i / 2), (uint8_t)(i % 2)};
+    }
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_ring);
+    RUN_TEST(test_nested_scopes);
+    RUN_TEST(test_wraparound);
+    RUN_TEST(test_clear);
+    RUN_TEST(test_many_tasks);
+    RUN_TEST(test_escaped_names);
+    return UNITY_END();
+}